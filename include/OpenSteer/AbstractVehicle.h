@@ -79,6 +79,14 @@ namespace OpenSteer {
         // (assumes velocity remains constant)
         virtual Vec3 predictFuturePosition (const float predictionTime) const = 0;
 
+        // same as predictFuturePosition, but vehicles which keep a per-tick
+        // cache of their predictions answer from it.  Used by steering
+        // behaviors reading another vehicle's future (pursuit, evasion).
+        virtual Vec3 cachedFuturePosition (const float predictionTime) const
+        {
+            return predictFuturePosition (predictionTime);
+        }
+
         // ----------------------------------------------------------------------
         // XXX this vehicle-model-specific functionality functionality seems out
         // XXX of place on the abstract base class, but for now it is expedient
@@ -0,0 +1,316 @@
+/**
+ * OpenSteer -- Steering Behaviors for Autonomous Characters
+ *
+ * Copyright (c) 2002-2005, Sony Computer Entertainment America
+ * Original author: Craig Reynolds <craig_reynolds@playstation.sony.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ *
+ * @file
+ *
+ * Segmented pathway build of centripetal Catmull-Rom spline segments with
+ * arc length lookup tables and radii interpolated between the control
+ * points.
+ */
+#ifndef OPENSTEER_CATMULLROMSEGMENTEDPATHWAY_H
+#define OPENSTEER_CATMULLROMSEGMENTEDPATHWAY_H
+
+// Include std::vector
+#include <vector>
+
+
+// Include OpenSteer::SegmentedPathway
+#include "OpenSteer/SegmentedPathway.h"
+
+// Include OpenSteer::PointToPathAlikeBaseDataExtractionPolicy
+#include "OpenSteer/QueryPathAlikeBaseDataExtractionPolicies.h"
+
+// Include OpenSteer::Vec3
+#include "OpenSteer/Vec3.h"
+
+// Include OpenSteer::distance
+#include "OpenSteer/Vec3Utilities.h"
+
+
+
+namespace OpenSteer {
+    
+    
+    /**
+     * Smooth segmented pathway through its points. Every segment is a 
+     * centripetal Catmull-Rom spline from one point to the next, so far 
+     * fewer points (and segments to test in path queries) are needed for a
+     * smooth route than with polylines.
+     *
+     * Every point carries a radius, along a segment the radius is 
+     * interpolated linearly by arc length.
+     *
+     * Distances along segments are arc lengths. Each segment keeps a lookup
+     * table of the arc length at @c samplesPerSegment + 1 evenly spaced 
+     * curve parameters which are refined by a Newton step when mapping
+     * distances to curve parameters. Mapping points to a segment starts at
+     * the nearest table sample and refines the curve parameter with Newton
+     * iterations.
+     *
+     * The ends of a non-cyclic pathway continue the first and last segment
+     * direction.
+     */
+    class CatmullRomSegmentedPathway : public SegmentedPathway {
+    public:
+        
+        /**
+         * Constructs an invalid pathway.
+         */
+        CatmullRomSegmentedPathway();
+        
+        /**
+         * Constructs a pathway through @a numOfPoints @a points with the
+         * associated @a radii (one per point).
+         *
+         * There mustn't be two adjacent points that are equal. The first and 
+         * last point mustn't be identical, too. If @a closedCycle is @c true
+         * the first point is duplicated at the end to represent the end point
+         * of the segment closing the cycle.
+         *
+         * @a samplesPerSegment is the number of intervals of the arc length
+         * lookup table of each segment.
+         */
+        CatmullRomSegmentedPathway( size_type numOfPoints,
+                                    Vec3 const points[],
+                                    float const radii[],
+                                    bool closedCycle,
+                                    size_type samplesPerSegment = 16 );
+        CatmullRomSegmentedPathway( CatmullRomSegmentedPathway const& other );
+        virtual ~CatmullRomSegmentedPathway();
+        
+        CatmullRomSegmentedPathway& operator=( CatmullRomSegmentedPathway other );
+        
+        /**
+         * Swaps the content with @a other.
+         */
+        void swap( CatmullRomSegmentedPathway& other );
+        
+        /**
+         * Replaces the pathway information completely, see the constructor.
+         */
+        void setPathway( size_type numOfPoints,
+                         Vec3 const points[],
+                         float const radii[],
+                         bool closedCycle );
+        
+        /**
+         * Replaces @a numOfPoints points starting at @a startIndex. Only the
+         * segments whose shape depends on the moved points are recalculated
+         * (up to two on each side of a moved point).
+         *
+         * In the resulting sequence of points there mustn't be two adjacent 
+         * ones that are equal.
+         */
+        void movePoints( size_type startIndex,
+                         size_type numOfPoints,
+                         Vec3 const points[] );
+        
+        /**
+         * Returns the radius at point @a pointIndex.
+         */
+        float pointRadius( size_type pointIndex ) const;
+        
+        /**
+         * Sets the radius at point @a pointIndex to @a r.
+         */
+        void setPointRadius( size_type pointIndex, float r );
+        
+        /**
+         * Returns the number of arc length table intervals per segment.
+         */
+        size_type samplesPerSegment() const;
+        
+        /**
+         * Returns the curve parameter in <code>[0, 1]</code> of segment 
+         * @a segmentIndex reached after @a segmentDistance along the segment.
+         */
+        float mapSegmentDistanceToParameter( size_type segmentIndex, 
+                                             float segmentDistance ) const;
+        
+        /**
+         * Returns the arc length from the start of segment @a segmentIndex to
+         * the curve parameter @a parameter.
+         */
+        float mapParameterToSegmentDistance( size_type segmentIndex, 
+                                             float parameter ) const;
+        
+        
+        virtual bool isValid() const;
+        virtual Vec3 mapPointToPath (const Vec3& point,
+                                     Vec3& tangent,
+                                     float& outside) const;
+		virtual Vec3 mapPathDistanceToPoint (float pathDistance) const;
+		virtual float mapPointToPathDistance (const Vec3& point) const;
+        virtual void mapPointsToPath( size_t count, 
+                                      Vec3 const* points, 
+                                      float const* offsets, 
+                                      PointMapping* mappings ) const;
+        virtual bool isCyclic() const;
+        virtual float length() const;
+        
+        
+        virtual size_type pointCount() const;
+        virtual Vec3 point( size_type pointIndex ) const;  
+        
+        
+        virtual size_type segmentCount() const;
+        virtual float segmentLength( size_type segmentIndex ) const;
+        virtual Vec3 segmentStart( size_type segmentIndex ) const;
+        virtual Vec3 segmentEnd( size_type segmentIndex ) const;
+        virtual float mapPointToSegmentDistance( size_type segmentIndex, 
+                                                 Vec3 const& point ) const;
+        virtual Vec3 mapSegmentDistanceToPoint( size_type segmentIndex, 
+                                                float segmentDistance ) const;
+        virtual float mapSegmentDistanceToRadius( size_type segmentIndex, 
+                                                  float distanceOnSegment ) const;
+        virtual Vec3 mapSegmentDistanceToTangent( size_type segmentIndex, 
+                                                  float segmentDistance ) const;
+        
+        virtual void mapDistanceToSegmentPointAndTangentAndRadius( size_type segmentIndex,
+                                                                   float segmentDistance,
+                                                                   Vec3& pointOnPath,
+                                                                   Vec3& tangent,
+                                                                   float& radius ) const;
+        
+        virtual void mapPointToSegmentDistanceAndPointAndTangentAndRadius( size_type segmentIndex,
+                                                                           Vec3 const& point,
+                                                                           float& distance,
+                                                                           Vec3& pointOnPath,
+                                                                           Vec3& tangent,
+                                                                           float& radius) const;
+        
+    private:
+        /**
+         * Recalculates the curve coefficients, arc length table and samples
+         * of segment @a segmentIndex.
+         */
+        void updateSegment( size_type segmentIndex );
+        
+        /**
+         * Recalculates the distances along the pathway to the segment starts.
+         */
+        void updateSegmentStartDistances();
+        
+        Vec3 curvePoint( size_type segmentIndex, float parameter ) const;
+        Vec3 curveDerivative( size_type segmentIndex, float parameter ) const;
+        Vec3 curveSecondDerivative( size_type segmentIndex, float parameter ) const;
+        
+        /**
+         * Arc length of segment @a segmentIndex between the curve parameters
+         * @a first and @a last.
+         */
+        float arcLength( size_type segmentIndex, float first, float last ) const;
+        
+        /**
+         * Returns the curve parameter of the point on segment @a segmentIndex
+         * nearest to @a point.
+         */
+        float mapPointToParameter( size_type segmentIndex, Vec3 const& point ) const;
+        
+        /**
+         * Returns the tangent at @a parameter of segment @a segmentIndex.
+         */
+        Vec3 tangentAt( size_type segmentIndex, float parameter ) const;
+        
+    private:
+        // Cubic polynomial coefficients of a segment, 
+        // p(t) = c0 + c1 t + c2 t^2 + c3 t^3 for t in [0, 1].
+        struct Segment {
+            Vec3 c0;
+            Vec3 c1;
+            Vec3 c2;
+            Vec3 c3;
+        };
+        
+        std::vector< Vec3 > points_;
+        std::vector< float > radii_;
+        std::vector< Segment > segments_;
+        // samplesPerSegment_ + 1 arc lengths per segment, the last one is the
+        // segment length.
+        std::vector< float > arcLengths_;
+        // samplesPerSegment_ + 1 curve points per segment at the parameters
+        // of the arc length table.
+        std::vector< Vec3 > samplePoints_;
+        // Distance along the pathway at the start of every segment followed
+        // by the pathway length.
+        std::vector< float > segmentStartDistances_;
+        size_type samplesPerSegment_;
+        bool closedCycle_;
+    }; // class CatmullRomSegmentedPathway
+    
+    
+    /**
+     * Swaps the content of @a lhs and @a rhs.
+     */
+    inline void swap( CatmullRomSegmentedPathway& lhs, 
+                      CatmullRomSegmentedPathway& rhs ) {
+        lhs.swap( rhs );
+    }
+    
+    
+    /**
+     * Extracts the base data of @c CatmullRomSegmentedPathway.
+     */
+    template<>
+    class PointToPathAlikeBaseDataExtractionPolicy< CatmullRomSegmentedPathway > {
+    public:
+        
+        static void extract( CatmullRomSegmentedPathway const& pathAlike,
+                             CatmullRomSegmentedPathway::size_type segmentIndex,
+                             Vec3 const& point, 
+                             float& segmentDistance, 
+                             float& radius, 
+                             float& distancePointToPath, 
+                             Vec3& pointOnPathCenterLine, 
+                             Vec3& tangent ) {
+            pathAlike.mapPointToSegmentDistanceAndPointAndTangentAndRadius( segmentIndex, point, segmentDistance, pointOnPathCenterLine, tangent, radius );
+            distancePointToPath = distance( point, pointOnPathCenterLine ) - radius;
+        }
+        
+    }; // class PointToPathAlikeBaseDataExtractionPolicy
+    
+    
+    /**
+     * Extracts the base data of @c CatmullRomSegmentedPathway.
+     */
+    template<>
+    class DistanceToPathAlikeBaseDataExtractionPolicy< CatmullRomSegmentedPathway > {
+    public:
+        static void extract( CatmullRomSegmentedPathway const& pathAlike,
+                             CatmullRomSegmentedPathway::size_type segmentIndex,
+                             float segmentDistance, 
+                             Vec3& pointOnPathCenterLine, 
+                             Vec3& tangent, 
+                             float& radius )  {
+            pathAlike.mapDistanceToSegmentPointAndTangentAndRadius( segmentIndex, segmentDistance, pointOnPathCenterLine, tangent, radius );     
+        }
+        
+        
+    }; // DistanceToPathAlikeBaseDataExtractionPolicy
+    
+} // namespace OpenSteer
+
+
+#endif // OPENSTEER_CATMULLROMSEGMENTEDPATHWAY_H
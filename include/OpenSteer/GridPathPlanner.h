@@ -0,0 +1,272 @@
+/**
+ * OpenSteer -- Steering Behaviors for Autonomous Characters
+ *
+ * Copyright (c) 2002-2005, Sony Computer Entertainment America
+ * Original author: Craig Reynolds <craig_reynolds@playstation.sony.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ *
+ * @file
+ *
+ * Route planning around the blocked cells of an occupancy grid with 
+ * incremental repair of the searches when cells change and a cache for
+ * finished routes.
+ */
+#ifndef OPENSTEER_GRIDPATHPLANNER_H
+#define OPENSTEER_GRIDPATHPLANNER_H
+
+
+// Include std::vector
+#include <vector>
+
+// Include std::map
+#include <map>
+
+// Include std::pair
+#include <utility>
+
+// Include size_t
+#include <cstddef>
+
+
+// Include OpenSteer::Vec3
+#include "OpenSteer/Vec3.h"
+
+// Include OpenSteer::PlanningGrid
+#include "OpenSteer/PlanningGrid.h"
+
+
+
+namespace OpenSteer {
+    
+    
+    class PolylineSegmentedPathwaySegmentRadii;
+    
+    
+    /**
+     * Plans routes on the XZ plane around the blocked cells of a grid of 
+     * square cells. Cell <code>(i, j)</code> covers @c i to @c i + 1 cell
+     * sizes along the x axis and @c j to @c j + 1 cell sizes along the z axis
+     * from @c origin.
+     *
+     * Routes are searched on the eight connected grid with D* Lite, moves 
+     * never cut the corner of a blocked cell. The search state is kept per
+     * goal cell: further routes to the same goal and routes after cells
+     * changed (see @c setBlocked) only repair the part of the search that is
+     * affected instead of searching again. The grid route is shortened to
+     * waypoints in line of sight that keep at least the clearance of the 
+     * grid route. Every route segment gets the clearance to the nearest 
+     * blocked cell along it as its radius, clamped to the route radius range.
+     *
+     * Finished routes are cached by start and goal cell until a cell changes.
+     * @c findRoutes plans many requests at once, requests with different 
+     * goals are planned in parallel if OpenMP is enabled.
+     */
+    class GridPathPlanner {
+    public:
+        typedef size_t size_type;
+        
+        /**
+         * Route points and the radius of each segment between them.
+         */
+        struct Route {
+            std::vector< Vec3 > points;
+            std::vector< float > radii;
+        };
+        
+        /**
+         * Route request for @c findRoutes. @c route and @c found are set by
+         * the planner.
+         */
+        struct Request {
+            Vec3 start;
+            Vec3 goal;
+            Route route;
+            bool found;
+        };
+        
+        /**
+         * Work counted since construction or @c resetStatistics.
+         */
+        struct Statistics {
+            /// Requests answered from the route cache.
+            size_type cacheHits;
+            /// Requests that needed a (repaired or new) search.
+            size_type searches;
+            /// Cells expanded by the searches.
+            size_type expandedCells;
+            /// Cells whose search data was updated because of changed cells.
+            size_type repairedCells;
+        };
+        
+        
+        /**
+         * Creates a planner for @a cellCountX times @a cellCountZ cells of 
+         * @a cellSize whose corner lies at @a origin. All cells are free.
+         */
+        GridPathPlanner( int cellCountX, 
+                         int cellCountZ, 
+                         Vec3 const& origin, 
+                         float cellSize );
+        ~GridPathPlanner();
+        
+        int cellCountX() const;
+        int cellCountZ() const;
+        Vec3 const& origin() const;
+        float cellSize() const;
+        
+        /**
+         * Stores the indices of the cell containing the XZ position of 
+         * @a point in @a i and @a j and returns @c true. Returns @c false
+         * if the point is outside of the grid.
+         */
+        bool cellContaining( Vec3 const& point, int& i, int& j ) const;
+        
+        /**
+         * Returns the center of cell <code>(i, j)</code>.
+         */
+        Vec3 cellCenter( int i, int j ) const;
+        
+        bool isBlocked( int i, int j ) const;
+        
+        /**
+         * Blocks or frees cell <code>(i, j)</code>. Changing a cell repairs 
+         * the kept searches around it and invalidates the cached routes, 
+         * setting a cell to its current state does nothing.
+         */
+        void setBlocked( int i, int j, bool blocked );
+        
+        /**
+         * Sets the range route segment radii are clamped to.
+         */
+        void setRouteRadiusRange( float minRadius, float maxRadius );
+        float minRouteRadius() const;
+        float maxRouteRadius() const;
+        
+        /**
+         * Sets the number of cached routes and kept searches (one per goal
+         * cell). The least recently used ones are dropped first.
+         */
+        void setCacheCapacity( size_type routeCount, size_type searchCount );
+        size_type routeCacheCapacity() const;
+        size_type searchCacheCapacity() const;
+        
+        /**
+         * Drops all cached routes and kept searches.
+         */
+        void clearCache();
+        
+        /**
+         * Plans a route from @a start to @a goal and stores it in @a route.
+         * Returns @c false and leaves @a route unchanged if there is none, 
+         * e.g. because one of the points is outside of the grid, in a blocked
+         * cell or both are identical.
+         */
+        bool findRoute( Vec3 const& start, Vec3 const& goal, Route& route );
+        
+        /**
+         * Plans a route from @a start to @a goal and sets @a pathway to it.
+         * Returns @c false and leaves @a pathway unchanged if there is none.
+         */
+        bool findRoute( Vec3 const& start, 
+                        Vec3 const& goal, 
+                        PolylineSegmentedPathwaySegmentRadii& pathway );
+        
+        /**
+         * Plans the routes of @a count @a requests.
+         */
+        void findRoutes( Request* requests, size_type count );
+        
+        Statistics const& statistics() const;
+        void resetStatistics();
+        
+    private:
+        /**
+         * Not implemented to make it non-copyable.
+         */
+        GridPathPlanner( GridPathPlanner const& );
+        
+        /**
+         * Not implemented to make it non-copyable.
+         */
+        GridPathPlanner& operator=( GridPathPlanner );
+        
+    private:
+        class Search;
+        
+        /**
+         * Cached route as waypoint cells and segment radii.
+         */
+        struct CachedRoute {
+            std::vector< int > waypoints;
+            std::vector< float > radii;
+            size_type revision;
+            size_type lastUse;
+            bool found;
+        };
+        
+        typedef std::pair< int, int > RouteKey;
+        typedef std::map< RouteKey, CachedRoute > RouteCache;
+        typedef std::map< int, Search* > SearchCache;
+        
+        /**
+         * Recalculates the clearances if cells changed since the last time.
+         */
+        void updateClearances();
+        
+        /**
+         * Converts @a cached to @a route ending at @a start and @a goal. The
+         * start and goal cell centers are added if the direct segments from
+         * @a start or to @a goal would cross blocked cells.
+         */
+        void makeRoute( CachedRoute const& cached, 
+                        Vec3 const& start, 
+                        Vec3 const& goal, 
+                        Route& route ) const;
+        
+        /**
+         * Drops the least recently used routes and searches exceeding the
+         * cache capacities.
+         */
+        void trimCaches();
+        
+    private:
+        PlanningGrid grid_;
+        // Distance from each cell center to the nearest blocked cell center
+        // in cells.
+        std::vector< float > clearances_;
+        bool clearancesValid_;
+        float minRouteRadius_;
+        float maxRouteRadius_;
+        // Incremented for every changed cell.
+        size_type revision_;
+        size_type useCount_;
+        size_type routeCacheCapacity_;
+        size_type searchCacheCapacity_;
+        RouteCache routes_;
+        SearchCache searches_;
+        Statistics statistics_;
+    }; // class GridPathPlanner
+    
+    
+} // namespace OpenSteer
+
+
+#endif // OPENSTEER_GRIDPATHPLANNER_H
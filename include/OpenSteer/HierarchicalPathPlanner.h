@@ -0,0 +1,326 @@
+/**
+ * OpenSteer -- Steering Behaviors for Autonomous Characters
+ *
+ * Copyright (c) 2002-2005, Sony Computer Entertainment America
+ * Original author: Craig Reynolds <craig_reynolds@playstation.sony.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ *
+ * @file
+ *
+ * Hierarchical route planning on large occupancy grids: routes are planned 
+ * between the portals of grid clusters and refined to cells piece by piece.
+ */
+#ifndef OPENSTEER_HIERARCHICALPATHPLANNER_H
+#define OPENSTEER_HIERARCHICALPATHPLANNER_H
+
+
+// Include std::vector
+#include <vector>
+
+// Include size_t
+#include <cstddef>
+
+
+// Include OpenSteer::Vec3
+#include "OpenSteer/Vec3.h"
+
+// Include OpenSteer::PlanningGrid
+#include "OpenSteer/PlanningGrid.h"
+
+
+
+namespace OpenSteer {
+    
+    
+    class PolylineSegmentedPathwaySegmentRadii;
+    
+    
+    /**
+     * Plans routes on the XZ plane around the blocked cells of a grid of 
+     * square cells like @c GridPathPlanner, but for grids too large to 
+     * search cell by cell.
+     *
+     * The grid is divided into square clusters of @c clusterSize cells. 
+     * Where free cells of two neighboring clusters touch, the border cells
+     * on both sides become portals, and the move costs between all portals 
+     * of a cluster are precomputed. Routes are searched over the portals,
+     * so planning costs grow with the number of clusters crossed instead of
+     * the number of cells. Changing a cell only abstracts its cluster and
+     * the clusters sharing the changed border again, lazily before the next
+     * route is planned.
+     *
+     * A planned route is a list of portals. @c advanceRoute refines the next
+     * few legs between them to cells while a vehicle follows the route and
+     * emits them as a @c PolylineSegmentedPathwaySegmentRadii. As in 
+     * @c GridPathPlanner, moves on the eight connected grid never cut the 
+     * corner of a blocked cell, and each segment's radius is the clearance to
+     * the nearest blocked cell along it, clamped to the route radius range.
+     *
+     * Not thread safe. Abstracting clusters runs in parallel if OpenMP is
+     * enabled.
+     */
+    class HierarchicalPathPlanner {
+    public:
+        typedef size_t size_type;
+        
+        /**
+         * Route through the cluster portals planned by @c findRoute and 
+         * followed with @c advanceRoute.
+         */
+        class Route {
+        public:
+            Route();
+            
+            /**
+             * Returns @c true if no route has been planned.
+             */
+            bool empty() const;
+            
+            /**
+             * Number of legs between start, portals and goal.
+             */
+            size_type legCount() const;
+            
+            /**
+             * Index of the leg the vehicle was on at the last 
+             * @c advanceRoute.
+             */
+            size_type currentLeg() const;
+            
+        private:
+            friend class HierarchicalPathPlanner;
+            
+            Vec3 start_;
+            Vec3 goal_;
+            // Start cell, portal cells and goal cell.
+            std::vector< int > cells_;
+            size_type currentLeg_;
+            // Leg the emitted pathway starts with or cells_.size() if none
+            // has been emitted yet.
+            size_type emittedLeg_;
+        }; // class Route
+        
+        /**
+         * Work counted since construction or @c resetStatistics.
+         */
+        struct Statistics {
+            /// Clusters (re-)abstracted after cells changed.
+            size_type abstractedClusters;
+            /// Routes searched over the portals.
+            size_type searches;
+            /// Portals expanded by the searches.
+            size_type expandedPortals;
+            /// Route legs refined to cells.
+            size_type refinedLegs;
+        };
+        
+        
+        /**
+         * Creates a planner for @a cellCountX times @a cellCountZ cells of 
+         * @a cellSize whose corner lies at @a origin, divided into clusters
+         * of @a clusterSize times @a clusterSize cells. All cells are free.
+         */
+        HierarchicalPathPlanner( int cellCountX, 
+                                 int cellCountZ, 
+                                 Vec3 const& origin, 
+                                 float cellSize,
+                                 int clusterSize = 16 );
+        
+        int cellCountX() const;
+        int cellCountZ() const;
+        Vec3 const& origin() const;
+        float cellSize() const;
+        int clusterSize() const;
+        int clusterCountX() const;
+        int clusterCountZ() const;
+        
+        /**
+         * Stores the indices of the cell containing the XZ position of 
+         * @a point in @a i and @a j and returns @c true. Returns @c false
+         * if the point is outside of the grid.
+         */
+        bool cellContaining( Vec3 const& point, int& i, int& j ) const;
+        
+        /**
+         * Returns the center of cell <code>(i, j)</code>.
+         */
+        Vec3 cellCenter( int i, int j ) const;
+        
+        bool isBlocked( int i, int j ) const;
+        
+        /**
+         * Blocks or frees cell <code>(i, j)</code> and marks the clusters 
+         * affected by the change for abstraction. Setting a cell to its 
+         * current state does nothing.
+         */
+        void setBlocked( int i, int j, bool blocked );
+        
+        /**
+         * Sets the range route segment radii are clamped to.
+         */
+        void setRouteRadiusRange( float minRadius, float maxRadius );
+        float minRouteRadius() const;
+        float maxRouteRadius() const;
+        
+        /**
+         * Sets the number of route legs @c advanceRoute refines ahead of the 
+         * vehicle. The refined legs are extended through the next leg that
+         * crosses a cluster border, so the vehicle always gets to leave the
+         * cluster it is in.
+         */
+        void setRefinedLegCount( size_type legCount );
+        size_type refinedLegCount() const;
+        
+        /**
+         * Abstracts the clusters marked by @c setBlocked. Called by 
+         * @c findRoute, call it to control when the work is done.
+         */
+        void updateAbstraction();
+        
+        /**
+         * Total number of portals of all clusters.
+         */
+        size_type portalCount();
+        
+        /**
+         * Plans a route from @a start to @a goal over the cluster portals and
+         * stores it in @a route. Returns @c false and leaves @a route 
+         * unchanged if there is none, e.g. because one of the points is 
+         * outside of the grid, in a blocked cell or both are identical.
+         */
+        bool findRoute( Vec3 const& start, Vec3 const& goal, Route& route );
+        
+        /**
+         * Sets @a pathway to the refined legs of @a route ahead of a vehicle
+         * at @a position. @a pathway is only set again after the vehicle 
+         * entered the cluster of a later leg, starting with that leg. 
+         * Returns @c false and leaves @a pathway unchanged if a leg to refine
+         * became impassable, @a route has to be planned again then.
+         */
+        bool advanceRoute( Route& route, 
+                           Vec3 const& position, 
+                           PolylineSegmentedPathwaySegmentRadii& pathway );
+        
+        Statistics const& statistics() const;
+        void resetStatistics();
+        
+    private:
+        /**
+         * Portal cells of a cluster and the move costs between them.
+         */
+        struct Cluster {
+            // Sorted portal cells.
+            std::vector< int > portals;
+            // Move cost from portal a to portal b at a * portals.size() + b.
+            std::vector< int > distances;
+            bool dirty;
+        };
+        
+        int clusterContaining( int cell ) const;
+        
+        /**
+         * Stores the first cell indices of @a cluster and the ones past its 
+         * last cells along x and z.
+         */
+        void clusterBounds( int cluster, int& iBegin, int& jBegin, int& iEnd, int& jEnd ) const;
+        
+        /**
+         * Returns the global index of the portal of @a cluster at @a cell or
+         * @c -1 if it isn't one.
+         */
+        int portalIndex( int cluster, int cell ) const;
+        
+        /**
+         * Marks the cluster containing cell <code>(i, j)</code> for 
+         * abstraction if it exists.
+         */
+        void markDirty( int i, int j );
+        
+        /**
+         * Finds the portals of @a cluster and the move costs between them.
+         */
+        void abstractCluster( int cluster, Cluster& result ) const;
+        
+        /**
+         * Adds the cells of @a cluster to @a portals that are portals to the
+         * neighbor cluster in straight @a direction.
+         */
+        void addBorderPortals( int cluster, int direction, std::vector< int >& portals ) const;
+        
+        /**
+         * Stores the move costs from @a from to all cells of @a cluster in
+         * @a costs, indexed by the cell's position in the cluster. Moves 
+         * don't leave the cluster.
+         */
+        void clusterCosts( int cluster, int from, std::vector< int >& costs ) const;
+        
+        /**
+         * Stores which cells of @a cluster are blocked in @a blocked, indexed
+         * by the cell's position in the cluster. Positions outside of the 
+         * grid are blocked.
+         */
+        void clusterCells( int cluster, std::vector< char >& blocked ) const;
+        
+        int clusterCellIndex( int cluster, int cell ) const;
+        
+        /**
+         * Stores the cells of a cheapest move sequence from @a from to @a to
+         * in @a cells. Both have to be in one cluster or neighbors. Returns 
+         * @c false if the leg is impassable.
+         */
+        bool refineLeg( int from, int to, std::vector< int >& cells ) const;
+        
+        /**
+         * Returns the index past the last leg of @a route refined from leg
+         * @a firstLeg on, at least @c refinedLegCount legs ending with one
+         * that crosses a cluster border or the last leg.
+         */
+        size_type refinedLegsEnd( Route const& route, size_type firstLeg ) const;
+        
+    private:
+        PlanningGrid grid_;
+        int clusterSize_;
+        int clusterCountX_;
+        int clusterCountZ_;
+        std::vector< Cluster > clusters_;
+        bool abstractionValid_;
+        // Global index of the first portal of each cluster.
+        std::vector< int > firstPortals_;
+        // Cell and cluster of each portal by global index.
+        std::vector< int > portalCells_;
+        std::vector< int > portalClusters_;
+        float minRouteRadius_;
+        float maxRouteRadius_;
+        size_type refinedLegCount_;
+        // Search data by global portal index, start and goal follow the 
+        // portals. Entries are valid if their stamp is the current search's.
+        std::vector< int > searchCosts_;
+        std::vector< int > searchParents_;
+        std::vector< size_type > searchStamps_;
+        size_type searchStamp_;
+        Statistics statistics_;
+    }; // class HierarchicalPathPlanner
+    
+    
+} // namespace OpenSteer
+
+
+#endif // OPENSTEER_HIERARCHICALPATHPLANNER_H
@@ -0,0 +1,134 @@
+// ----------------------------------------------------------------------------
+//
+//
+// OpenSteer -- Steering Behaviors for Autonomous Characters
+//
+// Copyright (c) 2002-2005, Sony Computer Entertainment America
+// Original author: Craig Reynolds <craig_reynolds@playstation.sony.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+//
+// ----------------------------------------------------------------------------
+//
+//
+// Level of detail scheduling of vehicle updates
+//
+// Assigns each vehicle to an update tier from its "interest" (how close it
+// is to a focus point such as the camera, how hard it is steering, plus
+// whatever a subclass adds, e.g. neighbor density).  Vehicles in tier 0 run
+// their full update every tick, those in tier i only every 2^i ticks and
+// just coast (integrate their previous steering) in between.  An optional
+// budget caps the number of full updates per tick; vehicles which are due
+// but over budget coast and get priority on the following ticks.
+//
+// Usage: add vehicles, set the focus point each frame, then call update
+// instead of updating each vehicle directly.
+//
+// 10-19-26:     created
+//
+//
+// ----------------------------------------------------------------------------
+
+
+#ifndef OPENSTEER_LEVELOFDETAILSCHEDULER_H
+#define OPENSTEER_LEVELOFDETAILSCHEDULER_H
+
+
+#include <vector>
+#include "OpenSteer/SimpleVehicle.h"
+
+
+namespace OpenSteer {
+
+
+    class LevelOfDetailScheduler
+    {
+    public:
+
+        // constructor: "tiers" update tiers, full updates unbudgeted
+        LevelOfDetailScheduler (const int tiers = 4);
+
+        virtual ~LevelOfDetailScheduler () {}
+
+        // vehicles handled by the scheduler (it does not own them)
+        void add (SimpleVehicle* vehicle);
+        void remove (SimpleVehicle* vehicle);
+        void clear (void) {_entries.clear ();}
+        int size (void) const {return (int) _entries.size();}
+
+        // point of greatest interest (e.g. camera position), and the
+        // distance from it at which the distance term of interest is 1/2
+        void setFocus (const Vec3& focus) {_focus = focus;}
+        const Vec3& focus (void) const {return _focus;}
+        void setInterestRadius (const float r) {_interestRadius = r;}
+        float interestRadius (void) const {return _interestRadius;}
+
+        // maximum number of full updates per tick (0 for no limit)
+        void setBudget (const int fullUpdatesPerTick) {_budget = fullUpdatesPerTick;}
+        int budget (void) const {return _budget;}
+
+        // number of tiers: tier i runs a full update every 2^i ticks
+        // (a single tier turns level of detail off)
+        void setTierCount (const int tiers);
+        int tierCount (void) const {return (int) _tierPopulation.size();}
+
+        // run one simulation tick for all vehicles
+        void update (const float currentTime, const float elapsedTime);
+
+        // statistics for the most recent tick
+        int fullUpdates (void) const {return _fullUpdates;}
+        int coasts (void) const {return _coasts;}
+        int tierPopulation (const int tier) const {return _tierPopulation[tier];}
+
+        // interest in a vehicle, 1 (or more) meaning "update every tick":
+        // proximity to the focus point plus half the vehicle's relative
+        // steering effort.  Override to add application terms.
+        virtual float interest (const SimpleVehicle& vehicle) const;
+
+    private:
+
+        struct Entry
+        {
+            SimpleVehicle* vehicle;
+            int tier;
+            int ticksSinceUpdate;
+            float interest;
+        };
+
+        struct DueOrder;
+
+        // tier for a given interest: 0 for interest >= 1/2, 1 for >= 1/4...
+        int tierForInterest (float value) const;
+
+        std::vector<Entry> _entries;
+        std::vector<int> _due; // scratch: indices of entries due this tick
+        std::vector<int> _tierPopulation;
+        Vec3 _focus;
+        float _interestRadius;
+        int _budget;
+        int _fullUpdates;
+        int _coasts;
+    };
+
+} // namespace OpenSteer
+
+
+// ----------------------------------------------------------------------------
+#endif // OPENSTEER_LEVELOFDETAILSCHEDULER_H
@@ -36,6 +36,28 @@ namespace OpenSteer {
         void findIntersectionWithVehiclePath (const AbstractVehicle& vehicle,
                                               AbstractObstacle::PathIntersection& pi)
             const;
+
+        // find first intersection of a path (given by its start, unit
+        // direction and radius) with this obstacle.  The path is tested
+        // against the box's three slabs in its local space, the result is
+        // the same as testing the six faces as RectangleObstacles.
+        void findIntersectionWithPath (const Vec3& pathPosition,
+                                       const Vec3& pathDirection,
+                                       const float pathRadius,
+                                       AbstractObstacle::PathIntersection& pi)
+            const;
+
+        // find the nearest intersection of a vehicle's path with "count"
+        // boxes, like firstPathIntersectionWithObstacleGroup but querying
+        // the vehicle only once and without virtual calls per box
+        static void
+        firstPathIntersectionWithBoxes (const AbstractVehicle& vehicle,
+                                        const BoxObstacle* const boxes[],
+                                        const int count,
+                                        AbstractObstacle::PathIntersection& nearest);
+
+        // signed distance from a point to the box's surface
+        float signedDistance (const Vec3& point) const;
     };
 
 
@@ -75,6 +97,10 @@ namespace OpenSteer {
                                               AbstractObstacle::PathIntersection& pi)
             const;
 
+        // signed distance from a point to the plane, positive on its +Z
+        // side for "outside" (derived 2d shapes need their own version)
+        float signedDistance (const Vec3& point) const;
+
         // determines if a given point on XY plane is inside obstacle shape
         virtual bool xyPointInsideShape (const Vec3& /*point*/,
                                          float /*radius*/) const
@@ -117,6 +143,10 @@ namespace OpenSteer {
 
         // determines if a given point on XY plane is inside obstacle shape
         bool xyPointInsideShape (const Vec3& point, float radius) const;
+
+        // distance from a point to the rectangle, a thin plate which has no
+        // inside so the distance is never negative
+        float signedDistance (const Vec3& point) const;
     };
 
 
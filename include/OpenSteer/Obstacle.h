@@ -98,6 +98,12 @@ namespace OpenSteer {
             const
             = 0 ;
 
+        // signed distance from a point to the obstacle's surface, negative
+        // within the obstacle's solid (which side is solid follows seenFrom,
+        // "both" is never negative).  Used to bake ObstacleDistanceFields,
+        // the default returns FLT_MAX: the shape is left out of the field.
+        virtual float signedDistance (const Vec3& point) const;
+
         // virtual function for drawing -- normally does nothing, can be
         // specialized by derived types to provide graphics for obstacles
 #ifndef NO_ANNOT
@@ -187,6 +193,81 @@ namespace OpenSteer {
         void findIntersectionWithVehiclePath (const AbstractVehicle& vehicle,
                                               PathIntersection& pi)
             const;
+
+        // signed distance from a point to the sphere's surface
+        float signedDistance (const Vec3& point) const;
+    };
+
+
+    // ----------------------------------------------------------------------------
+    // SphereObstacleSet: many ball-shaped obstacles tested as one.  Centers
+    // and radii are kept in structure-of-arrays form (separate, 32 byte
+    // aligned arrays) so a vehicle's path is tested against several spheres
+    // per SIMD instruction.  Put the set into an ObstacleGroup to avoid all
+    // of its spheres: the nearest intersection is reported just like the
+    // one of the nearest SphereObstacle, with the set as its obstacle.  All
+    // spheres share the set's seenFrom state.
+
+
+    class SphereObstacleSet : public Obstacle
+    {
+    public:
+
+        // constructor
+        SphereObstacleSet (void);
+
+        // destructor
+        virtual ~SphereObstacleSet ();
+
+        // number of spheres in the set
+        int size (void) const {return count;}
+
+        // add a sphere, returns its index
+        int addSphere (const float r, const Vec3& c);
+
+        // change the sphere at a given index
+        void setSphere (const int i, const float r, const Vec3& c);
+
+        // remove the sphere at a given index by moving the last sphere into
+        // its place
+        void removeSphere (const int i);
+
+        // remove all spheres
+        void clear (void) {count = 0;}
+
+        float radius (const int i) const {return rs[i];}
+        Vec3 center (const int i) const {return Vec3 (xs[i], ys[i], zs[i]);}
+
+        // find nearest intersection of a vehicle's path with the spheres
+        void findIntersectionWithVehiclePath (const AbstractVehicle& vehicle,
+                                              PathIntersection& pi)
+            const;
+
+        // as above, returns the index of the sphere intersected (or -1)
+        int findNearestSphereOnVehiclePath (const AbstractVehicle& vehicle,
+                                            PathIntersection& pi)
+            const;
+
+        // signed distance from a point to the nearest sphere's surface
+        float signedDistance (const Vec3& point) const;
+
+    private:
+
+        // grow the arrays to hold at least n spheres
+        void reserve (const int n);
+
+        // not copyable: the arrays are owned
+        SphereObstacleSet (const SphereObstacleSet&);
+        SphereObstacleSet& operator= (const SphereObstacleSet&);
+
+        // per sphere arrays in one block, slots 0 to count-1 are in use
+        int count;
+        int capacity;
+        void* block;
+        float* xs;
+        float* ys;
+        float* zs;
+        float* rs;
     };
 
 } // namespace OpenSteer
@@ -0,0 +1,211 @@
+/**
+ * OpenSteer -- Steering Behaviors for Autonomous Characters
+ *
+ * Copyright (c) 2002-2005, Sony Computer Entertainment America
+ * Original author: Craig Reynolds <craig_reynolds@playstation.sony.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ *
+ * @file
+ *
+ * Signed distance field baked from a group of static obstacles so obstacle
+ * avoidance costs the same however many obstacles there are.
+ */
+#ifndef OPENSTEER_OBSTACLEDISTANCEFIELD_H
+#define OPENSTEER_OBSTACLEDISTANCEFIELD_H
+
+
+// Include std::vector
+#include <vector>
+
+// Include std::istream, std::ostream
+#include <iosfwd>
+
+// Include size_t
+#include <cstddef>
+
+
+// Include OpenSteer::Vec3
+#include "OpenSteer/Vec3.h"
+
+// Include OpenSteer::ObstacleGroup, OpenSteer::AbstractObstacle
+#include "OpenSteer/Obstacle.h"
+
+
+
+namespace OpenSteer {
+    
+    /**
+     * Grid of signed distances to a group of obstacles with their gradients.
+     *
+     * @c bake samples the obstacles' @c signedDistance at the nodes of a
+     * regular grid, either a single layer on the XZ plane (planar) or a
+     * volume, and stores the distance gradient per node. The distance is
+     * negative within the obstacles' solid, the gradient points away from
+     * the nearest surface. Queries interpolate between the nodes around a
+     * point, so they don't depend on the number of obstacles baked.
+     *
+     * The obstacles must be static: the field doesn't keep them and has to
+     * be baked again if they move. Baking visits every obstacle per node, so
+     * it belongs to load time or an offline tool; @c write and @c read
+     * store and restore a baked field as a binary blob.
+     */
+    class ObstacleDistanceField {
+    public:
+        typedef size_t size_type;
+        
+        /**
+         * Distance and unit gradient sampled at a point, see @c sample.
+         */
+        struct Sample {
+            float distance;
+            Vec3 gradient;
+        };
+        
+        /**
+         * Creates an empty field, @c bake or @c read it before use.
+         */
+        ObstacleDistanceField();
+        
+        /**
+         * Bakes the signed distances to @a obstacles at nodes @a cellSize
+         * apart covering the box from @a minimum to @a maximum (rounded up
+         * to whole cells). If both corners have the same height the field is
+         * planar: one layer of nodes at that height, sampled by the XZ
+         * position of query points, with gradients in the XZ plane.
+         * Obstacles without a distance function (@c signedDistance returns
+         * @c FLT_MAX) are left out.
+         */
+        void bake( ObstacleGroup const& obstacles, 
+                   Vec3 const& minimum, 
+                   Vec3 const& maximum, 
+                   float cellSize );
+        
+        /**
+         * Returns @c true if the field has been baked or read.
+         */
+        bool isValid() const;
+        
+        /**
+         * Returns @c true if the field is a single layer on the XZ plane.
+         */
+        bool isPlanar() const;
+        
+        /**
+         * Returns @c true if @a point lies inside the grid (only its XZ
+         * position is checked for planar fields).
+         */
+        bool contains( Vec3 const& point ) const;
+        
+        /**
+         * Samples the distance and gradient at @a point and stores them in
+         * @a result. Both are interpolated between the surrounding nodes,
+         * the gradient is normalized again (it stays zero where opposing
+         * gradients cancel out).
+         *
+         * Returns @c false and leaves @a result untouched if @a point lies
+         * outside the grid or the field isn't valid.
+         */
+        bool sample( Vec3 const& point, Sample& result ) const;
+        
+        /**
+         * Marches along a path starting at @a pathPosition in the unit 
+         * direction @a pathDirection for up to @a maxDistance and finds the
+         * first point where the path, @a pathRadius wide, touches the
+         * baked obstacles. Each step advances by the clearance sampled at
+         * the current point (at least a quarter cell, or a cell off the
+         * grid where nothing is baked).
+         *
+         * Fills @a pi like @c AbstractObstacle::findIntersectionWithVehiclePath
+         * does, with the gradient at the hit as surface normal and steer
+         * hint and no obstacle (@c pi.obstacle is @c 0).
+         */
+        void findIntersectionWithPath( Vec3 const& pathPosition,
+                                       Vec3 const& pathDirection,
+                                       float pathRadius,
+                                       float maxDistance,
+                                       AbstractObstacle::PathIntersection& pi ) const;
+        
+        /**
+         * Finds the first intersection of @a vehicle's path within
+         * @a maxDistance ahead, see @c findIntersectionWithPath.
+         */
+        void findIntersectionWithVehiclePath( AbstractVehicle const& vehicle,
+                                              float maxDistance,
+                                              AbstractObstacle::PathIntersection& pi ) const;
+        
+        
+        float cellSize() const;
+        
+        /**
+         * Returns the position of node 0, 0, 0.
+         */
+        Vec3 const& origin() const;
+        
+        size_type nodeCountX() const;
+        size_type nodeCountY() const;
+        size_type nodeCountZ() const;
+        
+        /**
+         * Returns the position of node @a x, @a y, @a z.
+         */
+        Vec3 nodePosition( size_type x, size_type y, size_type z ) const;
+        
+        float nodeDistance( size_type x, size_type y, size_type z ) const;
+        Vec3 nodeGradient( size_type x, size_type y, size_type z ) const;
+        
+        /**
+         * Writes the field to @a stream (opened in binary mode). Returns
+         * @c false if writing failed.
+         */
+        bool write( std::ostream& stream ) const;
+        
+        /**
+         * Reads a field written by @c write from @a stream (opened in binary
+         * mode). Returns @c false and leaves the field unchanged if the 
+         * stream doesn't hold a field in the format and byte order of this
+         * build. The header is checked against the size of the stream
+         * before any memory is allocated, so @a stream must be seekable.
+         */
+        bool read( std::istream& stream );
+        
+    private:
+        size_type nodeIndex( size_type x, size_type y, size_type z ) const;
+        void computeGradients();
+        
+    private:
+        Vec3 origin_;
+        float cellSize_;
+        size_type nodeCountX_;
+        size_type nodeCountY_;
+        size_type nodeCountZ_;
+        
+        // Per node, x fastest then z then y (layers of XZ rows).
+        std::vector< float > distances_;
+        
+        // Three components per node in the same order as the distances.
+        std::vector< float > gradients_;
+        
+    }; // class ObstacleDistanceField
+    
+} // namespace OpenSteer
+
+
+#endif // OPENSTEER_OBSTACLEDISTANCEFIELD_H
@@ -88,6 +88,10 @@ namespace OpenSteer {
         //     XXX  class structure this becomes the constructor
         static void initialize (void);
 
+        // run the named PlugIn in batch mode (without graphics) with the
+        // given arguments, returns the exit status for the application
+        static int runBatch (const char* plugInName, int argc, char** argv);
+
         // main update function: step simulation forward and redraw scene
         static void updateSimulationAndRedraw (void);
 
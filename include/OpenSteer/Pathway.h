@@ -30,12 +30,15 @@
 #ifndef OPENSTEER_PATHWAY_H
 #define OPENSTEER_PATHWAY_H
 
+// Include size_t
+#include <cstddef>
+
+// Include OpenSteer::Vec3
+#include "OpenSteer/Vec3.h"
+
+
 namespace OpenSteer {
     
-    // Forward declaration, include Vec3.h if needed.
-    // @todo Include Vec3.h?
-    class Vec3;
-    
     
     
     /**
@@ -76,6 +79,42 @@ namespace OpenSteer {
          */
 		virtual float mapPointToPathDistance (const Vec3& point) const = 0;
         
+        /**
+         * Everything path following needs to know about a query point, see
+         * @c mapPointsToPath.
+         */
+        struct PointMapping {
+            /// Nearest point on the path center line.
+            Vec3 pointOnPath;
+            /// Path tangent at @c pointOnPath.
+            Vec3 tangent;
+            /// Distance of the query point outside the path, negative inside.
+            float outside;
+            /// Distance of @c pointOnPath along the path.
+            float distanceOnPath;
+            /// Point on the path center line the requested offset further 
+            /// along the path than @c pointOnPath.
+            Vec3 pointAtOffset;
+        };
+        
+        /**
+         * Maps the @a count points in @a points to the path and stores the
+         * results of @c mapPointToPath and @c mapPointToPathDistance for each
+         * in the corresponding element of @a mappings. If @a offsets isn't 
+         * @c 0 the point @c offsets[ i ] further along the path is stored in
+         * @c mappings[ i ].pointAtOffset as by @c mapPathDistanceToPoint.
+         *
+         * The default implementation calls the single point queries, 
+         * segmented pathways override it to answer all queries with one
+         * traversal of their segments.
+         *
+         * If @c isValid is @c false the behavior is undefined.
+         */
+        virtual void mapPointsToPath( size_t count, 
+                                      Vec3 const* points, 
+                                      float const* offsets, 
+                                      PointMapping* mappings ) const;
+        
         /**
          * Returns @c true f the path is closed, otherwise @c false.
          */
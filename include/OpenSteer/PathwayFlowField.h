@@ -0,0 +1,200 @@
+/**
+ * OpenSteer -- Steering Behaviors for Autonomous Characters
+ *
+ * Copyright (c) 2002-2005, Sony Computer Entertainment America
+ * Original author: Craig Reynolds <craig_reynolds@playstation.sony.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ *
+ * @file
+ *
+ * Flow field precomputed from a pathway so path following can be answered
+ * by a grid lookup instead of a path query per vehicle and frame.
+ */
+#ifndef OPENSTEER_PATHWAYFLOWFIELD_H
+#define OPENSTEER_PATHWAYFLOWFIELD_H
+
+
+// Include std::vector
+#include <vector>
+
+// Include size_t
+#include <cstddef>
+
+
+// Include OpenSteer::Vec3
+#include "OpenSteer/Vec3.h"
+
+// Include OpenSteer::Pathway
+#include "OpenSteer/Pathway.h"
+
+
+
+namespace OpenSteer {
+    
+    /**
+     * Grid of path following guidance over the XZ plane around a pathway.
+     *
+     * Each cell stores for its center the direction to steer to when
+     * traveling along the path in either direction (towards the point 
+     * @c lookAhead further along the path from the nearest path point), the
+     * distance along the path and how far the center is outside the path.
+     * Many vehicles following the same pathway sample the grid instead of
+     * each mapping their positions to the path.
+     *
+     * The grid is built lazily: call @c update once per simulation step, it
+     * rebuilds the grid if it has never been built, if a parameter changed or
+     * if the points of the pathway moved. The pathway isn't owned and must
+     * outlive the flow field.
+     */
+    class PathwayFlowField {
+    public:
+        typedef size_t size_type;
+        
+        /**
+         * Guidance stored per grid cell.
+         */
+        struct Cell {
+            /// Desired direction when traveling towards the path end.
+            Vec3 forward;
+            /// Desired direction when traveling towards the path start.
+            Vec3 backward;
+            /// Distance of the nearest path point along the path.
+            float distanceOnPath;
+            /// Distance of the cell center outside the path, negative inside.
+            float outside;
+        };
+        
+        /**
+         * Guidance sampled at a point, see @c sample.
+         */
+        struct Sample {
+            Vec3 direction;
+            float distanceOnPath;
+            float outside;
+        };
+        
+        /**
+         * Creates a flow field for @a pathway with square cells of
+         * @a cellSize covering the path bounding area extended by 
+         * @a margin. The desired directions aim @a lookAhead along the path.
+         */
+        PathwayFlowField( Pathway const& pathway, 
+                          float cellSize = 1.0f, 
+                          float margin = 10.0f, 
+                          float lookAhead = 5.0f );
+        
+        
+        void setPathway( Pathway const& pathway );
+        Pathway const& pathway() const;
+        
+        void setCellSize( float cellSize );
+        float cellSize() const;
+        
+        void setMargin( float margin );
+        float margin() const;
+        
+        void setLookAhead( float lookAhead );
+        float lookAhead() const;
+        
+        /**
+         * Forces a rebuild on the next call to @c update, needed if the 
+         * pathway changed in a way @c update can't detect (e.g. only its
+         * radius).
+         */
+        void invalidate();
+        
+        /**
+         * Rebuilds the grid if it is out of date. Returns @c true if it has
+         * been rebuilt.
+         */
+        bool update();
+        
+        /**
+         * Returns @c true if the grid has been built and none of its 
+         * parameters changed since. Doesn't check the pathway points.
+         */
+        bool isValid() const;
+        
+        /**
+         * Samples the guidance at the XZ position of @a point for traveling
+         * in @a direction (positive for towards the path end, negative for
+         * towards its start) and stores it in @a result. The direction and
+         * outside distance are interpolated between the four nearest cell
+         * centers, the distance on path is taken from the nearest cell.
+         *
+         * Returns @c false and leaves @a result untouched if @a point lies
+         * outside the grid or the grid isn't valid.
+         */
+        bool sample( Vec3 const& point, int direction, Sample& result ) const;
+        
+        /**
+         * Returns @c true if the XZ position of @a point lies inside the grid.
+         */
+        bool contains( Vec3 const& point ) const;
+        
+        
+        size_type cellCountX() const;
+        size_type cellCountZ() const;
+        Cell const& cell( size_type x, size_type z ) const;
+        
+        /**
+         * Returns the corner of the grid with the minimal coordinates. Its
+         * @c y coordinate is the height the cell centers are mapped at.
+         */
+        Vec3 const& origin() const;
+        
+        /**
+         * Returns the center of cell @a x, @a z.
+         */
+        Vec3 cellCenter( size_type x, size_type z ) const;
+        
+        /**
+         * Returns how often the grid has been built.
+         */
+        size_type buildCount() const;
+        
+    private:
+        void build();
+        void takeSignature( std::vector< Vec3 >& signature ) const;
+        
+    private:
+        Pathway const* pathway_;
+        float cellSize_;
+        float margin_;
+        float lookAhead_;
+        
+        bool valid_;
+        size_type buildCount_;
+        
+        Vec3 origin_;
+        size_type cellCountX_;
+        size_type cellCountZ_;
+        std::vector< Cell > cells_;
+        
+        // Pathway points (or samples along it) the grid was built from.
+        std::vector< Vec3 > signature_;
+        
+    }; // class PathwayFlowField
+    
+} // namespace OpenSteer
+
+
+#endif // OPENSTEER_PATHWAYFLOWFIELD_H
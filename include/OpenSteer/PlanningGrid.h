@@ -0,0 +1,275 @@
+/**
+ * OpenSteer -- Steering Behaviors for Autonomous Characters
+ *
+ * Copyright (c) 2002-2005, Sony Computer Entertainment America
+ * Original author: Craig Reynolds <craig_reynolds@playstation.sony.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ *
+ * @file
+ *
+ * Occupancy grid with the cell geometry, moves and line of sight tests
+ * shared by the grid route planners.
+ */
+#ifndef OPENSTEER_PLANNINGGRID_H
+#define OPENSTEER_PLANNINGGRID_H
+
+
+// Include std::vector
+#include <vector>
+
+// Include std::min
+#include <algorithm>
+
+// Include std::abs
+#include <cstdlib>
+
+// Include size_t
+#include <cstddef>
+
+// Include assert
+#include <cassert>
+
+
+// Include OpenSteer::Vec3
+#include "OpenSteer/Vec3.h"
+
+// Include OpenSteer::clamp
+#include "OpenSteer/Utilities.h"
+
+
+
+namespace OpenSteer {
+    
+    
+    /**
+     * Grid of square cells on the XZ plane that are blocked or free, used by
+     * @c GridPathPlanner and @c HierarchicalPathPlanner. Cell
+     * <code>(i, j)</code> covers @c i to @c i + 1 cell sizes along the x
+     * axis and @c j to @c j + 1 cell sizes along the z axis from @c origin,
+     * its index is <code>i + j * cellCountX</code>.
+     *
+     * Moves on the eight connected grid never cut the corner of a blocked
+     * cell. Their costs are integral to keep search arithmetic exact.
+     */
+    class PlanningGrid {
+    public:
+        typedef size_t size_type;
+        
+        /**
+         * Cost of straight and diagonal moves between neighbor cells.
+         */
+        static int const straightMoveCost = 10;
+        static int const diagonalMoveCost = 14;
+        
+        /**
+         * Cell offsets of the eight neighbor directions, straight ones first.
+         */
+        static int const neighborOffsetX[ 8 ];
+        static int const neighborOffsetZ[ 8 ];
+        
+        /**
+         * Octile distance in move costs between two cells @a di and @a dj
+         * cells apart.
+         */
+        static int octileDistance( int di, int dj );
+        
+        
+        /**
+         * Creates a grid of @a cellCountX times @a cellCountZ free cells.
+         */
+        PlanningGrid( int cellCountX, int cellCountZ, Vec3 const& origin, float cellSize );
+        
+        int cellCountX() const;
+        int cellCountZ() const;
+        size_type cellCount() const;
+        Vec3 const& origin() const;
+        float cellSize() const;
+        
+        /**
+         * Stores the indices of the cell containing the XZ position of
+         * @a point in @a i and @a j and returns @c true. Returns @c false
+         * if the point is outside of the grid.
+         */
+        bool cellContaining( Vec3 const& point, int& i, int& j ) const;
+        
+        /**
+         * Returns the center of cell <code>(i, j)</code>.
+         */
+        Vec3 cellCenter( int i, int j ) const;
+        
+        /**
+         * Returns the center of @a cell at height @a y.
+         */
+        Vec3 cellCenterAtHeight( int cell, float y ) const;
+        
+        int cellIndex( int i, int j ) const;
+        
+        bool isBlocked( int cell ) const;
+        bool isBlocked( int i, int j ) const;
+        void setBlocked( int cell, bool blocked );
+        
+        /**
+         * Returns the neighbor of @a cell in @a direction (@c 0 to @c 7,
+         * straight ones first) or @c -1 if it is outside of the grid.
+         */
+        int neighborCell( int cell, int direction ) const;
+        
+        /**
+         * Returns the cost of the move from @a cell to its neighbor in
+         * @a direction or a negative value if the move isn't possible.
+         */
+        int moveCost( int cell, int direction ) const;
+        
+        /**
+         * Returns @c true if the segment from @a from to @a to only crosses
+         * free cells of the grid.
+         */
+        bool segmentIsFree( Vec3 const& from, Vec3 const& to ) const;
+        
+        /**
+         * Returns the smallest clearance of the cells crossed by the line
+         * between the centers of @a from and @a to, or a negative value if
+         * one of them is blocked.
+         *
+         * <code>float clearance( int cell )</code> returns the distance of
+         * the center of a cell to the nearest blocked cell center in cells.
+         */
+        template< typename Clearance >
+        float lineClearance( int from, int to, Clearance const& clearance ) const;
+        
+        /**
+         * Shortens the grid route @a cells to @a waypoints in line of sight
+         * that keep at least the clearance of the cells they replace and
+         * stores the segment radii, clamped to @a minRadius and
+         * @a maxRadius, in @a radii. @a clearance is used as in
+         * @c lineClearance.
+         */
+        template< typename Clearance >
+        void makeWaypoints( std::vector< int > const& cells,
+                            float minRadius,
+                            float maxRadius,
+                            Clearance const& clearance,
+                            std::vector< int >& waypoints,
+                            std::vector< float >& radii ) const;
+        
+    private:
+        int cellCountX_;
+        int cellCountZ_;
+        Vec3 origin_;
+        float cellSize_;
+        std::vector< char > blocked_;
+    }; // class PlanningGrid
+    
+    
+} // namespace OpenSteer
+
+
+
+template< typename Clearance >
+float
+OpenSteer::PlanningGrid::lineClearance( int from, int to, Clearance const& clearance ) const
+{
+    int i = from % cellCountX_;
+    int j = from / cellCountX_;
+    int const dx = to % cellCountX_ - i;
+    int const dz = to / cellCountX_ - j;
+    int const stepX = ( 0 < dx ) ? 1 : -1;
+    int const stepZ = ( 0 < dz ) ? 1 : -1;
+    int const nx = std::abs( dx );
+    int const nz = std::abs( dz );
+    
+    // Visit every cell the line between the cell centers touches, both
+    // cells beside a corner it passes exactly.
+    float result = clearance( from );
+    int ix = 0;
+    int iz = 0;
+    while ( ( ix < nx ) || ( iz < nz ) ) {
+        int const decision = ( 1 + 2 * ix ) * nz - ( 1 + 2 * iz ) * nx;
+        if ( 0 == decision ) {
+            result = std::min( result, clearance( i + stepX + j * cellCountX_ ) );
+            result = std::min( result, clearance( i + ( j + stepZ ) * cellCountX_ ) );
+            i += stepX;
+            j += stepZ;
+            ++ix;
+            ++iz;
+        } else if ( decision < 0 ) {
+            i += stepX;
+            ++ix;
+        } else {
+            j += stepZ;
+            ++iz;
+        }
+        result = std::min( result, clearance( i + j * cellCountX_ ) );
+    }
+    
+    // Blocked cells have no clearance.
+    return ( 0.0f < result ) ? result : -1.0f;
+}
+
+
+
+template< typename Clearance >
+void
+OpenSteer::PlanningGrid::makeWaypoints( std::vector< int > const& cells,
+                                        float minRadius,
+                                        float maxRadius,
+                                        Clearance const& clearance,
+                                        std::vector< int >& waypoints,
+                                        std::vector< float >& radii ) const
+{
+    assert( ! cells.empty() && "Grid route must contain cells." );
+    
+    waypoints.assign( 1, cells.front() );
+    radii.clear();
+    
+    // Start and goal in the same cell.
+    if ( 1 == cells.size() ) {
+        waypoints.push_back( cells.front() );
+        radii.push_back( clamp( ( clearance( cells.front() ) - 0.5f ) * cellSize_, minRadius, maxRadius ) );
+        return;
+    }
+    
+    // Extend each segment along the grid route as long as the straight line
+    // keeps the clearance of the grid route it replaces.
+    size_type anchor = 0;
+    while ( anchor + 1 < cells.size() ) {
+        size_type next = anchor + 1;
+        float routeClearance = std::min( clearance( cells[ anchor ] ), clearance( cells[ next ] ) );
+        float segmentClearance = std::min( routeClearance, lineClearance( cells[ anchor ], cells[ next ], clearance ) );
+        
+        for ( size_type k = next + 1; k < cells.size(); ++k ) {
+            routeClearance = std::min( routeClearance, clearance( cells[ k ] ) );
+            float const lineToCell = lineClearance( cells[ anchor ], cells[ k ], clearance );
+            if ( lineToCell < routeClearance ) {
+                break;
+            }
+            next = k;
+            segmentClearance = lineToCell;
+        }
+        
+        waypoints.push_back( cells[ next ] );
+        radii.push_back( clamp( ( segmentClearance - 0.5f ) * cellSize_, minRadius, maxRadius ) );
+        anchor = next;
+    }
+}
+
+
+#endif // OPENSTEER_PLANNINGGRID_H
@@ -114,6 +114,11 @@ namespace OpenSteer {
         // return an AVGroup (an STL vector of AbstractVehicle pointers) of
         // all vehicles(/agents/characters) defined by the PlugIn
         virtual const AVGroup& allVehicles (void) = 0;
+
+        // run the PlugIn without graphics ("batch mode", for example to
+        // gather statistics) given the remaining command line arguments,
+        // returns the exit status for the application
+        virtual int runBatch (int argc, char** argv) = 0;
     };
 
 
@@ -148,6 +153,9 @@ namespace OpenSteer {
         // default "mini help": print nothing
         void printMiniHelpForFunctionKeys (void) {}
 
+        // default batch mode: report that there is none, return failure
+        int runBatch (int argc, char** argv);
+
         // returns pointer to the next PlugIn in "selection order"
         PlugIn* next (void);
 
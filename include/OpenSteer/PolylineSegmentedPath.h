@@ -129,6 +129,69 @@ namespace OpenSteer {
                          size_type numOfPoints,
                          Vec3 const newPoints[]);
         
+        /**
+         * Moves point @a pointIndex to @a newPoint. Only the segments 
+         * starting or ending at the point are recalculated, the segment 
+         * length index is updated in <code>O(log n)</code>.
+         *
+         * If the path is cyclic and @a pointIndex is @c 0 the duplicated first
+         * point representing the cycle closing segment is moved, too.
+         *
+         * The moved point mustn't be equal to its neighbors.
+         *
+         * @param pointIndex Index of the point to move. Must be lesser than
+         *                   @c pointCount or, if the path is cyclic, lesser 
+         *                   than <code>pointCount - 1</code>.
+         */
+        void setPoint( size_type pointIndex, Vec3 const& newPoint );
+        
+        /**
+         * Inserts @a newPoint before point @a pointIndex splitting the segment
+         * ending at that point. Only the two segments adjacent to the new 
+         * point are calculated. The points following @a pointIndex are 
+         * shifted and the segment length index is rebuilt, both linear in the
+         * number of points but without any per segment calculations.
+         *
+         * If the path isn't cyclic @a pointIndex might be @c pointCount to 
+         * append a point. If the path is cyclic and @a pointIndex is @c 0 the
+         * new point becomes the first one and the cycle closing segment ends
+         * at it.
+         *
+         * The new point mustn't be equal to its neighbors.
+         */
+        void insertPoint( size_type pointIndex, Vec3 const& newPoint );
+        
+        /**
+         * Removes point @a pointIndex joining the two segments meeting at it
+         * into one. Only this segment is recalculated, the following points
+         * are shifted and the segment length index is rebuilt.
+         *
+         * The path must keep at least two distinct points and the neighbors
+         * of the erased point mustn't be equal.
+         *
+         * @param pointIndex Index of the point to erase. Must be lesser than
+         *                   @c pointCount or, if the path is cyclic, lesser 
+         *                   than <code>pointCount - 1</code>.
+         */
+        void erasePoint( size_type pointIndex );
+        
+        /**
+         * Returns the distance along the path from its start to the start
+         * of segment @a segmentIndex in <code>O(log n)</code>.
+         */
+        float segmentStartDistance( size_type segmentIndex ) const;
+        
+        /**
+         * Returns the index of the segment reached by walking @a distance 
+         * along the path (clamped to the path) and stores the distance from
+         * the path start to the start of that segment in 
+         * @a segmentStartDistance. Runs in <code>O(log n)</code>.
+         *
+         * Doesn't wrap @a distance around cyclic paths.
+         */
+        size_type mapDistanceToSegmentIndex( float distance, 
+                                             float& segmentStartDistance ) const;
+        
         
         
         virtual bool isValid() const;
@@ -171,6 +234,9 @@ namespace OpenSteer {
         std::vector< Vec3 > points_;
         std::vector< Vec3 > segmentTangents_;
         std::vector< float > segmentLengths_;
+        // Complete binary tree of segment length sums, the leaves are the
+        // segment lengths padded to a power of two, element 1 is the root.
+        std::vector< float > segmentLengthSums_;
         bool closedCycle_;
     }; // class PolylineSegmentedPath
     
@@ -112,6 +112,29 @@ namespace OpenSteer {
         void movePoints( size_type startIndex,
                          size_type numOfPoints,
                          Vec3 const points[] );
+        
+        /**
+         * Moves a single point only recalculating the segments adjacent to 
+         * it, see @c PolylineSegmentedPath::setPoint.
+         */
+        void setPoint( size_type pointIndex, Vec3 const& newPoint );
+        
+        /**
+         * Inserts @a newPoint before point @a pointIndex, see 
+         * @c PolylineSegmentedPath::insertPoint. Both halves of the split
+         * segment keep its radius. A point prepended to a non-cyclic pathway
+         * takes the radius of the first segment for the new one, a point
+         * appended to it the radius of the last segment.
+         */
+        void insertPoint( size_type pointIndex, Vec3 const& newPoint );
+        
+        /**
+         * Erases point @a pointIndex, see @c PolylineSegmentedPath::erasePoint.
+         * The joined segment keeps the radius of the segment that ended at the
+         * erased point (or started at it if it was the first point).
+         */
+        void erasePoint( size_type pointIndex );
+        
         /**
          * Replaces the pathway information completely.
          *
@@ -167,6 +190,10 @@ namespace OpenSteer {
                                      float& outside) const;
 		virtual Vec3 mapPathDistanceToPoint (float pathDistance) const;
 		virtual float mapPointToPathDistance (const Vec3& point) const;
+        virtual void mapPointsToPath( size_t count, 
+                                      Vec3 const* points, 
+                                      float const* offsets, 
+                                      PointMapping* mappings ) const;
         virtual bool isCyclic() const;
         virtual float length() const;
         
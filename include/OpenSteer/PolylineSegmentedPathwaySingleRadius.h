@@ -93,6 +93,17 @@ namespace OpenSteer {
         void movePoints( size_type startIndex,
                          size_type numOfPoints,
                          Vec3 const newPointValues[] );
+        
+        /**
+         * Moves, inserts or erases a single point only recalculating the 
+         * segments adjacent to it, see @c PolylineSegmentedPath::setPoint,
+         * @c PolylineSegmentedPath::insertPoint and 
+         * @c PolylineSegmentedPath::erasePoint.
+         */
+        void setPoint( size_type pointIndex, Vec3 const& newPoint );
+        void insertPoint( size_type pointIndex, Vec3 const& newPoint );
+        void erasePoint( size_type pointIndex );
+        
         /**
          * Replaces the pathway information completely.
          *
@@ -130,6 +141,10 @@ namespace OpenSteer {
                                      float& outside) const;
 		virtual Vec3 mapPathDistanceToPoint (float pathDistance) const;
 		virtual float mapPointToPathDistance (const Vec3& point) const;
+        virtual void mapPointsToPath( size_t count, 
+                                      Vec3 const* points, 
+                                      float const* offsets, 
+                                      PointMapping* mappings ) const;
         virtual bool isCyclic() const;
         virtual float length() const;
         
@@ -44,20 +44,205 @@
 
 
 #include <algorithm>
+#include <cstddef>
+#include <new>
 #include <vector>
 #include "OpenSteer/Vec3.h"
 #include "OpenSteer/lq.h"   // XXX temp?
 
+// SIMD width used by VectorizedBruteForceProximityDatabase: 8 floats with
+// AVX, 4 with SSE, otherwise a plain scalar loop (define it as 1 to force
+// the scalar loop)
+#if !defined(OPENSTEER_PROXIMITY_SIMD_WIDTH)
+#if defined(__AVX__)
+#include <immintrin.h>
+#define OPENSTEER_PROXIMITY_SIMD_WIDTH 8
+#elif defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#include <xmmintrin.h>
+#define OPENSTEER_PROXIMITY_SIMD_WIDTH 4
+#else
+#define OPENSTEER_PROXIMITY_SIMD_WIDTH 1
+#endif
+#endif
+
 
 namespace OpenSteer {
 
 
+    // ----------------------------------------------------------------------------
+    // Fixed size block pool used by the proximity databases to store their
+    // tokens: blocks are carved out of large chunks and recycled through a
+    // free list, so allocating and freeing a token is O(1) and does not go
+    // through the general purpose heap.  Chunks are only released when the
+    // pool (that is: the database owning it) is destroyed.
+
+
+    class ProximityTokenPool
+    {
+    public:
+
+        // every pooled block starts with a pointer back to its pool so that
+        // "delete token" can return the block, padded to keep the token
+        // that follows it suitably aligned
+        union BlockHeader
+        {
+            ProximityTokenPool* pool;
+            long double alignment;
+        };
+
+        // constructor
+        ProximityTokenPool (const size_t objectSize,
+                            const size_t blocksPerChunk = 256)
+            : _blockSize (roundUp (sizeof (BlockHeader) + objectSize)),
+              _blocksPerChunk (blocksPerChunk ? blocksPerChunk : 1),
+              _freeList (NULL),
+              _capacity (0),
+              _allocated (0)
+        {
+        }
+
+        // destructor
+        ~ProximityTokenPool ()
+        {
+            for (size_t i = 0; i < _chunks.size(); i++)
+                ::operator delete (_chunks[i]);
+        }
+
+        // get a block of blockSize() bytes, growing the pool when empty
+        void* allocate (void)
+        {
+            if (_freeList == NULL) grow (_blocksPerChunk);
+            void* block = _freeList;
+            _freeList = *((void**) block);
+            _allocated++;
+            return block;
+        }
+
+        // put a block obtained from allocate back on the free list
+        void deallocate (void* block)
+        {
+            *((void**) block) = _freeList;
+            _freeList = block;
+            _allocated--;
+        }
+
+        // make sure the next "count" allocations will not need to grow
+        // the pool (done in one chunk to keep those tokens together)
+        void reserve (const size_t count)
+        {
+            const size_t available = _capacity - _allocated;
+            if (count > available) grow (count - available);
+        }
+
+        size_t blockSize (void) const {return _blockSize;}
+        size_t capacity (void) const {return _capacity;}
+        size_t allocated (void) const {return _allocated;}
+
+        // allocate a token of the given size from pool, or from the heap
+        // when pool is NULL or the token does not fit in its blocks
+        // (used by PooledProximityToken's operator new)
+        static void* allocateToken (const size_t size, ProximityTokenPool* pool)
+        {
+            BlockHeader* header;
+            if (pool && (sizeof (BlockHeader) + size <= pool->_blockSize))
+            {
+                header = (BlockHeader*) pool->allocate ();
+                header->pool = pool;
+            }
+            else
+            {
+                header = (BlockHeader*) ::operator new (sizeof (BlockHeader) +
+                                                        size);
+                header->pool = NULL;
+            }
+            return header + 1;
+        }
+
+        // free storage obtained from allocateToken
+        static void deallocateToken (void* token)
+        {
+            if (token == NULL) return;
+            BlockHeader* header = ((BlockHeader*) token) - 1;
+            if (header->pool)
+                header->pool->deallocate (header);
+            else
+                ::operator delete (header);
+        }
+
+    private:
+
+        // not copyable: live tokens point back at the pool
+        ProximityTokenPool (const ProximityTokenPool&);
+        ProximityTokenPool& operator= (const ProximityTokenPool&);
+
+        static size_t roundUp (const size_t size)
+        {
+            const size_t a = sizeof (BlockHeader);
+            return ((size + a - 1) / a) * a;
+        }
+
+        // add a chunk of "count" blocks and thread them onto the free list
+        void grow (const size_t count)
+        {
+            char* chunk = (char*) ::operator new (_blockSize * count);
+            _chunks.push_back (chunk);
+            for (size_t i = count; i > 0; i--)
+            {
+                void* block = chunk + ((i - 1) * _blockSize);
+                *((void**) block) = _freeList;
+                _freeList = block;
+            }
+            _capacity += count;
+        }
+
+        const size_t _blockSize;
+        const size_t _blocksPerChunk;
+        void* _freeList;
+        size_t _capacity;
+        size_t _allocated;
+        std::vector<void*> _chunks;
+    };
+
+
+    // ----------------------------------------------------------------------------
+    // base for the token classes: "new (pool) token(...)" places the token in
+    // a ProximityTokenPool, plain "new" uses the heap.  Either way clients
+    // free a token with "delete token" as before.
+
+
+    class PooledProximityToken
+    {
+    public:
+
+        static void* operator new (size_t size)
+        {
+            return ProximityTokenPool::allocateToken (size, NULL);
+        }
+
+        static void* operator new (size_t size, ProximityTokenPool& pool)
+        {
+            return ProximityTokenPool::allocateToken (size, &pool);
+        }
+
+        static void operator delete (void* token)
+        {
+            ProximityTokenPool::deallocateToken (token);
+        }
+
+        // only called if a token constructor throws
+        static void operator delete (void* token, ProximityTokenPool&)
+        {
+            ProximityTokenPool::deallocateToken (token);
+        }
+    };
+
+
     // ----------------------------------------------------------------------------
     // "tokens" are the objects manipulated by the spatial database
 
 
     template <class ContentType>
-    class AbstractTokenForProximityDatabase
+    class AbstractTokenForProximityDatabase : public PooledProximityToken
     {
     public:
 
@@ -71,6 +256,19 @@ namespace OpenSteer {
                                     const float radius,
                                     std::vector<ContentType>& results) = 0;
 
+        // find all neighbors within the given sphere whose categories share
+        // at least one bit with includeMask and none with excludeMask
+        virtual void findNeighbors (const Vec3& center,
+                                    const float radius,
+                                    const unsigned int includeMask,
+                                    const unsigned int excludeMask,
+                                    std::vector<ContentType>& results) = 0;
+
+        // bit mask of the application-defined categories (e.g. team or
+        // role) this token belongs to, tokens start out in category 0
+        virtual void setCategories (const unsigned int categories) = 0;
+        virtual unsigned int getCategories (void) const = 0;
+
 #ifndef NO_LQ_BIN_STATS
         // only meaningful for LQProximityDatabase, provide dummy default
         virtual void getBinPopulationStats (int& min, int& max, float& average)
@@ -97,6 +295,23 @@ namespace OpenSteer {
         // allocate a token to represent a given client object in this database
         virtual tokenType* allocateToken (ContentType parentObject) = 0;
 
+        // allocate tokens for several client objects at once, appending
+        // them to "tokens" (databases override this to reserve storage)
+        virtual void allocateTokens (const std::vector<ContentType>& parentObjects,
+                                     std::vector<tokenType*>& tokens)
+        {
+            tokens.reserve (tokens.size() + parentObjects.size());
+            for (size_t i = 0; i < parentObjects.size(); i++)
+                tokens.push_back (allocateToken (parentObjects[i]));
+        }
+
+        // delete several tokens at once and clear the vector
+        virtual void deallocateTokens (std::vector<tokenType*>& tokens)
+        {
+            for (size_t i = 0; i < tokens.size(); i++) delete tokens[i];
+            tokens.clear ();
+        }
+
         // insert
         // XXX maybe this should return an iterator?
         // XXX see http://www.sgi.com/tech/stl/set.html
@@ -122,6 +337,7 @@ namespace OpenSteer {
 
         // constructor
         BruteForceProximityDatabase (void)
+            : pool (sizeof (tokenType))
         {
         }
 
@@ -142,16 +358,20 @@ namespace OpenSteer {
                 // token represents, and store this token on the database's vector
                 bfpd = &pd;
                 object = parentObject;
+                categories = lqDefaultCategories;
+                groupIndex = bfpd->group.size();
                 bfpd->group.push_back (this);
             }
 
             // destructor
             virtual ~tokenType ()
             {
-                // remove this token from the database's vector
-                bfpd->group.erase (std::find (bfpd->group.begin(),
-                                              bfpd->group.end(),
-                                              this));
+                // remove this token from the database's vector: move the
+                // last token into our slot (order of the group is unimportant)
+                tokenType* last = bfpd->group.back();
+                bfpd->group[groupIndex] = last;
+                last->groupIndex = groupIndex;
+                bfpd->group.pop_back ();
             }
 
             // the client object calls this each time its position changes
@@ -179,19 +399,59 @@ namespace OpenSteer {
                 }
             }
 
+            // find all neighbors within the given sphere which pass the
+            // category masks (tested before the distance)
+            void findNeighbors (const Vec3& center,
+                                const float radius,
+                                const unsigned int includeMask,
+                                const unsigned int excludeMask,
+                                std::vector<ContentType>& results)
+            {
+                const float r2 = radius * radius;
+                for (tokenIterator i = bfpd->group.begin();
+                     i != bfpd->group.end();
+                     i++)
+                {
+                    const unsigned int c = (**i).categories;
+                    if (((c & includeMask) != 0) && ((c & excludeMask) == 0))
+                    {
+                        const Vec3 offset = center - (**i).position;
+                        if (offset.lengthSquared() < r2)
+                            results.push_back ((**i).object);
+                    }
+                }
+            }
+
+            void setCategories (const unsigned int c) {categories = c;}
+            unsigned int getCategories (void) const {return categories;}
+
         private:
             BruteForceProximityDatabase* bfpd;
             ContentType object;
             Vec3 position;
+            unsigned int categories;
+            size_t groupIndex; // our slot in bfpd->group
         };
 
         typedef std::vector<tokenType*> tokenVector;
         typedef typename tokenVector::const_iterator tokenIterator;    
+        typedef AbstractTokenForProximityDatabase<ContentType> abstractTokenType;
 
         // allocate a token to represent a given client object in this database
         tokenType* allocateToken (ContentType parentObject)
         {
-            return new tokenType (parentObject, *this);
+            return new (pool) tokenType (parentObject, *this);
+        }
+
+        // allocate tokens for several client objects at once
+        void allocateTokens (const std::vector<ContentType>& parentObjects,
+                             std::vector<abstractTokenType*>& tokens)
+        {
+            pool.reserve (parentObjects.size());
+            group.reserve (group.size() + parentObjects.size());
+            tokens.reserve (tokens.size() + parentObjects.size());
+            for (size_t i = 0; i < parentObjects.size(); i++)
+                tokens.push_back (allocateToken (parentObjects[i]));
         }
 
         // return the number of tokens currently in the database
@@ -201,11 +461,309 @@ namespace OpenSteer {
         }
         
     private:
+        // token storage, declared first so it outlives the group
+        ProximityTokenPool pool;
+
         // STL vector containing all tokens in database
         tokenVector group;
     };
 
 
+    // ----------------------------------------------------------------------------
+    // Brute force database like the one above, but keeping positions in
+    // structure-of-arrays form (separate, 32 byte aligned x, y and z arrays)
+    // so a query tests OPENSTEER_PROXIMITY_SIMD_WIDTH tokens per instruction.
+    // Still O(n) per query: meant for populations up to a few thousand, where
+    // the flat arrays beat the bookkeeping of the LQ bin lattice.
+
+
+    template <class ContentType>
+    class VectorizedBruteForceProximityDatabase
+        : public AbstractProximityDatabase<ContentType>
+    {
+    public:
+
+        // constructor
+        VectorizedBruteForceProximityDatabase (void)
+            : pool (sizeof (tokenType)),
+              count (0),
+              capacity (0),
+              block (NULL),
+              xs (NULL), ys (NULL), zs (NULL),
+              categories (NULL),
+              objects (NULL),
+              tokens (NULL)
+        {
+        }
+
+        // destructor
+        virtual ~VectorizedBruteForceProximityDatabase ()
+        {
+            ::operator delete (block);
+        }
+
+        // "token" to represent objects stored in the database, which only
+        // knows its slot in the database's arrays
+        class tokenType : public AbstractTokenForProximityDatabase<ContentType>
+        {
+        public:
+
+            // constructor
+            tokenType (ContentType parentObject,
+                       VectorizedBruteForceProximityDatabase& pd)
+            {
+                vbfpd = &pd;
+                index = vbfpd->addSlot (parentObject, this);
+            }
+
+            // destructor
+            virtual ~tokenType ()
+            {
+                vbfpd->removeSlot (index);
+            }
+
+            // the client object calls this each time its position changes
+            void updateForNewPosition (const Vec3& newPosition)
+            {
+                vbfpd->xs[index] = newPosition.x;
+                vbfpd->ys[index] = newPosition.y;
+                vbfpd->zs[index] = newPosition.z;
+            }
+
+            // find all neighbors within the given sphere (as center and radius)
+            void findNeighbors (const Vec3& center,
+                                const float radius,
+                                std::vector<ContentType>& results)
+            {
+                vbfpd->findNeighbors (center, radius, 0, 0, false, results);
+            }
+
+            // find all neighbors within the given sphere which pass the
+            // category masks (tested on the tokens inside the radius)
+            void findNeighbors (const Vec3& center,
+                                const float radius,
+                                const unsigned int includeMask,
+                                const unsigned int excludeMask,
+                                std::vector<ContentType>& results)
+            {
+                vbfpd->findNeighbors (center, radius,
+                                      includeMask, excludeMask, true,
+                                      results);
+            }
+
+            void setCategories (const unsigned int c)
+            {
+                vbfpd->categories[index] = c;
+            }
+
+            unsigned int getCategories (void) const
+            {
+                return vbfpd->categories[index];
+            }
+
+        private:
+            friend class VectorizedBruteForceProximityDatabase;
+            VectorizedBruteForceProximityDatabase* vbfpd;
+            size_t index; // our slot in the database's arrays
+        };
+
+        typedef AbstractTokenForProximityDatabase<ContentType> abstractTokenType;
+
+        // allocate a token to represent a given client object in this database
+        tokenType* allocateToken (ContentType parentObject)
+        {
+            return new (pool) tokenType (parentObject, *this);
+        }
+
+        // allocate tokens for several client objects at once
+        void allocateTokens (const std::vector<ContentType>& parentObjects,
+                             std::vector<abstractTokenType*>& newTokens)
+        {
+            pool.reserve (parentObjects.size());
+            reserve (count + parentObjects.size());
+            newTokens.reserve (newTokens.size() + parentObjects.size());
+            for (size_t i = 0; i < parentObjects.size(); i++)
+                newTokens.push_back (allocateToken (parentObjects[i]));
+        }
+
+        // return the number of tokens currently in the database
+        int getPopulation (void)
+        {
+            return (int) count;
+        }
+
+    private:
+
+        // append a slot for a new token, which starts out at the origin
+        size_t addSlot (ContentType object, tokenType* token)
+        {
+            if (count == capacity) reserve (capacity ? capacity * 2 : 64);
+            xs[count] = ys[count] = zs[count] = 0;
+            categories[count] = lqDefaultCategories;
+            objects[count] = object;
+            tokens[count] = token;
+            return count++;
+        }
+
+        // remove a token's slot by moving the last slot into it
+        void removeSlot (const size_t i)
+        {
+            const size_t last = --count;
+            if (i != last)
+            {
+                xs[i] = xs[last];
+                ys[i] = ys[last];
+                zs[i] = zs[last];
+                categories[i] = categories[last];
+                objects[i] = objects[last];
+                tokens[i] = tokens[last];
+                tokens[i]->index = i;
+            }
+        }
+
+        // grow the arrays to hold at least n tokens.  All arrays live in one
+        // block, each starting on a 32 byte boundary.
+        void reserve (const size_t n)
+        {
+            if (n <= capacity) return;
+            const size_t newCapacity = ((n + 7) / 8) * 8;
+            const size_t floats = newCapacity * sizeof (float);
+            const size_t words = newCapacity * sizeof (unsigned int);
+            const size_t objs = roundUp (newCapacity * sizeof (ContentType));
+            const size_t toks = newCapacity * sizeof (tokenType*);
+            char* newBlock = (char*) ::operator new (31 + 3*floats + words +
+                                                     objs + toks);
+            char* p = (char*) roundUp ((size_t) newBlock);
+
+            float* newXs = (float*) p;  p += floats;
+            float* newYs = (float*) p;  p += floats;
+            float* newZs = (float*) p;  p += floats;
+            unsigned int* newCategories = (unsigned int*) p;  p += words;
+            ContentType* newObjects = (ContentType*) p;  p += objs;
+            tokenType** newTokens = (tokenType**) p;
+
+            for (size_t i = 0; i < count; i++)
+            {
+                newXs[i] = xs[i];
+                newYs[i] = ys[i];
+                newZs[i] = zs[i];
+                newCategories[i] = categories[i];
+                newObjects[i] = objects[i];
+                newTokens[i] = tokens[i];
+            }
+
+            ::operator delete (block);
+            block = newBlock;
+            xs = newXs;
+            ys = newYs;
+            zs = newZs;
+            categories = newCategories;
+            objects = newObjects;
+            tokens = newTokens;
+            capacity = newCapacity;
+        }
+
+        static size_t roundUp (const size_t n) {return (n + 31) & ~((size_t) 31);}
+
+        // push objects closer than radius to center (and passing the masks
+        // when "filter" is set) onto results
+        void findNeighbors (const Vec3& center,
+                            const float radius,
+                            const unsigned int includeMask,
+                            const unsigned int excludeMask,
+                            const bool filter,
+                            std::vector<ContentType>& results)
+        {
+            const float r2 = radius * radius;
+            size_t i = 0;
+
+#if OPENSTEER_PROXIMITY_SIMD_WIDTH == 8
+            const __m256 cx = _mm256_set1_ps (center.x);
+            const __m256 cy = _mm256_set1_ps (center.y);
+            const __m256 cz = _mm256_set1_ps (center.z);
+            const __m256 r2v = _mm256_set1_ps (r2);
+            for (; i + 8 <= count; i += 8)
+            {
+                const __m256 dx = _mm256_sub_ps (_mm256_load_ps (xs + i), cx);
+                const __m256 dy = _mm256_sub_ps (_mm256_load_ps (ys + i), cy);
+                const __m256 dz = _mm256_sub_ps (_mm256_load_ps (zs + i), cz);
+                const __m256 d2 = _mm256_add_ps (_mm256_mul_ps (dx, dx),
+                                  _mm256_add_ps (_mm256_mul_ps (dy, dy),
+                                                 _mm256_mul_ps (dz, dz)));
+                int hits = _mm256_movemask_ps (_mm256_cmp_ps (d2, r2v, _CMP_LT_OQ));
+                pushHits (i, hits, includeMask, excludeMask, filter, results);
+            }
+#elif OPENSTEER_PROXIMITY_SIMD_WIDTH == 4
+            const __m128 cx = _mm_set1_ps (center.x);
+            const __m128 cy = _mm_set1_ps (center.y);
+            const __m128 cz = _mm_set1_ps (center.z);
+            const __m128 r2v = _mm_set1_ps (r2);
+            for (; i + 4 <= count; i += 4)
+            {
+                const __m128 dx = _mm_sub_ps (_mm_load_ps (xs + i), cx);
+                const __m128 dy = _mm_sub_ps (_mm_load_ps (ys + i), cy);
+                const __m128 dz = _mm_sub_ps (_mm_load_ps (zs + i), cz);
+                const __m128 d2 = _mm_add_ps (_mm_mul_ps (dx, dx),
+                                  _mm_add_ps (_mm_mul_ps (dy, dy),
+                                              _mm_mul_ps (dz, dz)));
+                int hits = _mm_movemask_ps (_mm_cmplt_ps (d2, r2v));
+                pushHits (i, hits, includeMask, excludeMask, filter, results);
+            }
+#endif
+
+            // scalar loop for the remaining tokens (or all of them)
+            for (; i < count; i++)
+            {
+                const float dx = xs[i] - center.x;
+                const float dy = ys[i] - center.y;
+                const float dz = zs[i] - center.z;
+                if ((dx*dx + dy*dy + dz*dz) < r2)
+                    pushHits (i, 1, includeMask, excludeMask, filter, results);
+            }
+        }
+
+        // push the objects of the slots starting at "first" whose bits are
+        // set in "hits"
+        void pushHits (const size_t first,
+                       int hits,
+                       const unsigned int includeMask,
+                       const unsigned int excludeMask,
+                       const bool filter,
+                       std::vector<ContentType>& results)
+        {
+            for (size_t j = first; hits != 0; j++, hits >>= 1)
+            {
+                if (hits & 1)
+                {
+                    const unsigned int c = categories[j];
+                    if (!filter ||
+                        (((c & includeMask) != 0) && ((c & excludeMask) == 0)))
+                        results.push_back (objects[j]);
+                }
+            }
+        }
+
+        // not copyable: tokens point back at the database
+        VectorizedBruteForceProximityDatabase (const VectorizedBruteForceProximityDatabase&);
+        VectorizedBruteForceProximityDatabase& operator= (const VectorizedBruteForceProximityDatabase&);
+
+        // token storage
+        ProximityTokenPool pool;
+
+        // per token arrays, slots 0 to count-1 are in use (ContentType is
+        // copied as raw memory: a pointer, as with the LQ databases)
+        size_t count;
+        size_t capacity;
+        void* block;
+        float* xs;
+        float* ys;
+        float* zs;
+        unsigned int* categories;
+        ContentType* objects;
+        tokenType** tokens;
+    };
+
+
     // ----------------------------------------------------------------------------
     // A AbstractProximityDatabase-style wrapper for the LQ bin lattice system
 
@@ -219,6 +777,7 @@ namespace OpenSteer {
         LQProximityDatabase (const Vec3& center,
                              const Vec3& dimensions,
                              const Vec3& divisions)
+            : pool (sizeof (tokenType))
         {
             const Vec3 halfsize (dimensions * 0.5f);
             const Vec3 origin (center - halfsize);
@@ -273,6 +832,26 @@ namespace OpenSteer {
                                                (void*)&results);
             }
 
+            // find all neighbors within the given sphere which pass the
+            // category masks (filtered by LQ during the bin traversal)
+            void findNeighbors (const Vec3& center,
+                                const float radius,
+                                const unsigned int includeMask,
+                                const unsigned int excludeMask,
+                                std::vector<ContentType>& results)
+            {
+                lqMapOverAllObjectsInLocalityFiltered (lq, 
+                                                       center.x, center.y, center.z,
+                                                       radius,
+                                                       includeMask,
+                                                       excludeMask,
+                                                       perNeighborCallBackFunction,
+                                                       (void*)&results);
+            }
+
+            void setCategories (const unsigned int c) {proxy.categories = c;}
+            unsigned int getCategories (void) const {return proxy.categories;}
+
             // called by LQ for each clientObject in the specified neighborhood:
             // push that clientObject onto the ContentType vector in void*
             // clientQueryState
@@ -301,31 +880,94 @@ namespace OpenSteer {
         };
 
 
+        typedef AbstractTokenForProximityDatabase<ContentType> abstractTokenType;
+
         // allocate a token to represent a given client object in this database
         tokenType* allocateToken (ContentType parentObject)
         {
-            return new tokenType (parentObject, *this);
+            return new (pool) tokenType (parentObject, *this);
+        }
+
+        // allocate tokens for several client objects at once
+        void allocateTokens (const std::vector<ContentType>& parentObjects,
+                             std::vector<abstractTokenType*>& tokens)
+        {
+            pool.reserve (parentObjects.size());
+            tokens.reserve (tokens.size() + parentObjects.size());
+            for (size_t i = 0; i < parentObjects.size(); i++)
+                tokens.push_back (allocateToken (parentObjects[i]));
         }
 
-        // count the number of tokens currently in the database
+        // return the number of tokens currently in the database
+        // (LQ keeps count as tokens move between bins)
         int getPopulation (void)
         {
-            int count = 0;
-            lqMapOverAllObjects (lq, counterCallBackFunction, &count);
-            return count;
+            return lqGetPopulation (lq);
         }
-        
-        // (parameter names commented out to prevent compiler warning from "-W")
-        static void counterCallBackFunction  (void* /*clientObject*/,
-                                              float /*distanceSquared*/,
-                                              void* clientQueryState)
+
+        // snapshot of population and bin occupancy statistics, cheap
+        // enough to call every frame
+        void getPopulationStats (lqPopulationStats& stats)
+        {
+            lqGetPopulationStats (lq, &stats);
+        }
+
+        // statistics about the queries made since the last reset
+        // (bins visited, candidates tested versus hits), gathered only
+        // while recording (or auto-tune) is on.  A recording query
+        // writes to the database: findNeighbors is not thread-safe
+        // until both are turned off again.
+        void getQueryStats (lqQueryStats& stats)
         {
-            int& counter = *(int*)clientQueryState;
-            counter++;
+            lqGetQueryStats (lq, &stats);
+        }
+
+        void resetQueryStats (void)
+        {
+            lqResetQueryStats (lq);
+        }
+
+        void setQueryStatsRecording (const bool record)
+        {
+            lqSetQueryStatsRecording (lq, record ? 1 : 0);
+        }
+
+        // current lattice subdivisions
+        Vec3 getDivisions (void)
+        {
+            int x, y, z;
+            lqGetDivisions (lq, &x, &y, &z);
+            return Vec3 ((float) x, (float) y, (float) z);
+        }
+
+        // subdivisions suggested by the recorded query statistics
+        Vec3 recommendDivisions (void)
+        {
+            int x, y, z;
+            lqRecommendDivisions (lq, &x, &y, &z);
+            return Vec3 ((float) x, (float) y, (float) z);
+        }
+
+        // re-grid in place, existing tokens are kept (not reallocated)
+        void setDivisions (const Vec3& divisions)
+        {
+            lqSetDivisions (lq,
+                            (int) round (divisions.x),
+                            (int) round (divisions.y),
+                            (int) round (divisions.z));
+        }
+
+        // re-grid automatically every queryWindow queries when the cost
+        // per neighbor found exceeds costRatioThreshold (0 turns it off),
+        // queries record statistics (and are not thread-safe) while on
+        void setAutoTune (const float costRatioThreshold, const int queryWindow)
+        {
+            lqSetAutoTune (lq, costRatioThreshold, queryWindow);
         }
 
 
     private:
+        ProximityTokenPool pool;
         lqDB* lq;
     };
 
@@ -334,7 +976,7 @@ namespace OpenSteer {
 
     // "token" to represent objects stored in the database
     template <typename ContentType>
-    class SimpleLQProximityToken
+    class SimpleLQProximityToken : public PooledProximityToken
     {
       public:
 
@@ -369,6 +1011,28 @@ namespace OpenSteer {
             return results;
         }
 
+        // find all neighbors within the given sphere whose categories share
+        // at least one bit with includeMask and none with excludeMask
+        std::vector<ContentType>* findNeighbors (const Vec3& center,
+                                                 const float radius,
+                                                 const unsigned int includeMask,
+                                                 const unsigned int excludeMask)
+        {
+            std::vector<ContentType> *results = new std::vector<ContentType>();
+            lqMapOverAllObjectsInLocalityFiltered (lq, 
+                                                   center.x, center.y, center.z,
+                                                   radius,
+                                                   includeMask,
+                                                   excludeMask,
+                                                   perNeighborCallBackFunction,
+                                                   (void*)results);
+            return results;
+        }
+
+        // bit mask of the categories this token belongs to
+        void setCategories (const unsigned int c) {proxy.categories = c;}
+        unsigned int getCategories (void) const {return proxy.categories;}
+
         // called by LQ for each clientObject in the specified neighborhood:
         // push that clientObject onto the ContentType vector in void*
         // clientQueryState
@@ -406,6 +1070,7 @@ namespace OpenSteer {
         SimpleLQProximityDatabase (const Vec3& center,
                              const Vec3& dimensions,
                              const Vec3& divisions)
+            : pool (sizeof (SimpleLQProximityToken<ContentType>))
         {
             const Vec3 halfsize (dimensions * 0.5f);
             const Vec3 origin (center - halfsize);
@@ -428,28 +1093,43 @@ namespace OpenSteer {
         // allocate a token to represent a given client object in this database
         SimpleLQProximityToken<ContentType>* allocateToken (ContentType parentObject)
         {
-            return new SimpleLQProximityToken<ContentType> (parentObject, *lq);
+            return new (pool) SimpleLQProximityToken<ContentType> (parentObject, *lq);
+        }
+
+        // allocate tokens for several client objects at once
+        void allocateTokens (const std::vector<ContentType>& parentObjects,
+                             std::vector<SimpleLQProximityToken<ContentType>*>& tokens)
+        {
+            pool.reserve (parentObjects.size());
+            tokens.reserve (tokens.size() + parentObjects.size());
+            for (size_t i = 0; i < parentObjects.size(); i++)
+                tokens.push_back (allocateToken (parentObjects[i]));
+        }
+
+        // delete several tokens at once and clear the vector
+        void deallocateTokens (std::vector<SimpleLQProximityToken<ContentType>*>& tokens)
+        {
+            for (size_t i = 0; i < tokens.size(); i++) delete tokens[i];
+            tokens.clear ();
         }
 
-        // count the number of tokens currently in the database
+        // return the number of tokens currently in the database
+        // (LQ keeps count as tokens move between bins)
         int getPopulation (void)
         {
-            int count = 0;
-            lqMapOverAllObjects (lq, counterCallBackFunction, &count);
-            return count;
+            return lqGetPopulation (lq);
         }
-        
-        // (parameter names commented out to prevent compiler warning from "-W")
-        static void counterCallBackFunction  (void* /*clientObject*/,
-                                              float /*distanceSquared*/,
-                                              void* clientQueryState)
+
+        // snapshot of population and bin occupancy statistics, cheap
+        // enough to call every frame
+        void getPopulationStats (lqPopulationStats& stats)
         {
-            int& counter = *(int*)clientQueryState;
-            counter++;
+            lqGetPopulationStats (lq, &stats);
         }
 
 
     private:
+        ProximityTokenPool pool;
         lqDB* lq;
     };
     
@@ -37,6 +37,9 @@
 // Include std::numeric_limits< float >::max
 #include <limits>
 
+// Include std::min
+#include <algorithm>
+
 
 
 // Include OpenSteer::Vec3
@@ -51,6 +54,9 @@
 // Include OpenSteer::PointToPathAlikeBaseDataExtractionPolicy, OpenSteer::DistanceToPathAlikeBaseDataExtractionPolicy
 #include "OpenSteer/QueryPathAlikeBaseDataExtractionPolicies.h"
 
+// Include OpenSteer::PointToPathFollowingMapping, OpenSteer::PathDistanceToPointMapping
+#include "OpenSteer/QueryPathAlikeMappings.h"
+
 #ifdef _MSC_VER
 #undef min
 #undef max
@@ -145,6 +151,96 @@ namespace OpenSteer {
         PointToPathAlikeMapping< PathAlike, Mapping >::map( pathAlike, point, mapping );
     }
     
+    
+    /**
+     * Like @c PointToPathAlikeMapping but maps several query points with a
+     * single traversal of the path alike segments: each segment is visited
+     * once and the data of all query points is extracted from it while it is
+     * at hand.
+     */
+    template< class PathAlike, class Mapping, class BaseDataExtractionPolicy = PointToPathAlikeBaseDataExtractionPolicy< PathAlike > >
+    class PointsToPathAlikeMapping {
+    public:
+        
+        /**
+         * Maps the @a count points in @a queryPoints to @a pathAlike and 
+         * returns the queried data in the corresponding element of
+         * @a mappings.
+         *
+         * See @c PointToPathAlikeMapping::map for the requirements on 
+         * @c Mapping.
+         */
+        static void map( PathAlike const& pathAlike, Vec3 const* queryPoints, size_t count, Mapping* mappings ) {
+            
+            // Points are processed in chunks to keep the per point state on
+            // the stack.
+            for ( size_t first = 0; first < count; first += chunkSize ) {
+                size_t const chunkCount = std::min( count - first, static_cast< size_t >( chunkSize ) );
+                mapChunk( pathAlike, queryPoints + first, chunkCount, mappings + first );
+            }
+        }
+        
+        enum { chunkSize = 16 };
+        
+    private:
+        
+        static void mapChunk( PathAlike const& pathAlike, Vec3 const* queryPoints, size_t count, Mapping* mappings ) {
+            float minDistancePointToPath[ chunkSize ];
+            for ( size_t i = 0; i < count; ++i ) {
+                minDistancePointToPath[ i ] = std::numeric_limits< float >::max();
+                mappings[ i ].setDistanceOnPathFlag( 0.0f );
+            }
+            
+            typedef typename PathAlike::size_type size_type;
+            size_type const segmentCount = pathAlike.segmentCount();
+            for ( size_type segmentIndex = 0; segmentIndex < segmentCount; ++segmentIndex ) {
+                
+                float const segmentLength = pathAlike.segmentLength( segmentIndex );
+                
+                for ( size_t i = 0; i < count; ++i ) {
+                    Vec3 const& queryPoint = queryPoints[ i ];
+                    Mapping& mapping = mappings[ i ];
+                    
+                    float segmentDistance = 0.0f;
+                    float radius = 0.0f;
+                    float distancePointToPath = 0.0f;
+                    Vec3 pointOnPathCenterLine( 0.0f, 0.0f, 0.0f );
+                    Vec3 tangent( 0.0f, 0.0f, 0.0f );
+                    
+                    BaseDataExtractionPolicy::extract( pathAlike, segmentIndex, queryPoint, segmentDistance, radius, distancePointToPath, pointOnPathCenterLine, tangent );
+                    
+                    if ( distancePointToPath < minDistancePointToPath[ i ] ) {
+                        minDistancePointToPath[ i ] = distancePointToPath;
+                        mapping.setPointOnPathCenterLine( pointOnPathCenterLine );
+                        mapping.setPointOnPathBoundary( pointOnPathCenterLine + ( ( queryPoint - pointOnPathCenterLine ).normalize() * radius ) );
+                        mapping.setRadius( radius );
+                        mapping.setTangent( tangent );
+                        mapping.setSegmentIndex( segmentIndex );
+                        mapping.setDistancePointToPath( distancePointToPath );
+                        mapping.setDistancePointToPathCenterLine( distancePointToPath + radius );
+                        mapping.setDistanceOnPath( mapping.distanceOnPathFlag() + segmentDistance );
+                        mapping.setDistanceOnSegment( segmentDistance );
+                    }
+                    
+                    mapping.setDistanceOnPathFlag( mapping.distanceOnPathFlag() + segmentLength );
+                }
+            }
+        }
+        
+    }; // class PointsToPathAlikeMapping
+    
+    /**
+     * Maps the @a count points in @a points to @a pathAlike in one traversal
+     * and returns the data extracted in the corresponding element of 
+     * @a mappings.
+     *
+     * See @c PointsToPathAlikeMapping::map for further information.
+     */
+    template< class PathAlike, class Mapping >
+    void mapPointsToPathAlike( PathAlike const& pathAlike, Vec3 const* points, size_t count, Mapping* mappings ) {
+        PointsToPathAlikeMapping< PathAlike, Mapping >::map( pathAlike, points, count, mappings );
+    }
+    
         
     
     /**
@@ -224,6 +320,113 @@ namespace OpenSteer {
     }
     
     
+    /**
+     * Like @c mapDistanceToPathAlike but starts looking for the segment 
+     * reached by @a distance at segment @a segmentIndex, which starts 
+     * @a segmentStartDistance along the path, instead of at the first 
+     * segment. Use it when the distance is known to be close to a mapped
+     * point (such as a path following target ahead of the vehicle's own
+     * position on the path): only the segments in between are visited.
+     *
+     * See @c DistanceToPathAlikeMapping::map for the requirements on 
+     * @c Mapping.
+     */
+    template< class PathAlike, class Mapping, class BaseDataExtractionPolicy >
+    void mapDistanceToPathAlikeNearSegment( PathAlike const& pathAlike, 
+                                            float distanceOnPath, 
+                                            typename PathAlike::size_type segmentIndex,
+                                            float segmentStartDistance,
+                                            Mapping& mapping ) {
+        float const pathLength = pathAlike.length();
+        
+        // Modify @c distanceOnPath to applicable values.
+        if ( pathAlike.isCyclic() ) {
+            distanceOnPath = modulo( distanceOnPath, pathLength );       
+        }
+        distanceOnPath = clamp( distanceOnPath, 0.0f, pathLength );
+        
+        // Walk backward or forward from the start segment to the segment
+        // reached by @c distanceOnPath.
+        typedef typename PathAlike::size_type size_type;
+        size_type const maxSegmentIndex = pathAlike.segmentCount() - 1;
+        while ( ( segmentIndex > 0 ) && ( distanceOnPath < segmentStartDistance ) ) {
+            --segmentIndex;
+            segmentStartDistance -= pathAlike.segmentLength( segmentIndex );
+        }
+        while( ( segmentIndex < maxSegmentIndex ) && 
+               ( distanceOnPath - segmentStartDistance > pathAlike.segmentLength( segmentIndex ) ) ) {
+            segmentStartDistance += pathAlike.segmentLength( segmentIndex );
+            ++segmentIndex;
+        }
+        float const remainingDistance = ( 0 == segmentIndex ) ? distanceOnPath : distanceOnPath - segmentStartDistance;
+        
+        Vec3 pointOnPathCenterLine( 0.0f, 0.0f, 0.0f );
+        Vec3 tangent( 0.0f, 0.0f, 0.0f );
+        float radius = 0.0f;
+        BaseDataExtractionPolicy::extract( pathAlike, segmentIndex, remainingDistance, pointOnPathCenterLine, tangent, radius );
+        
+        mapping.setPointOnPathCenterLine( pointOnPathCenterLine );
+        mapping.setRadius( radius );
+        mapping.setTangent( tangent );
+        mapping.setSegmentIndex( segmentIndex );
+        mapping.setDistanceOnPath( distanceOnPath );
+        mapping.setDistanceOnSegment( remainingDistance );
+    }
+    
+    template< class PathAlike, class Mapping >
+    void mapDistanceToPathAlikeNearSegment( PathAlike const& pathAlike, 
+                                            float distanceOnPath, 
+                                            typename PathAlike::size_type segmentIndex,
+                                            float segmentStartDistance,
+                                            Mapping& mapping ) {
+        mapDistanceToPathAlikeNearSegment< PathAlike, Mapping, DistanceToPathAlikeBaseDataExtractionPolicy< PathAlike > >( pathAlike, distanceOnPath, segmentIndex, segmentStartDistance, mapping );
+    }
+    
+    
+    /**
+     * Maps the @a count points in @a points to @a pathAlike in one traversal
+     * (see @c PointsToPathAlikeMapping) and stores, for each, the point on
+     * the path center line, the tangent, how far the point is outside the
+     * path and its distance along the path in the corresponding element of
+     * @a results. If @a offsets isn't @c 0 the point on the path
+     * @c offsets[ i ] further along the path than point @c i is stored too,
+     * found by walking from the segment point @c i mapped to.
+     *
+     * @c Result must provide the data members 
+     * <code>Vec3 pointOnPath, tangent, pointAtOffset</code> and
+     * <code>float outside, distanceOnPath</code> 
+     * (see @c OpenSteer::Pathway::PointMapping ).
+     */
+    template< class PathAlike, class Result >
+    void mapPointsAndOffsetsToPathAlike( PathAlike const& pathAlike, Vec3 const* points, float const* offsets, size_t count, Result* results ) {
+        size_t const chunkSize = PointsToPathAlikeMapping< PathAlike, PointToPathFollowingMapping >::chunkSize;
+        PointToPathFollowingMapping mappings[ chunkSize ];
+        for ( size_t first = 0; first < count; first += chunkSize ) {
+            size_t const chunkCount = std::min( count - first, chunkSize );
+            mapPointsToPathAlike( pathAlike, points + first, chunkCount, mappings );
+            
+            for ( size_t i = 0; i < chunkCount; ++i ) {
+                PointToPathFollowingMapping const& mapping = mappings[ i ];
+                Result& result = results[ first + i ];
+                result.pointOnPath = mapping.pointOnPathCenterLine;
+                result.tangent = mapping.tangent;
+                result.outside = mapping.distancePointToPath;
+                result.distanceOnPath = mapping.distanceOnPath;
+                
+                if ( 0 != offsets ) {
+                    PathDistanceToPointMapping offsetMapping;
+                    mapDistanceToPathAlikeNearSegment( pathAlike, 
+                                                       mapping.distanceOnPath + offsets[ first + i ], 
+                                                       mapping.segmentIndex, 
+                                                       mapping.distanceOnPath - mapping.distanceOnSegment, 
+                                                       offsetMapping );
+                    result.pointAtOffset = offsetMapping.pointOnPathCenterLine;
+                }
+            }
+        }
+    }
+    
+    
 } // namespace OpenSteer
 
 #endif // OPENSTEER_QUERYPATHALIKE_H
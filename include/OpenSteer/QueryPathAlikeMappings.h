@@ -137,6 +137,50 @@ namespace OpenSteer {
     }; // class PointToPathDistanceMapping
     
     
+    /**
+     * Stores everything path following needs to know about a query point:
+     * the nearest point on the path center line, the tangent there, the
+     * distance of the query point to the path boundary, the distance along
+     * the path and the segment index and distance on that segment - used by
+     * @c OpenSteer::mapPointsToPathAlike and
+     * @c OpenSteer::mapDistanceToPathAlikeNearSegment.
+     */
+    class PointToPathFollowingMapping
+        : public ExtractPathDistance {
+    public:
+        PointToPathFollowingMapping() : pointOnPathCenterLine( 0.0f, 0.0f, 0.0f ), tangent( 0.0f, 0.0f, 0.0f ), distancePointToPath( 0.0f ), distanceOnPath( 0.0f ), segmentIndex( 0 ), distanceOnSegment( 0.0f ) {}
+        
+        void setPointOnPathCenterLine( Vec3 const& point ) {
+            pointOnPathCenterLine = point;
+        }
+        void setPointOnPathBoundary( Vec3 const& ) {}
+        void setRadius( float ) {}
+        void setTangent( Vec3 const& t ) {
+            tangent = t;
+        }
+        void setSegmentIndex( size_t index ) {
+            segmentIndex = index;
+        }
+        void setDistancePointToPath( float distance ) {
+            distancePointToPath = distance;
+        }
+        void setDistancePointToPathCenterLine( float ) {}
+        void setDistanceOnPath( float distance ) {
+            distanceOnPath = distance;
+        }
+        void setDistanceOnSegment( float distance ) {
+            distanceOnSegment = distance;
+        }
+        
+        Vec3 pointOnPathCenterLine;
+        Vec3 tangent;
+        float distancePointToPath;
+        float distanceOnPath;
+        size_t segmentIndex;
+        float distanceOnSegment;
+    }; // class PointToPathFollowingMapping
+    
+    
 } // namespace OpenSteer
 
 
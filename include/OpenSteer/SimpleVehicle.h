@@ -120,6 +120,10 @@ namespace OpenSteer {
             resetSmoothedPosition ();
             resetSmoothedCurvature ();
             resetSmoothedAcceleration ();
+
+            // predictions made before the reset no longer apply
+            _predictionCacheValid = false;
+            _lastSteeringForce = Vec3::zero;
         }
 
         // get/set mass
@@ -153,6 +157,19 @@ namespace OpenSteer {
         // adjusting our orientation to maintain velocity-alignment.
         void applySteeringForce (const Vec3& force, const float deltaTime);
 
+        // the force most recently passed to applySteeringForce
+        const Vec3& lastSteeringForce (void) const {return _lastSteeringForce;}
+
+        // advance motion without computing new steering, by applying the
+        // previous steering force again (used in place of update by
+        // LevelOfDetailScheduler).  Vehicles which must do more on each step,
+        // such as updating a proximity token, should extend this.
+        virtual void coast (const float /* currentTime */,
+                            const float elapsedTime)
+        {
+            applySteeringForce (_lastSteeringForce, elapsedTime);
+        }
+
         // the default version: keep FORWARD parallel to velocity, change
         // UP as little as possible.
         virtual void regenerateLocalSpace (const Vec3& newVelocity,
@@ -179,6 +196,26 @@ namespace OpenSteer {
         // (assumes velocity remains constant)
         Vec3 predictFuturePosition (const float predictionTime) const;
 
+        // Per-tick cache of predictFuturePosition at the standard horizons
+        // below (in seconds).  When enabled it is refilled at the end of
+        // applySteeringForce, so a vehicle which is pursued or evaded by many
+        // others evaluates its (virtual, possibly curved) prediction once
+        // per tick.  Call updatePredictionCache after moving the vehicle by
+        // other means (e.g. setPosition).
+        static const int predictionCacheSize = 13;
+        static const float predictionCacheHorizons [predictionCacheSize];
+        void setPredictionCaching (const bool enable)
+        {
+            _cachePredictions = enable;
+            _predictionCacheValid = false;
+        }
+        bool predictionCaching (void) const {return _cachePredictions;}
+        void updatePredictionCache (void);
+
+        // future position interpolated from the cache when it is valid and
+        // predictionTime is within the horizons, else predictFuturePosition
+        Vec3 cachedFuturePosition (const float predictionTime) const;
+
         // get instantaneous curvature (since last update)
         float curvature (void) const {return _curvature;}
 
@@ -236,6 +273,12 @@ namespace OpenSteer {
         float _maxSpeed;   // the maximum speed this vehicle is allowed to move
                            // (velocity is clipped to this magnitude)
 
+        Vec3 _lastSteeringForce; // argument of last applySteeringForce
+
+        bool _cachePredictions;      // refill cache in applySteeringForce
+        bool _predictionCacheValid;  // cache matches current state
+        Vec3 _predictionCache [predictionCacheSize];
+
         float _curvature;
         Vec3 _lastForward;
         Vec3 _lastPosition;
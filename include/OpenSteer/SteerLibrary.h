@@ -49,7 +49,9 @@
 
 #include "OpenSteer/AbstractVehicle.h"
 #include "OpenSteer/Pathway.h"
+#include "OpenSteer/PathwayFlowField.h"
 #include "OpenSteer/Obstacle.h"
+#include "OpenSteer/ObstacleDistanceField.h"
 #include "OpenSteer/Utilities.h"
 
 #ifndef NO_ANNOT
@@ -120,6 +122,13 @@ namespace OpenSteer {
                                 Pathway& path);
         Vec3 steerToStayOnPath (const float predictionTime, Pathway& path);
 
+        // Path following by sampling a flow field precomputed from "path"
+        // (falls back to steerToFollowPath outside of the field's grid)
+        Vec3 steerToFollowFlowField (const int direction,
+                                     const float predictionTime,
+                                     const PathwayFlowField& field,
+                                     Pathway& path);
+
         // ------------------------------------------------------------------------
         // Obstacle Avoidance behavior
         //
@@ -142,6 +151,13 @@ namespace OpenSteer {
                                     const ObstacleGroup& obstacles);
 
 
+        // avoids the obstacles baked into a distance field by marching along
+        // our path through it (cost independent of the number of obstacles)
+
+        Vec3 steerToAvoidObstacleField (const float minTimeToCollision,
+                                        const ObstacleDistanceField& field);
+
+
         // ------------------------------------------------------------------------
         // Unaligned collision avoidance behavior: avoid colliding with other
         // nearby vehicles moving in unconstrained directions.  Determine which
@@ -239,6 +255,28 @@ namespace OpenSteer {
                               const float maxPredictionTime);
 
 
+        // ------------------------------------------------------------------------
+        // evasion of a group of menaces: flee from where each menace will be
+        // (relative to us) when it could reach us, weighted by how soon that
+        // is.  Menaces which cannot close the distance within
+        // maxPredictionTime are ignored, so the group is best gathered with a
+        // proximity query of radius evasionQueryRadius.
+
+
+        Vec3 steerForEvasionFromGroup (const AVGroup& menaces,
+                                       const float maxPredictionTime);
+
+        // no menace moving at most maxMenaceSpeed from beyond this distance
+        // can reach us within maxPredictionTime (pad it for menaces much
+        // larger than we are)
+        float evasionQueryRadius (const float maxMenaceSpeed,
+                                  const float maxPredictionTime) const
+        {
+            return (((maxMenaceSpeed + maxSpeed ()) * maxPredictionTime) +
+                    (2 * radius ()));
+        }
+
+
         // ------------------------------------------------------------------------
         // tries to maintain a given speed, returns a maxForce-clipped steering
         // force along the forward/backward axis
@@ -437,28 +475,24 @@ steerToFollowPath (const int direction,
     // predict our future position
     const Vec3 futurePosition = predictFuturePosition (predictionTime);
 
-    // measure distance along path of our current and predicted positions
-    const float nowPathDistance =
-        path.mapPointToPathDistance (position ());
-    const float futurePathDistance =
-        path.mapPointToPathDistance (futurePosition);
+    // map our current and predicted positions to the path with one query:
+    // their distances along the path and the point on the path nearest the
+    // predicted future position (with how far we are outside the path tube
+    // there)
+    const Vec3 points[2] = { position (), futurePosition };
+    Pathway::PointMapping mappings[2];
+    path.mapPointsToPath (2, points, 0, mappings);
+
+    const float nowPathDistance = mappings[0].distanceOnPath;
+    const float futurePathDistance = mappings[1].distanceOnPath;
+    const Vec3 onPath = mappings[1].pointOnPath;
+    const float outside = mappings[1].outside;
 
     // are we facing in the correction direction?
     const bool rightway = ((pathDistanceOffset > 0) ?
                            (nowPathDistance < futurePathDistance) :
                            (nowPathDistance > futurePathDistance));
 
-    // find the point on the path nearest the predicted future position
-    // XXX need to improve calling sequence, maybe change to return a
-    // XXX special path-defined object which includes two Vec3s and a 
-    // XXX bool (onPath,tangent (ignored), withinPath)
-    Vec3 tangent;
-    float outside;
-    const Vec3 onPath = path.mapPointToPath (futurePosition,
-                                             // output arguments:
-                                             tangent,
-                                             outside);
-
     // no steering is required if (a) our future position is inside
     // the path tube and (b) we are facing in the correct direction
     if ((outside < 0) && rightway)
@@ -470,9 +504,8 @@ steerToFollowPath (const int direction,
     {
         // otherwise we need to steer towards a target point obtained
         // by adding pathDistanceOffset to our current path position
-
-        float const targetPathDistance = nowPathDistance + pathDistanceOffset;
-        Vec3 const target = path.mapPathDistanceToPoint (targetPathDistance);
+        const float targetPathDistance = nowPathDistance + pathDistanceOffset;
+        const Vec3 target = path.mapPathDistanceToPoint (targetPathDistance);
 
         annotatePathFollowing (futurePosition, onPath, target, outside);
 
@@ -482,6 +515,48 @@ steerToFollowPath (const int direction,
 }
 
 
+template<class Super>
+OpenSteer::Vec3
+OpenSteer::SteerLibraryMixin<Super>::
+steerToFollowFlowField (const int direction,
+                        const float predictionTime,
+                        const PathwayFlowField& field,
+                        Pathway& path)
+{
+    // predict our future position
+    const Vec3 futurePosition = predictFuturePosition (predictionTime);
+
+    // look up the guidance at our current and predicted positions, use the
+    // exact path query when either is off the grid
+    PathwayFlowField::Sample now, future;
+    if (! (field.sample (position (), direction, now) &&
+           field.sample (futurePosition, direction, future)))
+    {
+        return steerToFollowPath (direction, predictionTime, path);
+    }
+
+    // are we facing in the correction direction?
+    const bool rightway = ((direction > 0) ?
+                           (now.distanceOnPath < future.distanceOnPath) :
+                           (now.distanceOnPath > future.distanceOnPath));
+
+    // no steering is required if (a) our future position is inside
+    // the path tube and (b) we are facing in the correct direction
+    if ((future.outside < 0) && rightway)
+    {
+        // all is well, return zero steering
+        return Vec3::zero;
+    }
+    else
+    {
+        // otherwise seek along the flow: it points to the target ahead of
+        // our current path position
+        const Vec3 desiredVelocity = now.direction * maxSpeed ();
+        return desiredVelocity - velocity();
+    }
+}
+
+
 // ----------------------------------------------------------------------------
 // Obstacle Avoidance behavior
 //
@@ -539,6 +614,30 @@ steerToAvoidObstacles (const float minTimeToCollision,
 }
 
 
+// this version avoids the obstacles baked into an ObstacleDistanceField
+
+template<class Super>
+OpenSteer::Vec3
+OpenSteer::SteerLibraryMixin<Super>::
+steerToAvoidObstacleField (const float minTimeToCollision,
+                           const ObstacleDistanceField& field)
+{
+    // march along our path as far as we could travel before needing to
+    // react, then steer away from the surface found (if any) just like
+    // steerToAvoidObstacles does
+    AbstractObstacle::PathIntersection pi;
+    field.findIntersectionWithVehiclePath (*this,
+                                           minTimeToCollision * speed(),
+                                           pi);
+    const Vec3 avoidance = pi.steerToAvoidIfNeeded (*this, minTimeToCollision);
+
+    if (avoidance != Vec3::zero)
+        annotateAvoidObstacle (minTimeToCollision * speed());
+
+    return avoidance;
+}
+
+
 // ----------------------------------------------------------------------------
 // Unaligned collision avoidance behavior: avoid colliding with other nearby
 // vehicles moving in unconstrained directions.  Determine which (if any)
@@ -699,11 +798,9 @@ OpenSteer::SteerLibraryMixin<Super>::
 computeNearestApproachPositions (AbstractVehicle& otherVehicle,
                                  float time)
 {
-    const Vec3    myTravel =       forward () *       speed () * time;
-    const Vec3 otherTravel = otherVehicle.forward () * otherVehicle.speed () * time;
-
-    const Vec3    myFinal =       position () +    myTravel;
-    const Vec3 otherFinal = otherVehicle.position () + otherTravel;
+    // (read from the vehicles' prediction caches when they keep them)
+    const Vec3    myFinal = this->cachedFuturePosition (time);
+    const Vec3 otherFinal = otherVehicle.cachedFuturePosition (time);
 
     // xxx for annotation
     ourPositionAtNearestApproach = myFinal;
@@ -1043,7 +1140,8 @@ steerForPursuit (const AbstractVehicle& quarry,
     const float etl = (et > maxPredictionTime) ? maxPredictionTime : et;
 
     // estimated position of quarry at intercept
-    const Vec3 target = quarry.predictFuturePosition (etl);
+    // (from the quarry's prediction cache if it keeps one)
+    const Vec3 target = quarry.cachedFuturePosition (etl);
 
 #ifndef NO_ANNOT    
     // annotation
@@ -1074,12 +1172,95 @@ steerForEvasion (const AbstractVehicle& menace,
                                   maxPredictionTime :
                                   roughTime);
 
-    const Vec3 target = menace.predictFuturePosition (predictionTime);
+    const Vec3 target = menace.cachedFuturePosition (predictionTime);
 
     return steerForFlee (target);
 }
 
 
+// ----------------------------------------------------------------------------
+// evasion of a group of menaces
+//
+// Menaces are handled in batches: their state is gathered (through the
+// virtual AbstractVehicle accessors) into flat arrays of relative positions
+// and velocities, then each batch is evaluated in a single branch-free loop
+// the compiler can vectorize.  Prediction within the batch is straight line.
+
+
+template<class Super>
+OpenSteer::Vec3
+OpenSteer::SteerLibraryMixin<Super>::
+steerForEvasionFromGroup (const AVGroup& menaces,
+                          const float maxPredictionTime)
+{
+    const int batchSize = 64;
+    float px [batchSize], py [batchSize], pz [batchSize];
+    float vx [batchSize], vy [batchSize], vz [batchSize];
+    float reach [batchSize];
+
+    const Vec3 myPosition = position ();
+    const Vec3 myVelocity = velocity ();
+    const float myRadius = radius ();
+
+    // weighted sum of unit flee directions
+    float fx = 0, fy = 0, fz = 0;
+
+    for (size_t first = 0; first < menaces.size(); first += batchSize)
+    {
+        const size_t remaining = menaces.size() - first;
+        const int n = (int) ((remaining < (size_t) batchSize) ?
+                             remaining : batchSize);
+
+        // gather menace state relative to ours
+        for (int i = 0; i < n; i++)
+        {
+            const AbstractVehicle& m = *menaces[first + i];
+            const Vec3 p = m.position () - myPosition;
+            const Vec3 v = m.velocity () - myVelocity;
+            px[i] = p.x;  py[i] = p.y;  pz[i] = p.z;
+            vx[i] = v.x;  vy[i] = v.y;  vz[i] = v.z;
+            reach[i] = m.radius () + myRadius;
+        }
+
+        for (int i = 0; i < n; i++)
+        {
+            // distance and closing speed (relative velocity toward us)
+            const float d = sqrtf (px[i]*px[i] + py[i]*py[i] + pz[i]*pz[i]);
+            const float dotPV = px[i]*vx[i] + py[i]*vy[i] + pz[i]*vz[i];
+            const float closing = (d > 0) ? (-dotPV / d) : 0;
+
+            // time until the menace could touch us, and the resulting
+            // weight (1 when touching, falling to 0 at maxPredictionTime).
+            // A menace already touching us is always fled at full weight,
+            // even while it moves away.
+            const float gap = (d > reach[i]) ? (d - reach[i]) : 0;
+            const float t = ((gap > 0) ?
+                             ((closing > 0) ? (gap / closing) : maxPredictionTime) :
+                             0);
+            const float weight = ((t < maxPredictionTime) ?
+                                  (1 - (t / maxPredictionTime)) : 0);
+
+            // flee from the menace's relative position at that time
+            const float tx = px[i] + vx[i] * t;
+            const float ty = py[i] + vy[i] * t;
+            const float tz = pz[i] + vz[i] * t;
+            const float tl = sqrtf (tx*tx + ty*ty + tz*tz);
+            const float scale = (tl > 0) ? (weight / tl) : 0;
+            fx -= tx * scale;
+            fy -= ty * scale;
+            fz -= tz * scale;
+        }
+    }
+
+    const Vec3 flee (fx, fy, fz);
+    if (flee == Vec3::zero) return Vec3::zero;
+
+    // flee at a speed proportional to the combined urgency
+    const Vec3 desiredVelocity = flee.truncateLength (1) * maxSpeed ();
+    return desiredVelocity - velocity ();
+}
+
+
 // ----------------------------------------------------------------------------
 // tries to maintain a given speed, returns a maxForce-clipped steering
 // force along the forward/backward axis
@@ -0,0 +1,215 @@
+// ----------------------------------------------------------------------------
+//
+//
+// OpenSteer -- Steering Behaviors for Autonomous Characters
+//
+// Copyright (c) 2002-2005, Sony Computer Entertainment America
+// Original author: Craig Reynolds <craig_reynolds@playstation.sony.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+//
+// ----------------------------------------------------------------------------
+//
+//
+// SteeringArbiter: priority based combination of steering behaviors
+//
+// Behaviors are member functions of the vehicle class, registered with a
+// priority, a weight and an (estimated, relative) cost.  steer evaluates
+// them lazily, highest priority first (cheapest first among equals), adding
+// up the weighted forces until the force budget is used up or an
+// "exclusive" behavior produced a non-zero force.  Behaviors after that
+// point are not evaluated at all, so any setup they do (such as proximity
+// queries) is skipped too.  A behavior may also be given a "leak through"
+// probability of being passed over, so lower priorities get a chance to
+// drive.  Counters record how often each behavior ran, was active (non-zero),
+// leaked or was skipped.
+//
+// One arbiter can be shared by all vehicles of a class: the vehicle is
+// passed to steer, and the counters then cover the whole group.
+//
+// 10-19-26:     created
+//
+//
+// ----------------------------------------------------------------------------
+
+
+#ifndef OPENSTEER_STEERINGARBITER_H
+#define OPENSTEER_STEERINGARBITER_H
+
+
+#include <algorithm>
+#include <vector>
+#include "OpenSteer/Vec3.h"
+#include "OpenSteer/Utilities.h"
+
+
+namespace OpenSteer {
+
+
+    template <class Vehicle>
+    class SteeringArbiter
+    {
+    public:
+
+        // a steering behavior: member function of Vehicle returning a force
+        typedef Vec3 (Vehicle::*behaviorFunction) (const float elapsedTime);
+
+        struct Behavior
+        {
+            const char* name;
+            behaviorFunction function;
+            int priority;      // larger runs first
+            float weight;      // force is scaled by this
+            float cost;        // relative cost, orders equal priorities
+            bool exclusive;    // a non-zero force ends arbitration
+            float leakThrough; // probability of being passed over
+
+            // counters (see resetCounters)
+            int evaluated;
+            int active;
+            int leaked;
+            int skipped;
+        };
+
+        // constructor
+        SteeringArbiter (void) : _forceBudget (0), _costSkipped (0) {}
+
+        // register a behavior
+        void addBehavior (const char* name,
+                          const behaviorFunction function,
+                          const int priority,
+                          const float weight = 1,
+                          const float cost = 1,
+                          const bool exclusive = false,
+                          const float leakThrough = 0)
+        {
+            Behavior b;
+            b.name = name;
+            b.function = function;
+            b.priority = priority;
+            b.weight = weight;
+            b.cost = cost;
+            b.exclusive = exclusive;
+            b.leakThrough = leakThrough;
+            b.evaluated = b.active = b.leaked = b.skipped = 0;
+
+            // keep behaviors in evaluation order (stable for equal keys)
+            typename std::vector<Behavior>::iterator i = _behaviors.begin();
+            while ((i != _behaviors.end()) && !runsBefore (b, *i)) i++;
+            _behaviors.insert (i, b);
+        }
+
+        void clear (void) {_behaviors.clear ();}
+
+        // maximum magnitude of the combined force (0 for no limit): the
+        // force which crosses it is truncated, later behaviors are skipped
+        void setForceBudget (const float budget) {_forceBudget = budget;}
+        float forceBudget (void) const {return _forceBudget;}
+
+        // evaluate behaviors for the given vehicle, return combined force
+        Vec3 steer (Vehicle& vehicle, const float elapsedTime)
+        {
+            Vec3 total;
+            float remaining = _forceBudget;
+            bool saturated = false;
+
+            for (size_t i = 0; i < _behaviors.size(); i++)
+            {
+                Behavior& b = _behaviors[i];
+
+                // nothing more is needed: skip the rest
+                if (saturated)
+                {
+                    b.skipped++;
+                    _costSkipped += b.cost;
+                    continue;
+                }
+
+                // give lower priorities a chance
+                if ((b.leakThrough > 0) && (frandom01 () < b.leakThrough))
+                {
+                    b.leaked++;
+                    continue;
+                }
+
+                const Vec3 force = (vehicle.*b.function) (elapsedTime) * b.weight;
+                b.evaluated++;
+                if (force == Vec3::zero) continue;
+                b.active++;
+
+                if (_forceBudget > 0)
+                {
+                    const float length = force.length ();
+                    if (length >= remaining)
+                    {
+                        total += force * (remaining / length);
+                        saturated = true;
+                    }
+                    else
+                    {
+                        total += force;
+                        remaining -= length;
+                    }
+                }
+                else
+                {
+                    total += force;
+                }
+
+                if (b.exclusive) saturated = true;
+            }
+            return total;
+        }
+
+        // registered behaviors (with their counters), in evaluation order
+        int behaviorCount (void) const {return (int) _behaviors.size();}
+        const Behavior& behavior (const int i) const {return _behaviors[i];}
+
+        // total cost of the behaviors skipped since the last reset
+        float costSkipped (void) const {return _costSkipped;}
+
+        void resetCounters (void)
+        {
+            for (size_t i = 0; i < _behaviors.size(); i++)
+            {
+                Behavior& b = _behaviors[i];
+                b.evaluated = b.active = b.leaked = b.skipped = 0;
+            }
+            _costSkipped = 0;
+        }
+
+    private:
+
+        static bool runsBefore (const Behavior& a, const Behavior& b)
+        {
+            if (a.priority != b.priority) return a.priority > b.priority;
+            return a.cost < b.cost;
+        }
+
+        std::vector<Behavior> _behaviors;
+        float _forceBudget;
+        float _costSkipped;
+    };
+
+} // namespace OpenSteer
+
+
+// ----------------------------------------------------------------------------
+#endif // OPENSTEER_STEERINGARBITER_H
@@ -133,9 +133,25 @@ typedef struct lqClientProxy
     float x;
     float y;
     float z;
+
+    /* bit mask of the application-defined categories this object
+       belongs to, used to filter locality queries (see
+       lqMapOverAllObjectsInLocalityFiltered) */
+    unsigned int categories;
 } lqClientProxy;
 
 
+/* ------------------------------------------------------------------ */
+/* Category bit masks.  A proxy starts out in category 0 (the default
+   bit) until the application assigns it some other set of categories
+   by writing to its "categories" slot.  A query include mask of
+   lqAllCategories accepts an object in any category.  */
+
+
+#define lqDefaultCategories 1u
+#define lqAllCategories     (~0u)
+
+
 /* ------------------------------------------------------------------ */
 /*                                                                    */
 /*                            Basic API                               */
@@ -217,6 +233,26 @@ void lqMapOverAllObjectsInLocality (lqDB* lq,
 				    void* clientQueryState);
 
 
+/* ------------------------------------------------------------------ */
+/* Like lqMapOverAllObjectsInLocality but only applies the function to
+   objects whose category bit mask shares at least one bit with
+   includeMask and no bits with excludeMask.  The test is made during
+   the bin traversal, before the distance computation, so objects in
+   other categories cost only a mask test.  For example a query for
+   "only defenders" passes the defender bit as includeMask and 0 as
+   excludeMask, a query for "everyone but my team" passes
+   lqAllCategories and the team's bit. */
+
+
+void lqMapOverAllObjectsInLocalityFiltered (lqDB* lq, 
+					    float x, float y, float z,
+					    float radius,
+					    unsigned int includeMask,
+					    unsigned int excludeMask,
+					    lqCallBackFunction func,
+					    void* clientQueryState);
+
+
 /* ------------------------------------------------------------------ */
 /*                                                                    */
 /*                            Other API                               */
@@ -241,7 +277,9 @@ void* lqFindNearestNeighborWithinRadius (lqDB* lq,
 
 /* ------------------------------------------------------------------ */
 /* Adds a given client object to a given bin, linking it into the bin
-   contents list. */
+   contents list.  The bin must be a bin ID obtained from
+   lqBinForLocation: the population counts of the bin and of its
+   database are updated here. */
 
 
 void lqAddToBin (lqClientProxy* object, lqClientProxy** bin);
@@ -294,6 +332,109 @@ void lqMapOverAllObjects (lqDB* lq,
 void lqRemoveAllObjects (lqDB* lq);
 
 
+/* ------------------------------------------------------------------ */
+/* Population statistics.  The database keeps its population, the
+   population of each bin, the number of non-empty bins and the
+   maximum bin population up to date as objects are added to and
+   removed from bins, so these calls do not walk the bins or objects
+   and are cheap enough to call every frame.  */
+
+
+typedef struct lqPopulationStats
+{
+    /* number of objects in the database (including "other") */
+    int population;
+
+    /* number of objects outside the super-brick, in the "other" bin */
+    int outsidePopulation;
+
+    /* number of bins (sub-bricks), and how many of them are not empty */
+    int binCount;
+    int nonEmptyBinCount;
+
+    /* min, max and average population of non-empty bins (min is
+       INT_MAX when all bins are empty) */
+    int minBinPopulation;
+    int maxBinPopulation;
+    float averageBinPopulation;
+} lqPopulationStats;
+
+
+/* returns the number of objects in the database */
+int lqGetPopulation (lqDB* lq);
+
+
+/* returns the number of objects in the given bin (a bin ID as returned
+   by lqBinForLocation) */
+int lqGetBinPopulation (lqClientProxy** bin);
+
+
+/* fills in a snapshot of the database's population statistics */
+void lqGetPopulationStats (lqDB* lq, lqPopulationStats* stats);
+
+
+/* ------------------------------------------------------------------ */
+/* Query statistics.  The locality query functions count the queries
+   made, the bins they visited, the objects they tested (candidates)
+   and the objects found within the query radius (hits).  Together with
+   the sum of query radii these describe how well the lattice fits the
+   queries: many candidates per hit means the bins are too big, many
+   bins visited per hit means they are too small.
+
+   Recording is off by default: lqSetQueryStatsRecording turns it on
+   (nonzero) or off, and it is also on while automatic tuning is set
+   (see lqSetAutoTune).  A query which records writes to the database,
+   so queries are only safe to make from several threads at once while
+   recording and automatic tuning are both off.  */
+
+
+typedef struct lqQueryStats
+{
+    long queryCount;
+    long binsVisited;
+    long candidatesTested;
+    long hits;
+    float radiusSum;
+} lqQueryStats;
+
+
+void lqGetQueryStats (lqDB* lq, lqQueryStats* stats);
+void lqResetQueryStats (lqDB* lq);
+void lqSetQueryStatsRecording (lqDB* lq, int record);
+
+
+/* the cost of the recorded queries per object found: (bins visited +
+   candidates tested) / hits */
+float lqQueryCostRatio (lqDB* lq);
+
+
+/* ------------------------------------------------------------------ */
+/* Lattice subdivisions.  lqRecommendDivisions suggests subdivisions
+   based on the recorded query statistics (a bin edge near the mean
+   query radius, axes with one division left alone, total bins limited
+   relative to the population).  lqSetDivisions re-grids the database
+   in place: only the bin array is reallocated, client proxies are
+   relinked into their new bins without being moved or reinitialized.  */
+
+
+void lqGetDivisions (lqDB* lq, int* divx, int* divy, int* divz);
+void lqRecommendDivisions (lqDB* lq, int* divx, int* divy, int* divz);
+void lqSetDivisions (lqDB* lq, int divx, int divy, int divz);
+
+
+/* ------------------------------------------------------------------ */
+/* Automatic tuning.  lqAutoTune re-grids to the recommended
+   subdivisions when the query cost ratio exceeds the given threshold,
+   then resets the query statistics.  It returns 1 if the lattice was
+   changed.  lqSetAutoTune makes the database call lqAutoTune itself
+   every queryWindow queries (at the start of a query, never during a
+   bin traversal); a queryWindow of 0 turns this off (the default).  */
+
+
+int lqAutoTune (lqDB* lq, float costRatioThreshold);
+void lqSetAutoTune (lqDB* lq, float costRatioThreshold, int queryWindow);
+
+
 /* ------------------------------------------------------------------ */
 /* Get statistics about bin populations: min, max and average of
    non-empty bins. */
@@ -40,6 +40,7 @@
 #include "OpenSteer/SimpleVehicle.h"
 #include "OpenSteer/OpenSteerDemo.h"
 #include "OpenSteer/Proximity.h"
+#include "OpenSteer/LevelOfDetailScheduler.h"
 #include "OpenSteer/Color.h"
 #include "OpenSteer/UnusedParameter.h"
 
@@ -67,6 +68,7 @@ namespace {
 
     typedef OpenSteer::AbstractProximityDatabase<AbstractVehicle*> ProximityDatabase;
     typedef OpenSteer::AbstractTokenForProximityDatabase<AbstractVehicle*> ProximityToken;
+    typedef OpenSteer::LQProximityDatabase<AbstractVehicle*> LQPDAV;
 
 
     // ----------------------------------------------------------------------------
@@ -115,6 +117,9 @@ namespace {
             // initial slow speed
             setSpeed (maxSpeed() * 0.3f);
 
+            // no flockmates seen yet
+            neighborCount = 0;
+
             // randomize initial orientation
             regenerateOrthonormalBasisUF (RandomUnitVector ());
 
@@ -150,6 +155,15 @@ namespace {
         }
 
 
+        // simulation step without new steering (level of detail scheduling)
+        void coast (const float currentTime, const float elapsedTime)
+        {
+            SimpleVehicle::coast (currentTime, elapsedTime);
+            sphericalWrapAround ();
+            proximityToken->updateForNewPosition (position());
+        }
+
+
         // basic flocking
         Vec3 steerToFlock (void)
         {
@@ -177,6 +191,7 @@ namespace {
             // find all flockmates within maxRadius using proximity database
             neighbors.clear();
             proximityToken->findNeighbors (position(), maxRadius, neighbors);
+            neighborCount = (int) neighbors.size();
 
     #ifndef NO_LQ_BIN_STATS
             // maintain stats on max/min/ave neighbors per boids
@@ -291,6 +306,9 @@ namespace {
         // (change to per-instance allocation to be more MP-safe)
         static AVGroup neighbors;
 
+        // number of flockmates found by the latest neighborhood query
+        int neighborCount;
+
         static float worldRadius;
 
         // xxx perhaps this should be a call to a general purpose annotation for
@@ -325,6 +343,22 @@ namespace {
     #endif // NO_LQ_BIN_STATS
 
 
+    // ----------------------------------------------------------------------------
+    // level of detail for boids: boids in a crowd are more interesting
+
+
+    class BoidLevelOfDetailScheduler : public LevelOfDetailScheduler
+    {
+    public:
+        float interest (const SimpleVehicle& vehicle) const
+        {
+            const Boid& boid = (const Boid&) vehicle;
+            const float crowding = minXXX (boid.neighborCount / 10.0f, 1.0f);
+            return LevelOfDetailScheduler::interest (vehicle) + crowding * 0.5f;
+        }
+    };
+
+
     // ----------------------------------------------------------------------------
     // PlugIn for OpenSteerDemo
 
@@ -345,6 +379,9 @@ namespace {
             cyclePD = -1;
             nextPD ();
 
+            // update every boid every tick until asked otherwise
+            levelOfDetail = false;
+
             // make default-sized flock
             population = 0;
             for (int i = 0; i < 200; i++) addBoidToFlock ();
@@ -370,9 +407,18 @@ namespace {
     #endif // NO_LQ_BIN_STATS
 
             // update flock simulation for each boid
-            for (iterator i = flock.begin(); i != flock.end(); i++)
+            if (levelOfDetail)
             {
-                (**i).update (currentTime, elapsedTime);
+                // distant boids away from the crowd steer less often
+                lodScheduler.setFocus (OpenSteerDemo::camera.position ());
+                lodScheduler.update (currentTime, elapsedTime);
+            }
+            else
+            {
+                for (iterator i = flock.begin(); i != flock.end(); i++)
+                {
+                    (**i).update (currentTime, elapsedTime);
+                }
             }
         }
 
@@ -404,6 +450,14 @@ namespace {
             {
             case 0: status << "LQ bin lattice"; break;
             case 1: status << "brute force";    break;
+            case 2:
+                {
+                    const Vec3 d = ((LQPDAV*) pd)->getDivisions ();
+                    status << "LQ bin lattice, auto-tuned ("
+                           << d.x << "x" << d.y << "x" << d.z << ")";
+                    break;
+                }
+            case 3: status << "brute force, vectorized"; break;
             }
             status << "\n[F4]    Obstacles: ";
             switch (constraint)
@@ -427,6 +481,12 @@ namespace {
             case insideBox:
                 status << "inside a box" ; break;
             }
+            status << "\n[F6]    Level of detail: ";
+            if (levelOfDetail)
+                status << lodScheduler.fullUpdates () << " full updates, "
+                       << lodScheduler.coasts () << " coasting";
+            else
+                status << "off";
             status << std::endl;
             const float h = drawGetWindowHeight ();
             const Vec3 screenLocation (10, h-50, 0);
@@ -466,7 +526,7 @@ namespace {
             ProximityDatabase* oldPD = pd;
 
             // allocate new PD
-            const int totalPD = 2;
+            const int totalPD = 4;
             switch (cyclePD = (cyclePD + 1) % totalPD)
             {
             case 0:
@@ -476,7 +536,6 @@ namespace {
                     const Vec3 divisions (div, div, div);
                     const float diameter = Boid::worldRadius * 1.1f * 2;
                     const Vec3 dimensions (diameter, diameter, diameter);
-                    typedef LQProximityDatabase<AbstractVehicle*> LQPDAV;
                     pd = new LQPDAV (center, dimensions, divisions);
                     break;
                 }
@@ -485,6 +544,25 @@ namespace {
                     pd = new BruteForceProximityDatabase<AbstractVehicle*> ();
                     break;
                 }
+            case 2:
+                {
+                    // start from a deliberately coarse lattice and let the
+                    // database re-grid itself from its query statistics
+                    const Vec3 center;
+                    const float div = 2.0f;
+                    const Vec3 divisions (div, div, div);
+                    const float diameter = Boid::worldRadius * 1.1f * 2;
+                    const Vec3 dimensions (diameter, diameter, diameter);
+                    LQPDAV* lqpd = new LQPDAV (center, dimensions, divisions);
+                    lqpd->setAutoTune (10.0f, 1000);
+                    pd = lqpd;
+                    break;
+                }
+            case 3:
+                {
+                    pd = new VectorizedBruteForceProximityDatabase<AbstractVehicle*> ();
+                    break;
+                }
             }
 
             // switch each boid to new PD
@@ -503,6 +581,7 @@ namespace {
             case 3:  nextPD ();                 break;
             case 4:  nextBoundaryCondition ();  break;
             case 5:  printLQbinStats ();        break;
+            case 6:  levelOfDetail = !levelOfDetail; break;
             }
         }
 
@@ -535,6 +614,7 @@ namespace {
             OpenSteerDemo::printMessage ("  F2     remove a boid from the flock.");
             OpenSteerDemo::printMessage ("  F3     use next proximity database.");
             OpenSteerDemo::printMessage ("  F4     next flock boundary condition.");
+            OpenSteerDemo::printMessage ("  F6     toggle level of detail updates.");
             OpenSteerDemo::printMessage ("");
         }
 
@@ -543,6 +623,7 @@ namespace {
             population++;
             Boid* boid = new Boid (*pd);
             flock.push_back (boid);
+            lodScheduler.add (boid);
             if (population == 1) OpenSteerDemo::selectedVehicle = boid;
         }
 
@@ -551,8 +632,9 @@ namespace {
             if (population > 0)
             {
                 // save a pointer to the last boid, then remove it from the flock
-                const Boid* boid = flock.back();
+                Boid* boid = flock.back();
                 flock.pop_back();
+                lodScheduler.remove (boid);
                 population--;
 
                 // if it is OpenSteerDemo's selected vehicle, unselect it
@@ -580,6 +662,10 @@ namespace {
         // which of the various proximity databases is currently in use
         int cyclePD;
 
+        // when on, boids are updated through lodScheduler
+        bool levelOfDetail;
+        BoidLevelOfDetailScheduler lodScheduler;
+
         // --------------------------------------------------------
         // the rest of this plug-in supports the various obstacles:
         // --------------------------------------------------------
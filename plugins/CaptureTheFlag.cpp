@@ -79,8 +79,9 @@ namespace {
     class CtfBase : public SimpleVehicle
     {
     public:
-        // constructor
-        CtfBase () {reset ();}
+        // constructor (the seeker and the enemies read each other's
+        // predicted positions many times per tick, so cache them)
+        CtfBase () {setPredictionCaching (true); reset ();}
 
         // reset state
         void reset (void);
@@ -110,6 +111,10 @@ namespace {
         static int obstacleCount;
         static const int maxObstacleCount;
         static SOG allObstacles;
+
+        // the same spheres packed for batched path intersection tests
+        static SphereObstacleSet obstacleSet;
+        static ObstacleGroup obstacleSetGroup;
     };
 
 
@@ -299,7 +304,7 @@ namespace {
         {
             const Vec3 avoidance =
                 steerToAvoidObstacles (gAvoidancePredictTimeMin,
-                                       (ObstacleGroup&) allObstacles);
+                                       obstacleSetGroup);
 
             // saved for annotation
             avoiding = (avoidance == Vec3::zero);
@@ -366,7 +371,7 @@ namespace {
             const CtfEnemy& e = *ctfEnemies[i];
             const float eDistance = Vec3::distance (position(), e.position());
             const float timeEstimate = 0.3f * eDistance / e.speed(); //xxx
-            const Vec3 eFuture = e.predictFuturePosition (timeEstimate);
+            const Vec3 eFuture = e.cachedFuturePosition (timeEstimate);
             const Vec3 eOffset = eFuture - position();
             const float alongCorridor = goalDirection.dot (eOffset);
             const bool inCorridor = ((alongCorridor > -behindThreshold) && 
@@ -487,7 +492,7 @@ namespace {
                     // const float timeEstimate = 0.5f * eDistance / e.speed;//xxx
                     const float timeEstimate = 0.15f * eDistance / e.speed();//xxx
                     const Vec3 future =
-                        e.predictFuturePosition (timeEstimate);
+                        e.cachedFuturePosition (timeEstimate);
 
                     annotationXZCircle (e.radius(), future, evadeColor, 20); // xxx
 
@@ -515,7 +520,7 @@ namespace {
 
             // xxx maybe this should take into account e's heading? xxx
             const float timeEstimate = 0.5f * eDistance / e.speed(); //xxx
-            const Vec3 eFuture = e.predictFuturePosition (timeEstimate);
+            const Vec3 eFuture = e.cachedFuturePosition (timeEstimate);
 
             // annotation
             annotationXZCircle (e.radius(), eFuture, evadeColor, 20);
@@ -548,7 +553,7 @@ namespace {
         adjustObstacleAvoidanceLookAhead (clearPath);
         const Vec3 obstacleAvoidance =
             steerToAvoidObstacles (gAvoidancePredictTime,
-                                   (ObstacleGroup&) allObstacles);
+                                   obstacleSetGroup);
 
         // saved for annotation
         avoiding = (obstacleAvoidance != Vec3::zero);
@@ -740,6 +745,8 @@ namespace {
 
     int CtfBase::obstacleCount = -1; // this value means "uninitialized"
     SOG CtfBase::allObstacles;
+    SphereObstacleSet CtfBase::obstacleSet;
+    ObstacleGroup CtfBase::obstacleSetGroup;
 
 
     #define testOneObstacleOverlap(radius, center)               \
@@ -756,6 +763,7 @@ namespace {
         if (obstacleCount == -1)
         {
             obstacleCount = 0;
+            obstacleSetGroup.push_back (&obstacleSet);
             for (int i = 0; i < (maxObstacleCount * 0.4); i++) addOneObstacle ();
         }
     }
@@ -789,6 +797,7 @@ namespace {
 
             // add new non-overlapping obstacle to registry
             allObstacles.push_back (new SphereObstacle (r, c));
+            obstacleSet.addSphere (r, c);
             obstacleCount++;
         }
     }
@@ -813,6 +822,7 @@ namespace {
         {
             obstacleCount--;
             allObstacles.pop_back();
+            obstacleSet.removeSphere (obstacleSet.size () - 1);
         }
     }
 
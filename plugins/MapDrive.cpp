@@ -52,15 +52,27 @@
 
 #include <iomanip>
 #include <sstream>
+#include <fstream>
+#include <deque>
+#include <map>
 #include <cassert>
+#include <cstdlib>
+#include <cstring>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 #include "OpenSteer/OpenSteerDemo.h"
 #include "OpenSteer/SimpleVehicle.h"
+#include "OpenSteer/Proximity.h"
 #include "OpenSteer/Color.h"
 #include "OpenSteer/UnusedParameter.h"
 
 // Include OpenSteer::PolylineSegmentedPathwaySegmentRadii
 #include "OpenSteer/PolylineSegmentedPathwaySegmentRadii.h"
 
+// Include OpenSteer::GridPathPlanner
+#include "OpenSteer/GridPathPlanner.h"
+
 // Include OpenSteer::mapPointToPathway
 #include "OpenSteer/QueryPathAlike.h"
 
@@ -111,26 +123,6 @@ namespace {
     
     
     
-    class PointToTangentMapping : public OpenSteer::DontExtractPathDistance {
-    public:
-        PointToTangentMapping() : tangent( OpenSteer::Vec3( 0.0f, 0.0f, 0.0f ) ) {}
-        
-        void setPointOnPathCenterLine( OpenSteer::Vec3 const& ) {}
-        void setPointOnPathBoundary( OpenSteer::Vec3 const&  ) {}
-        void setRadius( float ) {}
-        void setTangent( OpenSteer::Vec3 const& t ) { tangent = t; }
-        void setSegmentIndex( OpenSteer::size_t ) {}
-        void setDistancePointToPath( float  ) {}
-        void setDistancePointToPathCenterLine( float ) {}
-        void setDistanceOnPath( float  ) {}
-        void setDistanceOnSegment( float ) {}
-        
-        OpenSteer::Vec3 tangent;
-    };
-
-
-        
-    
     class PointToPointOnCenterLineAndOutsideMapping : public OpenSteer::DontExtractPathDistance {
     public:
         PointToPointOnCenterLineAndOutsideMapping() : pointOnPathCenterLine( OpenSteer::Vec3( 0.0f, 0.0f, 0.0f ) ), distancePointToPathBoundary( 0.0f ) {}
@@ -197,16 +189,6 @@ namespace {
         return mapping.radius;
     }
     
-    /**
-     * Maps @a point to @a pathway and extracts the tangent at the mapping 
-     * point.
-     */
-    OpenSteer::Vec3 mapPointToTangent( OpenSteer::PolylineSegmentedPathwaySegmentRadii const& pathway, OpenSteer::Vec3 const& point ) {
-        PointToTangentMapping mapping;
-        OpenSteer::mapPointToPathAlike( pathway, point, mapping );
-        return mapping.tangent;
-    }
-    
     /**
      * Returns @c true if @a point is inside @a pathway segment @a segmentIndex.
      *
@@ -358,13 +340,6 @@ namespace {
     }
     
 
-    OpenSteer::PolylineSegmentedPathwaySegmentRadii::size_type mapPointToSegmentIndex(  OpenSteer::PolylineSegmentedPathwaySegmentRadii const& pathway, 
-                                                                                        OpenSteer::Vec3 const& point ) {
-        PointToSegmentIndexMapping mapping;
-        OpenSteer::mapPointToPathAlike( pathway, point, mapping );
-        return mapping.segmentIndex;
-    }
-    
     
 
 
@@ -446,6 +421,27 @@ namespace {
         }
 
 
+        // fractional cell coordinates (i, 0, j) of a position in 3d world
+        // space: getMapValue looks at cell ((int) i, (int) j)
+        Vec3 cellCoordinates (const Vec3& point) const
+        {
+            const float r = (float) resolution;
+            const float hxs = xSize/2;
+            const float hzs = zSize/2;
+            return Vec3 (remapInterval (point.x - center.x, -hxs, hxs, 0.0f, r),
+                         0,
+                         remapInterval (point.z - center.z, -hzs, hzs, 0.0f, r));
+        }
+
+        // get a value based on fractional cell coordinates
+        bool getCellValue (const float i, const float j) const
+        {
+            const float r = (float) resolution;
+            if ((i < 0) || (j < 0) || (i >= r) || (j >= r)) return outsideValue;
+            return getMapBit ((int) i, (int) j);
+        }
+
+
         void xxxDrawMap (void)
         {
             const float xs = xSize/(float)resolution;
@@ -742,13 +738,87 @@ namespace {
     // ----------------------------------------------------------------------------
 
 
+    // ----------------------------------------------------------------------------
+    // The sample points of a set of curved obstacle scans (arcs around a
+    // vehicle's center of curvature, see MapDriver::addArcScan) in the
+    // vehicle's local space: x sideways, z forward.  A MapDriver keeps them
+    // for each quantized curvature and scan reach it has seen, so a scan is
+    // a transform into map cells and a table of map lookups.
+
+
+    class ArcScanTemplate
+    {
+    public:
+
+        // number of scans in the set
+        int scanCount (void) const {return (int) first.size () - 1;}
+
+        // sample k of a scan (starts at 0, its start point) and the
+        // distance reported when the first obstacle is found there
+        std::vector<float> x, z, distance;
+
+        // scan i has samples first[i] to first[i+1]-1
+        std::vector<int> first;
+
+        ArcScanTemplate (void) : first (1, 0) {}
+    };
+
+
+    // quantized curvature and reach of a MapDriver's scan set
+
+
+    struct ArcScanKey
+    {
+        int kind;       // obstacle avoidance or imminent collision
+        int curvature;
+        int reach;
+        int width;
+
+        bool operator< (const ArcScanKey& k) const
+        {
+            if (kind != k.kind) return kind < k.kind;
+            if (curvature != k.curvature) return curvature < k.curvature;
+            if (reach != k.reach) return reach < k.reach;
+            return width < k.width;
+        }
+    };
+
+
+    typedef AbstractProximityDatabase<AbstractVehicle*> ProximityDatabase;
+    typedef AbstractTokenForProximityDatabase<AbstractVehicle*> ProximityToken;
+
+
     class MapDriver : public SimpleVehicle
     {
     public:
 
         // constructor
-        MapDriver () : map (makeMap ()), path (makePath ())
+        MapDriver () : map (makeMap ()), path (makePath ()), sharesMap (false)
+        {
+            initialize ();
+        }
+
+        // constructor for an additional driver on another driver's map and
+        // route (which must outlive this one)
+        MapDriver (TerrainMap& sharedMap, GCRoute& sharedPath)
+            : map (&sharedMap), path (&sharedPath), sharesMap (true)
+        {
+            initialize ();
+        }
+
+        void initialize (void)
         {
+            // alone until given a proximity database (see newPD)
+            proximityToken = NULL;
+            trafficSpeedLimit = 0;
+            heldByTraffic = false;
+            vehicleContact = false;
+            vehicleContactCount = 0;
+
+            // default top speed, messages and camera moves
+            topSpeed = 20;
+            headless = false;
+
             reset ();
 
             // to compute mean time between collisions
@@ -775,6 +845,7 @@ namespace {
             lapsFinished = 0;
             hintGivenCount = 0;
             hintTakenCount = 0;
+            savedNearestWR = savedNearestR = savedNearestL = savedNearestWL = 0;
 
             // follow the path "upstream or downstream" (+1/-1)
             pathFollowDirection = 1;
@@ -790,8 +861,12 @@ namespace {
         // destructor
         ~MapDriver ()
         {
-            delete (map);
-            delete (path);
+            delete proximityToken;
+            if (! sharesMap)
+            {
+                delete (map);
+                delete (path);
+            }
         }
 
         // reset state
@@ -803,9 +878,9 @@ namespace {
             // initially stopped
             setSpeed (0);
 
-            // Assume top speed is 20 meters per second (44.7 miles per hour).
-            // This value will eventually be supplied by a higher level module.
-            setMaxSpeed (20);
+            // Assume top speed is 20 meters per second (44.7 miles per hour)
+            // unless a higher level module (like the batch runs) supplied it.
+            setMaxSpeed (topSpeed);
 
             // steering force is clipped to this magnitude
             setMaxForce (maxSpeed () * 0.4f);
@@ -825,6 +900,7 @@ namespace {
 
             // first pass at detecting "stuck" state
             stuck = false;
+            brakingRate = 0;
 
             // QQQ need to clean up this hack
             qqqLastNearestObstacle = Vec3::zero;
@@ -835,9 +911,8 @@ namespace {
             if (demoSelect == 2)
             {
                 lapsStarted++;
-                const float s = worldSize;
                 const float d = (float) pathFollowDirection;
-                setPosition (Vec3 (s * d * 0.6f, 0, s * -0.4f));
+                setPosition (startPosition ());
                 regenerateOrthonormalBasisUF (Vec3::side * d);
             }
 
@@ -861,12 +936,25 @@ namespace {
 
         // per frame simulation update
         void update (const float currentTime, const float elapsedTime)
+        {
+            findTraffic ();
+            applySteering (determineSteering (elapsedTime),
+                           currentTime, elapsedTime);
+        }
+
+
+        // first half of update: decide on steering, using the neighbors
+        // gathered by findTraffic.  Changes no state other drivers look at
+        // (position, velocity, radius: braking is only noted, applySteering
+        // does it) and makes no proximity database query so all drivers on
+        // a map can do this at the same time, see MapDriveWorld::updateDrivers
+        Vec3 determineSteering (const float elapsedTime)
         {
             // take note when current dt is zero (as in paused) for stat counters
             dtZero = (elapsedTime == 0);
 
-            // pretend we are bigger when going fast
-            adjustVehicleRadiusForSpeed ();
+            // look for other drivers sharing the map
+            scanTraffic ();
 
             // state saved for speedometer
     //      annoteMaxRelSpeed = annoteMaxRelSpeedCurve = annoteMaxRelSpeedPath = 0;
@@ -881,7 +969,7 @@ namespace {
                 // stuck, because off path or collision seemed imminent)
                 // (QQQ combine with stuckCycleCount code at end of this function?)
     //          applyBrakingForce (curvedSteering ? 3 : 2, elapsedTime); // QQQ
-                applyBrakingForce ((curvedSteering?3.0f:2.0f), elapsedTime); // QQQ
+                brakingRate = (curvedSteering?3.0f:2.0f); // QQQ
                 // count "off path" events
                 if (offPath && !stuck && (demoSelect == 2)) stuckOffPathCount++;
                 stuck = true;
@@ -912,8 +1000,13 @@ namespace {
                 }
                 else
                 {
-                    // otherwise speed up and...
-                    steering = steerForTargetSpeed (maxSpeedForCurvature ());
+                    // otherwise speed up (no faster than traffic ahead
+                    // allows) and...
+                    const float curveSpeed = maxSpeedForCurvature ();
+                    heldByTraffic = trafficSpeedLimit < curveSpeed;
+                    steering = steerForTargetSpeed (heldByTraffic ?
+                                                    trafficSpeedLimit :
+                                                    curveSpeed);
 
                     // wander for demo 1
                     if (demoSelect == 1)
@@ -970,16 +1063,28 @@ namespace {
                 // enforce minimum turning radius
                 steering = adjustSteeringForMinimumTurningRadius (steering);
             }
+            return steering;
+        }
 
-            // apply selected steering force to vehicle, record data
+
+        // second half of update: move, record data
+        void applySteering (const Vec3& steering,
+                            const float currentTime,
+                            const float elapsedTime)
+        {
+            // brake if determineSteering decided to stop, then apply selected
+            // steering force to vehicle, record data
+            if (brakingRate > 0) applyBrakingForce (brakingRate, elapsedTime);
+            brakingRate = 0;
             applySteeringForce (steering, elapsedTime);
             collectReliabilityStatistics (currentTime, elapsedTime);
 
             // detect getting stuck in cycles -- we are moving but not
             // making progress down the route (annotate smoothedPosition)
+            // (waiting in a queue behind other drivers doesn't count)
             if (demoSelect == 2)
             {
-                const bool circles = weAreGoingInCircles ();
+                const bool circles = weAreGoingInCircles () && !heldByTraffic;
                 if (circles && !stuck) stuckCycleCount++;
                 if (circles) stuck = true;
                 annotationCircleOrDisk (0.5, up(), smoothedPosition (),
@@ -989,6 +1094,96 @@ namespace {
             // annotation
             perFrameAnnotation ();
             recordTrailVertex (currentTime, position());
+
+            // pretend we are bigger when going fast (for the next update)
+            adjustVehicleRadiusForSpeed ();
+        }
+
+
+        // time gap (seconds) and distance kept to the driver ahead
+        static float trafficHeadway (void) {return 1;}
+        static float trafficMinimumGap (void) {return 2;}
+
+
+        // find the other drivers within following distance.  This queries
+        // the proximity database (which may record query statistics) so
+        // MapDriveWorld::updateDrivers calls it for each driver in turn
+        void findTraffic (void)
+        {
+            neighbors.clear ();
+            if (proximityToken == NULL) return;
+            const float reach = (halfLength * 2) + trafficMinimumGap () +
+                                (maxSpeed () * trafficHeadway () * 2);
+            proximityToken->findNeighbors (position (), reach, neighbors);
+        }
+
+
+        // note contact with one of the neighbors found by findTraffic and
+        // limit speed to keep a time gap to the nearest one ahead in our
+        // lane (all drivers have the same dimensions)
+        void scanTraffic (void)
+        {
+            trafficSpeedLimit = maxSpeed ();
+            heldByTraffic = false;
+            if (proximityToken == NULL) return;
+
+            const float headway = trafficHeadway ();
+            const float minimumGap = trafficMinimumGap ();
+            const float laneWidth = (halfWidth * 2) + 1;
+            const float length = halfLength * 2;
+
+            const bool contactLastTime = vehicleContact;
+            vehicleContact = false;
+            for (AVIterator i = neighbors.begin(); i != neighbors.end(); i++)
+            {
+                const AbstractVehicle& other = **i;
+                if (&other == this) continue;
+
+                // touching (overlap of the vehicles' inscribed circles)?
+                const Vec3 offset = other.position () - position ();
+                if (offset.length () < halfWidth * 2) vehicleContact = true;
+
+                // other driver ahead in our lane?
+                const float ahead = offset.dot (forward ());
+                const Vec3 lateral = offset - (forward () * ahead);
+                if ((ahead > 0) && (lateral.length () < laneWidth))
+                {
+                    const float gap = ahead - length - minimumGap;
+                    const float otherSpeed = maxXXX (0.0f, other.velocity ().dot (forward ()));
+                    const float limit = maxXXX (0.0f, otherSpeed + (gap / headway));
+                    trafficSpeedLimit = minXXX (trafficSpeedLimit, limit);
+                }
+            }
+            if (vehicleContact && !contactLastTime) vehicleContactCount++;
+        }
+
+
+        // where reset puts the vehicle
+        Vec3 startPosition (void) const
+        {
+            if (demoSelect != 2) return Vec3::zero;
+            const float s = worldSize;
+            const float d = (float) pathFollowDirection;
+            return Vec3 (s * d * 0.6f, 0, s * -0.4f);
+        }
+
+
+        // switch to a new proximity database
+        void newPD (ProximityDatabase& pd)
+        {
+            delete proximityToken;
+            proximityToken = pd.allocateToken (this);
+            proximityToken->updateForNewPosition (position ());
+        }
+
+        // leave the proximity database (drive alone again)
+        void leavePD (void)
+        {
+            delete proximityToken;
+            proximityToken = NULL;
+            trafficSpeedLimit = maxSpeed ();
+            heldByTraffic = false;
+            vehicleContact = false;
         }
 
 
@@ -1031,9 +1226,12 @@ namespace {
                 !collisionLastTime &&
                 (timeSinceLastCollision > 1))
             {
-                std::ostringstream message;
-                message << "collision after "<<timeSinceLastCollision<<" seconds";
-                OpenSteerDemo::printMessage (message);
+                if (!headless)
+                {
+                    std::ostringstream message;
+                    message << "collision after "<<timeSinceLastCollision<<" seconds";
+                    OpenSteerDemo::printMessage (message);
+                }
                 sumOfCollisionFreeTimes += timeSinceLastCollision;
                 countOfCollisionFreeTimes++;
                 timeOfLastCollision = currentTime;
@@ -1174,11 +1372,7 @@ namespace {
             const float arcRadius = signedRadius * -sign;
             const float twoPi = 2 * OPENSTEER_M_PI;
             const float circumference = twoPi * arcRadius;
-            const float rawLength = speed() * minTimeToCollision * sign;
             const float fracLimit = 1.0f / 6.0f;
-            const float distLimit = circumference * fracLimit;
-            const float arcLength = arcLengthLimit (rawLength, distLimit);
-            const float arcAngle = twoPi * arcLength / circumference;
 
             // XXX temp annotation to show limit on arc angle
             if (curvedSteering)
@@ -1196,6 +1390,18 @@ namespace {
             // assert loops will terminate
         assert (spacing > 0);
 
+            // curved scans: corridor then wings (scans left and right of
+            // each offset s), precomputed for this curvature and reach
+            int corridorScans = 0;
+            for (float t = s; t < maxSide; t += spacing) corridorScans++;
+            const ArcScanTemplate* scans = (curvedSteering ?
+                                            &arcScanTemplate (avoidanceScans,
+                                                              maxForward,
+                                                              wingSlope (),
+                                                              corridorScans) :
+                                            NULL);
+            int scan = 0;
+
             // scan corridor straight ahead of vehicle,
             // keep track of nearest obstacle on left and right sides
             while (s < maxSide)
@@ -1208,25 +1414,13 @@ namespace {
                 Vec3 lObsPos, rObsPos;
 
                 const int L = (curvedSteering ? 
-                               (int) (scanObstacleMap (lOffset,
-                                                       center,
-                                                       arcAngle,
-                                                       maxSamples,
-                                                       0,
-                                                       gYellow,
-                                                       gRed,
-                                                       lObsPos)
+                               (int) (scanArc (*scans, scan++, 0,
+                                               gYellow, gRed, lObsPos)
                                       / spacing) :
                                map.scanXZray (lOffset, step, maxSamples));
                 const int R = (curvedSteering ? 
-                               (int) (scanObstacleMap (rOffset,
-                                                        center,
-                                                       arcAngle,
-                                                       maxSamples,
-                                                       0,
-                                                       gYellow,
-                                                       gRed,
-                                                       rObsPos)
+                               (int) (scanArc (*scans, scan++, 0,
+                                               gYellow, gRed, rObsPos)
                                       / spacing) :
                                map.scanXZray (rOffset, step, maxSamples));
 
@@ -1287,32 +1481,25 @@ namespace {
                         const float rayLength = ray.length();
                         const Vec3 step = ray * spacing / rayLength;
                         const int raySamples = (int) (rayLength / spacing);
-                        const float endRadius =
-                            wingSlope () * maxForward * fraction *
-                            (signedRadius < 0 ? 1 : -1) * (j==1?1:-1);
                         Vec3 ignore;
-                        const int scan = (curvedSteering ?
-                                          (int) (scanObstacleMap (start,
-                                                                  center,
-                                                                  arcAngle,
-                                                                  raySamples,
-                                                                  endRadius,
-                                                                  beforeColor,
-                                                                  afterColor,
-                                                                  ignore)
+                        const int wing = (curvedSteering ?
+                                          (int) (scanArc (*scans, scan++, 0,
+                                                          beforeColor,
+                                                          afterColor,
+                                                          ignore)
                                                  / spacing) :
                                           map.scanXZray (start, step, raySamples));
 
                         if (!curvedSteering)
-                            annotateAvoidObstaclesOnMap (start,scan,step);
+                            annotateAvoidObstaclesOnMap (start,wing,step);
 
                         if (j==1) 
                         {
-                            if ((scan > 0) && (scan < nearestWL)) nearestWL = scan;
+                            if ((wing > 0) && (wing < nearestWL)) nearestWL = wing;
                         }
                         else
                         {
-                            if ((scan > 0) && (scan < nearestWR)) nearestWR = scan;
+                            if ((wing > 0) && (wing < nearestWR)) nearestWR = wing;
                         }
                     }
                 }
@@ -1493,43 +1680,36 @@ namespace {
         }
 
 
-        // scan across the obstacle map along a given arc
-        // (possibly with radius adjustment ramp)
-        // returns approximate distance to first obstacle found
+        // append to a scan set the sample points of a scan across the
+        // obstacle map along a given arc (possibly with radius adjustment
+        // ramp), relative to the vehicle's position.  The distance stored
+        // with a sample is the approximate distance to an obstacle found
+        // there.  The arc is a rotation about the global Y axis, so the
+        // samples in local space don't depend on the heading.
         //
         // QQQ 1: this calling sequence does not allow for zero curvature case
-        // QQQ 2: in library version of this, "map" should be a parameter
-        // QQQ 3: instead of passing in colors, call virtual annotation function?
-        // QQQ 4: need flag saying to continue after a hit, for annotation
-        // QQQ 5: I needed to return both distance-to and position-of the first
-        //        obstacle. I added returnObstaclePosition but maybe this should
-        //        return a "scan results object" with a flag for obstacle found,
-        //        plus distant and position if so.
         //
-        float scanObstacleMap (const Vec3& start,
-                               const Vec3& center,
-                               const float arcAngle,
-                               const int segments,
-                               const float endRadiusChange,
-                               const Color& beforeColor,
-                               const Color& afterColor,
-                               Vec3& returnObstaclePosition)
+        void addArcScan (ArcScanTemplate& scans,
+                         const Vec3& start,
+                         const Vec3& center,
+                         const float arcAngle,
+                         const int segments,
+                         const float endRadiusChange) const
         {
             // "spoke" is initially the vector from center to start,
             // which is then rotated step by step around center
             Vec3 spoke = start - center;
             // determine the angular step per segment
             const float step = arcAngle / segments;
-            // store distance to, and position of first obstacle
-            float obstacleDistance = 0;
-            returnObstaclePosition = Vec3::zero;
             // for spiral "ramps" of changing radius
             const float startRadius = (endRadiusChange == 0) ? 0 : spoke.length(); 
 
-            // traverse each segment along arc
+            // the start point, then the end of each segment
+            scans.x.push_back (start.dot (side ()));
+            scans.z.push_back (start.dot (forward ()));
+            scans.distance.push_back (0);
             float sin=0, cos=0;
             Vec3 oldPoint = start;
-            bool obstacleFound = false;
             for (int i = 0; i < segments; i++)
             {
                 // rotate "spoke" to next step around circle
@@ -1550,33 +1730,219 @@ namespace {
                 // spoke (possibly adjusting the radius if endRadiusChange!=0)
                 const Vec3 newPoint = center + (spoke * adjust);
 
-                // once an obstacle if found "our work here is done" -- continue
-                // to loop only for the sake of annotation (make that optional?)
-                if (obstacleFound)
+                // distance reported for an obstacle at the end of this
+                // segment (a chord of the arc)
+                const Vec3 offset = newPoint - oldPoint;
+                const float d2 = offset.length() * 2;
+                scans.x.push_back (newPoint.dot (side ()));
+                scans.z.push_back (newPoint.dot (forward ()));
+                scans.distance.push_back (d2 * 0.5f * (i+1));
+
+                // save new point for next time around loop
+                oldPoint = newPoint;
+            }
+            scans.first.push_back ((int) scans.x.size ());
+        }
+
+
+        // scan across the obstacle map along one scan of a set placed at the
+        // vehicle, returns approximate distance to first obstacle found (or
+        // zero if none found) and its position.  Annotation (lifted above the
+        // ground) shows the segments before and after the obstacle.
+        //
+        // QQQ 3: instead of passing in colors, call virtual annotation function?
+        //
+        float scanArc (const ArcScanTemplate& scans,
+                       const int scan,
+                       const float lift,
+                       const Color& beforeColor,
+                       const Color& afterColor,
+                       Vec3& returnObstaclePosition) const
+        {
+            // transform from local space to fractional map cells
+            const Vec3 origin = map->cellCoordinates (position ());
+            const float cx = map->resolution / map->xSize;
+            const float cz = map->resolution / map->zSize;
+            const float sx = side ().x * cx;
+            const float sz = side ().z * cz;
+            const float fx = forward ().x * cx;
+            const float fz = forward ().z * cz;
+
+            // look up the samples until the first obstacle
+            const int begin = scans.first[scan];
+            const int end = scans.first[scan + 1];
+            int hit = end;
+            for (int i = begin + 1; i < end; i++)
+            {
+                const float x = scans.x[i];
+                const float z = scans.z[i];
+                if (map->getCellValue (origin.x + (sx * x) + (fx * z),
+                                       origin.z + (sz * x) + (fz * z)))
                 {
-                    annotationLine (oldPoint, newPoint, afterColor);
+                    hit = i;
+                    break;
                 }
-                else
+            }
+
+            if (annotationIsOn ())
+            {
+                const Vec3 base = position () + (up () * lift);
+                Vec3 oldPoint = (base +
+                                 (side () * scans.x[begin]) +
+                                 (forward () * scans.z[begin]));
+                for (int i = begin + 1; i < end; i++)
                 {
-                    // no obstacle found on this scan so far,
-                    // scan map along current segment (a chord of the arc)
-                    const Vec3 offset = newPoint - oldPoint;
-                    const float d2 = offset.length() * 2;
+                    const Vec3 newPoint = (base +
+                                           (side () * scans.x[i]) +
+                                           (forward () * scans.z[i]));
+                    annotationLine (oldPoint, newPoint,
+                                    (i <= hit) ? beforeColor : afterColor);
+                    oldPoint = newPoint;
+                }
+            }
 
-                    // when obstacle found: set flag, save distance and position
-                    if (! map->isPassable (newPoint))
-                    {
-                        obstacleFound = true;
-                        obstacleDistance = d2 * 0.5f * (i+1);
-                        returnObstaclePosition = newPoint;
-                    }
-                    annotationLine (oldPoint, newPoint, beforeColor);
+            if (hit == end)
+            {
+                returnObstaclePosition = Vec3::zero;
+                return 0;
+            }
+            returnObstaclePosition = (position () +
+                                      (side () * scans.x[hit]) +
+                                      (forward () * scans.z[hit]));
+            return scans.distance[hit];
+        }
+
+
+        // kinds of scan sets
+        enum {avoidanceScans, collisionScans};
+
+        // the set of curved scans of the given kind (for
+        // steerToAvoidObstaclesOnMap or detectImminentCollision) for the
+        // current curvature, reach (maxForward in those) and wing slope and
+        // number of corridor scans (for avoidance), made on first use.
+        // Curvature, reach and wing slope are quantized (to 1/512 per meter,
+        // a meter and 1/32) so most frames reuse a template: finer steps
+        // miss so often that making templates costs more than it saves.
+        const ArcScanTemplate& arcScanTemplate (const int kind,
+                                                const float reach,
+                                                const float wingSlope,
+                                                const int corridorScans)
+        {
+            ArcScanKey key;
+            key.kind = kind;
+            key.curvature = (int) OpenSteer::round (nonZeroCurvatureQQQ () * 512);
+            key.reach = (int) OpenSteer::round (reach);
+            key.width = (int) OpenSteer::round (wingSlope * 32) * 256 + corridorScans;
+            std::map<ArcScanKey, ArcScanTemplate>::iterator found = arcScans.find (key);
+            if (found != arcScans.end ()) return found->second;
+
+            // curvature and speed keep changing, start over now and then
+            // (templates take some memory, and there may be many drivers)
+            if (arcScans.size () >= 32) arcScans.clear ();
+
+            const float minCurvature = 1.0f / 100000.0f; // see nonZeroCurvatureQQQ
+            const float curvature = ((key.curvature == 0) ?
+                                     minCurvature :
+                                     key.curvature / 512.0f);
+            ArcScanTemplate& scans = arcScans[key];
+            if (kind == avoidanceScans)
+                makeAvoidanceScans (scans, curvature, (float) key.reach,
+                                    OpenSteer::round (wingSlope * 32) / 32,
+                                    corridorScans);
+            else
+                makeCollisionScans (scans, curvature, (float) key.reach);
+            return scans;
+        }
+
+
+        // curved scans of steerToAvoidObstaclesOnMap: the corridor ahead
+        // (left and right of each side offset) then the "wings"
+        void makeAvoidanceScans (ArcScanTemplate& scans,
+                                 const float curvature,
+                                 const float maxForward,
+                                 const float wingSlope,
+                                 const int corridorScans) const
+        {
+            const float spacing = map->minSpacing() / 2;
+            const float signedRadius = 1 / curvature;
+            const Vec3 center = side () * signedRadius;
+            const float sign = signedRadius < 0 ? 1.0f : -1.0f;
+            const float arcRadius = signedRadius * -sign;
+            const float twoPi = 2 * OPENSTEER_M_PI;
+            const float circumference = twoPi * arcRadius;
+            const float rawLength = maxForward * sign;
+            const float fracLimit = 1.0f / 6.0f;
+            const float distLimit = circumference * fracLimit;
+            const float arcLength = arcLengthLimit (rawLength, distLimit);
+            const float arcAngle = twoPi * arcLength / circumference;
+            const int maxSamples = (int) (maxForward / spacing);
+
+            Vec3 sOffset;
+            float s = spacing / 2;
+            for (int i = 0; i < corridorScans; i++)
+            {
+                sOffset = side() * s;
+                s += spacing;
+                addArcScan (scans, sOffset, center, arcAngle, maxSamples, 0);
+                addArcScan (scans, -sOffset, center, arcAngle, maxSamples, 0);
+            }
+
+            // see duplicated code at: QQQ draw sensing "wings"
+            const int wingScans = 4;
+            const Vec3 wingWidth = side() * wingSlope * maxForward;
+            for (int i=1; i<=wingScans; i++)
+            {
+                const float fraction = (float)i / (float)wingScans;
+                const Vec3 endside = sOffset + (wingWidth * fraction);
+                const Vec3 corridorFront = forward() * maxForward;
+
+                // "loop" from -1 to 1
+                for (int j = -1; j < 2; j+=2)
+                {
+                    float k = (float)j; // prevent VC7.1 warning
+                    const Vec3 start = sOffset * k;
+                    const Vec3 end = corridorFront + (endside * k);
+                    const float rayLength = (end - start).length();
+                    const int raySamples = (int) (rayLength / spacing);
+                    const float endRadius =
+                        wingSlope * maxForward * fraction *
+                        (signedRadius < 0 ? 1 : -1) * (j==1?1:-1);
+                    addArcScan (scans, start, center, arcAngle, raySamples,
+                                endRadius);
                 }
-                // save new point for next time around loop
-                oldPoint = newPoint;
             }
-            // return distance to first obstacle (or zero if none found)
-            return obstacleDistance;
+        }
+
+
+        // curved scans of detectImminentCollision: the region ahead (left
+        // and right of each side offset)
+        void makeCollisionScans (ArcScanTemplate& scans,
+                                 const float curvature,
+                                 const float maxForward) const
+        {
+            const float spacing = map->minSpacing() / 2;
+            const float maxSide = halfWidth + spacing;
+            const float signedRadius = 1 / curvature;
+            const Vec3 center = side () * signedRadius;
+            const float sign = signedRadius < 0 ? 1.0f : -1.0f;
+            const float arcRadius = signedRadius * -sign;
+            const float twoPi = 2 * OPENSTEER_M_PI;
+            const float circumference = twoPi * arcRadius;
+
+            for (float s = spacing / 4; s < maxSide; s += spacing)
+            {
+                const Vec3 sOffset = side() * s;
+                const float bevel = 0.3f;
+                const float fraction = s / maxSide;
+                const float scanDist = (halfLength +
+                                        interpolate (fraction,
+                                                     maxForward,
+                                                     maxForward * bevel));
+                const float angle = (scanDist * twoPi * sign) / circumference;
+                const int samples = (int) (scanDist / spacing);
+                addArcScan (scans, sOffset, center, angle, samples, 0);
+                addArcScan (scans, -sOffset, center, angle, samples, 0);
+            }
         }
 
 
@@ -1595,14 +1961,13 @@ namespace {
             const Vec3 step = forward () * spacing;
             float s = curvedSteering ? (spacing / 4) : (spacing / 2);
 
-            const float signedRadius = 1 / nonZeroCurvatureQQQ ();
-            const Vec3 localCenterOfCurvature = side () * signedRadius;
-            const Vec3 center = position () + localCenterOfCurvature;
-            const float sign = signedRadius < 0 ? 1.0f : -1.0f;
-            const float arcRadius = signedRadius * -sign;
-            const float twoPi = 2 * OPENSTEER_M_PI;
-            const float circumference = twoPi * arcRadius;
-            const Vec3 qqqLift (0, 0.2f, 0);
+            // curved scans (left and right of each offset s) precomputed
+            // for this curvature and reach
+            const ArcScanTemplate* scans = (curvedSteering ?
+                                            &arcScanTemplate (collisionScans,
+                                                              maxForward, 0, 0) :
+                                            NULL);
+            int scan = 0;
             Vec3 ignore;
 
             // scan region ahead of vehicle
@@ -1617,28 +1982,15 @@ namespace {
                                         interpolate (fraction,
                                                      maxForward,
                                                      maxForward * bevel));
-                const float angle = (scanDist * twoPi * sign) / circumference;
                 const int samples = (int) (scanDist / spacing);
                 const int L = (curvedSteering ?
-                               (int) (scanObstacleMap (lOffset + qqqLift,
-                                                       center,
-                                                       angle,
-                                                       samples,
-                                                       0,
-                                                       gMagenta,
-                                                       gCyan,
-                                                       ignore)
+                               (int) (scanArc (*scans, scan++, 0.2f,
+                                               gMagenta, gCyan, ignore)
                                       / spacing) :
                                map->scanXZray (lOffset, step, samples));
                 const int R = (curvedSteering ?
-                               (int) (scanObstacleMap (rOffset + qqqLift,
-                                                       center,
-                                                       angle,
-                                                       samples,
-                                                       0,
-                                                       gMagenta,
-                                                       gCyan,
-                                                       ignore)
+                               (int) (scanArc (*scans, scan++, 0.2f,
+                                               gMagenta, gCyan, ignore)
                                       / spacing) :
                                map->scanXZray (rOffset, step, samples));
 
@@ -1754,24 +2106,30 @@ namespace {
             // predict our future position
             const Vec3 futurePosition = predictFuturePosition (predictionTime);
 
-            // measure distance along path of our current and predicted positions
-            const float nowPathDistance =
-                path.mapPointToPathDistance (position ());
+            // map our current and predicted positions to the path in a single
+            // traversal of its segments: distance along the path, tangent,
+            // nearest point on the center line, how far outside the path tube
+            // and the nearest segment
+            const Vec3 points[2] = { position (), futurePosition };
+            PointToPathFollowingMapping mappings[2];
+            mapPointsToPathAlike( path, points, 2, mappings );
+            PointToPathFollowingMapping const& nowMapping = mappings[0];
+            PointToPathFollowingMapping const& futureMapping = mappings[1];
+
+            // measure distance along path of our current position
+            const float nowPathDistance = nowMapping.distanceOnPath;
 
             // are we facing in the correction direction?
-            const Vec3 pathHeading = mapPointToTangent( path, position() ) * static_cast< float >( direction );// path.tangentAt(position()) * (float)direction;
+            const Vec3 pathHeading = nowMapping.tangent * static_cast< float >( direction );// path.tangentAt(position()) * (float)direction;
             const bool correctDirection = pathHeading.dot (forward ()) > 0;
 
             // find the point on the path nearest the predicted future position
-            // XXX need to improve calling sequence, maybe change to return a
-            // XXX special path-defined object which includes two Vec3s and a 
-            // XXX bool (onPath,tangent (ignored), withinPath)
-            float futureOutside;
-            const Vec3 onPath = mapPointToPointOnCenterLineAndOutside( path, futurePosition, futureOutside ); // path.mapPointToPath (futurePosition,futureOutside);
+            const float futureOutside = futureMapping.distancePointToPath;
+            const Vec3 onPath = futureMapping.pointOnPathCenterLine; // path.mapPointToPath (futurePosition,futureOutside);
 
             // determine if we are currently inside the path tube
-            float nowOutside;
-            const Vec3 nowOnPath = mapPointToPointOnCenterLineAndOutside( path, position(), nowOutside );  // path.mapPointToPath (position (), nowOutside);
+            const float nowOutside = nowMapping.distancePointToPath;
+            const Vec3 nowOnPath = nowMapping.pointOnPathCenterLine;  // path.mapPointToPath (position (), nowOutside);
 
             // no steering is required if our present and future positions are
             // inside the path tube and we are facing in the correct direction
@@ -1787,17 +2145,22 @@ namespace {
                 // otherwise we need to steer towards a target point obtained
                 // by adding pathDistanceOffset to our current path position
                 // (reduce the offset if facing in the wrong direction)
+                // (the target is searched for starting at our current segment
+                // instead of walking the path from its start)
                 const float targetPathDistance = (nowPathDistance + 
                                                   (pathDistanceOffset *
                                                    (correctDirection ? 1 : 0.1f)));
-                Vec3 target = path.mapPathDistanceToPoint (targetPathDistance);
+                const float nowSegmentStart = nowPathDistance - nowMapping.distanceOnSegment;
+                PointToPathFollowingMapping targetMapping;
+                mapDistanceToPathAlikeNearSegment( path, targetPathDistance, nowMapping.segmentIndex, nowSegmentStart, targetMapping );
+                Vec3 target = targetMapping.pointOnPathCenterLine;
 
 
                 // if we are on one segment and target is on the next segment and
                 // the dot of the tangents of the two segments is negative --
                 // increase the target offset to compensate the fold back
-                const int ip =  static_cast< int >( mapPointToSegmentIndex( path, position() ) ); // path.indexOfNearestSegment (position ());
-                const int it =  static_cast< int >( mapPointToSegmentIndex( path, target ) ); // path.indexOfNearestSegment (target);
+                const int ip =  static_cast< int >( nowMapping.segmentIndex ); // path.indexOfNearestSegment (position ());
+                const int it =  static_cast< int >( targetMapping.segmentIndex ); // path.indexOfNearestSegment (target);
                 // Because polyline paths have a constant tangent along a segment
                 // just set the distance along the segment to @c 0.0f.
                 Vec3 const ipTangent = path.mapSegmentDistanceToTangent( ip, 0.0f );
@@ -1809,7 +2172,8 @@ namespace {
                 {
                     const float newTargetPathDistance =
                         nowPathDistance + (pathDistanceOffset * 2);
-                    target = path.mapPathDistanceToPoint (newTargetPathDistance);
+                    mapDistanceToPathAlikeNearSegment( path, newTargetPathDistance, nowMapping.segmentIndex, nowSegmentStart, targetMapping );
+                    target = targetMapping.pointOnPathCenterLine;
                 }
 
                 annotatePathFollowing (futurePosition,onPath,target,futureOutside);
@@ -2158,6 +2522,7 @@ namespace {
                     lapsFinished++;
 
                     const Vec3 camOffsetBefore =
+                        headless ? Vec3::zero :
                         OpenSteerDemo::camera.position() - position ();
 
                     // set position on other side of the map (set new X coordinate)
@@ -2171,11 +2536,14 @@ namespace {
                     resetStuckCycleDetection ();
 
                     // new camera position and aimpoint to compensate for teleport
-                    OpenSteerDemo::camera.target = position ();
-                    OpenSteerDemo::camera.setPosition (position () + camOffsetBefore);
+                    if (!headless)
+                    {
+                        OpenSteerDemo::camera.target = position ();
+                        OpenSteerDemo::camera.setPosition (position () + camOffsetBefore);
 
-                    // make camera jump immediately to new position
-                    OpenSteerDemo::camera.doNotSmoothNextMove ();
+                        // make camera jump immediately to new position
+                        OpenSteerDemo::camera.doNotSmoothNextMove ();
+                    }
 
                     // prevent long streaks due to teleportation 
                     clearTrailHistory ();
@@ -2502,6 +2870,10 @@ namespace {
 
         // QQQ first pass at detecting "stuck" state
         bool stuck;
+
+        // braking rate decided by determineSteering (0 for none), applied
+        // by applySteering when all drivers have decided
+        float brakingRate;
         int stuckCount;
         int stuckCycleCount;
         int stuckOffPathCount;
@@ -2526,9 +2898,33 @@ namespace {
         bool curvedSteering;
         bool incrementalSteering;
 
+        // curved scans made so far (see arcScanTemplate)
+        std::map<ArcScanKey, ArcScanTemplate> arcScans;
+
         // save obstacle avoidance stats for annotation
         // (nearest obstacle in each of the four zones)
-        static float savedNearestWR, savedNearestR, savedNearestL, savedNearestWL;
+        float savedNearestWR, savedNearestR, savedNearestL, savedNearestWL;
+
+        // top speed set on reset (meters per second)
+        float topSpeed;
+
+        // true when map and path belong to another driver
+        bool sharesMap;
+
+        // other drivers on the same map: our token in their proximity
+        // database (NULL when alone), neighbors found by the last scan,
+        // speed limit due to the nearest one ahead and whether it (rather
+        // than the path's curvature) held us back, and contacts with them
+        ProximityToken* proximityToken;
+        AVGroup neighbors;
+        float trafficSpeedLimit;
+        bool heldByTraffic;
+        bool vehicleContact;
+        int vehicleContactCount;
+
+        // when set (for batch runs) there are no messages and the vehicle
+        // doesn't move OpenSteerDemo's camera
+        bool headless;
 
         float annoteMaxRelSpeed, annoteMaxRelSpeedCurve, annoteMaxRelSpeedPath;
 
@@ -2551,59 +2947,850 @@ namespace {
     // int MapDriver::demoSelect = 0;
     int MapDriver::demoSelect = 2;
 
-    float MapDriver::savedNearestWR = 0;
-    float MapDriver::savedNearestR = 0;
-    float MapDriver::savedNearestL = 0;
-    float MapDriver::savedNearestWL = 0;
-
 
     // ----------------------------------------------------------------------------
-    // PlugIn for OpenSteerDemo
+    // The map and path a MapDriver drives through: regenerates the map (random
+    // rock clumps, fences) for each lap and plans routes around the rocks.
+    // Random numbers come from a generator owned by the world so several
+    // worlds can be regenerated at once on different threads (batch runs).
+    //
+    // More drivers can share the vehicle's map and route (see
+    // setDriverCount): they find each other through a proximity database,
+    // enter the route one at a time from a start queue and their obstacle
+    // scans run in parallel (see updateDrivers).
 
 
-    class MapDrivePlugIn : public PlugIn
+    class MapDriveWorld
     {
     public:
 
-        const char* name (void) {return "Driving through map based obstacles";}
+        MapDriveWorld (void)
+            : vehicle (NULL),
+              usePathFences (true),
+              useRandomRocks (true),
+              planner (NULL),
+              usePlannedRoute (false),
+              proximityDatabase (NULL),
+              randomState (1)
+        {
+        }
 
-        float selectionOrderSortKey (void) {return 0.07f;}
+        // restart the random sequence used to generate maps
+        void seedRandom (const unsigned int seed) {randomState = seed;}
 
-        // be more "nice" to avoid a compiler warning
-        virtual ~MapDrivePlugIn() {}
+        // random utilities drawing from this world's generator (same ranges
+        // as OpenSteer::frandom2)
+        float frandom2 (const float lowerBound, const float upperBound)
+        {
+            randomState = randomState * 1664525u + 1013904223u;
+            const float r01 = (float) (randomState >> 8) / 16777216.0f;
+            return lowerBound + (r01 * (upperBound - lowerBound));
+        }
 
-        void open (void)
+        int irandom2 (int min, int max)
         {
-            // make new MapDriver
-            vehicle = new MapDriver ();
-            vehicles.push_back (vehicle);
-            OpenSteerDemo::selectedVehicle = vehicle;
+            return (int) frandom2 ((float) min, (float) max);
+        }
 
-            // marks as obstacles map cells adjacent to the path
-            usePathFences = true; 
 
-            // scatter random rock clumps over map
-            useRandomRocks = true;
+        // number of drivers on the map, including vehicle
+        int driverCount (void) const {return (int) drivers.size ();}
 
-            // init OpenSteerDemo camera
-            initCamDist = 30;
-            initCamElev = 15;
-            OpenSteerDemo::init2dCamera (*vehicle, initCamDist, initCamElev);
-            // "look straight down at vehicle" camera mode parameters
-            OpenSteerDemo::camera.lookdownDistance = 50;
-            // "static" camera mode parameters
-            OpenSteerDemo::camera.fixedPosition.set (145, 145, 145);
-            OpenSteerDemo::camera.fixedTarget.set (40, 0, 40);
-            OpenSteerDemo::camera.fixedUp = Vec3::up;
+        // add or remove the drivers sharing vehicle's map and route (they
+        // copy its settings).  Call with 1 before deleting vehicle.
+        void setDriverCount (const int count)
+        {
+            // tokens go before the database they are in
+            for (size_t i = 1; i < drivers.size (); i++) delete drivers[i];
+            drivers.clear ();
+            activeDrivers.clear ();
+            startQueue.clear ();
+            if (proximityDatabase)
+            {
+                vehicle->leavePD ();
+                delete proximityDatabase;
+                proximityDatabase = NULL;
+            }
 
-            // reset this plugin
-            reset ();
-        }
+            drivers.push_back (vehicle);
+            activeDrivers.push_back (vehicle);
+            if (count < 2) return;
 
+            // cover the map and the ends of the route outside it
+            const float s = MapDriver::worldSize * 2;
+            proximityDatabase =
+                new LQProximityDatabase<AbstractVehicle*> (vehicle->map->center,
+                                                           Vec3 (s, s, s),
+                                                           Vec3 (40, 1, 40));
+            vehicle->newPD (*proximityDatabase);
+            for (int i = 1; i < count; i++)
+            {
+                MapDriver* driver = new MapDriver (*vehicle->map, *vehicle->path);
+                driver->headless = true;
+                driver->topSpeed = vehicle->topSpeed;
+                driver->curvedSteering = vehicle->curvedSteering;
+                driver->incrementalSteering = vehicle->incrementalSteering;
+                driver->pathFollowDirection = vehicle->pathFollowDirection;
+                drivers.push_back (driver);
+                startQueue.push_back (driver);
+            }
+        }
 
-        void update (const float currentTime, const float elapsedTime)
+        // put vehicle back at the start and all other drivers in the queue
+        void restartDrivers (void)
         {
-            // update simulation of test vehicle
+            if (drivers.size () < 2) return;
+            activeDrivers.clear ();
+            startQueue.clear ();
+            activeDrivers.push_back (vehicle);
+            vehicle->proximityToken->updateForNewPosition (vehicle->position ());
+            for (size_t i = 1; i < drivers.size (); i++)
+            {
+                MapDriver& driver = *drivers[i];
+                driver.pathFollowDirection = vehicle->pathFollowDirection;
+                driver.curvedSteering = vehicle->curvedSteering;
+                driver.incrementalSteering = vehicle->incrementalSteering;
+                driver.leavePD ();
+                startQueue.push_back (&driver);
+            }
+        }
+
+        // simulate all drivers on the map for one time step.  Each first
+        // decides on steering looking at the others, then all move.  The
+        // map is left alone (others drive on it) so leaving the map only
+        // teleports a driver back to the route's start, stuck drivers go
+        // to the end of the start queue.
+        void updateDrivers (const float currentTime, const float elapsedTime)
+        {
+            releaseFromStartQueue ();
+
+            const int count = (int) activeDrivers.size ();
+            driverSteering.resize (count);
+
+            // proximity queries are made one at a time, before the parallel
+            // part: a query may write the database (statistics, auto-tune)
+            for (int i = 0; i < count; i++) activeDrivers[i]->findTraffic ();
+#ifdef _OPENMP
+            // annotation is buffered for redraw in a shared list
+            const bool parallel = ! annotationIsOn ();
+            #pragma omp parallel for schedule(dynamic) if (parallel)
+#endif
+            for (int i = 0; i < count; i++)
+            {
+                driverSteering[i] = activeDrivers[i]->determineSteering (elapsedTime);
+            }
+#ifdef _OPENMP
+            #pragma omp parallel for schedule(dynamic) if (parallel)
+#endif
+            for (int i = 0; i < count; i++)
+            {
+                activeDrivers[i]->applySteering (driverSteering[i],
+                                                 currentTime, elapsedTime);
+            }
+
+            for (int i = count - 1; i >= 0; i--)
+            {
+                MapDriver& driver = *activeDrivers[i];
+                driver.handleExitFromMap ();
+                if (driver.stuck && (driver.relativeSpeed () < 0.001f))
+                {
+                    driver.stuckCount++;
+                    driver.leavePD ();
+                    activeDrivers.erase (activeDrivers.begin () + i);
+                    startQueue.push_back (&driver);
+                }
+                else
+                {
+                    driver.proximityToken->updateForNewPosition (driver.position ());
+                }
+            }
+        }
+
+        // the first driver in the queue enters when no other is near the start
+        void releaseFromStartQueue (void)
+        {
+            if (startQueue.empty ()) return;
+            MapDriver& driver = *startQueue.front ();
+            const Vec3 start = driver.startPosition ();
+            const float clearance = driver.halfLength * 8;
+            for (size_t i = 0; i < activeDrivers.size (); i++)
+            {
+                const Vec3 offset = activeDrivers[i]->position () - start;
+                if (offset.length () < clearance) return;
+            }
+            startQueue.pop_front ();
+            driver.reset ();
+            driver.newPD (*proximityDatabase);
+            activeDrivers.push_back (&driver);
+        }
+
+	void regenerateMap (void)
+	{
+	    // regenerate map: clear and add random "rocks"
+	    vehicle->map->clear();
+	    drawRandomClumpsOfRocksOnMap (*vehicle->map);
+	    clearCenterOfMap (*vehicle->map);
+
+	    // draw fences for first two demo modes
+	    if (vehicle->demoSelect < 2) drawBoundaryFencesOnMap (*vehicle->map);
+
+	    // plan the path around the rocks or randomize path widths
+	    if (usePlannedRoute && (vehicle->demoSelect == 2))
+	    {
+		planRoute ();
+	    }
+	    else if (vehicle->demoSelect == 2)
+	    {
+		const OpenSteer::size_t count = vehicle->path->segmentCount();
+		const bool upstream = vehicle->pathFollowDirection > 0;
+		const OpenSteer::size_t entryIndex = upstream ? 0 : count-1;
+		const OpenSteer::size_t exitIndex  = upstream ? count-1 : 0;
+		const float lastExitRadius = vehicle->path->segmentRadius( exitIndex );
+		for (OpenSteer::size_t i = 0; i < count; i++)
+		{
+		    vehicle->path->setSegmentRadius( i, frandom2 (4, 19) );
+		}
+		vehicle->path->setSegmentRadius( entryIndex, lastExitRadius );
+	    }
+
+	    // mark path-boundary map cells as obstacles
+	    // (when in path following demo and appropriate mode is set)
+	    if (usePathFences && (vehicle->demoSelect == 2))
+		drawPathFencesOnMap (*vehicle->map, *vehicle->path);
+	}
+
+        // planner cells coincide with the map cells
+        GridPathPlanner* makePlanner (const TerrainMap& map)
+        {
+            const float cellSize = map.xSize / (float) map.resolution;
+            const Vec3 corner (map.xSize / -2, 0, map.zSize / -2);
+            GridPathPlanner* p = new GridPathPlanner (map.resolution,
+                                                      map.resolution,
+                                                      map.center + corner,
+                                                      cellSize);
+            // at least the vehicle width, at most the widest random path
+            p->setRouteRadiusRange (2, 19);
+            return p;
+        }
+
+
+        // replace the path by routes planned around the rocks between the
+        // waypoints of the hand made path (its first and last waypoints
+        // are outside the map and reached by straight segments)
+        void planRoute (void)
+        {
+            // only cells changed since the last planning repair the searches
+            TerrainMap& map = *vehicle->map;
+            for (int j = 0; j < map.resolution; j++)
+                for (int i = 0; i < map.resolution; i++)
+                    planner->setBlocked (i, j, map.getMapBit (i, j));
+
+            GCRoute* course = vehicle->makePath ();
+            const OpenSteer::size_t count = course->pointCount ();
+            std::vector<GridPathPlanner::Request> legs (count - 3);
+            for (OpenSteer::size_t i = 0; i < legs.size(); i++)
+            {
+                legs[i].start = course->point (i + 1);
+                legs[i].goal = course->point (i + 2);
+            }
+            planner->findRoutes (&legs[0], legs.size());
+
+            std::vector<Vec3> points;
+            std::vector<float> radii;
+            points.push_back (course->point (0));
+            points.push_back (course->point (1));
+            radii.push_back (course->segmentRadius (0));
+            for (OpenSteer::size_t i = 0; i < legs.size(); i++)
+            {
+                const GridPathPlanner::Route& leg = legs[i].route;
+                if (legs[i].found)
+                {
+                    points.insert (points.end(), leg.points.begin() + 1, leg.points.end());
+                    radii.insert (radii.end(), leg.radii.begin(), leg.radii.end());
+                }
+                else
+                {
+                    // keep the straight leg when a waypoint is blocked
+                    points.push_back (legs[i].goal);
+                    radii.push_back (course->segmentRadius (i + 1));
+                }
+            }
+            points.push_back (course->point (count - 1));
+            radii.push_back (course->segmentRadius (count - 2));
+
+            vehicle->path->setPathway (points.size(), &points[0], &radii[0], false);
+            delete (course);
+        }
+
+
+        void drawRandomClumpsOfRocksOnMap (TerrainMap& map)
+        {
+            if (useRandomRocks)
+            {
+                const int spread = 4;
+                const int r = map.cellwidth();
+                const int k = irandom2 (50, 150);
+
+                for (int p=0; p<k; p++)
+                {
+                    const int i = irandom2 (0, r - spread);
+                    const int j = irandom2 (0, r - spread);
+                    const int c = irandom2 (0, 10);
+
+                    for (int q=0; q<c; q++)
+                    {
+                        const int m = irandom2 (0, spread);
+                        const int n = irandom2 (0, spread);
+    #ifdef OLDTERRAINMAP
+                        map.setMapBit (i+m, j+n, 1);
+    #else
+                        map.setType (i+m, j+n, CellData::OBSTACLE);
+    #endif
+                    }
+                }
+            }
+        }
+
+
+        void drawBoundaryFencesOnMap (TerrainMap& map)
+        {
+            // QQQ it would make more sense to do this with a "draw line
+            // QQQ on map" primitive, may need that for other things too
+
+            const int cw = map.cellwidth();
+            const int ch = map.cellheight();
+
+            const int r = cw - 1;
+            const int a = cw >> 3;
+            const int b = cw - a;
+            const int o = cw >> 4;
+            const int p = (cw - o) >> 1;
+            const int q = (cw + o) >> 1;
+
+            for (int i = 0; i < cw; i++)
+            {
+                for (int j = 0; j < ch; j++)
+                {
+                    const bool c = i>a && i<b && (i<p || i>q);
+                    if (i==0 || j==0 || i==r || j==r || (c && (i==j || i+j==r))) 
+    #ifdef OLDTERRAINMAP
+                        map.setMapBit (i, j, 1);
+    #else
+                        map.setType (i, j, CellData::IMPASSABLE);
+    #endif
+                }
+            }
+        }
+
+
+        void clearCenterOfMap (TerrainMap& map)
+        {
+            const int o = map.cellwidth() >> 4;
+            const int p = (map.cellwidth() - o) >> 1;
+            const int q = (map.cellwidth() + o) >> 1;
+            for (int i = p; i <= q; i++)
+                for (int j = p; j <= q; j++)
+    #ifdef OLDTERRAINMAP
+                    map.setMapBit (i, j, 0);
+    #else
+                    map.setType (i, j, CellData::CLEAR);
+    #endif
+        }
+
+
+        void drawPathFencesOnMap (TerrainMap& map, GCRoute& path)
+        {
+    #ifdef OLDTERRAINMAP
+            const float xs = map.xSize / (float)map.resolution;
+            const float zs = map.zSize / (float)map.resolution;
+            const Vec3 alongRow (xs, 0, 0);
+            const Vec3 nextRow (-map.xSize, 0, zs);
+            Vec3 g ((map.xSize - xs) / -2, 0, (map.zSize - zs) / -2);
+            for (int j = 0; j < map.resolution; j++)
+            {
+                for (int i = 0; i < map.resolution; i++)
+                {
+                    const float outside = mapPointToOutside( path, g ); // path.howFarOutsidePath (g);
+                    const float wallThickness = 1.0f;
+
+                    // set map cells adjacent to the outside edge of the path
+                    if ((outside > 0) && (outside < wallThickness))
+                        map.setMapBit (i, j, true);
+
+                    // clear all other off-path map cells 
+                    if (outside > wallThickness) map.setMapBit (i, j, false);
+
+                    g += alongRow;
+                }
+                g += nextRow;
+            }
+    #else
+    #endif
+        }
+
+        MapDriver* vehicle;
+
+        bool usePathFences;
+        bool useRandomRocks;
+
+        GridPathPlanner* planner;
+        bool usePlannedRoute;
+
+        // all drivers on the map (vehicle first), those driving, those
+        // waiting to enter and the database they find each other in
+        std::vector<MapDriver*> drivers;
+        std::vector<MapDriver*> activeDrivers;
+        std::deque<MapDriver*> startQueue;
+        ProximityDatabase* proximityDatabase;
+
+    private:
+
+        unsigned int randomState;
+
+        // steering decided by each active driver in updateDrivers
+        std::vector<Vec3> driverSteering;
+    };
+
+
+    // ----------------------------------------------------------------------------
+    // Batch runs: many independent MapDrive episodes, each with its own
+    // MapDriver, randomly filled map and route planner, simulated without
+    // graphics on all cores.  The collision, wipeout (stuck and reset) and
+    // lap completion statistics and the timing are written as CSV.
+    //
+    // Every configuration (a top speed with curved or linear steering) runs
+    // the same sequence of random seeds so all of them drive through the
+    // same maps.  The wander behavior (demo 0 and 1) still draws from the
+    // global rand (), those runs aren't reproducible.
+
+
+    struct MapDriveBatchSettings
+    {
+        int episodes;          // per configuration
+        float duration;        // simulated seconds per episode
+        float stepSize;        // simulation time step (seconds)
+        unsigned int seed;     // seed of the first episode
+        int demo;              // MapDriver::demoSelect
+        int drivers;           // sharing each episode's map
+        bool pathFences;
+        bool randomRocks;
+        bool plannedRoute;
+        std::vector<float> speeds;
+        std::vector<bool> curved;
+        std::string reportFile;
+        std::string episodeFile;
+    };
+
+
+    struct MapDriveEpisode
+    {
+        // settings
+        int configuration;
+        unsigned int seed;
+        float topSpeed;
+        bool curvedSteering;
+
+        // outcome
+        float simulatedTime;
+        int collisions;
+        float collisionTime;
+        int wipeouts;
+        int stuckCycles;
+        int stuckOffPath;
+        int lapsStarted;
+        int lapsFinished;
+        float distance;
+        float pathOffTime;
+        int hintsGiven;
+        int hintsTaken;
+        int vehicleContacts;
+        float realTime;
+    };
+
+
+    // simulate one episode the way MapDrivePlugIn's update does, without
+    // camera or annotation.  With several drivers the outcome is their total.
+
+
+    void runMapDriveEpisode (const MapDriveBatchSettings& settings,
+                             MapDriveEpisode& e)
+    {
+        MapDriveWorld world;
+
+        // SimpleVehicle's serial number counter is shared
+        MapDriver* vehicle;
+#ifdef _OPENMP
+        #pragma omp critical (mapDriveBatchVehicles)
+#endif
+        {
+            vehicle = new MapDriver ();
+            vehicle->headless = true;
+            vehicle->topSpeed = e.topSpeed;
+            vehicle->curvedSteering = e.curvedSteering;
+            vehicle->incrementalSteering = e.curvedSteering;
+            world.vehicle = vehicle;
+            world.setDriverCount (settings.drivers);
+        }
+
+        world.seedRandom (e.seed);
+        world.usePathFences = settings.pathFences;
+        world.useRandomRocks = settings.randomRocks;
+        world.usePlannedRoute = settings.plannedRoute;
+        if (settings.plannedRoute)
+            world.planner = world.makePlanner (*vehicle->map);
+
+        world.regenerateMap ();
+        vehicle->reset ();
+        world.restartDrivers ();
+
+        Clock timer;
+        const float startTime = timer.realTimeSinceFirstClockUpdate ();
+        const int steps = (int) ((settings.duration / settings.stepSize) + 0.5f);
+        e.collisionTime = 0;
+        for (int i = 1; i <= steps; i++)
+        {
+            if (settings.drivers > 1)
+            {
+                world.updateDrivers (i * settings.stepSize, settings.stepSize);
+                for (size_t j = 0; j < world.activeDrivers.size (); j++)
+                    if (world.activeDrivers[j]->collisionDetected)
+                        e.collisionTime += settings.stepSize;
+                continue;
+            }
+
+            vehicle->update (i * settings.stepSize, settings.stepSize);
+            if (vehicle->collisionDetected) e.collisionTime += settings.stepSize;
+
+            if (vehicle->handleExitFromMap ()) world.regenerateMap ();
+
+            if (vehicle->stuck && (vehicle->relativeSpeed () < 0.001f))
+            {
+                vehicle->stuckCount++;
+                world.regenerateMap ();
+                vehicle->reset ();
+            }
+        }
+        e.realTime = timer.realTimeSinceFirstClockUpdate () - startTime;
+
+        e.simulatedTime = steps * settings.stepSize;
+        e.collisions = e.wipeouts = e.stuckCycles = e.stuckOffPath = 0;
+        e.lapsStarted = e.lapsFinished = e.hintsGiven = e.hintsTaken = 0;
+        e.vehicleContacts = 0;
+        e.distance = e.pathOffTime = 0;
+        for (size_t i = 0; i < world.drivers.size (); i++)
+        {
+            const MapDriver& driver = *world.drivers[i];
+            e.collisions += driver.countOfCollisionFreeTimes;
+            e.wipeouts += driver.stuckCount;
+            e.stuckCycles += driver.stuckCycleCount;
+            e.stuckOffPath += driver.stuckOffPathCount;
+            e.lapsStarted += driver.lapsStarted;
+            e.lapsFinished += driver.lapsFinished;
+            e.distance += driver.totalDistance;
+            e.pathOffTime += driver.pathFollowOffTime;
+            e.hintsGiven += driver.hintGivenCount;
+            e.hintsTaken += driver.hintTakenCount;
+            e.vehicleContacts += driver.vehicleContactCount;
+        }
+
+        world.setDriverCount (1);
+        delete (world.planner);
+        delete (vehicle);
+    }
+
+
+    // parse "key=value" batch arguments, returns false (after printing
+    // usage) if one is unknown
+
+
+    bool parseMapDriveBatchArguments (int argc, char** argv,
+                                      MapDriveBatchSettings& settings)
+    {
+        settings.episodes = 100;
+        settings.duration = 60;
+        settings.stepSize = 1.0f / 60.0f;
+        settings.seed = 1;
+        settings.demo = 2;
+        settings.drivers = 1;
+        settings.pathFences = true;
+        settings.randomRocks = true;
+        settings.plannedRoute = false;
+        settings.reportFile = "mapdrive_batch.csv";
+
+        std::string speeds = "20";
+        std::string steering = "curved,linear";
+        bool ok = true;
+        for (int i = 0; i < argc; i++)
+        {
+            const char* equals = std::strchr (argv[i], '=');
+            const std::string key (argv[i], equals ? equals - argv[i] : std::strlen (argv[i]));
+            const char* value = equals ? equals + 1 : "";
+            if (key == "episodes") settings.episodes = std::atoi (value);
+            else if (key == "seconds") settings.duration = (float) std::atof (value);
+            else if (key == "step") settings.stepSize = (float) std::atof (value);
+            else if (key == "seed") settings.seed = (unsigned int) std::strtoul (value, NULL, 10);
+            else if (key == "demo") settings.demo = std::atoi (value);
+            else if (key == "drivers") settings.drivers = std::atoi (value);
+            else if (key == "fences") settings.pathFences = std::atoi (value) != 0;
+            else if (key == "rocks") settings.randomRocks = std::atoi (value) != 0;
+            else if (key == "planned") settings.plannedRoute = std::atoi (value) != 0;
+            else if (key == "speeds") speeds = value;
+            else if (key == "steering") steering = value;
+            else if (key == "report") settings.reportFile = value;
+            else if (key == "episodeReport") settings.episodeFile = value;
+            else
+            {
+                std::cerr << "unknown batch argument \"" << argv[i] << "\"" << std::endl;
+                ok = false;
+            }
+        }
+
+        // comma separated lists of top speeds and steering kinds
+        std::istringstream speedList (speeds);
+        std::string item;
+        while (std::getline (speedList, item, ','))
+            settings.speeds.push_back ((float) std::atof (item.c_str ()));
+        std::istringstream steeringList (steering);
+        while (std::getline (steeringList, item, ','))
+        {
+            if ((item == "curved") || (item == "linear"))
+            {
+                settings.curved.push_back (item == "curved");
+            }
+            else
+            {
+                std::cerr << "unknown steering \"" << item << "\"" << std::endl;
+                ok = false;
+            }
+        }
+
+        if (settings.speeds.empty () || settings.curved.empty () ||
+            (settings.episodes < 1) || (settings.drivers < 1) ||
+            !(settings.duration > 0) ||
+            !(settings.stepSize > 0) || (settings.demo < 0) || (settings.demo > 2))
+        {
+            ok = false;
+        }
+
+        if (!ok)
+        {
+            std::cerr << "batch arguments (key=value, defaults in brackets):\n"
+                      << "  episodes=N        episodes per configuration [100]\n"
+                      << "  seconds=S         simulated seconds per episode [60]\n"
+                      << "  step=DT           simulation time step [1/60]\n"
+                      << "  seed=N            seed of the first episode's map [1]\n"
+                      << "  demo=0|1|2        driving demo [2, path following]\n"
+                      << "  drivers=N         drivers sharing each map [1]\n"
+                      << "  fences=0|1        path fences [1]\n"
+                      << "  rocks=0|1         random rock clumps [1]\n"
+                      << "  planned=0|1       route planned around rocks [0]\n"
+                      << "  speeds=A,B,...    top speeds (m/s) to compare [20]\n"
+                      << "  steering=curved,linear  steering kinds to compare [both]\n"
+                      << "  report=FILE       per configuration CSV [mapdrive_batch.csv]\n"
+                      << "  episodeReport=FILE  per episode CSV [none]"
+                      << std::endl;
+        }
+        return ok;
+    }
+
+
+    // run the batch and write the reports, returns the exit status
+
+
+    int runMapDriveBatch (int argc, char** argv)
+    {
+        MapDriveBatchSettings settings;
+        if (!parseMapDriveBatchArguments (argc, argv, settings)) return EXIT_FAILURE;
+
+        // every configuration runs episodes with the same seeds
+        std::vector<MapDriveEpisode> episodes;
+        const int configurationCount = (int) (settings.speeds.size () *
+                                              settings.curved.size ());
+        for (int c = 0; c < configurationCount; c++)
+        {
+            for (int i = 0; i < settings.episodes; i++)
+            {
+                MapDriveEpisode e;
+                e.configuration = c;
+                e.seed = settings.seed + i;
+                e.topSpeed = settings.speeds[c / settings.curved.size ()];
+                e.curvedSteering = settings.curved[c % settings.curved.size ()];
+                episodes.push_back (e);
+            }
+        }
+
+        // no annotation: it would buffer lines for a redraw that never comes
+        const bool annotation = annotationIsOn ();
+        setAnnotationOff ();
+        const int demo = MapDriver::demoSelect;
+        MapDriver::demoSelect = settings.demo;
+
+        Clock timer;
+        const float startTime = timer.realTimeSinceFirstClockUpdate ();
+        const int episodeCount = (int) episodes.size ();
+#ifdef _OPENMP
+        // few episodes with many drivers: parallel within the episodes
+        const bool parallel = ((settings.drivers == 1) ||
+                               (episodeCount >= omp_get_max_threads ()));
+        #pragma omp parallel for schedule(dynamic) if (parallel)
+#endif
+        for (int i = 0; i < episodeCount; i++)
+        {
+            runMapDriveEpisode (settings, episodes[i]);
+        }
+        const float realTime = timer.realTimeSinceFirstClockUpdate () - startTime;
+
+        MapDriver::demoSelect = demo;
+        if (annotation) setAnnotationOn ();
+
+        // one row per episode
+        if (!settings.episodeFile.empty ())
+        {
+            std::ofstream out (settings.episodeFile.c_str ());
+            out << "episode,configuration,seed,topSpeed,steering,simulatedSeconds,"
+                << "collisions,collisionSeconds,wipeouts,stuckCycles,stuckOffPath,"
+                << "lapsStarted,lapsFinished,distance,pathOffSeconds,"
+                << "hintsGiven,hintsTaken,vehicleContacts,realSeconds\n";
+            for (int i = 0; i < episodeCount; i++)
+            {
+                const MapDriveEpisode& e = episodes[i];
+                out << i << ',' << e.configuration << ',' << e.seed << ','
+                    << e.topSpeed << ',' << (e.curvedSteering ? "curved" : "linear") << ','
+                    << e.simulatedTime << ',' << e.collisions << ',' << e.collisionTime << ','
+                    << e.wipeouts << ',' << e.stuckCycles << ',' << e.stuckOffPath << ','
+                    << e.lapsStarted << ',' << e.lapsFinished << ',' << e.distance << ','
+                    << e.pathOffTime << ',' << e.hintsGiven << ',' << e.hintsTaken << ','
+                    << e.vehicleContacts << ',' << e.realTime << '\n';
+            }
+            if (!out)
+            {
+                std::cerr << "could not write " << settings.episodeFile << std::endl;
+                return EXIT_FAILURE;
+            }
+        }
+
+        // one row per configuration with the totals and rates (per driver)
+        std::ofstream out (settings.reportFile.c_str ());
+        out << "configuration,topSpeed,steering,drivers,episodes,simulatedSeconds,"
+            << "collisions,collisionsPerHour,collisionTimeFraction,"
+            << "wipeouts,wipeoutsPerHour,stuckCycles,stuckOffPath,"
+            << "lapsStarted,lapsFinished,completionRate,averageSpeed,"
+            << "pathOffFraction,hintsGiven,hintsTaken,vehicleContacts,"
+            << "realSeconds,meanEpisodeRealSeconds,speedup\n";
+        for (int c = 0; c < configurationCount; c++)
+        {
+            MapDriveEpisode sum = episodes[c * settings.episodes];
+            for (int i = 1; i < settings.episodes; i++)
+            {
+                const MapDriveEpisode& e = episodes[c * settings.episodes + i];
+                sum.simulatedTime += e.simulatedTime;
+                sum.collisions += e.collisions;
+                sum.collisionTime += e.collisionTime;
+                sum.wipeouts += e.wipeouts;
+                sum.stuckCycles += e.stuckCycles;
+                sum.stuckOffPath += e.stuckOffPath;
+                sum.lapsStarted += e.lapsStarted;
+                sum.lapsFinished += e.lapsFinished;
+                sum.distance += e.distance;
+                sum.pathOffTime += e.pathOffTime;
+                sum.hintsGiven += e.hintsGiven;
+                sum.hintsTaken += e.hintsTaken;
+                sum.vehicleContacts += e.vehicleContacts;
+                sum.realTime += e.realTime;
+            }
+            const float driverTime = sum.simulatedTime * settings.drivers;
+            const float hours = driverTime / 3600;
+            out << c << ',' << sum.topSpeed << ','
+                << (sum.curvedSteering ? "curved" : "linear") << ','
+                << settings.drivers << ','
+                << settings.episodes << ',' << sum.simulatedTime << ','
+                << sum.collisions << ',' << sum.collisions / hours << ','
+                << sum.collisionTime / driverTime << ','
+                << sum.wipeouts << ',' << sum.wipeouts / hours << ','
+                << sum.stuckCycles << ',' << sum.stuckOffPath << ','
+                << sum.lapsStarted << ',' << sum.lapsFinished << ','
+                << (sum.lapsStarted ? (float) sum.lapsFinished / sum.lapsStarted : 0.0f) << ','
+                << sum.distance / driverTime << ','
+                << sum.pathOffTime / driverTime << ','
+                << sum.hintsGiven << ',' << sum.hintsTaken << ','
+                << sum.vehicleContacts << ','
+                << sum.realTime << ',' << sum.realTime / settings.episodes << ','
+                << sum.simulatedTime / sum.realTime << '\n';
+        }
+        if (!out)
+        {
+            std::cerr << "could not write " << settings.reportFile << std::endl;
+            return EXIT_FAILURE;
+        }
+
+        std::cout << episodeCount << " MapDrive episodes in " << realTime
+                  << " seconds, report written to " << settings.reportFile
+                  << std::endl;
+        return EXIT_SUCCESS;
+    }
+
+
+    // ----------------------------------------------------------------------------
+    // PlugIn for OpenSteerDemo
+
+
+    class MapDrivePlugIn : public PlugIn, public MapDriveWorld
+    {
+    public:
+
+        const char* name (void) {return "Driving through map based obstacles";}
+
+        float selectionOrderSortKey (void) {return 0.07f;}
+
+        // be more "nice" to avoid a compiler warning
+        virtual ~MapDrivePlugIn() {}
+
+        void open (void)
+        {
+            // make new MapDriver
+            vehicle = new MapDriver ();
+            vehicles.push_back (vehicle);
+            OpenSteerDemo::selectedVehicle = vehicle;
+
+            // marks as obstacles map cells adjacent to the path
+            usePathFences = true; 
+
+            // scatter random rock clumps over map
+            useRandomRocks = true;
+
+            // plans the path around the rocks on the map
+            planner = makePlanner (*vehicle->map);
+            usePlannedRoute = false;
+
+            // drives alone (F8 adds drivers)
+            setDriverCount (1);
+
+            // init OpenSteerDemo camera
+            initCamDist = 30;
+            initCamElev = 15;
+            OpenSteerDemo::init2dCamera (*vehicle, initCamDist, initCamElev);
+            // "look straight down at vehicle" camera mode parameters
+            OpenSteerDemo::camera.lookdownDistance = 50;
+            // "static" camera mode parameters
+            OpenSteerDemo::camera.fixedPosition.set (145, 145, 145);
+            OpenSteerDemo::camera.fixedTarget.set (40, 0, 40);
+            OpenSteerDemo::camera.fixedUp = Vec3::up;
+
+            // reset this plugin
+            reset ();
+        }
+
+
+        void update (const float currentTime, const float elapsedTime)
+        {
+            // several drivers share the map
+            if (driverCount () > 1)
+            {
+                updateDrivers (currentTime, elapsedTime);
+                return;
+            }
+
+            // update simulation of test vehicle
             vehicle->update (currentTime, elapsedTime);
 
             // when vehicle drives outside the world
@@ -2636,8 +3823,9 @@ namespace {
             vehicle->drawMap ();
             if (vehicle->demoSelect == 2) vehicle->drawPath ();
 
-            // draw test vehicle
-            vehicle->draw ();
+            // draw test vehicle (and the other drivers)
+            for (size_t i = 0; i < activeDrivers.size (); i++)
+                activeDrivers[i]->draw ();
 
             // QQQ mark origin to help spot artifacts
             const float tick = 2;
@@ -2678,6 +3866,15 @@ namespace {
             status << "\n\nStuck count: " << vehicle->stuckCount << " (" 
                    << vehicle->stuckCycleCount << " cycles, "
                    << vehicle->stuckOffPathCount << " off path)";
+            if (driverCount () > 1)
+            {
+                int contacts = 0;
+                for (size_t i = 0; i < drivers.size (); i++)
+                    contacts += drivers[i]->vehicleContactCount;
+                status << "\n[F8] drivers: " << driverCount ()
+                       << " (" << activeDrivers.size () << " on the map), "
+                       << contacts << " contacts";
+            }
             status << "\n\n[F1] ";
             if (1 == vehicle->demoSelect) status << "wander, ";
             if (2 == vehicle->demoSelect) status << "follow path, ";
@@ -2689,6 +3886,8 @@ namespace {
                 if (vehicle->pathFollowDirection>0)status<<"+1";else status<<"-1";
                 status << "\n[F3] path fence: ";
                 if (usePathFences) status << "on"; else status << "off";
+                status << "\n[F7] planned route: ";
+                if (usePlannedRoute) status << "on"; else status << "off";
             }
 
             status << "\n[F4] rocks: ";
@@ -2755,15 +3954,18 @@ namespace {
         void close (void)
         {
             vehicles.clear ();
+            setDriverCount (1);
             delete (vehicle);
+            delete (planner);
         }
 
         void reset (void)
         {
             regenerateMap();
 
-            // reset vehicle
+            // reset vehicle, line up the other drivers behind it
             vehicle->reset ();
+            restartDrivers ();
 
             // make camera jump immediately to new position
             OpenSteerDemo::camera.doNotSmoothNextMove ();
@@ -2797,6 +3999,8 @@ namespace {
                     drawPathFencesOnMap (*vehicle->map, r);
                     break;
                 }
+            case 7: togglePlannedRoute (); break;
+            case 8: selectNextDriverCount (); break;
             }
         }
 
@@ -2811,6 +4015,8 @@ namespace {
             OpenSteerDemo::printMessage ("  F3     toggle path fences.");
             OpenSteerDemo::printMessage ("  F4     toggle random rock clumps.");
             OpenSteerDemo::printMessage ("  F5     toggle curved prediction.");
+            OpenSteerDemo::printMessage ("  F7     toggle route planned around rocks.");
+            OpenSteerDemo::printMessage ("  F8     select number of drivers (1, 10, 100).");
             OpenSteerDemo::printMessage ("");
         }
 
@@ -2832,6 +4038,42 @@ namespace {
             reset ();
         }
 
+        void togglePlannedRoute (void)
+        {
+            usePlannedRoute = ! usePlannedRoute;
+
+            // go back to the hand made route (other drivers hold the old one)
+            if (! usePlannedRoute)
+            {
+                const int count = driverCount ();
+                setDriverCount (1);
+                delete (vehicle->path);
+                vehicle->path = vehicle->makePath ();
+                setDriverCount (count);
+                syncVehicles ();
+            }
+            reset ();
+        }
+
+        void selectNextDriverCount (void)
+        {
+            const int count = driverCount ();
+            setDriverCount ((count == 1) ? 10 : ((count == 10) ? 100 : 1));
+            syncVehicles ();
+            reset ();
+
+            std::ostringstream message;
+            message << name() << ": " << driverCount () << " drivers" << std::ends;
+            OpenSteerDemo::printMessage (message);
+        }
+
+        // allVehicles are all drivers on the map
+        void syncVehicles (void)
+        {
+            vehicles = drivers;
+            OpenSteerDemo::selectedVehicle = vehicle;
+        }
+
         void toggleCurvedSteering (void)
         {
             vehicle->curvedSteering = ! vehicle->curvedSteering;
@@ -2864,157 +4106,14 @@ namespace {
             OpenSteerDemo::printMessage (message);
         }
 
-        // random utility, worth moving to Utilities.h?
-        int irandom2 (int min, int max)
-        {
-            return (int) frandom2 ((float) min, (float) max);
-        }
-
-	void regenerateMap (void)
-	{
-	    // regenerate map: clear and add random "rocks"
-	    vehicle->map->clear();
-	    drawRandomClumpsOfRocksOnMap (*vehicle->map);
-	    clearCenterOfMap (*vehicle->map);
-
-	    // draw fences for first two demo modes
-	    if (vehicle->demoSelect < 2) drawBoundaryFencesOnMap (*vehicle->map);
-
-	    // randomize path widths
-	    if (vehicle->demoSelect == 2)
-	    {
-		const OpenSteer::size_t count = vehicle->path->segmentCount();
-		const bool upstream = vehicle->pathFollowDirection > 0;
-		const OpenSteer::size_t entryIndex = upstream ? 0 : count-1;
-		const OpenSteer::size_t exitIndex  = upstream ? count-1 : 0;
-		const float lastExitRadius = vehicle->path->segmentRadius( exitIndex );
-		for (OpenSteer::size_t i = 0; i < count; i++)
-		{
-		    vehicle->path->setSegmentRadius( i, frandom2 (4, 19) );
-		}
-		vehicle->path->setSegmentRadius( entryIndex, lastExitRadius );
-	    }
-
-	    // mark path-boundary map cells as obstacles
-	    // (when in path following demo and appropriate mode is set)
-	    if (usePathFences && (vehicle->demoSelect == 2))
-		drawPathFencesOnMap (*vehicle->map, *vehicle->path);
-	}
-
-        void drawRandomClumpsOfRocksOnMap (TerrainMap& map)
-        {
-            if (useRandomRocks)
-            {
-                const int spread = 4;
-                const int r = map.cellwidth();
-                const int k = irandom2 (50, 150);
-
-                for (int p=0; p<k; p++)
-                {
-                    const int i = irandom2 (0, r - spread);
-                    const int j = irandom2 (0, r - spread);
-                    const int c = irandom2 (0, 10);
-
-                    for (int q=0; q<c; q++)
-                    {
-                        const int m = irandom2 (0, spread);
-                        const int n = irandom2 (0, spread);
-    #ifdef OLDTERRAINMAP
-                        map.setMapBit (i+m, j+n, 1);
-    #else
-                        map.setType (i+m, j+n, CellData::OBSTACLE);
-    #endif
-                    }
-                }
-            }
-        }
-
-
-        void drawBoundaryFencesOnMap (TerrainMap& map)
-        {
-            // QQQ it would make more sense to do this with a "draw line
-            // QQQ on map" primitive, may need that for other things too
-
-            const int cw = map.cellwidth();
-            const int ch = map.cellheight();
-
-            const int r = cw - 1;
-            const int a = cw >> 3;
-            const int b = cw - a;
-            const int o = cw >> 4;
-            const int p = (cw - o) >> 1;
-            const int q = (cw + o) >> 1;
-
-            for (int i = 0; i < cw; i++)
-            {
-                for (int j = 0; j < ch; j++)
-                {
-                    const bool c = i>a && i<b && (i<p || i>q);
-                    if (i==0 || j==0 || i==r || j==r || (c && (i==j || i+j==r))) 
-    #ifdef OLDTERRAINMAP
-                        map.setMapBit (i, j, 1);
-    #else
-                        map.setType (i, j, CellData::IMPASSABLE);
-    #endif
-                }
-            }
-        }
-
-
-        void clearCenterOfMap (TerrainMap& map)
-        {
-            const int o = map.cellwidth() >> 4;
-            const int p = (map.cellwidth() - o) >> 1;
-            const int q = (map.cellwidth() + o) >> 1;
-            for (int i = p; i <= q; i++)
-                for (int j = p; j <= q; j++)
-    #ifdef OLDTERRAINMAP
-                    map.setMapBit (i, j, 0);
-    #else
-                    map.setType (i, j, CellData::CLEAR);
-    #endif
-        }
-
-
-        void drawPathFencesOnMap (TerrainMap& map, GCRoute& path)
-        {
-    #ifdef OLDTERRAINMAP
-            const float xs = map.xSize / (float)map.resolution;
-            const float zs = map.zSize / (float)map.resolution;
-            const Vec3 alongRow (xs, 0, 0);
-            const Vec3 nextRow (-map.xSize, 0, zs);
-            Vec3 g ((map.xSize - xs) / -2, 0, (map.zSize - zs) / -2);
-            for (int j = 0; j < map.resolution; j++)
-            {
-                for (int i = 0; i < map.resolution; i++)
-                {
-                    const float outside = mapPointToOutside( path, g ); // path.howFarOutsidePath (g);
-                    const float wallThickness = 1.0f;
-
-                    // set map cells adjacent to the outside edge of the path
-                    if ((outside > 0) && (outside < wallThickness))
-                        map.setMapBit (i, j, true);
-
-                    // clear all other off-path map cells 
-                    if (outside > wallThickness) map.setMapBit (i, j, false);
-
-                    g += alongRow;
-                }
-                g += nextRow;
-            }
-    #else
-    #endif
-        }
-
         const AVGroup& allVehicles (void) {return (const AVGroup&) vehicles;}
 
-        MapDriver* vehicle;
+        // batch mode: run many episodes without graphics, see runMapDriveBatch
+        int runBatch (int argc, char** argv) {return runMapDriveBatch (argc, argv);}
+
         std::vector<MapDriver*> vehicles; // for allVehicles
 
         float initCamDist, initCamElev;
-
-        bool usePathFences;
-        bool useRandomRocks;
     };
 
 
@@ -84,8 +84,9 @@ namespace {
     {
     public:
 
-        // constructor
-        MpWanderer () {reset ();}
+        // constructor (every pursuer predicts the wanderer's position, so
+        // keep a per-tick cache of those predictions)
+        MpWanderer () {setPredictionCaching (true); reset ();}
 
         // reset state
         void reset (void)
@@ -40,9 +40,12 @@
 #include <iomanip>
 #include <sstream>
 #include "OpenSteer/PolylineSegmentedPathwaySingleRadius.h"
+#include "OpenSteer/PathwayFlowField.h"
+#include "OpenSteer/ObstacleDistanceField.h"
 #include "OpenSteer/SimpleVehicle.h"
 #include "OpenSteer/OpenSteerDemo.h"
 #include "OpenSteer/Proximity.h"
+#include "OpenSteer/SteeringArbiter.h"
 #include "OpenSteer/Color.h"
 
 namespace {
@@ -65,12 +68,20 @@ namespace {
     // creates a path for the PlugIn
     PolylineSegmentedPathwaySingleRadius* getTestPath (void);
     PolylineSegmentedPathwaySingleRadius* gTestPath = NULL;
+    // creates the flow field precomputed from the test path
+    PathwayFlowField* getFlowField (void);
+    PathwayFlowField* gFlowField = NULL;
+    // creates the distance field baked from the obstacles
+    ObstacleDistanceField* getObstacleField (void);
+    ObstacleDistanceField* gObstacleField = NULL;
     SphereObstacle gObstacle1;
     SphereObstacle gObstacle2;
     ObstacleGroup gObstacles;
     Vec3 gEndpoint0;
     Vec3 gEndpoint1;
     bool gUseDirectedPathFollowing = true;
+    bool gUseFlowField = false;
+    bool gUseObstacleField = false;
     // ------------------------------------ xxxcwr11-1-04 fixing steerToAvoid
     RectangleObstacle gObstacle3 (7,7);
     // ------------------------------------ xxxcwr11-1-04 fixing steerToAvoid
@@ -183,77 +194,81 @@ namespace {
         // or neighbors if needed, otherwise follow the path and wander
         Vec3 determineCombinedSteering (const float elapsedTime)
         {
-            // move forward
-            Vec3 steeringForce = forward();
-
-            // probability that a lower priority behavior will be given a
-            // chance to "drive" even if a higher priority behavior might
-            // otherwise be triggered.
-            const float leakThrough = 0.1f;
-
-            // determine if obstacle avoidance is required
-            Vec3 obstacleAvoidance;
-            if (leakThrough < frandom01())
+            // register the behaviors on first use: each avoidance behavior
+            // takes over when it produces a force (so the neighbor query is
+            // only made when there is no obstacle to avoid), and each has a
+            // 10% chance to let lower priority behaviors "drive" instead
+            if (arbiter.behaviorCount () == 0)
             {
-                const float oTime = 6; // minTimeToCollision = 6 seconds
-    // ------------------------------------ xxxcwr11-1-04 fixing steerToAvoid
-    // just for testing
-    //             obstacleAvoidance = steerToAvoidObstacles (oTime, gObstacles);
-    //             obstacleAvoidance = steerToAvoidObstacle (oTime, gObstacle1);
-    //             obstacleAvoidance = steerToAvoidObstacle (oTime, gObstacle3);
-                obstacleAvoidance = steerToAvoidObstacles (oTime, gObstacles);
-    // ------------------------------------ xxxcwr11-1-04 fixing steerToAvoid
+                const float leakThrough = 0.1f;
+                arbiter.addBehavior ("avoid obstacles",
+                                     &Pedestrian::steerToAvoidObstaclesBehavior,
+                                     4, 1, 2, true, leakThrough);
+                arbiter.addBehavior ("avoid neighbors",
+                                     &Pedestrian::steerToAvoidNeighborsBehavior,
+                                     3, 10, 4, true, leakThrough);
+                arbiter.addBehavior ("wander",
+                                     &Pedestrian::steerForWanderBehavior,
+                                     2, 1, 1);
+                arbiter.addBehavior ("follow path",
+                                     &Pedestrian::steerToFollowPathBehavior,
+                                     1, 0.5f, 2);
             }
 
-            // if obstacle avoidance is needed, do it
-            if (obstacleAvoidance != Vec3::zero)
-            {
-                steeringForce += obstacleAvoidance;
-            }
-            else
-            {
-                // otherwise consider avoiding collisions with others
-                Vec3 collisionAvoidance;
-                const float caLeadTime = 3;
-
-                // find all neighbors within maxRadius using proximity database
-                // (radius is largest distance between vehicles traveling head-on
-                // where a collision is possible within caLeadTime seconds.)
-                const float maxRadius = caLeadTime * maxSpeed() * 2;
-                neighbors.clear();
-                proximityToken->findNeighbors (position(), maxRadius, neighbors);
-
-                if (leakThrough < frandom01())
-                    collisionAvoidance =
-                        steerToAvoidNeighbors (caLeadTime, neighbors) * 10;
-
-                // if collision avoidance is needed, do it
-                if (collisionAvoidance != Vec3::zero)
-                {
-                    steeringForce += collisionAvoidance;
-                }
-                else
-                {
-                    // add in wander component (according to user switch)
-                    if (gWanderSwitch)
-                        steeringForce += steerForWander (elapsedTime);
-
-                    // do (interactively) selected type of path following
-                    const float pfLeadTime = 3;
-                    const Vec3 pathFollow =
-                        (gUseDirectedPathFollowing ?
-                         steerToFollowPath (pathDirection, pfLeadTime, *path) :
-                         steerToStayOnPath (pfLeadTime, *path));
-
-                    // add in to steeringForce
-                    steeringForce += pathFollow * 0.5;
-                }
-            }
+            // move forward, plus whatever the arbiter decides
+            const Vec3 steeringForce = forward() + arbiter.steer (*this,
+                                                                  elapsedTime);
 
             // return steering constrained to global XZ "ground" plane
             return steeringForce.setYtoZero ();
         }
 
+        // the behaviors combined by determineCombinedSteering
+        // (parameter names commented out to prevent compiler warning from "-W")
+
+        Vec3 steerToAvoidObstaclesBehavior (const float /* elapsedTime */)
+        {
+            const float oTime = 6; // minTimeToCollision = 6 seconds
+            return (gUseObstacleField ?
+                    steerToAvoidObstacleField (oTime, *getObstacleField ()) :
+                    steerToAvoidObstacles (oTime, gObstacles));
+        }
+
+        Vec3 steerToAvoidNeighborsBehavior (const float /* elapsedTime */)
+        {
+            const float caLeadTime = 3;
+
+            // find all neighbors within maxRadius using proximity database
+            // (radius is largest distance between vehicles traveling head-on
+            // where a collision is possible within caLeadTime seconds.)
+            const float maxRadius = caLeadTime * maxSpeed() * 2;
+            neighbors.clear();
+            proximityToken->findNeighbors (position(), maxRadius, neighbors);
+
+            return steerToAvoidNeighbors (caLeadTime, neighbors);
+        }
+
+        Vec3 steerForWanderBehavior (const float elapsedTime)
+        {
+            // add in wander component (according to user switch)
+            return gWanderSwitch ? steerForWander (elapsedTime) : Vec3::zero;
+        }
+
+        Vec3 steerToFollowPathBehavior (const float /* elapsedTime */)
+        {
+            // do (interactively) selected type of path following
+            const float pfLeadTime = 3;
+            return (gUseDirectedPathFollowing ?
+                    (gUseFlowField ?
+                     steerToFollowFlowField (pathDirection, pfLeadTime,
+                                             *getFlowField (), *path) :
+                     steerToFollowPath (pathDirection, pfLeadTime, *path)) :
+                    steerToStayOnPath (pfLeadTime, *path));
+        }
+
+        // shared by all Pedestrians, so its counters cover the whole crowd
+        static SteeringArbiter<Pedestrian> arbiter;
+
 
         // draw this pedestrian into scene
         void draw (void)
@@ -369,6 +384,7 @@ namespace {
 
 
     AVGroup Pedestrian::neighbors;
+    SteeringArbiter<Pedestrian> Pedestrian::arbiter;
 
 
     // ----------------------------------------------------------------------------
@@ -464,6 +480,34 @@ namespace {
     }
 
 
+    // flow field precomputed from the test path, shared by all pedestrians
+    PathwayFlowField* getFlowField (void)
+    {
+        if (gFlowField == NULL)
+        {
+            gFlowField = new PathwayFlowField (*getTestPath (), 0.5f, 6, 5);
+        }
+        return gFlowField;
+    }
+
+
+    // distance field baked from the (static) obstacles, shared by all
+    // pedestrians: a single layer on the ground covering the test path
+    ObstacleDistanceField* getObstacleField (void)
+    {
+        if (gObstacleField == NULL)
+        {
+            getTestPath (); // places the obstacles
+            gObstacleField = new ObstacleDistanceField;
+            gObstacleField->bake (gObstacles,
+                                  Vec3 (-30, 0, -10),
+                                  Vec3 (75, 0, 70),
+                                  0.5f);
+        }
+        return gObstacleField;
+    }
+
+
     // ----------------------------------------------------------------------------
     // OpenSteerDemo PlugIn
 
@@ -498,6 +542,9 @@ namespace {
 
         void update (const float currentTime, const float elapsedTime)
         {
+            // rebuild the shared flow field if the path changed
+            if (gUseFlowField) getFlowField ()->update ();
+
             // update each Pedestrian
             for (iterator i = crowd.begin(); i != crowd.end(); i++)
             {
@@ -568,6 +615,10 @@ namespace {
                 status << "Stay on the path.";
             status << "\n[F5] Wander: ";
             if (gWanderSwitch) status << "yes"; else status << "no";
+            status << "\n[F7] Flow field: ";
+            if (gUseFlowField) status << "yes"; else status << "no";
+            status << "\n[F8] Obstacle distance field: ";
+            if (gUseObstacleField) status << "yes"; else status << "no";
             status << std::endl;
             const float h = drawGetWindowHeight ();
             const Vec3 screenLocation (10, h-50, 0);
@@ -665,7 +716,28 @@ namespace {
             case 3:  nextPD ();                                             break;
             case 4: gUseDirectedPathFollowing = !gUseDirectedPathFollowing; break;
             case 5: gWanderSwitch = !gWanderSwitch;                         break;
+            case 6: printArbiterStats ();                                   break;
+            case 7: gUseFlowField = !gUseFlowField;                         break;
+            case 8: gUseObstacleField = !gUseObstacleField;                 break;
+            }
+        }
+
+        // how often each steering behavior ran since the last call
+        void printArbiterStats (void)
+        {
+            SteeringArbiter<Pedestrian>& a = Pedestrian::arbiter;
+            for (int i = 0; i < a.behaviorCount (); i++)
+            {
+                const SteeringArbiter<Pedestrian>::Behavior& b = a.behavior (i);
+                std::ostringstream message;
+                message << "  " << b.name << ": "
+                        << b.evaluated << " evaluated, "
+                        << b.active << " active, "
+                        << b.leaked << " leaked, "
+                        << b.skipped << " skipped" << std::ends;
+                OpenSteerDemo::printMessage (message);
             }
+            a.resetCounters ();
         }
 
         void printMiniHelpForFunctionKeys (void)
@@ -680,6 +752,9 @@ namespace {
             OpenSteerDemo::printMessage ("  F3     use next proximity database.");
             OpenSteerDemo::printMessage ("  F4     toggle directed path follow.");
             OpenSteerDemo::printMessage ("  F5     toggle wander component on/off.");
+            OpenSteerDemo::printMessage ("  F6     print steering arbitration counts.");
+            OpenSteerDemo::printMessage ("  F7     toggle shared path flow field.");
+            OpenSteerDemo::printMessage ("  F8     toggle baked obstacle distance field.");
             OpenSteerDemo::printMessage ("");
         }
 
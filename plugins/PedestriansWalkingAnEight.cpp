@@ -40,6 +40,7 @@
 #include <iomanip>
 #include <sstream>
 #include "OpenSteer/PolylineSegmentedPathwaySingleRadius.h"
+#include "OpenSteer/PathwayFlowField.h"
 #include "OpenSteer/SimpleVehicle.h"
 #include "OpenSteer/OpenSteerDemo.h"
 #include "OpenSteer/Proximity.h"
@@ -65,10 +66,14 @@ namespace {
     // creates a path for the PlugIn
     PolylineSegmentedPathwaySingleRadius* getTestPath (void);
     PolylineSegmentedPathwaySingleRadius* gTestPath = NULL;
+    // creates the flow field precomputed from the test path
+    PathwayFlowField* getFlowField (void);
+    PathwayFlowField* gFlowField = NULL;
     ObstacleGroup gObstacles;
     Vec3 gEndpoint0;
     Vec3 gEndpoint1;
     bool gUseDirectedPathFollowing = true;
+    bool gUseFlowField = false;
     
     // this was added for debugging tool, but I might as well leave it in
     bool gWanderSwitch = true;
@@ -237,7 +242,10 @@ public:
                     const float pfLeadTime = 3;
                     const Vec3 pathFollow =
                         (gUseDirectedPathFollowing ?
-                         steerToFollowPath (pathDirection, pfLeadTime, *path) :
+                         (gUseFlowField ?
+                          steerToFollowFlowField (pathDirection, pfLeadTime,
+                                                  *getFlowField (), *path) :
+                          steerToFollowPath (pathDirection, pfLeadTime, *path)) :
                          steerToStayOnPath (pfLeadTime, *path));
                     
                     // add in to steeringForce
@@ -414,6 +422,20 @@ PolylineSegmentedPathwaySingleRadius* getTestPath (void)
 }
 
 
+/**
+ * Creates the flow field precomputed from the test path and shared by all
+ * pedestrians.
+ */
+PathwayFlowField* getFlowField (void)
+{
+    if (gFlowField == NULL)
+    {
+        gFlowField = new PathwayFlowField (*getTestPath (), 0.5f, 6, 5);
+    }
+    return gFlowField;
+}
+
+
 // ----------------------------------------------------------------------------
 // OpenSteerDemo PlugIn
 
@@ -448,6 +470,9 @@ public:
     
     void update (const float currentTime, const float elapsedTime)
     {
+        // rebuild the shared flow field if the path changed
+        if (gUseFlowField) getFlowField ()->update ();
+        
         // update each Pedestrian
         for (iterator i = crowd.begin(); i != crowd.end(); i++)
         {
@@ -518,6 +543,8 @@ public:
             status << "Stay on the path.";
         status << "\n[F5] Wander: ";
         if (gWanderSwitch) status << "yes"; else status << "no";
+        status << "\n[F6] Flow field: ";
+        if (gUseFlowField) status << "yes"; else status << "no";
         status << std::endl;
         const float h = drawGetWindowHeight ();
         const Vec3 screenLocation (10, h-50, 0);
@@ -594,6 +621,7 @@ public:
             case 3:  nextPD ();                                             break;
             case 4: gUseDirectedPathFollowing = !gUseDirectedPathFollowing; break;
             case 5: gWanderSwitch = !gWanderSwitch;                         break;
+            case 6: gUseFlowField = !gUseFlowField;                         break;
         }
     }
     
@@ -609,6 +637,7 @@ public:
         OpenSteerDemo::printMessage ("  F3     use next proximity database.");
         OpenSteerDemo::printMessage ("  F4     toggle directed path follow.");
         OpenSteerDemo::printMessage ("  F5     toggle wander component on/off.");
+        OpenSteerDemo::printMessage ("  F6     toggle shared path flow field.");
         OpenSteerDemo::printMessage ("");
     }
     
@@ -0,0 +1,726 @@
+/**
+ * OpenSteer -- Steering Behaviors for Autonomous Characters
+ *
+ * Copyright (c) 2002-2005, Sony Computer Entertainment America
+ * Original author: Craig Reynolds <craig_reynolds@playstation.sony.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+#include "OpenSteer/CatmullRomSegmentedPathway.h"
+
+
+// Include std::swap, std::upper_bound, std::min, std::max
+#include <algorithm>
+
+// Include std::sqrt
+#include <cmath>
+
+// Include assert
+#include <cassert>
+
+
+// Include OpenSteer::mapPointToPathAlike, OpenSteer::mapDistanceToPathAlikeNearSegment, OpenSteer::mapPointsAndOffsetsToPathAlike
+#include "OpenSteer/QueryPathAlike.h"
+
+// Include OpenSteer::PointToPathMapping, OpenSteer::PathDistanceToPointMapping, OpenSteer::PointToPathDistanceMapping
+#include "OpenSteer/QueryPathAlikeMappings.h"
+
+// Include OpenSteer::clamp, OpenSteer::modulo, OpenSteer::shrinkToFit
+#include "OpenSteer/Utilities.h"
+
+
+
+namespace {
+    
+    typedef OpenSteer::CatmullRomSegmentedPathway::size_type size_type;
+    
+    
+    /**
+     * Nodes and weights of the five point Gauss-Legendre quadrature on
+     * <code>[-1, 1]</code>.
+     */
+    float const gaussNodes[] = { 0.0f, 
+                                 -0.5384693101f, 0.5384693101f, 
+                                 -0.9061798459f, 0.9061798459f };
+    float const gaussWeights[] = { 0.5688888889f, 
+                                   0.4786286705f, 0.4786286705f, 
+                                   0.2369268851f, 0.2369268851f };
+    
+    
+    /**
+     * Newton iterations used to refine the nearest curve parameter to a 
+     * point.
+     */
+    int const closestPointIterations = 4;
+    
+    
+    /**
+     * Knot interval of centripetal Catmull-Rom splines between @a lhs and 
+     * @a rhs.
+     */
+    float knotInterval( OpenSteer::Vec3 const& lhs, OpenSteer::Vec3 const& rhs ) {
+        return std::sqrt( OpenSteer::distance( lhs, rhs ) );
+    }
+    
+    
+    /**
+     * Returns @c true if all radii in the range @a first to @a last (excluding
+     * @a last) are greater or equal to @c 0, @c false otherwise.
+     */
+    bool allRadiiNonNegative( float const* first, float const* last ) {
+        for ( ; first != last; ++first ) {
+            if ( *first < 0.0f ) {
+                return false;
+            }
+        }
+        return true;
+    }
+    
+} // namespace anonymous
+
+
+
+
+OpenSteer::CatmullRomSegmentedPathway::CatmullRomSegmentedPathway()
+    : points_(), radii_(), segments_(), arcLengths_(), samplePoints_(), segmentStartDistances_( 1, 0.0f ), samplesPerSegment_( 16 ), closedCycle_( false )
+{
+    
+}
+
+
+
+
+OpenSteer::CatmullRomSegmentedPathway::CatmullRomSegmentedPathway( size_type numOfPoints,
+                                                                   Vec3 const points[],
+                                                                   float const radii[],
+                                                                   bool closedCycle,
+                                                                   size_type samplesPerSegment )
+    : points_(), radii_(), segments_(), arcLengths_(), samplePoints_(), segmentStartDistances_( 1, 0.0f ), samplesPerSegment_( samplesPerSegment ), closedCycle_( closedCycle )
+{
+    assert( 0 < samplesPerSegment && "At least one arc length sample per segment needed." );
+    setPathway( numOfPoints, points, radii, closedCycle );
+}
+
+
+
+
+OpenSteer::CatmullRomSegmentedPathway::CatmullRomSegmentedPathway( CatmullRomSegmentedPathway const& other )
+    : SegmentedPathway( other ), points_( other.points_ ), radii_( other.radii_ ), segments_( other.segments_ ), arcLengths_( other.arcLengths_ ), samplePoints_( other.samplePoints_ ), segmentStartDistances_( other.segmentStartDistances_ ), samplesPerSegment_( other.samplesPerSegment_ ), closedCycle_( other.closedCycle_ )
+{
+    // Nothing to do.
+}
+
+
+
+
+OpenSteer::CatmullRomSegmentedPathway::~CatmullRomSegmentedPathway()
+{
+    // Nothing to do.
+}
+
+
+
+
+OpenSteer::CatmullRomSegmentedPathway& 
+OpenSteer::CatmullRomSegmentedPathway::operator=( CatmullRomSegmentedPathway other )
+{
+    swap( other );
+    return *this;
+}
+
+
+
+
+void 
+OpenSteer::CatmullRomSegmentedPathway::swap( CatmullRomSegmentedPathway& other )
+{
+    points_.swap( other.points_ );
+    radii_.swap( other.radii_ );
+    segments_.swap( other.segments_ );
+    arcLengths_.swap( other.arcLengths_ );
+    samplePoints_.swap( other.samplePoints_ );
+    segmentStartDistances_.swap( other.segmentStartDistances_ );
+    std::swap( samplesPerSegment_, other.samplesPerSegment_ );
+    std::swap( closedCycle_, other.closedCycle_ );
+}
+
+
+
+
+void 
+OpenSteer::CatmullRomSegmentedPathway::setPathway( size_type numOfPoints,
+                                                   Vec3 const points[],
+                                                   float const radii[],
+                                                   bool closedCycle )
+{
+    assert( 1 < numOfPoints && "Pathway must have at least two distinct points." );
+    assert( allRadiiNonNegative( radii, radii + numOfPoints ) && "All radii must be positive or zero." );
+    
+    closedCycle_ = closedCycle;
+    
+    points_.assign( points, points + numOfPoints );
+    radii_.assign( radii, radii + numOfPoints );
+    if ( closedCycle_ ) {
+        points_.push_back( points_.front() );
+        radii_.push_back( radii_.front() );
+    }
+    
+    size_type const segCount = points_.size() - 1;
+    segments_.resize( segCount );
+    arcLengths_.resize( segCount * ( samplesPerSegment_ + 1 ) );
+    samplePoints_.resize( segCount * ( samplesPerSegment_ + 1 ) );
+    segmentStartDistances_.resize( segCount + 1 );
+    
+    shrinkToFit( points_ );
+    shrinkToFit( radii_ );
+    shrinkToFit( segments_ );
+    shrinkToFit( arcLengths_ );
+    shrinkToFit( samplePoints_ );
+    shrinkToFit( segmentStartDistances_ );
+    
+    for ( size_type i = 0; i < segCount; ++i ) {
+        updateSegment( i );
+    }
+    updateSegmentStartDistances();
+}
+
+
+
+
+void 
+OpenSteer::CatmullRomSegmentedPathway::movePoints( size_type startIndex,
+                                                   size_type numOfPoints,
+                                                   Vec3 const points[] )
+{
+    assert( ( startIndex < ( pointCount() - ( isCyclic() ? 1 : 0 ) ) ) && 
+            "startIndex must be inside index range." );
+    assert( ( ( startIndex + numOfPoints ) <= ( pointCount() - ( isCyclic() ? 1 : 0 ) ) ) && 
+            "The max. index of a point to set must be inside the index range." ); 
+    
+    std::copy( points, points + numOfPoints, points_.begin() + startIndex );
+    
+    // If the first point is changed and the path is cyclic also change the
+    // last point, which is just a copy of the first point.
+    if ( isCyclic() && ( 0 == startIndex ) ) {
+        points_.back() = points_.front();
+    }
+    
+    // Point k shapes the segments k - 2 to k + 1.
+    size_type const segCount = segmentCount();
+    if ( isCyclic() ) {
+        size_type const updateCount = std::min( numOfPoints + 3, segCount );
+        size_type const firstSegmentIndex = ( startIndex + segCount - 2 ) % segCount;
+        for ( size_type i = 0; i < updateCount; ++i ) {
+            updateSegment( ( firstSegmentIndex + i ) % segCount );
+        }
+    } else {
+        size_type const firstSegmentIndex = ( 2 < startIndex ) ? startIndex - 2 : 0;
+        size_type const lastSegmentIndex = std::min( startIndex + numOfPoints + 1, segCount );
+        for ( size_type i = firstSegmentIndex; i < lastSegmentIndex; ++i ) {
+            updateSegment( i );
+        }
+    }
+    
+    updateSegmentStartDistances();
+}
+
+
+
+
+float 
+OpenSteer::CatmullRomSegmentedPathway::pointRadius( size_type pointIndex ) const
+{
+    assert( pointIndex < pointCount() && "pointIndex out of range." );
+    return radii_[ pointIndex ];
+}
+
+
+
+
+void 
+OpenSteer::CatmullRomSegmentedPathway::setPointRadius( size_type pointIndex, float r )
+{
+    assert( pointIndex < pointCount() && "pointIndex out of range." );
+    assert( 0.0f <= r && "No negative radii allowed." );
+    
+    radii_[ pointIndex ] = r;
+    
+    // Keep the radius of the copy of the first point closing the cycle in 
+    // sync.
+    if ( isCyclic() ) {
+        if ( 0 == pointIndex ) {
+            radii_.back() = r;
+        } else if ( pointCount() - 1 == pointIndex ) {
+            radii_.front() = r;
+        }
+    }
+}
+
+
+
+
+OpenSteer::CatmullRomSegmentedPathway::size_type 
+OpenSteer::CatmullRomSegmentedPathway::samplesPerSegment() const
+{
+    return samplesPerSegment_;
+}
+
+
+
+
+float 
+OpenSteer::CatmullRomSegmentedPathway::mapSegmentDistanceToParameter( size_type segmentIndex, 
+                                                                      float segmentDistance ) const
+{
+    assert( segmentIndex < segmentCount() && "segmentIndex out of range." );
+    
+    std::vector< float >::const_iterator const first = arcLengths_.begin() + segmentIndex * ( samplesPerSegment_ + 1 );
+    std::vector< float >::const_iterator const last = first + samplesPerSegment_ + 1;
+    float const distance = clamp( segmentDistance, 0.0f, *( last - 1 ) );
+    
+    // Find the table interval containing the distance and interpolate 
+    // linearly inside of it.
+    size_type sample = std::upper_bound( first + 1, last, distance ) - first;
+    sample = std::min( sample, samplesPerSegment_ ) - 1;
+    float const intervalStart = first[ sample ];
+    float const intervalLength = first[ sample + 1 ] - intervalStart;
+    float const parameterStep = 1.0f / static_cast< float >( samplesPerSegment_ );
+    float const parameterStart = static_cast< float >( sample ) * parameterStep;
+    float parameter = parameterStart;
+    if ( 0.0f < intervalLength ) {
+        parameter += parameterStep * ( distance - intervalStart ) / intervalLength;
+    }
+    
+    // One Newton step on the arc length corrects the linear interpolation.
+    float const speed = curveDerivative( segmentIndex, parameter ).length();
+    if ( 0.0f < speed ) {
+        float const error = intervalStart + arcLength( segmentIndex, parameterStart, parameter ) - distance;
+        parameter = clamp( parameter - error / speed, parameterStart, parameterStart + parameterStep );
+    }
+    
+    return parameter;
+}
+
+
+
+
+float 
+OpenSteer::CatmullRomSegmentedPathway::mapParameterToSegmentDistance( size_type segmentIndex, 
+                                                                      float parameter ) const
+{
+    assert( segmentIndex < segmentCount() && "segmentIndex out of range." );
+    
+    float const t = clamp( parameter, 0.0f, 1.0f );
+    size_type const sample = std::min( static_cast< size_type >( t * static_cast< float >( samplesPerSegment_ ) ), samplesPerSegment_ - 1 );
+    float const parameterStart = static_cast< float >( sample ) / static_cast< float >( samplesPerSegment_ );
+    
+    return arcLengths_[ segmentIndex * ( samplesPerSegment_ + 1 ) + sample ] + arcLength( segmentIndex, parameterStart, t );
+}
+
+
+
+
+bool
+OpenSteer::CatmullRomSegmentedPathway::isValid() const 
+{
+    return pointCount() > 1;
+}
+
+
+
+
+OpenSteer::Vec3 
+OpenSteer::CatmullRomSegmentedPathway::mapPointToPath (const Vec3& point,
+                                                       Vec3& tangent,
+                                                       float& outside) const
+{
+    PointToPathMapping mapping;
+    mapPointToPathAlike( *this, point, mapping );
+    tangent = mapping.tangent;
+    outside = mapping.distancePointToPath;
+    return mapping.pointOnPathCenterLine;    
+}
+
+
+
+
+OpenSteer::Vec3 
+OpenSteer::CatmullRomSegmentedPathway::mapPathDistanceToPoint (float pathDistance) const
+{
+    float const distance = isCyclic() ? modulo( pathDistance, length() ) : clamp( pathDistance, 0.0f, length() );
+    
+    // segmentStartDistances_ starts with 0 and ends with the pathway length,
+    // the segment containing distance starts before the first greater entry.
+    size_type const greaterIndex = std::upper_bound( segmentStartDistances_.begin(), segmentStartDistances_.end(), distance ) - segmentStartDistances_.begin();
+    size_type const segmentIndex = clamp( greaterIndex, size_type( 1 ), segmentCount() ) - 1;
+    
+    PathDistanceToPointMapping mapping;
+    mapDistanceToPathAlikeNearSegment( *this, pathDistance, segmentIndex, segmentStartDistances_[ segmentIndex ], mapping );
+    return mapping.pointOnPathCenterLine;    
+}
+
+
+
+
+float 
+OpenSteer::CatmullRomSegmentedPathway::mapPointToPathDistance (const Vec3& point) const
+{
+    PointToPathDistanceMapping mapping;
+    mapPointToPathAlike( *this, point, mapping );
+    return mapping.distanceOnPath;    
+}
+
+
+
+
+void 
+OpenSteer::CatmullRomSegmentedPathway::mapPointsToPath( size_t count, 
+                                                        Vec3 const* points, 
+                                                        float const* offsets, 
+                                                        PointMapping* mappings ) const
+{
+    mapPointsAndOffsetsToPathAlike( *this, points, offsets, count, mappings );
+}
+
+
+
+
+bool 
+OpenSteer::CatmullRomSegmentedPathway::isCyclic() const
+{
+    return closedCycle_;
+}
+
+
+
+
+float 
+OpenSteer::CatmullRomSegmentedPathway::length() const
+{
+    return segmentStartDistances_.back();
+}
+
+
+
+
+OpenSteer::CatmullRomSegmentedPathway::size_type 
+OpenSteer::CatmullRomSegmentedPathway::pointCount() const 
+{
+    return points_.size();
+}
+
+
+
+
+OpenSteer::Vec3 
+OpenSteer::CatmullRomSegmentedPathway::point( size_type pointIndex ) const
+{
+    assert( pointIndex < pointCount() && "pointIndex out of range." );
+    return points_[ pointIndex ];
+}
+
+
+
+
+OpenSteer::CatmullRomSegmentedPathway::size_type 
+OpenSteer::CatmullRomSegmentedPathway::segmentCount() const
+{
+    return segments_.size();
+}
+
+
+
+
+float 
+OpenSteer::CatmullRomSegmentedPathway::segmentLength( size_type segmentIndex ) const
+{
+    assert( segmentIndex < segmentCount() && "segmentIndex out of range." );
+    return arcLengths_[ segmentIndex * ( samplesPerSegment_ + 1 ) + samplesPerSegment_ ];
+}
+
+
+
+
+OpenSteer::Vec3 
+OpenSteer::CatmullRomSegmentedPathway::segmentStart( size_type segmentIndex ) const
+{
+    assert( segmentIndex < segmentCount() && "segmentIndex out of range." );
+    return points_[ segmentIndex ];
+}
+
+
+
+
+OpenSteer::Vec3 
+OpenSteer::CatmullRomSegmentedPathway::segmentEnd( size_type segmentIndex ) const
+{
+    assert( segmentIndex < segmentCount() && "segmentIndex out of range." );
+    return points_[ segmentIndex + 1 ];
+}
+
+
+
+
+float 
+OpenSteer::CatmullRomSegmentedPathway::mapPointToSegmentDistance( size_type segmentIndex, 
+                                                                  Vec3 const& point ) const
+{
+    return mapParameterToSegmentDistance( segmentIndex, mapPointToParameter( segmentIndex, point ) );
+}
+
+
+
+
+OpenSteer::Vec3 
+OpenSteer::CatmullRomSegmentedPathway::mapSegmentDistanceToPoint( size_type segmentIndex, 
+                                                                  float segmentDistance ) const
+{
+    return curvePoint( segmentIndex, mapSegmentDistanceToParameter( segmentIndex, segmentDistance ) );
+}
+
+
+
+
+float 
+OpenSteer::CatmullRomSegmentedPathway::mapSegmentDistanceToRadius( size_type segmentIndex, 
+                                                                   float distanceOnSegment ) const
+{
+    assert( segmentIndex < segmentCount() && "segmentIndex out of range." );
+    
+    float const segLength = segmentLength( segmentIndex );
+    float const weight = ( 0.0f < segLength ) ? clamp( distanceOnSegment / segLength, 0.0f, 1.0f ) : 0.0f;
+    return radii_[ segmentIndex ] + weight * ( radii_[ segmentIndex + 1 ] - radii_[ segmentIndex ] );
+}
+
+
+
+
+OpenSteer::Vec3 
+OpenSteer::CatmullRomSegmentedPathway::mapSegmentDistanceToTangent( size_type segmentIndex, 
+                                                                    float segmentDistance ) const
+{
+    return tangentAt( segmentIndex, mapSegmentDistanceToParameter( segmentIndex, segmentDistance ) );
+}
+
+
+
+
+void 
+OpenSteer::CatmullRomSegmentedPathway::mapDistanceToSegmentPointAndTangentAndRadius( size_type segmentIndex,
+                                                                                     float distance,
+                                                                                     Vec3& pointOnPath,
+                                                                                     Vec3& tangent,
+                                                                                     float& radius ) const
+{
+    float const parameter = mapSegmentDistanceToParameter( segmentIndex, distance );
+    pointOnPath = curvePoint( segmentIndex, parameter );
+    tangent = tangentAt( segmentIndex, parameter );
+    radius = mapSegmentDistanceToRadius( segmentIndex, distance );
+}
+
+
+
+
+void 
+OpenSteer::CatmullRomSegmentedPathway::mapPointToSegmentDistanceAndPointAndTangentAndRadius( size_type segmentIndex,
+                                                                                             Vec3 const& point,
+                                                                                             float& distance,
+                                                                                             Vec3& pointOnPath,
+                                                                                             Vec3& tangent,
+                                                                                             float& radius) const
+{
+    float const parameter = mapPointToParameter( segmentIndex, point );
+    distance = mapParameterToSegmentDistance( segmentIndex, parameter );
+    pointOnPath = curvePoint( segmentIndex, parameter );
+    tangent = tangentAt( segmentIndex, parameter );
+    radius = mapSegmentDistanceToRadius( segmentIndex, distance );
+}
+
+
+
+
+void 
+OpenSteer::CatmullRomSegmentedPathway::updateSegment( size_type segmentIndex )
+{
+    size_type const lastPointIndex = pointCount() - 1;
+    Vec3 const p1 = points_[ segmentIndex ];
+    Vec3 const p2 = points_[ segmentIndex + 1 ];
+    
+    // Neighbours outside of a cyclic pathway wrap around (skipping the copy 
+    // of the first point), otherwise they continue the end segment.
+    Vec3 p0 = 2.0f * p1 - p2;
+    if ( 0 < segmentIndex ) {
+        p0 = points_[ segmentIndex - 1 ];
+    } else if ( isCyclic() ) {
+        p0 = points_[ lastPointIndex - 1 ];
+    }
+    
+    Vec3 p3 = 2.0f * p2 - p1;
+    if ( segmentIndex + 2 <= lastPointIndex ) {
+        p3 = points_[ segmentIndex + 2 ];
+    } else if ( isCyclic() ) {
+        p3 = points_[ 1 ];
+    }
+    
+    // Centripetal parametrization converted to Hermite tangents for the 
+    // unit parameter interval of the segment.
+    float const t01 = knotInterval( p0, p1 );
+    float const t12 = knotInterval( p1, p2 );
+    float const t23 = knotInterval( p2, p3 );
+    
+    Vec3 m1 = p2 - p1;
+    if ( 0.0f < t01 ) {
+        m1 += t12 * ( ( p1 - p0 ) / t01 - ( p2 - p0 ) / ( t01 + t12 ) );
+    }
+    Vec3 m2 = p2 - p1;
+    if ( 0.0f < t23 ) {
+        m2 += t12 * ( ( p3 - p2 ) / t23 - ( p3 - p1 ) / ( t12 + t23 ) );
+    }
+    
+    Segment& segment = segments_[ segmentIndex ];
+    segment.c0 = p1;
+    segment.c1 = m1;
+    segment.c2 = -3.0f * p1 + 3.0f * p2 - 2.0f * m1 - m2;
+    segment.c3 = 2.0f * p1 - 2.0f * p2 + m1 + m2;
+    
+    // Fill the arc length table and the sample points.
+    size_type const firstSample = segmentIndex * ( samplesPerSegment_ + 1 );
+    float const parameterStep = 1.0f / static_cast< float >( samplesPerSegment_ );
+    arcLengths_[ firstSample ] = 0.0f;
+    samplePoints_[ firstSample ] = p1;
+    for ( size_type i = 1; i <= samplesPerSegment_; ++i ) {
+        float const parameter = static_cast< float >( i ) * parameterStep;
+        arcLengths_[ firstSample + i ] = arcLengths_[ firstSample + i - 1 ] + arcLength( segmentIndex, parameter - parameterStep, parameter );
+        samplePoints_[ firstSample + i ] = curvePoint( segmentIndex, parameter );
+    }
+    samplePoints_[ firstSample + samplesPerSegment_ ] = p2;
+}
+
+
+
+
+void 
+OpenSteer::CatmullRomSegmentedPathway::updateSegmentStartDistances()
+{
+    segmentStartDistances_[ 0 ] = 0.0f;
+    for ( size_type i = 0; i < segmentCount(); ++i ) {
+        segmentStartDistances_[ i + 1 ] = segmentStartDistances_[ i ] + segmentLength( i );
+    }
+}
+
+
+
+
+OpenSteer::Vec3 
+OpenSteer::CatmullRomSegmentedPathway::curvePoint( size_type segmentIndex, float parameter ) const
+{
+    Segment const& segment = segments_[ segmentIndex ];
+    return segment.c0 + parameter * ( segment.c1 + parameter * ( segment.c2 + parameter * segment.c3 ) );
+}
+
+
+
+
+OpenSteer::Vec3 
+OpenSteer::CatmullRomSegmentedPathway::curveDerivative( size_type segmentIndex, float parameter ) const
+{
+    Segment const& segment = segments_[ segmentIndex ];
+    return segment.c1 + parameter * ( 2.0f * segment.c2 + parameter * 3.0f * segment.c3 );
+}
+
+
+
+
+OpenSteer::Vec3 
+OpenSteer::CatmullRomSegmentedPathway::curveSecondDerivative( size_type segmentIndex, float parameter ) const
+{
+    Segment const& segment = segments_[ segmentIndex ];
+    return 2.0f * segment.c2 + parameter * 6.0f * segment.c3;
+}
+
+
+
+
+float 
+OpenSteer::CatmullRomSegmentedPathway::arcLength( size_type segmentIndex, float first, float last ) const
+{
+    float const halfWidth = 0.5f * ( last - first );
+    float const center = 0.5f * ( last + first );
+    
+    float sum = 0.0f;
+    for ( int i = 0; i < 5; ++i ) {
+        sum += gaussWeights[ i ] * curveDerivative( segmentIndex, center + halfWidth * gaussNodes[ i ] ).length();
+    }
+    
+    return halfWidth * sum;
+}
+
+
+
+
+float 
+OpenSteer::CatmullRomSegmentedPathway::mapPointToParameter( size_type segmentIndex, Vec3 const& point ) const
+{
+    assert( segmentIndex < segmentCount() && "segmentIndex out of range." );
+    
+    // Start at the nearest sample point.
+    size_type const firstSample = segmentIndex * ( samplesPerSegment_ + 1 );
+    size_type nearestSample = 0;
+    float nearestDistanceSquared = ( samplePoints_[ firstSample ] - point ).lengthSquared();
+    for ( size_type i = 1; i <= samplesPerSegment_; ++i ) {
+        float const distanceSquared = ( samplePoints_[ firstSample + i ] - point ).lengthSquared();
+        if ( distanceSquared < nearestDistanceSquared ) {
+            nearestDistanceSquared = distanceSquared;
+            nearestSample = i;
+        }
+    }
+    
+    // Newton iterations on the derivative of the squared distance, 
+    // restricted to the table intervals adjacent to the nearest sample.
+    float const parameterStep = 1.0f / static_cast< float >( samplesPerSegment_ );
+    float const lowerBound = static_cast< float >( ( 0 < nearestSample ) ? nearestSample - 1 : 0 ) * parameterStep;
+    float const upperBound = static_cast< float >( std::min( nearestSample + 1, samplesPerSegment_ ) ) * parameterStep;
+    float parameter = static_cast< float >( nearestSample ) * parameterStep;
+    for ( int i = 0; i < closestPointIterations; ++i ) {
+        Vec3 const offset = curvePoint( segmentIndex, parameter ) - point;
+        Vec3 const derivative = curveDerivative( segmentIndex, parameter );
+        float const slope = offset.dot( derivative );
+        float const curvature = derivative.lengthSquared() + offset.dot( curveSecondDerivative( segmentIndex, parameter ) );
+        if ( curvature <= 0.0f ) {
+            break;
+        }
+        parameter = clamp( parameter - slope / curvature, lowerBound, upperBound );
+    }
+    
+    return parameter;
+}
+
+
+
+
+OpenSteer::Vec3 
+OpenSteer::CatmullRomSegmentedPathway::tangentAt( size_type segmentIndex, float parameter ) const
+{
+    Vec3 const derivative = curveDerivative( segmentIndex, parameter );
+    float const speed = derivative.length();
+    if ( 0.0f < speed ) {
+        return derivative / speed;
+    }
+    return ( segmentEnd( segmentIndex ) - segmentStart( segmentIndex ) ).normalize();
+}
@@ -0,0 +1,840 @@
+/**
+ * OpenSteer -- Steering Behaviors for Autonomous Characters
+ *
+ * Copyright (c) 2002-2005, Sony Computer Entertainment America
+ * Original author: Craig Reynolds <craig_reynolds@playstation.sony.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+#include "OpenSteer/GridPathPlanner.h"
+
+
+// Include std::push_heap, std::pop_heap, std::nth_element, std::min, std::max
+#include <algorithm>
+
+// Include assert
+#include <cassert>
+
+
+// Include OpenSteer::PolylineSegmentedPathwaySegmentRadii
+#include "OpenSteer/PolylineSegmentedPathwaySegmentRadii.h"
+
+
+
+namespace {
+    
+    typedef OpenSteer::GridPathPlanner::size_type size_type;
+    
+    /**
+     * Cost of unreachable cells, leaves room to add heuristics and the key
+     * modifier without overflow.
+     */
+    int const unreachable = 1 << 29;
+    
+    /**
+     * Key modifier value at which the search queue is rebuilt to restart
+     * the key modifier at @c 0.
+     */
+    int const maxKeyModifier = 1 << 28;
+    
+    /**
+     * Diagonal distance between cell centers in cells.
+     */
+    float const diagonalDistance = 1.41421356f;
+    
+    
+    
+    /**
+     * Looks up the precomputed cell clearances for 
+     * @c PlanningGrid::makeWaypoints.
+     */
+    class PrecomputedClearance {
+    public:
+        explicit PrecomputedClearance( std::vector< float > const& clearances ) : clearances_( clearances ) {}
+        
+        float operator()( int cell ) const {
+            return clearances_[ cell ];
+        }
+        
+    private:
+        std::vector< float > const& clearances_;
+    };
+    
+    
+    /**
+     * Drops the entries with the smallest @c lastUse from @a container until
+     * no more than @a capacity are left and calls @a dropped for each of 
+     * them. @c lastUse values must be unique.
+     */
+    template< typename Container, typename Dropped >
+    void dropLeastRecentlyUsed( Container& container, size_type capacity, Dropped dropped ) {
+        if ( container.size() <= capacity ) {
+            return;
+        }
+        
+        std::vector< size_type > uses;
+        uses.reserve( container.size() );
+        for ( typename Container::const_iterator it = container.begin(); it != container.end(); ++it ) {
+            uses.push_back( dropped.lastUse( it->second ) );
+        }
+        
+        size_type const dropCount = container.size() - capacity;
+        std::nth_element( uses.begin(), uses.begin() + ( dropCount - 1 ), uses.end() );
+        size_type const newestDropped = uses[ dropCount - 1 ];
+        
+        typename Container::iterator it = container.begin();
+        while ( it != container.end() ) {
+            if ( dropped.lastUse( it->second ) <= newestDropped ) {
+                dropped( it->second );
+                container.erase( it++ );
+            } else {
+                ++it;
+            }
+        }
+    }
+    
+} // anonymous namespace
+
+
+
+/**
+ * D* Lite search state of one goal cell. Searches backward from the goal so
+ * the state is reused for every start and repaired after cells changed.
+ */
+class OpenSteer::GridPathPlanner::Search {
+public:
+    Search( GridPathPlanner const& planner, int goal );
+    
+    /**
+     * Repairs the search after @a cell changed. Returns the number of 
+     * updated cells.
+     */
+    size_type cellChanged( int cell );
+    
+    /**
+     * Stores the grid route from @a start to the goal in @a cells. Returns
+     * @c false if there is none.
+     */
+    bool findCells( int start, std::vector< int >& cells );
+    
+    size_type lastUse;
+    size_type expandedCells;
+    
+private:
+    struct Entry {
+        int primary;
+        int secondary;
+        int cell;
+    };
+    
+    /**
+     * Orders entries for a min heap.
+     */
+    struct EntryGreater {
+        bool operator()( Entry const& lhs, Entry const& rhs ) const {
+            return ( lhs.primary > rhs.primary ) || ( ( lhs.primary == rhs.primary ) && ( lhs.secondary > rhs.secondary ) );
+        }
+    };
+    
+    Entry key( int cell ) const;
+    int heuristic( int from, int to ) const;
+    void push( int cell );
+    void rebuildQueue();
+    void updateCell( int cell );
+    void computeShortestPath( int start );
+    
+    GridPathPlanner const& planner_;
+    int goal_;
+    // Start of the last search, @c -1 before the first one.
+    int start_;
+    int keyModifier_;
+    std::vector< int > g_;
+    std::vector< int > rhs_;
+    // Min heap, contains outdated entries which are skipped or reinserted 
+    // when popped.
+    std::vector< Entry > queue_;
+}; // class Search
+
+
+
+OpenSteer::GridPathPlanner::Search::Search( GridPathPlanner const& planner, int goal )
+    : lastUse( 0 ), expandedCells( 0 ), planner_( planner ), goal_( goal ), start_( -1 ), keyModifier_( 0 ), 
+      g_( planner.grid_.cellCount(), unreachable ), rhs_( planner.grid_.cellCount(), unreachable ), queue_()
+{
+    rhs_[ goal_ ] = 0;
+}
+
+
+
+size_type 
+OpenSteer::GridPathPlanner::Search::cellChanged( int cell )
+{
+    // Nothing searched yet, so nothing to repair.
+    if ( start_ < 0 ) {
+        return 0;
+    }
+    
+    updateCell( cell );
+    size_type updated = 1;
+    for ( int direction = 0; direction < 8; ++direction ) {
+        int const neighbor = planner_.grid_.neighborCell( cell, direction );
+        if ( 0 <= neighbor ) {
+            updateCell( neighbor );
+            ++updated;
+        }
+    }
+    
+    return updated;
+}
+
+
+
+bool 
+OpenSteer::GridPathPlanner::Search::findCells( int start, std::vector< int >& cells )
+{
+    computeShortestPath( start );
+    
+    cells.clear();
+    if ( unreachable <= g_[ start ] ) {
+        return false;
+    }
+    
+    // Follow the cheapest moves down to the goal.
+    int current = start;
+    cells.push_back( current );
+    while ( current != goal_ ) {
+        if ( g_.size() < cells.size() ) {
+            return false;
+        }
+        
+        int bestCost = unreachable;
+        int next = -1;
+        for ( int direction = 0; direction < 8; ++direction ) {
+            int const cost = planner_.grid_.moveCost( current, direction );
+            if ( 0 <= cost ) {
+                int const neighbor = planner_.grid_.neighborCell( current, direction );
+                int const total = cost + g_[ neighbor ];
+                if ( total < bestCost ) {
+                    bestCost = total;
+                    next = neighbor;
+                }
+            }
+        }
+        
+        if ( next < 0 ) {
+            return false;
+        }
+        current = next;
+        cells.push_back( current );
+    }
+    
+    return true;
+}
+
+
+
+OpenSteer::GridPathPlanner::Search::Entry 
+OpenSteer::GridPathPlanner::Search::key( int cell ) const
+{
+    int const cost = std::min( g_[ cell ], rhs_[ cell ] );
+    Entry const entry = { cost + heuristic( start_, cell ) + keyModifier_, cost, cell };
+    return entry;
+}
+
+
+
+int 
+OpenSteer::GridPathPlanner::Search::heuristic( int from, int to ) const
+{
+    int const cellCountX = planner_.grid_.cellCountX();
+    return PlanningGrid::octileDistance( to % cellCountX - from % cellCountX, to / cellCountX - from / cellCountX );
+}
+
+
+
+void 
+OpenSteer::GridPathPlanner::Search::push( int cell )
+{
+    // Drop outdated entries if they pile up.
+    if ( 4 * g_.size() < queue_.size() ) {
+        rebuildQueue();
+    }
+    
+    queue_.push_back( key( cell ) );
+    std::push_heap( queue_.begin(), queue_.end(), EntryGreater() );
+}
+
+
+
+void 
+OpenSteer::GridPathPlanner::Search::rebuildQueue()
+{
+    queue_.clear();
+    for ( size_type i = 0; i < g_.size(); ++i ) {
+        if ( g_[ i ] != rhs_[ i ] ) {
+            queue_.push_back( key( static_cast< int >( i ) ) );
+        }
+    }
+    std::make_heap( queue_.begin(), queue_.end(), EntryGreater() );
+}
+
+
+
+void 
+OpenSteer::GridPathPlanner::Search::updateCell( int cell )
+{
+    if ( cell != goal_ ) {
+        int best = unreachable;
+        for ( int direction = 0; direction < 8; ++direction ) {
+            int const cost = planner_.grid_.moveCost( cell, direction );
+            if ( 0 <= cost ) {
+                int const neighborCost = g_[ planner_.grid_.neighborCell( cell, direction ) ];
+                if ( neighborCost < unreachable ) {
+                    best = std::min( best, cost + neighborCost );
+                }
+            }
+        }
+        rhs_[ cell ] = best;
+    }
+    
+    if ( g_[ cell ] != rhs_[ cell ] ) {
+        push( cell );
+    }
+}
+
+
+
+void 
+OpenSteer::GridPathPlanner::Search::computeShortestPath( int start )
+{
+    if ( start_ < 0 ) {
+        start_ = start;
+        push( goal_ );
+    } else if ( start != start_ ) {
+        keyModifier_ += heuristic( start_, start );
+        start_ = start;
+        
+        // Restart the key modifier before it could overflow.
+        if ( maxKeyModifier < keyModifier_ ) {
+            keyModifier_ = 0;
+            rebuildQueue();
+        }
+    }
+    
+    EntryGreater const greater = EntryGreater();
+    while ( ! queue_.empty() ) {
+        Entry const top = queue_.front();
+        // Cells with keys equal to the start key are expanded too, they may
+        // lie on the route followed by findCells.
+        if ( greater( top, key( start ) ) && ( rhs_[ start ] == g_[ start ] ) ) {
+            break;
+        }
+        
+        std::pop_heap( queue_.begin(), queue_.end(), greater );
+        queue_.pop_back();
+        
+        int const cell = top.cell;
+        if ( g_[ cell ] == rhs_[ cell ] ) {
+            continue;
+        }
+        
+        Entry const currentKey = key( cell );
+        if ( greater( currentKey, top ) ) {
+            queue_.push_back( currentKey );
+            std::push_heap( queue_.begin(), queue_.end(), greater );
+            continue;
+        }
+        
+        ++expandedCells;
+        if ( g_[ cell ] > rhs_[ cell ] ) {
+            g_[ cell ] = rhs_[ cell ];
+        } else {
+            g_[ cell ] = unreachable;
+            updateCell( cell );
+        }
+        
+        for ( int direction = 0; direction < 8; ++direction ) {
+            int const neighbor = planner_.grid_.neighborCell( cell, direction );
+            if ( 0 <= neighbor ) {
+                updateCell( neighbor );
+            }
+        }
+    }
+}
+
+
+
+
+namespace {
+    
+    /**
+     * Helps @c dropLeastRecentlyUsed with the route cache.
+     */
+    struct DropRoute {
+        template< typename CachedRoute >
+        size_type lastUse( CachedRoute const& route ) const {
+            return route.lastUse;
+        }
+        
+        template< typename CachedRoute >
+        void operator()( CachedRoute const& ) const {
+            // Nothing to do.
+        }
+    };
+    
+    
+    /**
+     * Helps @c dropLeastRecentlyUsed with the search cache.
+     */
+    struct DropSearch {
+        template< typename Search >
+        size_type lastUse( Search* search ) const {
+            return search->lastUse;
+        }
+        
+        template< typename Search >
+        void operator()( Search* search ) const {
+            delete search;
+        }
+    };
+    
+} // anonymous namespace
+
+
+
+
+OpenSteer::GridPathPlanner::GridPathPlanner( int cellCountX, 
+                                             int cellCountZ, 
+                                             Vec3 const& origin, 
+                                             float cellSize )
+    : grid_( cellCountX, cellCountZ, origin, cellSize ), clearances_( cellCountX * cellCountZ, 0.0f ), clearancesValid_( false ),
+      minRouteRadius_( 0.5f * cellSize ), maxRouteRadius_( 10.0f * cellSize ), 
+      revision_( 0 ), useCount_( 0 ), routeCacheCapacity_( 1024 ), searchCacheCapacity_( 16 ),
+      routes_(), searches_(), statistics_()
+{
+    assert( 0 < cellCountX && 0 < cellCountZ && "Grid must contain cells." );
+    assert( 0.0f < cellSize && "Cell size must be positive." );
+    resetStatistics();
+}
+
+
+
+OpenSteer::GridPathPlanner::~GridPathPlanner()
+{
+    clearCache();
+}
+
+
+
+int 
+OpenSteer::GridPathPlanner::cellCountX() const
+{
+    return grid_.cellCountX();
+}
+
+
+
+int 
+OpenSteer::GridPathPlanner::cellCountZ() const
+{
+    return grid_.cellCountZ();
+}
+
+
+
+OpenSteer::Vec3 const& 
+OpenSteer::GridPathPlanner::origin() const
+{
+    return grid_.origin();
+}
+
+
+
+float 
+OpenSteer::GridPathPlanner::cellSize() const
+{
+    return grid_.cellSize();
+}
+
+
+
+bool 
+OpenSteer::GridPathPlanner::cellContaining( Vec3 const& point, int& i, int& j ) const
+{
+    return grid_.cellContaining( point, i, j );
+}
+
+
+
+OpenSteer::Vec3 
+OpenSteer::GridPathPlanner::cellCenter( int i, int j ) const
+{
+    return grid_.cellCenter( i, j );
+}
+
+
+
+bool 
+OpenSteer::GridPathPlanner::isBlocked( int i, int j ) const
+{
+    return grid_.isBlocked( i, j );
+}
+
+
+
+void 
+OpenSteer::GridPathPlanner::setBlocked( int i, int j, bool blocked )
+{
+    int const cell = grid_.cellIndex( i, j );
+    if ( grid_.isBlocked( cell ) == blocked ) {
+        return;
+    }
+    
+    grid_.setBlocked( cell, blocked );
+    ++revision_;
+    clearancesValid_ = false;
+    
+    for ( SearchCache::iterator it = searches_.begin(); it != searches_.end(); ++it ) {
+        statistics_.repairedCells += it->second->cellChanged( cell );
+    }
+}
+
+
+
+void 
+OpenSteer::GridPathPlanner::setRouteRadiusRange( float minRadius, float maxRadius )
+{
+    assert( 0.0f < minRadius && minRadius <= maxRadius && "Invalid route radius range." );
+    minRouteRadius_ = minRadius;
+    maxRouteRadius_ = maxRadius;
+    routes_.clear();
+}
+
+
+
+float 
+OpenSteer::GridPathPlanner::minRouteRadius() const
+{
+    return minRouteRadius_;
+}
+
+
+
+float 
+OpenSteer::GridPathPlanner::maxRouteRadius() const
+{
+    return maxRouteRadius_;
+}
+
+
+
+void 
+OpenSteer::GridPathPlanner::setCacheCapacity( size_type routeCount, size_type searchCount )
+{
+    routeCacheCapacity_ = routeCount;
+    searchCacheCapacity_ = searchCount;
+    trimCaches();
+}
+
+
+
+OpenSteer::GridPathPlanner::size_type 
+OpenSteer::GridPathPlanner::routeCacheCapacity() const
+{
+    return routeCacheCapacity_;
+}
+
+
+
+OpenSteer::GridPathPlanner::size_type 
+OpenSteer::GridPathPlanner::searchCacheCapacity() const
+{
+    return searchCacheCapacity_;
+}
+
+
+
+void 
+OpenSteer::GridPathPlanner::clearCache()
+{
+    routes_.clear();
+    
+    for ( SearchCache::iterator it = searches_.begin(); it != searches_.end(); ++it ) {
+        delete it->second;
+    }
+    searches_.clear();
+}
+
+
+
+bool 
+OpenSteer::GridPathPlanner::findRoute( Vec3 const& start, Vec3 const& goal, Route& route )
+{
+    Request request;
+    request.start = start;
+    request.goal = goal;
+    request.found = false;
+    findRoutes( &request, 1 );
+    
+    if ( request.found ) {
+        route.points.swap( request.route.points );
+        route.radii.swap( request.route.radii );
+    }
+    
+    return request.found;
+}
+
+
+
+bool 
+OpenSteer::GridPathPlanner::findRoute( Vec3 const& start, 
+                                       Vec3 const& goal, 
+                                       PolylineSegmentedPathwaySegmentRadii& pathway )
+{
+    Route route;
+    if ( ! findRoute( start, goal, route ) ) {
+        return false;
+    }
+    
+    pathway.setPathway( route.points.size(), &route.points[ 0 ], &route.radii[ 0 ], false );
+    return true;
+}
+
+
+
+void 
+OpenSteer::GridPathPlanner::findRoutes( Request* requests, size_type count )
+{
+    updateClearances();
+    
+    // Answer requests from the cache and collect the others grouped by their
+    // goal cell.
+    std::vector< RouteKey > keys( count, RouteKey( -1, -1 ) );
+    std::vector< std::pair< Search*, std::vector< size_type > > > groups;
+    std::map< int, size_type > groupIndices;
+    
+    for ( size_type r = 0; r < count; ++r ) {
+        Request& request = requests[ r ];
+        request.found = false;
+        
+        int si = 0;
+        int sj = 0;
+        int gi = 0;
+        int gj = 0;
+        if ( ! cellContaining( request.start, si, sj ) || 
+             ! cellContaining( request.goal, gi, gj ) ||
+             ( request.start == request.goal ) ||
+             isBlocked( si, sj ) ||
+             isBlocked( gi, gj ) ) {
+            continue;
+        }
+        
+        RouteKey const key( grid_.cellIndex( si, sj ), grid_.cellIndex( gi, gj ) );
+        RouteCache::iterator const cached = routes_.find( key );
+        if ( ( cached != routes_.end() ) && ( cached->second.revision == revision_ ) ) {
+            ++statistics_.cacheHits;
+            cached->second.lastUse = ++useCount_;
+            if ( cached->second.found ) {
+                makeRoute( cached->second, request.start, request.goal, request.route );
+                request.found = true;
+            }
+            continue;
+        }
+        
+        keys[ r ] = key;
+        std::map< int, size_type >::iterator group = groupIndices.find( key.second );
+        if ( group == groupIndices.end() ) {
+            Search*& search = searches_[ key.second ];
+            if ( 0 == search ) {
+                search = new Search( *this, key.second );
+            }
+            group = groupIndices.insert( std::make_pair( key.second, groups.size() ) ).first;
+            groups.push_back( std::make_pair( search, std::vector< size_type >() ) );
+        }
+        groups[ group->second ].first->lastUse = ++useCount_;
+        groups[ group->second ].second.push_back( r );
+    }
+    
+    // Searches only touch their own state, so different goals are planned
+    // in parallel.
+    std::vector< CachedRoute > results( count );
+    int const groupCount = static_cast< int >( groups.size() );
+#ifdef _OPENMP
+    #pragma omp parallel for schedule(dynamic)
+#endif
+    for ( int g = 0; g < groupCount; ++g ) {
+        Search& search = *groups[ g ].first;
+        std::vector< size_type > const& indices = groups[ g ].second;
+        std::vector< int > cells;
+        for ( size_type k = 0; k < indices.size(); ++k ) {
+            CachedRoute& result = results[ indices[ k ] ];
+            result.found = search.findCells( keys[ indices[ k ] ].first, cells );
+            if ( result.found ) {
+                grid_.makeWaypoints( cells, minRouteRadius_, maxRouteRadius_, PrecomputedClearance( clearances_ ), result.waypoints, result.radii );
+            }
+        }
+    }
+    
+    // Publish and cache the results.
+    for ( size_type g = 0; g < groups.size(); ++g ) {
+        Search& search = *groups[ g ].first;
+        statistics_.expandedCells += search.expandedCells;
+        search.expandedCells = 0;
+        
+        std::vector< size_type > const& indices = groups[ g ].second;
+        for ( size_type k = 0; k < indices.size(); ++k ) {
+            size_type const r = indices[ k ];
+            CachedRoute& result = results[ r ];
+            result.revision = revision_;
+            result.lastUse = ++useCount_;
+            if ( result.found ) {
+                makeRoute( result, requests[ r ].start, requests[ r ].goal, requests[ r ].route );
+                requests[ r ].found = true;
+            }
+            routes_[ keys[ r ] ] = result;
+            ++statistics_.searches;
+        }
+    }
+    
+    trimCaches();
+}
+
+
+
+OpenSteer::GridPathPlanner::Statistics const& 
+OpenSteer::GridPathPlanner::statistics() const
+{
+    return statistics_;
+}
+
+
+
+void 
+OpenSteer::GridPathPlanner::resetStatistics()
+{
+    statistics_.cacheHits = 0;
+    statistics_.searches = 0;
+    statistics_.expandedCells = 0;
+    statistics_.repairedCells = 0;
+}
+
+
+
+void 
+OpenSteer::GridPathPlanner::updateClearances()
+{
+    if ( clearancesValid_ ) {
+        return;
+    }
+    
+    // Two pass chamfer distance transform.
+    int const cellCountX = grid_.cellCountX();
+    int const cellCountZ = grid_.cellCountZ();
+    float const far = static_cast< float >( cellCountX + cellCountZ );
+    for ( size_type i = 0; i < clearances_.size(); ++i ) {
+        clearances_[ i ] = grid_.isBlocked( static_cast< int >( i ) ) ? 0.0f : far;
+    }
+    
+    for ( int j = 0; j < cellCountZ; ++j ) {
+        for ( int i = 0; i < cellCountX; ++i ) {
+            float& clearance = clearances_[ i + j * cellCountX ];
+            if ( 0 < i ) {
+                clearance = std::min( clearance, clearances_[ i - 1 + j * cellCountX ] + 1.0f );
+            }
+            if ( 0 < j ) {
+                clearance = std::min( clearance, clearances_[ i + ( j - 1 ) * cellCountX ] + 1.0f );
+                if ( 0 < i ) {
+                    clearance = std::min( clearance, clearances_[ i - 1 + ( j - 1 ) * cellCountX ] + diagonalDistance );
+                }
+                if ( i + 1 < cellCountX ) {
+                    clearance = std::min( clearance, clearances_[ i + 1 + ( j - 1 ) * cellCountX ] + diagonalDistance );
+                }
+            }
+        }
+    }
+    
+    for ( int j = cellCountZ - 1; 0 <= j; --j ) {
+        for ( int i = cellCountX - 1; 0 <= i; --i ) {
+            float& clearance = clearances_[ i + j * cellCountX ];
+            if ( i + 1 < cellCountX ) {
+                clearance = std::min( clearance, clearances_[ i + 1 + j * cellCountX ] + 1.0f );
+            }
+            if ( j + 1 < cellCountZ ) {
+                clearance = std::min( clearance, clearances_[ i + ( j + 1 ) * cellCountX ] + 1.0f );
+                if ( i + 1 < cellCountX ) {
+                    clearance = std::min( clearance, clearances_[ i + 1 + ( j + 1 ) * cellCountX ] + diagonalDistance );
+                }
+                if ( 0 < i ) {
+                    clearance = std::min( clearance, clearances_[ i - 1 + ( j + 1 ) * cellCountX ] + diagonalDistance );
+                }
+            }
+        }
+    }
+    
+    clearancesValid_ = true;
+}
+
+
+
+void 
+OpenSteer::GridPathPlanner::makeRoute( CachedRoute const& cached, 
+                                       Vec3 const& start, 
+                                       Vec3 const& goal, 
+                                       Route& route ) const
+{
+    std::vector< int > const& waypoints = cached.waypoints;
+    size_type const waypointCount = waypoints.size();
+    
+    Vec3 const startCenter = grid_.cellCenterAtHeight( waypoints.front(), start.y );
+    Vec3 const goalCenter = grid_.cellCenterAtHeight( waypoints.back(), start.y );
+    
+    route.points.assign( 1, start );
+    route.radii.clear();
+    
+    // The waypoints are in line of sight from cell center to cell center, 
+    // not necessarily from start and goal inside their cells.
+    Vec3 const firstWaypoint = ( 2 < waypointCount ) ? grid_.cellCenterAtHeight( waypoints[ 1 ], start.y ) : goalCenter;
+    if ( ( start != startCenter ) && ! grid_.segmentIsFree( start, firstWaypoint ) ) {
+        route.points.push_back( startCenter );
+        route.radii.push_back( cached.radii.front() );
+    }
+    
+    for ( size_type i = 1; i + 1 < waypointCount; ++i ) {
+        route.points.push_back( grid_.cellCenterAtHeight( waypoints[ i ], start.y ) );
+        route.radii.push_back( cached.radii[ i - 1 ] );
+    }
+    
+    Vec3 const lastWaypoint = route.points.back();
+    if ( ( goal != goalCenter ) && ( lastWaypoint != goalCenter ) && ! grid_.segmentIsFree( lastWaypoint, goal ) ) {
+        route.points.push_back( goalCenter );
+        route.radii.push_back( cached.radii.back() );
+    }
+    
+    route.points.push_back( goal );
+    route.radii.push_back( cached.radii.back() );
+}
+
+
+
+void 
+OpenSteer::GridPathPlanner::trimCaches()
+{
+    dropLeastRecentlyUsed( routes_, routeCacheCapacity_, DropRoute() );
+    dropLeastRecentlyUsed( searches_, searchCacheCapacity_, DropSearch() );
+}
@@ -0,0 +1,977 @@
+/**
+ * OpenSteer -- Steering Behaviors for Autonomous Characters
+ *
+ * Copyright (c) 2002-2005, Sony Computer Entertainment America
+ * Original author: Craig Reynolds <craig_reynolds@playstation.sony.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+#include "OpenSteer/HierarchicalPathPlanner.h"
+
+
+// Include std::push_heap, std::pop_heap, std::sort, std::unique, std::lower_bound, std::min, std::max, std::reverse
+#include <algorithm>
+
+// Include std::ceil, std::sqrt
+#include <cmath>
+
+// Include std::greater
+#include <functional>
+
+// Include std::map
+#include <map>
+
+// Include std::pair
+#include <utility>
+
+// Include assert
+#include <cassert>
+
+
+// Include OpenSteer::PolylineSegmentedPathwaySegmentRadii
+#include "OpenSteer/PolylineSegmentedPathwaySegmentRadii.h"
+
+
+
+namespace {
+    
+    typedef OpenSteer::HierarchicalPathPlanner::size_type size_type;
+    typedef OpenSteer::PlanningGrid PlanningGrid;
+    
+    /**
+     * Cost of unreachable cells and portals.
+     */
+    int const unreachable = 1 << 29;
+    
+    /**
+     * Free border runs shorter than this get one portal in their middle, 
+     * longer ones one at each end.
+     */
+    int const maxSinglePortalRun = 6;
+    
+    /**
+     * Queue entry of cost and cell or portal, the smallest cost on top with
+     * @c std::greater.
+     */
+    typedef std::pair< int, int > QueueEntry;
+    typedef std::greater< QueueEntry > QueueOrder;
+    
+    
+    
+    /**
+     * Cells queued by cost modulo the bucket count. Moves cost at most
+     * @c PlanningGrid::diagonalMoveCost, so all queued costs fit into 
+     * distinct buckets (Dial's algorithm).
+     */
+    int const bucketCount = PlanningGrid::diagonalMoveCost + 1;
+    typedef std::vector< std::vector< int > > Buckets;
+    
+    
+    /**
+     * Stores the move costs from cell @a from to all cells of a @a size 
+     * times @a size block of cells in @a costs. Moves don't leave the block,
+     * @a buckets is the reusable search queue.
+     */
+    void blockCosts( std::vector< char > const& blocked, 
+                     int size, 
+                     int from, 
+                     std::vector< int >& costs, 
+                     Buckets& buckets ) {
+        costs.assign( blocked.size(), unreachable );
+        buckets.resize( bucketCount );
+        
+        costs[ from ] = 0;
+        buckets[ 0 ].assign( 1, from );
+        size_type queued = 1;
+        for ( int current = 0; 0 < queued; ++current ) {
+            std::vector< int >& bucket = buckets[ current % bucketCount ];
+            while ( ! bucket.empty() ) {
+                int const cell = bucket.back();
+                bucket.pop_back();
+                --queued;
+                
+                // Skip cells queued again with a smaller cost.
+                if ( costs[ cell ] < current ) {
+                    continue;
+                }
+                
+                int const i = cell % size;
+                int const j = cell / size;
+                for ( int direction = 0; direction < 8; ++direction ) {
+                    int const dx = PlanningGrid::neighborOffsetX[ direction ];
+                    int const dz = PlanningGrid::neighborOffsetZ[ direction ];
+                    if ( ( i + dx < 0 ) || ( j + dz < 0 ) || ( size <= i + dx ) || ( size <= j + dz ) ) {
+                        continue;
+                    }
+                    
+                    // Diagonal moves mustn't cut the corner of a blocked cell.
+                    int const neighbor = cell + dx + dz * size;
+                    int move = PlanningGrid::straightMoveCost;
+                    if ( 0 != blocked[ neighbor ] ) {
+                        continue;
+                    } else if ( ( 0 != dx ) && ( 0 != dz ) ) {
+                        if ( ( 0 != blocked[ cell + dx ] ) || ( 0 != blocked[ cell + dz * size ] ) ) {
+                            continue;
+                        }
+                        move = PlanningGrid::diagonalMoveCost;
+                    }
+                    
+                    if ( current + move < costs[ neighbor ] ) {
+                        costs[ neighbor ] = current + move;
+                        buckets[ costs[ neighbor ] % bucketCount ].push_back( neighbor );
+                        ++queued;
+                    }
+                }
+            }
+        }
+    }
+    
+    
+    /**
+     * Clearances of cells calculated when @c PlanningGrid::makeWaypoints 
+     * first asks for them. A clearance is the distance of the cell's center
+     * to the nearest blocked cell center in cells, searched only up to the
+     * maximal route radius.
+     */
+    class LazyClearance {
+    public:
+        LazyClearance( PlanningGrid const& grid, float maxRadius ) 
+            : grid_( grid ), range_( std::ceil( maxRadius / grid.cellSize() ) + 1.0f ), clearances_() {}
+        
+        float operator()( int cell ) const {
+            std::map< int, float >::const_iterator const known = clearances_.find( cell );
+            if ( known != clearances_.end() ) {
+                return known->second;
+            }
+            
+            // Search the square around the cell that can hold blocked cells 
+            // closer than the maximal route radius.
+            int const cellCountX = grid_.cellCountX();
+            int const cellCountZ = grid_.cellCountZ();
+            int const reach = static_cast< int >( range_ );
+            int const ci = cell % cellCountX;
+            int const cj = cell / cellCountX;
+            float nearest = grid_.isBlocked( cell ) ? 0.0f : range_;
+            for ( int j = std::max( cj - reach, 0 ); ( j <= std::min( cj + reach, cellCountZ - 1 ) ) && ( 0.0f < nearest ); ++j ) {
+                for ( int i = std::max( ci - reach, 0 ); i <= std::min( ci + reach, cellCountX - 1 ); ++i ) {
+                    if ( grid_.isBlocked( i + j * cellCountX ) ) {
+                        float const di = static_cast< float >( i - ci );
+                        float const dj = static_cast< float >( j - cj );
+                        nearest = std::min( nearest, std::sqrt( di * di + dj * dj ) );
+                    }
+                }
+            }
+            
+            clearances_[ cell ] = nearest;
+            return nearest;
+        }
+        
+    private:
+        PlanningGrid const& grid_;
+        float range_;
+        mutable std::map< int, float > clearances_;
+    };
+    
+} // anonymous namespace
+
+
+
+
+OpenSteer::HierarchicalPathPlanner::Route::Route()
+    : start_( 0.0f, 0.0f, 0.0f ), goal_( 0.0f, 0.0f, 0.0f ), cells_(), currentLeg_( 0 ), emittedLeg_( 0 )
+{
+    // Nothing to do.
+}
+
+
+
+bool 
+OpenSteer::HierarchicalPathPlanner::Route::empty() const
+{
+    return cells_.empty();
+}
+
+
+
+OpenSteer::HierarchicalPathPlanner::size_type 
+OpenSteer::HierarchicalPathPlanner::Route::legCount() const
+{
+    return cells_.empty() ? 0 : cells_.size() - 1;
+}
+
+
+
+OpenSteer::HierarchicalPathPlanner::size_type 
+OpenSteer::HierarchicalPathPlanner::Route::currentLeg() const
+{
+    return currentLeg_;
+}
+
+
+
+
+OpenSteer::HierarchicalPathPlanner::HierarchicalPathPlanner( int cellCountX, 
+                                                             int cellCountZ, 
+                                                             Vec3 const& origin, 
+                                                             float cellSize,
+                                                             int clusterSize )
+    : grid_( cellCountX, cellCountZ, origin, cellSize ), 
+      clusterSize_( clusterSize ), 
+      clusterCountX_( ( cellCountX + clusterSize - 1 ) / clusterSize ), 
+      clusterCountZ_( ( cellCountZ + clusterSize - 1 ) / clusterSize ),
+      clusters_(), abstractionValid_( false ),
+      firstPortals_(), portalCells_(), portalClusters_(),
+      minRouteRadius_( 0.5f * cellSize ), maxRouteRadius_( 10.0f * cellSize ), refinedLegCount_( 4 ),
+      searchCosts_(), searchParents_(), searchStamps_(), searchStamp_( 0 ), statistics_()
+{
+    assert( 1 < clusterSize && "Clusters must be larger than a cell." );
+    
+    Cluster dirty;
+    dirty.dirty = true;
+    clusters_.assign( clusterCountX_ * clusterCountZ_, dirty );
+    resetStatistics();
+}
+
+
+
+int 
+OpenSteer::HierarchicalPathPlanner::cellCountX() const
+{
+    return grid_.cellCountX();
+}
+
+
+
+int 
+OpenSteer::HierarchicalPathPlanner::cellCountZ() const
+{
+    return grid_.cellCountZ();
+}
+
+
+
+OpenSteer::Vec3 const& 
+OpenSteer::HierarchicalPathPlanner::origin() const
+{
+    return grid_.origin();
+}
+
+
+
+float 
+OpenSteer::HierarchicalPathPlanner::cellSize() const
+{
+    return grid_.cellSize();
+}
+
+
+
+int 
+OpenSteer::HierarchicalPathPlanner::clusterSize() const
+{
+    return clusterSize_;
+}
+
+
+
+int 
+OpenSteer::HierarchicalPathPlanner::clusterCountX() const
+{
+    return clusterCountX_;
+}
+
+
+
+int 
+OpenSteer::HierarchicalPathPlanner::clusterCountZ() const
+{
+    return clusterCountZ_;
+}
+
+
+
+bool 
+OpenSteer::HierarchicalPathPlanner::cellContaining( Vec3 const& point, int& i, int& j ) const
+{
+    return grid_.cellContaining( point, i, j );
+}
+
+
+
+OpenSteer::Vec3 
+OpenSteer::HierarchicalPathPlanner::cellCenter( int i, int j ) const
+{
+    return grid_.cellCenter( i, j );
+}
+
+
+
+bool 
+OpenSteer::HierarchicalPathPlanner::isBlocked( int i, int j ) const
+{
+    return grid_.isBlocked( i, j );
+}
+
+
+
+void 
+OpenSteer::HierarchicalPathPlanner::setBlocked( int i, int j, bool blocked )
+{
+    int const cell = grid_.cellIndex( i, j );
+    if ( grid_.isBlocked( cell ) == blocked ) {
+        return;
+    }
+    
+    grid_.setBlocked( cell, blocked );
+    
+    // Cells on a cluster border also change the portals of the neighbor 
+    // cluster across it.
+    markDirty( i, j );
+    if ( 0 == i % clusterSize_ ) {
+        markDirty( i - 1, j );
+    }
+    if ( clusterSize_ - 1 == i % clusterSize_ ) {
+        markDirty( i + 1, j );
+    }
+    if ( 0 == j % clusterSize_ ) {
+        markDirty( i, j - 1 );
+    }
+    if ( clusterSize_ - 1 == j % clusterSize_ ) {
+        markDirty( i, j + 1 );
+    }
+}
+
+
+
+void 
+OpenSteer::HierarchicalPathPlanner::setRouteRadiusRange( float minRadius, float maxRadius )
+{
+    assert( 0.0f < minRadius && minRadius <= maxRadius && "Invalid route radius range." );
+    minRouteRadius_ = minRadius;
+    maxRouteRadius_ = maxRadius;
+}
+
+
+
+float 
+OpenSteer::HierarchicalPathPlanner::minRouteRadius() const
+{
+    return minRouteRadius_;
+}
+
+
+
+float 
+OpenSteer::HierarchicalPathPlanner::maxRouteRadius() const
+{
+    return maxRouteRadius_;
+}
+
+
+
+void 
+OpenSteer::HierarchicalPathPlanner::setRefinedLegCount( size_type legCount )
+{
+    assert( 0 < legCount && "At least one leg must be refined." );
+    refinedLegCount_ = legCount;
+}
+
+
+
+OpenSteer::HierarchicalPathPlanner::size_type 
+OpenSteer::HierarchicalPathPlanner::refinedLegCount() const
+{
+    return refinedLegCount_;
+}
+
+
+
+void 
+OpenSteer::HierarchicalPathPlanner::updateAbstraction()
+{
+    if ( abstractionValid_ ) {
+        return;
+    }
+    
+    std::vector< int > dirtyClusters;
+    for ( size_type c = 0; c < clusters_.size(); ++c ) {
+        if ( clusters_[ c ].dirty ) {
+            dirtyClusters.push_back( static_cast< int >( c ) );
+        }
+    }
+    
+    // Clusters are abstracted from the grid alone, so they are independent
+    // of each other.
+    int const dirtyCount = static_cast< int >( dirtyClusters.size() );
+#ifdef _OPENMP
+    #pragma omp parallel for schedule(dynamic)
+#endif
+    for ( int k = 0; k < dirtyCount; ++k ) {
+        abstractCluster( dirtyClusters[ k ], clusters_[ dirtyClusters[ k ] ] );
+    }
+    statistics_.abstractedClusters += dirtyClusters.size();
+    
+    // Renumber the portals.
+    firstPortals_.resize( clusters_.size() );
+    portalCells_.clear();
+    portalClusters_.clear();
+    for ( size_type c = 0; c < clusters_.size(); ++c ) {
+        firstPortals_[ c ] = static_cast< int >( portalCells_.size() );
+        portalCells_.insert( portalCells_.end(), clusters_[ c ].portals.begin(), clusters_[ c ].portals.end() );
+        portalClusters_.resize( portalCells_.size(), static_cast< int >( c ) );
+    }
+    
+    size_type const nodeCount = portalCells_.size() + 2;
+    searchCosts_.resize( nodeCount );
+    searchParents_.resize( nodeCount );
+    searchStamps_.assign( nodeCount, 0 );
+    searchStamp_ = 0;
+    
+    abstractionValid_ = true;
+}
+
+
+
+OpenSteer::HierarchicalPathPlanner::size_type 
+OpenSteer::HierarchicalPathPlanner::portalCount()
+{
+    updateAbstraction();
+    return portalCells_.size();
+}
+
+
+
+bool 
+OpenSteer::HierarchicalPathPlanner::findRoute( Vec3 const& start, Vec3 const& goal, Route& route )
+{
+    int si = 0;
+    int sj = 0;
+    int gi = 0;
+    int gj = 0;
+    if ( ! cellContaining( start, si, sj ) || 
+         ! cellContaining( goal, gi, gj ) ||
+         ( start == goal ) ||
+         grid_.isBlocked( si, sj ) ||
+         grid_.isBlocked( gi, gj ) ) {
+        return false;
+    }
+    
+    updateAbstraction();
+    ++statistics_.searches;
+    
+    int const startCell = grid_.cellIndex( si, sj );
+    int const goalCell = grid_.cellIndex( gi, gj );
+    int const startCluster = clusterContaining( startCell );
+    int const goalCluster = clusterContaining( goalCell );
+    
+    // Costs from start and goal to the portals of their clusters.
+    std::vector< int > startCosts;
+    std::vector< int > goalCosts;
+    clusterCosts( startCluster, startCell, startCosts );
+    clusterCosts( goalCluster, goalCell, goalCosts );
+    
+    // A* over the portals, the start and goal nodes follow the portals.
+    int const startNode = static_cast< int >( portalCells_.size() );
+    int const goalNode = startNode + 1;
+    ++searchStamp_;
+    
+    std::vector< QueueEntry > queue;
+    int const cellCountX = grid_.cellCountX();
+    int const gx = goalCell % cellCountX;
+    int const gz = goalCell / cellCountX;
+    
+    // Relaxes the node and queues it with its cost estimate.
+    struct Relax {
+        std::vector< int >& costs;
+        std::vector< int >& parents;
+        std::vector< size_type >& stamps;
+        size_type stamp;
+        std::vector< QueueEntry >& queue;
+        int cellCountX;
+        int gx;
+        int gz;
+        
+        void operator()( int node, int cell, int cost, int parent ) {
+            if ( ( stamps[ node ] == stamp ) && ( costs[ node ] <= cost ) ) {
+                return;
+            }
+            stamps[ node ] = stamp;
+            costs[ node ] = cost;
+            parents[ node ] = parent;
+            int const estimate = cost + PlanningGrid::octileDistance( cell % cellCountX - gx, cell / cellCountX - gz );
+            queue.push_back( QueueEntry( estimate, node ) );
+            std::push_heap( queue.begin(), queue.end(), QueueOrder() );
+        }
+    } relax = { searchCosts_, searchParents_, searchStamps_, searchStamp_, queue, cellCountX, gx, gz };
+    
+    relax( startNode, startCell, 0, -1 );
+    bool found = false;
+    while ( ! queue.empty() ) {
+        std::pop_heap( queue.begin(), queue.end(), QueueOrder() );
+        QueueEntry const entry = queue.back();
+        queue.pop_back();
+        
+        int const node = entry.second;
+        int const cost = searchCosts_[ node ];
+        int const cell = ( startNode == node ) ? startCell : ( goalNode == node ) ? goalCell : portalCells_[ node ];
+        
+        // Skip outdated queue entries.
+        if ( entry.first != cost + PlanningGrid::octileDistance( cell % cellCountX - gx, cell / cellCountX - gz ) ) {
+            continue;
+        }
+        if ( goalNode == node ) {
+            found = true;
+            break;
+        }
+        ++statistics_.expandedPortals;
+        
+        int const cluster = clusterContaining( cell );
+        Cluster const& abstraction = clusters_[ cluster ];
+        int const first = firstPortals_[ cluster ];
+        size_type const count = abstraction.portals.size();
+        
+        if ( startNode == node ) {
+            for ( size_type p = 0; p < count; ++p ) {
+                int const portalCost = startCosts[ clusterCellIndex( cluster, abstraction.portals[ p ] ) ];
+                if ( portalCost < unreachable ) {
+                    relax( first + static_cast< int >( p ), abstraction.portals[ p ], portalCost, node );
+                }
+            }
+        } else {
+            // Other portals of the cluster.
+            size_type const p = static_cast< size_type >( node - first );
+            for ( size_type q = 0; q < count; ++q ) {
+                int const distance = abstraction.distances[ p * count + q ];
+                if ( ( p != q ) && ( distance < unreachable ) ) {
+                    relax( first + static_cast< int >( q ), abstraction.portals[ q ], cost + distance, node );
+                }
+            }
+            
+            // Portals across the cluster borders.
+            for ( int direction = 0; direction < 4; ++direction ) {
+                int const neighbor = grid_.neighborCell( cell, direction );
+                if ( neighbor < 0 ) {
+                    continue;
+                }
+                int const neighborCluster = clusterContaining( neighbor );
+                if ( neighborCluster == cluster ) {
+                    continue;
+                }
+                int const portal = portalIndex( neighborCluster, neighbor );
+                if ( 0 <= portal ) {
+                    relax( portal, neighbor, cost + PlanningGrid::straightMoveCost, node );
+                }
+            }
+        }
+        
+        if ( cluster == goalCluster ) {
+            int const goalCost = goalCosts[ clusterCellIndex( cluster, cell ) ];
+            if ( goalCost < unreachable ) {
+                relax( goalNode, goalCell, cost + goalCost, node );
+            }
+        }
+    }
+    
+    if ( ! found ) {
+        return false;
+    }
+    
+    route.start_ = start;
+    route.goal_ = goal;
+    route.cells_.clear();
+    for ( int node = goalNode; 0 <= node; node = searchParents_[ node ] ) {
+        route.cells_.push_back( ( startNode == node ) ? startCell : ( goalNode == node ) ? goalCell : portalCells_[ node ] );
+    }
+    std::reverse( route.cells_.begin(), route.cells_.end() );
+    route.currentLeg_ = 0;
+    route.emittedLeg_ = route.cells_.size();
+    return true;
+}
+
+
+
+bool 
+OpenSteer::HierarchicalPathPlanner::advanceRoute( Route& route, 
+                                                  Vec3 const& position, 
+                                                  PolylineSegmentedPathwaySegmentRadii& pathway )
+{
+    assert( ! route.empty() && "Route must be planned." );
+    
+    std::vector< int > const& legCells = route.cells_;
+    size_type const legCount = route.legCount();
+    
+    // Move on to the first leg of the refined legs or the one after them
+    // starting in the vehicle's cluster once the vehicle left the current
+    // leg's cluster.
+    int i = 0;
+    int j = 0;
+    if ( cellContaining( position, i, j ) ) {
+        int const cluster = clusterContaining( grid_.cellIndex( i, j ) );
+        if ( cluster != clusterContaining( legCells[ route.currentLeg_ ] ) ) {
+            size_type const lastLeg = std::min( refinedLegsEnd( route, route.currentLeg_ ), legCount - 1 );
+            for ( size_type leg = route.currentLeg_ + 1; leg <= lastLeg; ++leg ) {
+                if ( cluster == clusterContaining( legCells[ leg ] ) ) {
+                    route.currentLeg_ = leg;
+                    break;
+                }
+            }
+        }
+    }
+    
+    if ( route.emittedLeg_ == route.currentLeg_ ) {
+        return true;
+    }
+    
+    // Refine the window of legs, extended if all of it lies in one cell.
+    std::vector< int > cells;
+    std::vector< int > refined;
+    size_type leg = route.currentLeg_;
+    size_type const windowEnd = refinedLegsEnd( route, route.currentLeg_ );
+    while ( ( leg < windowEnd ) || ( ( cells.size() < 2 ) && ( leg < legCount ) ) ) {
+        if ( ! refineLeg( legCells[ leg ], legCells[ leg + 1 ], refined ) ) {
+            return false;
+        }
+        size_type const first = ( ! cells.empty() && ( cells.back() == refined.front() ) ) ? 1 : 0;
+        cells.insert( cells.end(), refined.begin() + first, refined.end() );
+        ++leg;
+    }
+    statistics_.refinedLegs += leg - route.currentLeg_;
+    
+    std::vector< int > waypoints;
+    std::vector< float > radii;
+    grid_.makeWaypoints( cells, minRouteRadius_, maxRouteRadius_, LazyClearance( grid_, maxRouteRadius_ ), waypoints, radii );
+    
+    // The pathway starts at the start or where the vehicle is. The 
+    // waypoints are in line of sight from cell center to cell center, not
+    // necessarily from there or to the goal inside their cells.
+    bool const atGoal = ( legCount == leg );
+    Vec3 const from = ( 0 == route.currentLeg_ ) ? route.start_ : position;
+    float const y = route.start_.y;
+    size_type const waypointCount = waypoints.size();
+    std::vector< Vec3 > points;
+    std::vector< float > pointRadii;
+    
+    Vec3 const firstCenter = grid_.cellCenterAtHeight( waypoints.front(), y );
+    Vec3 const firstWaypoint = ( 2 < waypointCount ) ? grid_.cellCenterAtHeight( waypoints[ 1 ], y ) : 
+                               atGoal ? route.goal_ : grid_.cellCenterAtHeight( waypoints.back(), y );
+    points.push_back( from );
+    if ( ( from != firstCenter ) && ! grid_.segmentIsFree( from, firstWaypoint ) ) {
+        points.push_back( firstCenter );
+        pointRadii.push_back( radii.front() );
+    }
+    
+    for ( size_type w = 1; w + 1 < waypointCount; ++w ) {
+        points.push_back( grid_.cellCenterAtHeight( waypoints[ w ], y ) );
+        pointRadii.push_back( radii[ w - 1 ] );
+    }
+    
+    Vec3 const lastCenter = grid_.cellCenterAtHeight( waypoints.back(), y );
+    if ( atGoal ) {
+        if ( ( route.goal_ != lastCenter ) && ( points.back() != lastCenter ) && ! grid_.segmentIsFree( points.back(), route.goal_ ) ) {
+            points.push_back( lastCenter );
+            pointRadii.push_back( radii.back() );
+        }
+        points.push_back( route.goal_ );
+    } else {
+        points.push_back( lastCenter );
+    }
+    pointRadii.push_back( radii.back() );
+    
+    // The vehicle can stand on a waypoint or the goal.
+    size_type kept = 1;
+    for ( size_type k = 1; k < points.size(); ++k ) {
+        if ( points[ k ] != points[ kept - 1 ] ) {
+            points[ kept ] = points[ k ];
+            pointRadii[ kept - 1 ] = pointRadii[ k - 1 ];
+            ++kept;
+        }
+    }
+    route.emittedLeg_ = route.currentLeg_;
+    if ( kept < 2 ) {
+        return true;
+    }
+    points.resize( kept );
+    pointRadii.resize( kept - 1 );
+    
+    pathway.setPathway( points.size(), &points[ 0 ], &pointRadii[ 0 ], false );
+    return true;
+}
+
+
+
+OpenSteer::HierarchicalPathPlanner::Statistics const& 
+OpenSteer::HierarchicalPathPlanner::statistics() const
+{
+    return statistics_;
+}
+
+
+
+void 
+OpenSteer::HierarchicalPathPlanner::resetStatistics()
+{
+    statistics_.abstractedClusters = 0;
+    statistics_.searches = 0;
+    statistics_.expandedPortals = 0;
+    statistics_.refinedLegs = 0;
+}
+
+
+
+int 
+OpenSteer::HierarchicalPathPlanner::clusterContaining( int cell ) const
+{
+    return ( cell % grid_.cellCountX() ) / clusterSize_ + ( cell / grid_.cellCountX() ) / clusterSize_ * clusterCountX_;
+}
+
+
+
+void 
+OpenSteer::HierarchicalPathPlanner::clusterBounds( int cluster, int& iBegin, int& jBegin, int& iEnd, int& jEnd ) const
+{
+    iBegin = ( cluster % clusterCountX_ ) * clusterSize_;
+    jBegin = ( cluster / clusterCountX_ ) * clusterSize_;
+    iEnd = std::min( iBegin + clusterSize_, grid_.cellCountX() );
+    jEnd = std::min( jBegin + clusterSize_, grid_.cellCountZ() );
+}
+
+
+
+int 
+OpenSteer::HierarchicalPathPlanner::portalIndex( int cluster, int cell ) const
+{
+    std::vector< int > const& portals = clusters_[ cluster ].portals;
+    std::vector< int >::const_iterator const portal = std::lower_bound( portals.begin(), portals.end(), cell );
+    if ( ( portal == portals.end() ) || ( *portal != cell ) ) {
+        return -1;
+    }
+    return firstPortals_[ cluster ] + static_cast< int >( portal - portals.begin() );
+}
+
+
+
+void 
+OpenSteer::HierarchicalPathPlanner::markDirty( int i, int j )
+{
+    if ( ( i < 0 ) || ( j < 0 ) || ( grid_.cellCountX() <= i ) || ( grid_.cellCountZ() <= j ) ) {
+        return;
+    }
+    clusters_[ clusterContaining( grid_.cellIndex( i, j ) ) ].dirty = true;
+    abstractionValid_ = false;
+}
+
+
+
+void 
+OpenSteer::HierarchicalPathPlanner::abstractCluster( int cluster, Cluster& result ) const
+{
+    result.portals.clear();
+    for ( int direction = 0; direction < 4; ++direction ) {
+        addBorderPortals( cluster, direction, result.portals );
+    }
+    
+    // Corner cells can be portals to two neighbors.
+    std::sort( result.portals.begin(), result.portals.end() );
+    result.portals.erase( std::unique( result.portals.begin(), result.portals.end() ), result.portals.end() );
+    
+    std::vector< char > blocked;
+    clusterCells( cluster, blocked );
+    
+    size_type const count = result.portals.size();
+    result.distances.assign( count * count, unreachable );
+    std::vector< int > costs;
+    Buckets buckets;
+    for ( size_type p = 0; p < count; ++p ) {
+        result.distances[ p * count + p ] = 0;
+    }
+    
+    // Moves cost the same both ways, so the last portal's costs are known 
+    // from the others.
+    for ( size_type p = 0; p + 1 < count; ++p ) {
+        blockCosts( blocked, clusterSize_, clusterCellIndex( cluster, result.portals[ p ] ), costs, buckets );
+        for ( size_type q = p + 1; q < count; ++q ) {
+            int const cost = costs[ clusterCellIndex( cluster, result.portals[ q ] ) ];
+            result.distances[ p * count + q ] = cost;
+            result.distances[ q * count + p ] = cost;
+        }
+    }
+    
+    result.dirty = false;
+}
+
+
+
+void 
+OpenSteer::HierarchicalPathPlanner::addBorderPortals( int cluster, int direction, std::vector< int >& portals ) const
+{
+    int iBegin = 0;
+    int jBegin = 0;
+    int iEnd = 0;
+    int jEnd = 0;
+    clusterBounds( cluster, iBegin, jBegin, iEnd, jEnd );
+    
+    // Inner border cells run from the first one along the border.
+    int const dx = PlanningGrid::neighborOffsetX[ direction ];
+    int const dz = PlanningGrid::neighborOffsetZ[ direction ];
+    int const firstI = ( 0 < dx ) ? iEnd - 1 : iBegin;
+    int const firstJ = ( 0 < dz ) ? jEnd - 1 : jBegin;
+    int const outerI = firstI + dx;
+    int const outerJ = firstJ + dz;
+    if ( ( outerI < 0 ) || ( outerJ < 0 ) || ( grid_.cellCountX() <= outerI ) || ( grid_.cellCountZ() <= outerJ ) ) {
+        return;
+    }
+    
+    int const length = ( 0 != dx ) ? jEnd - jBegin : iEnd - iBegin;
+    int const step = ( 0 != dx ) ? grid_.cellCountX() : 1;
+    int const first = grid_.cellIndex( firstI, firstJ );
+    int const outerOffset = dx + dz * grid_.cellCountX();
+    
+    // Runs of border cells free on both sides, the run detection sees the
+    // same pairs from both clusters so their portals match.
+    int runBegin = -1;
+    for ( int k = 0; k <= length; ++k ) {
+        int const cell = first + k * step;
+        bool const open = ( k < length ) && ! grid_.isBlocked( cell ) && ! grid_.isBlocked( cell + outerOffset );
+        if ( open && ( runBegin < 0 ) ) {
+            runBegin = k;
+        } else if ( ! open && ( 0 <= runBegin ) ) {
+            int const runEnd = k - 1;
+            if ( runEnd - runBegin + 1 < maxSinglePortalRun ) {
+                portals.push_back( first + ( ( runBegin + runEnd ) / 2 ) * step );
+            } else {
+                portals.push_back( first + runBegin * step );
+                portals.push_back( first + runEnd * step );
+            }
+            runBegin = -1;
+        }
+    }
+}
+
+
+
+void 
+OpenSteer::HierarchicalPathPlanner::clusterCosts( int cluster, int from, std::vector< int >& costs ) const
+{
+    std::vector< char > blocked;
+    clusterCells( cluster, blocked );
+    Buckets buckets;
+    blockCosts( blocked, clusterSize_, clusterCellIndex( cluster, from ), costs, buckets );
+}
+
+
+
+void 
+OpenSteer::HierarchicalPathPlanner::clusterCells( int cluster, std::vector< char >& blocked ) const
+{
+    int iBegin = 0;
+    int jBegin = 0;
+    int iEnd = 0;
+    int jEnd = 0;
+    clusterBounds( cluster, iBegin, jBegin, iEnd, jEnd );
+    
+    // Clusters at the far grid borders can be cut off.
+    blocked.assign( clusterSize_ * clusterSize_, 1 );
+    for ( int j = jBegin; j < jEnd; ++j ) {
+        for ( int i = iBegin; i < iEnd; ++i ) {
+            blocked[ ( i - iBegin ) + ( j - jBegin ) * clusterSize_ ] = grid_.isBlocked( i, j ) ? 1 : 0;
+        }
+    }
+}
+
+
+
+int 
+OpenSteer::HierarchicalPathPlanner::clusterCellIndex( int cluster, int cell ) const
+{
+    int const i = cell % grid_.cellCountX() - ( cluster % clusterCountX_ ) * clusterSize_;
+    int const j = cell / grid_.cellCountX() - ( cluster / clusterCountX_ ) * clusterSize_;
+    assert( 0 <= i && i < clusterSize_ && 0 <= j && j < clusterSize_ && "Cell outside of the cluster." );
+    return i + j * clusterSize_;
+}
+
+
+
+bool 
+OpenSteer::HierarchicalPathPlanner::refineLeg( int from, int to, std::vector< int >& cells ) const
+{
+    cells.assign( 1, from );
+    if ( from == to ) {
+        return ! grid_.isBlocked( from );
+    }
+    
+    int const cluster = clusterContaining( to );
+    if ( clusterContaining( from ) != cluster ) {
+        // Neighbor portals across a cluster border.
+        cells.push_back( to );
+        return ! grid_.isBlocked( from ) && ! grid_.isBlocked( to );
+    }
+    
+    // Walk down the costs towards @a to.
+    std::vector< int > costs;
+    clusterCosts( cluster, to, costs );
+    if ( unreachable <= costs[ clusterCellIndex( cluster, from ) ] ) {
+        return false;
+    }
+    
+    int iBegin = 0;
+    int jBegin = 0;
+    int iEnd = 0;
+    int jEnd = 0;
+    clusterBounds( cluster, iBegin, jBegin, iEnd, jEnd );
+    
+    int cell = from;
+    while ( cell != to ) {
+        int const cost = costs[ clusterCellIndex( cluster, cell ) ];
+        int next = -1;
+        for ( int direction = 0; ( direction < 8 ) && ( next < 0 ); ++direction ) {
+            int const move = grid_.moveCost( cell, direction );
+            if ( move < 0 ) {
+                continue;
+            }
+            int const neighbor = grid_.neighborCell( cell, direction );
+            int const i = neighbor % grid_.cellCountX();
+            int const j = neighbor / grid_.cellCountX();
+            if ( ( iBegin <= i ) && ( jBegin <= j ) && ( i < iEnd ) && ( j < jEnd ) && 
+                 ( costs[ clusterCellIndex( cluster, neighbor ) ] + move == cost ) ) {
+                next = neighbor;
+            }
+        }
+        assert( 0 <= next && "Costs must lead to the leg's end." );
+        cells.push_back( next );
+        cell = next;
+    }
+    
+    return true;
+}
+
+
+
+OpenSteer::HierarchicalPathPlanner::size_type 
+OpenSteer::HierarchicalPathPlanner::refinedLegsEnd( Route const& route, size_type firstLeg ) const
+{
+    // A window ending at a portal inside the current cluster would never 
+    // let the vehicle enter the cluster of a later leg.
+    std::vector< int > const& legCells = route.cells_;
+    size_type const legCount = route.legCount();
+    size_type end = std::min( firstLeg + refinedLegCount_, legCount );
+    while ( ( end < legCount ) && ( clusterContaining( legCells[ end - 1 ] ) == clusterContaining( legCells[ end ] ) ) ) {
+        ++end;
+    }
+    return end;
+}
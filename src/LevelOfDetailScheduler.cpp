@@ -0,0 +1,207 @@
+// ----------------------------------------------------------------------------
+//
+//
+// OpenSteer -- Steering Behaviors for Autonomous Characters
+//
+// Copyright (c) 2002-2005, Sony Computer Entertainment America
+// Original author: Craig Reynolds <craig_reynolds@playstation.sony.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+//
+// ----------------------------------------------------------------------------
+//
+//
+// Level of detail scheduling of vehicle updates
+//
+// 10-19-26:     created
+//
+//
+// ----------------------------------------------------------------------------
+
+
+#include "OpenSteer/LevelOfDetailScheduler.h"
+#include <algorithm>
+
+
+// ----------------------------------------------------------------------------
+// order entries which are due: longest waiting first, then most interesting
+
+
+struct OpenSteer::LevelOfDetailScheduler::DueOrder
+{
+    DueOrder (const std::vector<Entry>& entries) : _entries (entries) {}
+
+    bool operator() (const int a, const int b) const
+    {
+        const Entry& ea = _entries[a];
+        const Entry& eb = _entries[b];
+        if (ea.ticksSinceUpdate != eb.ticksSinceUpdate)
+            return ea.ticksSinceUpdate > eb.ticksSinceUpdate;
+        return ea.interest > eb.interest;
+    }
+
+    const std::vector<Entry>& _entries;
+};
+
+
+// ----------------------------------------------------------------------------
+// constructor
+
+
+OpenSteer::LevelOfDetailScheduler::LevelOfDetailScheduler (const int tiers)
+    : _interestRadius (50),
+      _budget (0),
+      _fullUpdates (0),
+      _coasts (0)
+{
+    setTierCount (tiers);
+}
+
+
+// ----------------------------------------------------------------------------
+// add and remove vehicles
+
+
+void 
+OpenSteer::LevelOfDetailScheduler::add (SimpleVehicle* vehicle)
+{
+    Entry e;
+    e.vehicle = vehicle;
+    e.tier = 0;
+    e.interest = 1;
+
+    // stagger the phase so that vehicles added together do not all
+    // fall due on the same ticks
+    e.ticksSinceUpdate = (int) (_entries.size() % (1 << (tierCount() - 1)));
+
+    _entries.push_back (e);
+}
+
+
+void 
+OpenSteer::LevelOfDetailScheduler::remove (SimpleVehicle* vehicle)
+{
+    // search from the back: vehicles are usually removed in reverse order
+    for (size_t i = _entries.size(); i > 0; i--)
+    {
+        if (_entries[i-1].vehicle == vehicle)
+        {
+            _entries[i-1] = _entries.back ();
+            _entries.pop_back ();
+            return;
+        }
+    }
+}
+
+
+void 
+OpenSteer::LevelOfDetailScheduler::setTierCount (const int tiers)
+{
+    _tierPopulation.assign ((tiers < 1) ? 1 : ((tiers > 16) ? 16 : tiers), 0);
+}
+
+
+// ----------------------------------------------------------------------------
+// interest and tiers
+
+
+float 
+OpenSteer::LevelOfDetailScheduler::interest (const SimpleVehicle& vehicle) const
+{
+    const float distance = Vec3::distance (vehicle.position(), _focus);
+    const float proximity = _interestRadius / (_interestRadius + distance);
+    const float effort = ((vehicle.maxForce() > 0) ?
+                          (vehicle.lastSteeringForce().length() /
+                           vehicle.maxForce()) :
+                          0);
+    return proximity + (0.5f * effort);
+}
+
+
+int 
+OpenSteer::LevelOfDetailScheduler::tierForInterest (float value) const
+{
+    const int lastTier = tierCount() - 1;
+    int tier = 0;
+    while ((tier < lastTier) && (value < 0.5f))
+    {
+        value *= 2;
+        tier++;
+    }
+    return tier;
+}
+
+
+// ----------------------------------------------------------------------------
+// run one tick: re-tier every vehicle, pick those due for a full update
+// (within budget), coast the rest
+
+
+void 
+OpenSteer::LevelOfDetailScheduler::update (const float currentTime,
+                                           const float elapsedTime)
+{
+    std::fill (_tierPopulation.begin(), _tierPopulation.end(), 0);
+    _due.clear ();
+
+    // assign tiers and collect the vehicles due for a full update
+    for (size_t i = 0; i < _entries.size(); i++)
+    {
+        Entry& e = _entries[i];
+        e.interest = interest (*e.vehicle);
+        e.tier = tierForInterest (e.interest);
+        _tierPopulation[e.tier]++;
+        if (e.ticksSinceUpdate + 1 >= (1 << e.tier)) _due.push_back ((int) i);
+    }
+
+    // over budget: keep the vehicles which waited longest (then the most
+    // interesting ones), the others are considered again next tick
+    if ((_budget > 0) && ((int) _due.size() > _budget))
+    {
+        std::nth_element (_due.begin(), _due.begin() + _budget, _due.end(),
+                          DueOrder (_entries));
+        _due.resize (_budget);
+    }
+
+    // mark the chosen vehicles, then update every vehicle in order
+    for (size_t i = 0; i < _due.size(); i++)
+        _entries[_due[i]].ticksSinceUpdate = -1;
+
+    _fullUpdates = _coasts = 0;
+    for (size_t i = 0; i < _entries.size(); i++)
+    {
+        Entry& e = _entries[i];
+        if (e.ticksSinceUpdate < 0)
+        {
+            e.vehicle->update (currentTime, elapsedTime);
+            e.ticksSinceUpdate = 0;
+            _fullUpdates++;
+        }
+        else
+        {
+            e.vehicle->coast (currentTime, elapsedTime);
+            e.ticksSinceUpdate++;
+            _coasts++;
+        }
+    }
+}
+
+
+// ----------------------------------------------------------------------------
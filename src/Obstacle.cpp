@@ -39,6 +39,167 @@
 #include "OpenSteer/Obstacle.h"
 #include "OpenSteer/LocalSpaceObstacles.h"
 
+// SIMD width used by SphereObstacleSet: 8 floats with AVX, 4 with SSE,
+// otherwise a plain scalar loop (define it as 1 to force the scalar loop)
+#if !defined(OPENSTEER_OBSTACLE_SIMD_WIDTH)
+#if defined(__AVX__)
+#include <immintrin.h>
+#define OPENSTEER_OBSTACLE_SIMD_WIDTH 8
+#elif defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#include <xmmintrin.h>
+#define OPENSTEER_OBSTACLE_SIMD_WIDTH 4
+#else
+#define OPENSTEER_OBSTACLE_SIMD_WIDTH 1
+#endif
+#endif
+
+
+namespace {
+
+    using namespace OpenSteer;
+
+
+    // ----------------------------------------------------------------------------
+    // find first intersection of a vehicle's path with a sphere, shared by
+    // SphereObstacle and SphereObstacleSet
+
+
+    void findIntersectionWithSphere (const AbstractVehicle& vehicle,
+                                     const Vec3& center,
+                                     const float radius,
+                                     const AbstractObstacle::seenFromState sf,
+                                     const AbstractObstacle* obstacle,
+                                     AbstractObstacle::PathIntersection& pi)
+    {
+        // This routine is based on the Paul Bourke's derivation in:
+        //   Intersection of a Line and a Sphere (or circle)
+        //   http://www.swin.edu.au/astronomy/pbourke/geometry/sphereline/
+        // But the computation is done in the vehicle's local space, so
+        // the line in question is the Z (Forward) axis of the space which
+        // simplifies some of the calculations.
+
+        float b, c, d, p, q, s;
+        Vec3 lc;
+
+        // initialize pathIntersection object to "no intersection found"
+        pi.intersect = false;
+
+        // find sphere's "local center" (lc) in the vehicle's coordinate space
+        lc = vehicle.localizePosition (center);
+        pi.vehicleOutside = lc.length () > radius;
+
+        // if obstacle is seen from inside, but vehicle is outside, must avoid
+        // (noticed once a vehicle got outside it ignored the obstacle 2008-5-20)
+        if (pi.vehicleOutside && (sf == AbstractObstacle::inside))
+        {
+            pi.intersect = true;
+            pi.distance = 0.0f;
+            pi.steerHint = (center - vehicle.position()).normalize();
+            return;
+        }
+
+        // compute line-sphere intersection parameters
+        const float r = radius + vehicle.radius();
+        b = -2 * lc.z;
+        c = square (lc.x) + square (lc.y) + square (lc.z) - square (r);
+        d = (b * b) - (4 * c);
+
+        // when the path does not intersect the sphere
+        if (d < 0) return;
+
+        // otherwise, the path intersects the sphere in two points with
+        // parametric coordinates of "p" and "q".  (If "d" is zero the two
+        // points are coincident, the path is tangent)
+        s = sqrtXXX (d);
+        p = (-b + s) / 2;
+        q = (-b - s) / 2;
+
+        // both intersections are behind us, so no potential collisions
+        if ((p < 0) && (q < 0)) return; 
+
+        // at least one intersection is in front, so intersects our forward
+        // path
+        pi.intersect = true;
+        pi.obstacle = obstacle;
+        pi.distance =
+            ((p > 0) && (q > 0)) ?
+            // both intersections are in front of us, find nearest one
+            ((p < q) ? p : q) :
+            // otherwise one is ahead and one is behind: we are INSIDE obstacle
+            (sf == AbstractObstacle::outside ?
+             // inside a solid obstacle, so distance to obstacle is zero
+             0.0f :
+             // hollow obstacle (or "both"), pick point that is in front
+             ((p > 0) ? p : q));
+        pi.surfacePoint =
+            vehicle.position() + (vehicle.forward() * pi.distance);
+        pi.surfaceNormal = (pi.surfacePoint-center).normalize();
+        switch (sf)
+        {
+        case AbstractObstacle::outside:
+            pi.steerHint = pi.surfaceNormal;
+            break;
+        case AbstractObstacle::inside:
+            pi.steerHint = -pi.surfaceNormal;
+            break;
+        case AbstractObstacle::both:
+            pi.steerHint = pi.surfaceNormal * (pi.vehicleOutside ? 1.0f : -1.0f);
+            break;
+        }
+    }
+
+
+    // ----------------------------------------------------------------------------
+    // distance along a vehicle's path (position "v", unit forward "f", radius
+    // "vr") to a sphere as computed by findIntersectionWithSphere, or FLT_MAX
+    // when the path does not intersect it.  The sphere's center is given
+    // relative to the vehicle.
+
+
+    float sphereDistanceOnPath (const float rx, const float ry, const float rz,
+                                const float radius,
+                                const Vec3& f, const float vr,
+                                const AbstractObstacle::seenFromState sf)
+    {
+        const float lz = rx * f.x + ry * f.y + rz * f.z;
+        const float length2 = rx * rx + ry * ry + rz * rz;
+        if ((sf == AbstractObstacle::inside) && (length2 > radius * radius))
+            return 0.0f;
+
+        const float r = radius + vr;
+        const float d = lz * lz - (length2 - r * r);
+        if (d < 0) return FLT_MAX;
+        const float s = sqrtXXX (d);
+        const float p = lz + s;
+        const float q = lz - s;
+        if (p < 0) return FLT_MAX;
+        if (q > 0) return q;
+        if (sf == AbstractObstacle::outside) return 0.0f;
+        return (p > 0) ? p : q;
+    }
+
+
+
+    // ----------------------------------------------------------------------------
+    // signed distance to a closed surface given its distance "d" measured
+    // positive outside and negative inside, signed for an obstacle's
+    // seenFrom state (negative within its solid)
+
+
+    float signedForSeenFrom (const float d,
+                             const AbstractObstacle::seenFromState sf)
+    {
+        switch (sf)
+        {
+        case AbstractObstacle::inside: return -d;
+        case AbstractObstacle::both:   return (d < 0) ? -d : d;
+        default:                       return d;
+        }
+    }
+
+} // anonymous namespace
+
+
 // ----------------------------------------------------------------------------
 // Obstacle
 // compute steering for a vehicle to avoid this obstacle, if needed 
@@ -141,6 +302,18 @@ steerToAvoidIfNeeded (const AbstractVehicle& vehicle,
 }
 
 
+// ----------------------------------------------------------------------------
+// AbstractObstacle
+// shapes without a distance function are left out of distance fields
+
+
+float 
+OpenSteer::AbstractObstacle::signedDistance (const Vec3& /*point*/) const
+{
+    return FLT_MAX;
+}
+
+
 // ----------------------------------------------------------------------------
 // SphereObstacle
 // find first intersection of a vehicle's path with this obstacle
@@ -152,81 +325,287 @@ SphereObstacle::
 findIntersectionWithVehiclePath (const AbstractVehicle& vehicle,
                                  PathIntersection& pi) const
 {
-    // This routine is based on the Paul Bourke's derivation in:
-    //   Intersection of a Line and a Sphere (or circle)
-    //   http://www.swin.edu.au/astronomy/pbourke/geometry/sphereline/
-    // But the computation is done in the vehicle's local space, so
-    // the line in question is the Z (Forward) axis of the space which
-    // simplifies some of the calculations.
+    findIntersectionWithSphere (vehicle, center, radius, seenFrom (), this, pi);
+}
 
-    float b, c, d, p, q, s;
-    Vec3 lc;
 
-    // initialize pathIntersection object to "no intersection found"
-    pi.intersect = false;
+// ----------------------------------------------------------------------------
+// SphereObstacle
+// signed distance from a point to the sphere's surface
 
-    // find sphere's "local center" (lc) in the vehicle's coordinate space
-    lc = vehicle.localizePosition (center);
-    pi.vehicleOutside = lc.length () > radius;
-
-	// if obstacle is seen from inside, but vehicle is outside, must avoid
-	// (noticed once a vehicle got outside it ignored the obstacle 2008-5-20)
-	if (pi.vehicleOutside && (seenFrom () == inside))
-	{
-		pi.intersect = true;
-		pi.distance = 0.0f;
-		pi.steerHint = (center - vehicle.position()).normalize();
-		return;
-	}
-	
-    // compute line-sphere intersection parameters
-    const float r = radius + vehicle.radius();
-    b = -2 * lc.z;
-    c = square (lc.x) + square (lc.y) + square (lc.z) - square (r);
-    d = (b * b) - (4 * c);
-
-    // when the path does not intersect the sphere
-    if (d < 0) return;
-
-    // otherwise, the path intersects the sphere in two points with
-    // parametric coordinates of "p" and "q".  (If "d" is zero the two
-    // points are coincident, the path is tangent)
-    s = sqrtXXX (d);
-    p = (-b + s) / 2;
-    q = (-b - s) / 2;
-
-    // both intersections are behind us, so no potential collisions
-    if ((p < 0) && (q < 0)) return; 
-
-    // at least one intersection is in front, so intersects our forward
-    // path
-    pi.intersect = true;
+
+float 
+OpenSteer::SphereObstacle::signedDistance (const Vec3& point) const
+{
+    return signedForSeenFrom (Vec3::distance (point, center) - radius,
+                              seenFrom ());
+}
+
+
+// ----------------------------------------------------------------------------
+// SphereObstacleSet
+
+
+OpenSteer::SphereObstacleSet::SphereObstacleSet (void)
+    : count (0),
+      capacity (0),
+      block (NULL),
+      xs (NULL), ys (NULL), zs (NULL), rs (NULL)
+{
+}
+
+
+OpenSteer::SphereObstacleSet::~SphereObstacleSet ()
+{
+    ::operator delete (block);
+}
+
+
+int 
+OpenSteer::SphereObstacleSet::addSphere (const float r, const Vec3& c)
+{
+    if (count == capacity) reserve (capacity ? capacity * 2 : 64);
+    setSphere (count, r, c);
+    return count++;
+}
+
+
+void 
+OpenSteer::SphereObstacleSet::setSphere (const int i, const float r, const Vec3& c)
+{
+    xs[i] = c.x;
+    ys[i] = c.y;
+    zs[i] = c.z;
+    rs[i] = r;
+}
+
+
+void 
+OpenSteer::SphereObstacleSet::removeSphere (const int i)
+{
+    const int last = --count;
+    if (i != last) setSphere (i, rs[last], center (last));
+}
+
+
+// grow the arrays to hold at least n spheres.  All arrays live in one
+// block, each starting on a 32 byte boundary.
+
+
+void 
+OpenSteer::SphereObstacleSet::reserve (const int n)
+{
+    if (n <= capacity) return;
+    const int newCapacity = ((n + 7) / 8) * 8;
+    const size_t floats = newCapacity * sizeof (float);
+    char* newBlock = (char*) ::operator new (31 + 4*floats);
+    char* p = (char*) ((((size_t) newBlock) + 31) & ~((size_t) 31));
+
+    float* newXs = (float*) p;  p += floats;
+    float* newYs = (float*) p;  p += floats;
+    float* newZs = (float*) p;  p += floats;
+    float* newRs = (float*) p;
+
+    for (int i = 0; i < count; i++)
+    {
+        newXs[i] = xs[i];
+        newYs[i] = ys[i];
+        newZs[i] = zs[i];
+        newRs[i] = rs[i];
+    }
+
+    ::operator delete (block);
+    block = newBlock;
+    xs = newXs;
+    ys = newYs;
+    zs = newZs;
+    rs = newRs;
+    capacity = newCapacity;
+}
+
+
+// ----------------------------------------------------------------------------
+// SphereObstacleSet
+// find nearest intersection of a vehicle's path with the spheres
+
+
+void 
+OpenSteer::SphereObstacleSet::
+findIntersectionWithVehiclePath (const AbstractVehicle& vehicle,
+                                 PathIntersection& pi) const
+{
+    findNearestSphereOnVehiclePath (vehicle, pi);
+}
+
+
+int 
+OpenSteer::SphereObstacleSet::
+findNearestSphereOnVehiclePath (const AbstractVehicle& vehicle,
+                                PathIntersection& pi) const
+{
+    const Vec3 v = vehicle.position ();
+    const Vec3 f = vehicle.forward ();
+    const float vr = vehicle.radius ();
+    const seenFromState sf = seenFrom ();
+
+    // find the sphere with the nearest intersection, the first one of
+    // equally near spheres (like firstPathIntersectionWithObstacleGroup)
+    float nearest = FLT_MAX;
+    int nearestIndex = -1;
+    int i = 0;
+
+#if OPENSTEER_OBSTACLE_SIMD_WIDTH == 8
+    const __m256 vx = _mm256_set1_ps (v.x);
+    const __m256 vy = _mm256_set1_ps (v.y);
+    const __m256 vz = _mm256_set1_ps (v.z);
+    const __m256 fx = _mm256_set1_ps (f.x);
+    const __m256 fy = _mm256_set1_ps (f.y);
+    const __m256 fz = _mm256_set1_ps (f.z);
+    const __m256 vrv = _mm256_set1_ps (vr);
+    const __m256 zero = _mm256_setzero_ps ();
+    const __m256 none = _mm256_set1_ps (FLT_MAX);
+    const __m256 solid = (sf == outside) ? _mm256_castsi256_ps (_mm256_set1_epi32 (-1)) : zero;
+    for (; i + 8 <= count; i += 8)
+    {
+        const __m256 rx = _mm256_sub_ps (_mm256_load_ps (xs + i), vx);
+        const __m256 ry = _mm256_sub_ps (_mm256_load_ps (ys + i), vy);
+        const __m256 rz = _mm256_sub_ps (_mm256_load_ps (zs + i), vz);
+        const __m256 radius = _mm256_load_ps (rs + i);
+        const __m256 lz = _mm256_add_ps (_mm256_mul_ps (rx, fx),
+                          _mm256_add_ps (_mm256_mul_ps (ry, fy),
+                                         _mm256_mul_ps (rz, fz)));
+        const __m256 length2 = _mm256_add_ps (_mm256_mul_ps (rx, rx),
+                               _mm256_add_ps (_mm256_mul_ps (ry, ry),
+                                              _mm256_mul_ps (rz, rz)));
+        const __m256 r = _mm256_add_ps (radius, vrv);
+        const __m256 d = _mm256_sub_ps (_mm256_mul_ps (lz, lz),
+                                        _mm256_sub_ps (length2, _mm256_mul_ps (r, r)));
+        const __m256 s = _mm256_sqrt_ps (_mm256_max_ps (d, zero));
+        const __m256 p = _mm256_add_ps (lz, s);
+        const __m256 q = _mm256_sub_ps (lz, s);
+
+        // q when both are ahead, otherwise zero for solid spheres, else p
+        // if ahead, else q
+        const __m256 behind = _mm256_blendv_ps (p, q, _mm256_cmp_ps (p, zero, _CMP_LE_OQ));
+        const __m256 inner = _mm256_blendv_ps (behind, zero, solid);
+        __m256 distance = _mm256_blendv_ps (inner, q, _mm256_cmp_ps (q, zero, _CMP_GT_OQ));
+        const __m256 hit = _mm256_and_ps (_mm256_cmp_ps (d, zero, _CMP_GE_OQ),
+                                          _mm256_cmp_ps (p, zero, _CMP_GE_OQ));
+        distance = _mm256_blendv_ps (none, distance, hit);
+
+        // outside a sphere seen from inside, avoid at once
+        if (sf == inside)
+        {
+            const __m256 out = _mm256_cmp_ps (length2, _mm256_mul_ps (radius, radius), _CMP_GT_OQ);
+            distance = _mm256_blendv_ps (distance, zero, out);
+        }
+
+        if (_mm256_movemask_ps (_mm256_cmp_ps (distance, _mm256_set1_ps (nearest), _CMP_LT_OQ)))
+        {
+            float lanes[8];
+            _mm256_storeu_ps (lanes, distance);
+            for (int k = 0; k < 8; k++)
+            {
+                if (lanes[k] < nearest) {nearest = lanes[k]; nearestIndex = i + k;}
+            }
+        }
+    }
+#elif OPENSTEER_OBSTACLE_SIMD_WIDTH == 4
+    const __m128 vx = _mm_set1_ps (v.x);
+    const __m128 vy = _mm_set1_ps (v.y);
+    const __m128 vz = _mm_set1_ps (v.z);
+    const __m128 fx = _mm_set1_ps (f.x);
+    const __m128 fy = _mm_set1_ps (f.y);
+    const __m128 fz = _mm_set1_ps (f.z);
+    const __m128 vrv = _mm_set1_ps (vr);
+    const __m128 zero = _mm_setzero_ps ();
+    const __m128 none = _mm_set1_ps (FLT_MAX);
+    for (; i + 4 <= count; i += 4)
+    {
+        const __m128 rx = _mm_sub_ps (_mm_load_ps (xs + i), vx);
+        const __m128 ry = _mm_sub_ps (_mm_load_ps (ys + i), vy);
+        const __m128 rz = _mm_sub_ps (_mm_load_ps (zs + i), vz);
+        const __m128 radius = _mm_load_ps (rs + i);
+        const __m128 lz = _mm_add_ps (_mm_mul_ps (rx, fx),
+                          _mm_add_ps (_mm_mul_ps (ry, fy),
+                                      _mm_mul_ps (rz, fz)));
+        const __m128 length2 = _mm_add_ps (_mm_mul_ps (rx, rx),
+                               _mm_add_ps (_mm_mul_ps (ry, ry),
+                                           _mm_mul_ps (rz, rz)));
+        const __m128 r = _mm_add_ps (radius, vrv);
+        const __m128 d = _mm_sub_ps (_mm_mul_ps (lz, lz),
+                                     _mm_sub_ps (length2, _mm_mul_ps (r, r)));
+        const __m128 s = _mm_sqrt_ps (_mm_max_ps (d, zero));
+        const __m128 p = _mm_add_ps (lz, s);
+        const __m128 q = _mm_sub_ps (lz, s);
+
+        // q when both are ahead, otherwise zero for solid spheres, else p
+        // if ahead, else q (SSE has no blend: select with and/andnot/or)
+        const __m128 pAhead = _mm_cmpgt_ps (p, zero);
+        __m128 distance = (sf == outside) ? zero :
+            _mm_or_ps (_mm_and_ps (pAhead, p), _mm_andnot_ps (pAhead, q));
+        const __m128 qAhead = _mm_cmpgt_ps (q, zero);
+        distance = _mm_or_ps (_mm_and_ps (qAhead, q), _mm_andnot_ps (qAhead, distance));
+        const __m128 hit = _mm_and_ps (_mm_cmpge_ps (d, zero), _mm_cmpge_ps (p, zero));
+        distance = _mm_or_ps (_mm_and_ps (hit, distance), _mm_andnot_ps (hit, none));
+
+        // outside a sphere seen from inside, avoid at once
+        if (sf == inside)
+        {
+            const __m128 out = _mm_cmpgt_ps (length2, _mm_mul_ps (radius, radius));
+            distance = _mm_andnot_ps (out, distance);
+        }
+
+        if (_mm_movemask_ps (_mm_cmplt_ps (distance, _mm_set1_ps (nearest))))
+        {
+            float lanes[4];
+            _mm_storeu_ps (lanes, distance);
+            for (int k = 0; k < 4; k++)
+            {
+                if (lanes[k] < nearest) {nearest = lanes[k]; nearestIndex = i + k;}
+            }
+        }
+    }
+#endif
+
+    // scalar loop for the remaining spheres (or all of them)
+    for (; i < count; i++)
+    {
+        const float distance = sphereDistanceOnPath (xs[i] - v.x,
+                                                     ys[i] - v.y,
+                                                     zs[i] - v.z,
+                                                     rs[i], f, vr, sf);
+        if (distance < nearest) {nearest = distance; nearestIndex = i;}
+    }
+
+    // fill in the intersection with the nearest sphere like SphereObstacle
+    pi.intersect = false;
+    if (nearestIndex < 0) return -1;
+    findIntersectionWithSphere (vehicle, center (nearestIndex),
+                                rs[nearestIndex], sf, this, pi);
     pi.obstacle = this;
-    pi.distance =
-        ((p > 0) && (q > 0)) ?
-        // both intersections are in front of us, find nearest one
-        ((p < q) ? p : q) :
-        // otherwise one is ahead and one is behind: we are INSIDE obstacle
-        (seenFrom () == outside ?
-         // inside a solid obstacle, so distance to obstacle is zero
-         0.0f :
-         // hollow obstacle (or "both"), pick point that is in front
-         ((p > 0) ? p : q));
-    pi.surfacePoint =
-        vehicle.position() + (vehicle.forward() * pi.distance);
-    pi.surfaceNormal = (pi.surfacePoint-center).normalize();
-    switch (seenFrom ())
+    return nearestIndex;
+}
+
+
+// ----------------------------------------------------------------------------
+// SphereObstacleSet
+// signed distance from a point to the nearest sphere's surface (the spheres
+// are solid where any of them is, so the nearest is the minimum)
+
+
+float 
+OpenSteer::SphereObstacleSet::signedDistance (const Vec3& point) const
+{
+    const seenFromState sf = seenFrom ();
+    float nearest = FLT_MAX;
+    for (int i = 0; i < count; i++)
     {
-    case outside:
-        pi.steerHint = pi.surfaceNormal;
-        break;
-    case inside:
-        pi.steerHint = -pi.surfaceNormal;
-        break;
-    case both:
-        pi.steerHint = pi.surfaceNormal * (pi.vehicleOutside ? 1.0f : -1.0f);
-        break;
+        const Vec3 offset (xs[i] - point.x, ys[i] - point.y, zs[i] - point.z);
+        const float d = signedForSeenFrom (offset.length () - rs[i], sf);
+        if (d < nearest) nearest = d;
     }
+    return nearest;
 }
 
 
@@ -241,50 +620,172 @@ BoxObstacle::
 findIntersectionWithVehiclePath (const AbstractVehicle& vehicle,
                                  PathIntersection& pi) const
 {
-    // abbreviations
-    const float w = width; // dimensions
-    const float h = height;
-    const float d = depth;
-    const Vec3 s = side (); // local space
-    const Vec3 u = up ();
-    const Vec3 f = forward ();
-    const Vec3 p = position ();
-    const Vec3 hw = s * (0.5f * width); // offsets for face centers
-    const Vec3 hh = u * (0.5f * height);
-    const Vec3 hd = f * (0.5f * depth);
+    findIntersectionWithPath (vehicle.position (),
+                              vehicle.forward (),
+                              vehicle.radius (),
+                              pi);
+}
+
+
+// ----------------------------------------------------------------------------
+// BoxObstacle
+// find first intersection of a path with this obstacle
+//
+// Each pair of opposite faces bounds a slab along one local axis.  A face
+// is treated exactly like a RectangleObstacle (PlaneObstacle) in its own
+// local space: it is hit where the path crosses its plane heading towards
+// it, from a side it is seen from, within the face grown by the path
+// radius.  Faces are tested in the order front, back, side, other side,
+// top, bottom and the first of equally near hits is taken.
+
+
+void 
+OpenSteer::
+BoxObstacle::
+findIntersectionWithPath (const Vec3& pathPosition,
+                          const Vec3& pathDirection,
+                          const float pathRadius,
+                          PathIntersection& pi) const
+{
+    // initialize pathIntersection object to "no intersection found"
+    pi.intersect = false;
+
+    // path in the box's local space, by axis (side, up, forward)
+    const Vec3 lp = localizePosition (pathPosition);
+    const Vec3 ld = localizeDirection (pathDirection);
+    const float p[3] = {lp.x, lp.y, lp.z};
+    const float d[3] = {ld.x, ld.y, ld.z};
+    const float e[3] = {width * 0.5f, height * 0.5f, depth * 0.5f};
+
+    // axis and direction of the outward normal of each face
+    const int faceAxis[6] = {2, 2, 0, 0, 1, 1};
+    const float faceSign[6] = {+1.0f, -1.0f, +1.0f, -1.0f, +1.0f, -1.0f};
     const seenFromState sf = seenFrom ();
 
-    // the box's six rectangular faces
-    RectangleObstacle r1 (w, h,  s,  u,  f, p + hd, sf); // front
-    RectangleObstacle r2 (w, h, -s,  u, -f, p - hd, sf); // back
-    RectangleObstacle r3 (d, h, -f,  u,  s, p + hw, sf); // side
-    RectangleObstacle r4 (d, h,  f,  u, -s, p - hw, sf); // other side
-    RectangleObstacle r5 (w, d,  s, -f,  u, p + hh, sf); // top
-    RectangleObstacle r6 (w, d, -s, -f, -u, p - hh, sf); // bottom
-
-    // group the six RectangleObstacle faces together
-    ObstacleGroup faces;
-    faces.push_back (&r1);
-    faces.push_back (&r2);
-    faces.push_back (&r3);
-    faces.push_back (&r4);
-    faces.push_back (&r5);
-    faces.push_back (&r6);
-
-    // find first intersection of vehicle path with group of six faces
-    PathIntersection next;
-    firstPathIntersectionWithObstacleGroup (vehicle, faces, pi, next);
+    int nearestFace = -1;
+    float nearestDistance = 0.0f;
+    float nearestB = 0.0f;
+    float nearestC = 0.0f;
+    float nearestHeight = 0.0f;
+
+    for (int i = 0; i < 6; i++)
+    {
+        const int a = faceAxis[i];
+        const int b = (a + 1) % 3;
+        const int c = (a + 2) % 3;
+
+        // path position and direction along the face normal, relative to
+        // the face's plane
+        const float pz = faceSign[i] * p[a] - e[a];
+        const float dz = faceSign[i] * d[a];
+
+        // no intersection if path is parallel to the face or heading away
+        if (dz == 0.0f) continue;
+        if ((pz > 0.0f) && (dz > 0.0f)) continue;
+        if ((pz < 0.0f) && (dz < 0.0f)) continue;
+
+        // no intersection if face "not seen" from the path's side
+        if ((sf == outside) && (pz < 0.0f)) continue;
+        if ((sf == inside)  && (pz > 0.0f)) continue;
+
+        // no intersection if the plane intersection is outside the face
+        const float ib = p[b] - (d[b] * pz / dz);
+        const float ic = p[c] - (d[c] * pz / dz);
+        const float wb = pathRadius + e[b];
+        const float wc = pathRadius + e[c];
+        if ((ib > wb) || (ib < -wb) || (ic > wc) || (ic < -wc)) continue;
+
+        const float distance = sqrtXXX (square (p[b] - ib) +
+                                        square (p[c] - ic) +
+                                        square (pz));
+        if ((nearestFace < 0) || (distance < nearestDistance))
+        {
+            nearestFace = i;
+            nearestDistance = distance;
+            nearestB = ib;
+            nearestC = ic;
+            nearestHeight = pz;
+        }
+    }
+
+    if (nearestFace < 0) return;
+
+    // surface point and normal of the nearest face hit
+    const int a = faceAxis[nearestFace];
+    float q[3];
+    q[a] = faceSign[nearestFace] * e[a];
+    q[(a + 1) % 3] = nearestB;
+    q[(a + 2) % 3] = nearestC;
+    const Vec3 axis = (a == 0) ? side () : ((a == 1) ? up () : forward ());
+    const float sideSign = (nearestHeight > 0.0f) ? +1.0f : -1.0f;
+
+    pi.intersect = true;
+    pi.obstacle = this;
+    pi.distance = nearestDistance;
+    pi.surfacePoint = globalizePosition (Vec3 (q[0], q[1], q[2]));
+    pi.surfaceNormal = axis * (faceSign[nearestFace] * sideSign);
+    pi.vehicleOutside = nearestHeight > 0.0f;
+    pi.steerHint = ((pi.surfacePoint - position ()).normalize () *
+                    (pi.vehicleOutside ? 1.0f : -1.0f));
+}
+
+
+// ----------------------------------------------------------------------------
+// BoxObstacle
+// static method to find the first vehicle path intersection with an array
+// of boxes
+
+
+void 
+OpenSteer::
+BoxObstacle::
+firstPathIntersectionWithBoxes (const AbstractVehicle& vehicle,
+                                const BoxObstacle* const boxes[],
+                                const int count,
+                                PathIntersection& nearest)
+{
+    const Vec3 position = vehicle.position ();
+    const Vec3 forward = vehicle.forward ();
+    const float radius = vehicle.radius ();
 
-    // when intersection found, adjust PathIntersection for the box case
-    if (pi.intersect)
+    // test all boxes for an intersection with the vehicle's future path,
+    // select the one whose point of intersection is nearest
+    PathIntersection next;
+    nearest.intersect = false;
+    for (int i = 0; i < count; i++)
     {
-        pi.obstacle = this;
-        pi.steerHint = ((pi.surfacePoint - position ()).normalize () *
-                        (pi.vehicleOutside ? 1.0f : -1.0f));
+        boxes[i]->findIntersectionWithPath (position, forward, radius, next);
+        if (next.intersect &&
+            (!nearest.intersect || (next.distance < nearest.distance)))
+        {
+            nearest = next;
+        }
     }
 }
 
 
+// ----------------------------------------------------------------------------
+// BoxObstacle
+// signed distance from a point to the box's surface, measured in its local
+// space: outside the box it is the distance to the nearest point of the
+// box, inside it is minus the distance to the nearest face
+
+
+float 
+OpenSteer::
+BoxObstacle::
+signedDistance (const Vec3& point) const
+{
+    const Vec3 lp = localizePosition (point);
+    const float dx = absXXX (lp.x) - width * 0.5f;
+    const float dy = absXXX (lp.y) - height * 0.5f;
+    const float dz = absXXX (lp.z) - depth * 0.5f;
+    const Vec3 outside (maxXXX (dx, 0.0f), maxXXX (dy, 0.0f), maxXXX (dz, 0.0f));
+    const float inside = minXXX (maxXXX (dx, maxXXX (dy, dz)), 0.0f);
+    return signedForSeenFrom (outside.length () + inside, seenFrom ());
+}
+
+
 // ----------------------------------------------------------------------------
 // PlaneObstacle
 // find first intersection of a vehicle's path with this obstacle
@@ -336,6 +837,20 @@ findIntersectionWithVehiclePath (const AbstractVehicle& vehicle,
 }
 
 
+// ----------------------------------------------------------------------------
+// PlaneObstacle
+// signed distance from a point to the plane, its -Z half-space is the solid
+
+
+float 
+OpenSteer::
+PlaneObstacle::
+signedDistance (const Vec3& point) const
+{
+    return signedForSeenFrom (localizePosition (point).z, seenFrom ());
+}
+
+
 // ----------------------------------------------------------------------------
 // RectangleObstacle
 // determines if a given point on XY plane is inside obstacle shape
@@ -352,4 +867,21 @@ xyPointInsideShape (const Vec3& point, float radius) const
 }
 
 
+// ----------------------------------------------------------------------------
+// RectangleObstacle
+// distance from a point to the rectangle (a thin plate, so never negative)
+
+
+float 
+OpenSteer::
+RectangleObstacle::
+signedDistance (const Vec3& point) const
+{
+    const Vec3 lp = localizePosition (point);
+    const float dx = maxXXX (absXXX (lp.x) - width * 0.5f, 0.0f);
+    const float dy = maxXXX (absXXX (lp.y) - height * 0.5f, 0.0f);
+    return Vec3 (dx, dy, lp.z).length ();
+}
+
+
 // ----------------------------------------------------------------------------
@@ -0,0 +1,501 @@
+/**
+ * OpenSteer -- Steering Behaviors for Autonomous Characters
+ *
+ * Copyright (c) 2002-2005, Sony Computer Entertainment America
+ * Original author: Craig Reynolds <craig_reynolds@playstation.sony.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+#include "OpenSteer/ObstacleDistanceField.h"
+
+
+// Include std::ceil, std::floor, std::sqrt
+#include <cmath>
+
+// Include assert
+#include <cassert>
+
+// Include FLT_MAX
+#include <cfloat>
+
+// Include std::min, std::max
+#include <algorithm>
+
+// Include std::istream, std::ostream
+#include <iostream>
+
+// Include std::numeric_limits
+#include <limits>
+
+
+// Include OpenSteer::AbstractVehicle
+#include "OpenSteer/AbstractVehicle.h"
+
+// Include OpenSteer::clamp
+#include "OpenSteer/Utilities.h"
+
+#ifdef _MSC_VER
+#undef min
+#undef max
+#endif
+
+
+namespace {
+    
+    /**
+     * Header of a written field: tag, format version and a marker to detect
+     * fields written with another byte order, followed by the grid layout.
+     */
+    struct FileHeader {
+        char tag[ 4 ];
+        unsigned int version;
+        unsigned int byteOrder;
+        unsigned int nodeCountX;
+        unsigned int nodeCountY;
+        unsigned int nodeCountZ;
+        float cellSize;
+        float origin[ 3 ];
+    };
+    
+    char const fileTag[ 4 ] = { 'O', 'S', 'D', 'F' };
+    unsigned int const fileVersion = 1;
+    unsigned int const fileByteOrder = 0x01020304;
+    
+    /**
+     * Bytes stored per node: the distance and the three gradient components.
+     */
+    size_t const nodeBytes = 4 * sizeof( float );
+    
+    
+    /**
+     * Number of bytes left to read in @a stream, @c -1 if the stream can't
+     * tell (it can't seek).
+     */
+    std::streamoff remainingBytes( std::istream& stream )
+    {
+        std::streampos const position = stream.tellg();
+        if ( std::streampos( -1 ) == position ) {
+            return -1;
+        }
+        stream.seekg( 0, std::ios::end );
+        std::streampos const end = stream.tellg();
+        stream.seekg( position );
+        if ( std::streampos( -1 ) == end || ! stream ) {
+            stream.clear();
+            return -1;
+        }
+        return end - position;
+    }
+    
+    
+    /**
+     * Number of nodes @a cellSize apart needed to cover @a extent, at least
+     * two so there is always a cell to interpolate in.
+     */
+    size_t nodeCount( float extent, float cellSize ) 
+    {
+        return std::max( size_t( 2 ), static_cast< size_t >( std::ceil( extent / cellSize ) ) + 1 );
+    }
+    
+    
+    /**
+     * Lower node of the cell containing grid coordinate @a f along an axis
+     * with @a count nodes and the interpolation weight of the upper node.
+     */
+    size_t cellAt( float f, size_t count, float& t ) 
+    {
+        float const lower = OpenSteer::clamp( std::floor( f ), 0.0f, static_cast< float >( count - 2 ) );
+        t = OpenSteer::clamp( f - lower, 0.0f, 1.0f );
+        return static_cast< size_t >( lower );
+    }
+    
+} // anonymous namespace
+
+
+
+OpenSteer::ObstacleDistanceField::ObstacleDistanceField()
+    : origin_( 0.0f, 0.0f, 0.0f ),
+      cellSize_( 1.0f ),
+      nodeCountX_( 0 ),
+      nodeCountY_( 0 ),
+      nodeCountZ_( 0 ),
+      distances_(),
+      gradients_()
+{
+    // Nothing to do.
+}
+
+
+
+void 
+OpenSteer::ObstacleDistanceField::bake( ObstacleGroup const& obstacles, 
+                                        Vec3 const& minimum, 
+                                        Vec3 const& maximum, 
+                                        float cellSize )
+{
+    assert( cellSize > 0.0f && "cellSize must be greater than 0." );
+    
+    origin_ = minimum;
+    cellSize_ = cellSize;
+    nodeCountX_ = nodeCount( maximum.x - minimum.x, cellSize );
+    nodeCountY_ = ( maximum.y == minimum.y ) ? 1 : nodeCount( maximum.y - minimum.y, cellSize );
+    nodeCountZ_ = nodeCount( maximum.z - minimum.z, cellSize );
+    distances_.assign( nodeCountX_ * nodeCountY_ * nodeCountZ_, FLT_MAX );
+    
+    // Each row of nodes along X is independent of the others.
+    int const rowCount = static_cast< int >( nodeCountY_ * nodeCountZ_ );
+#ifdef _OPENMP
+    #pragma omp parallel for schedule(dynamic)
+#endif
+    for ( int row = 0; row < rowCount; ++row ) {
+        size_type const y = static_cast< size_type >( row ) / nodeCountZ_;
+        size_type const z = static_cast< size_type >( row ) % nodeCountZ_;
+        for ( size_type x = 0; x < nodeCountX_; ++x ) {
+            Vec3 const position = nodePosition( x, y, z );
+            float nearest = FLT_MAX;
+            for ( ObstacleIterator o = obstacles.begin(); o != obstacles.end(); ++o ) {
+                nearest = std::min( nearest, ( **o ).signedDistance( position ) );
+            }
+            distances_[ nodeIndex( x, y, z ) ] = nearest;
+        }
+    }
+    
+    computeGradients();
+}
+
+
+
+bool 
+OpenSteer::ObstacleDistanceField::isValid() const
+{
+    return ! distances_.empty();
+}
+
+
+
+bool 
+OpenSteer::ObstacleDistanceField::isPlanar() const
+{
+    return 1 == nodeCountY_;
+}
+
+
+
+bool 
+OpenSteer::ObstacleDistanceField::contains( Vec3 const& point ) const
+{
+    float const x = ( point.x - origin_.x ) / cellSize_;
+    float const y = ( point.y - origin_.y ) / cellSize_;
+    float const z = ( point.z - origin_.z ) / cellSize_;
+    return isValid() &&
+           ( x >= 0.0f ) && ( x <= static_cast< float >( nodeCountX_ - 1 ) ) &&
+           ( z >= 0.0f ) && ( z <= static_cast< float >( nodeCountZ_ - 1 ) ) &&
+           ( isPlanar() || ( ( y >= 0.0f ) && ( y <= static_cast< float >( nodeCountY_ - 1 ) ) ) );
+}
+
+
+
+bool 
+OpenSteer::ObstacleDistanceField::sample( Vec3 const& point, Sample& result ) const
+{
+    if ( ! contains( point ) ) {
+        return false;
+    }
+    
+    float tx = 0.0f;
+    float tz = 0.0f;
+    size_type const x0 = cellAt( ( point.x - origin_.x ) / cellSize_, nodeCountX_, tx );
+    size_type const z0 = cellAt( ( point.z - origin_.z ) / cellSize_, nodeCountZ_, tz );
+    
+    // Bilinear interpolation in the XZ cell, per layer for volumes.
+    float ty = 0.0f;
+    size_type const y0 = isPlanar() ? 0 : cellAt( ( point.y - origin_.y ) / cellSize_, nodeCountY_, ty );
+    size_type const layerCount = isPlanar() ? 1 : 2;
+    
+    float distance = 0.0f;
+    Vec3 gradient( 0.0f, 0.0f, 0.0f );
+    for ( size_type layer = 0; layer < layerCount; ++layer ) {
+        float const wy = ( 0 == layer ) ? ( 1.0f - ty ) : ty;
+        for ( size_type corner = 0; corner < 4; ++corner ) {
+            size_type const dx = corner & 1;
+            size_type const dz = corner >> 1;
+            float const w = wy * ( dx ? tx : 1.0f - tx ) * ( dz ? tz : 1.0f - tz );
+            size_type const i = nodeIndex( x0 + dx, y0 + layer, z0 + dz );
+            distance += w * distances_[ i ];
+            gradient += Vec3( gradients_[ 3 * i ], gradients_[ 3 * i + 1 ], gradients_[ 3 * i + 2 ] ) * w;
+        }
+    }
+    
+    result.distance = distance;
+    result.gradient = gradient.normalize();
+    return true;
+}
+
+
+
+void 
+OpenSteer::ObstacleDistanceField::findIntersectionWithPath( Vec3 const& pathPosition,
+                                                            Vec3 const& pathDirection,
+                                                            float pathRadius,
+                                                            float maxDistance,
+                                                            AbstractObstacle::PathIntersection& pi ) const
+{
+    pi.intersect = false;
+    pi.vehicleOutside = true;
+    
+    float const minimumStep = 0.25f * cellSize_;
+    Sample sample;
+    float traveled = 0.0f;
+    while ( traveled <= maxDistance ) {
+        Vec3 const point = pathPosition + pathDirection * traveled;
+        if ( ! this->sample( point, sample ) ) {
+            // Nothing is baked off the grid, keep going until the path
+            // (maybe) enters it.
+            traveled += cellSize_;
+            continue;
+        }
+        
+        if ( 0.0f == traveled ) {
+            pi.vehicleOutside = sample.distance > 0.0f;
+        }
+        
+        float const clearance = sample.distance - pathRadius;
+        if ( clearance <= 0.0f ) {
+            pi.intersect = true;
+            pi.obstacle = 0;
+            pi.distance = traveled;
+            pi.surfacePoint = point;
+            pi.surfaceNormal = sample.gradient;
+            pi.steerHint = sample.gradient;
+            return;
+        }
+        
+        traveled += std::max( clearance, minimumStep );
+    }
+}
+
+
+
+void 
+OpenSteer::ObstacleDistanceField::findIntersectionWithVehiclePath( AbstractVehicle const& vehicle,
+                                                                   float maxDistance,
+                                                                   AbstractObstacle::PathIntersection& pi ) const
+{
+    findIntersectionWithPath( vehicle.position(), vehicle.forward(), vehicle.radius(), maxDistance, pi );
+}
+
+
+
+float 
+OpenSteer::ObstacleDistanceField::cellSize() const
+{
+    return cellSize_;
+}
+
+
+
+OpenSteer::Vec3 const& 
+OpenSteer::ObstacleDistanceField::origin() const
+{
+    return origin_;
+}
+
+
+
+OpenSteer::ObstacleDistanceField::size_type 
+OpenSteer::ObstacleDistanceField::nodeCountX() const
+{
+    return nodeCountX_;
+}
+
+
+
+OpenSteer::ObstacleDistanceField::size_type 
+OpenSteer::ObstacleDistanceField::nodeCountY() const
+{
+    return nodeCountY_;
+}
+
+
+
+OpenSteer::ObstacleDistanceField::size_type 
+OpenSteer::ObstacleDistanceField::nodeCountZ() const
+{
+    return nodeCountZ_;
+}
+
+
+
+OpenSteer::Vec3 
+OpenSteer::ObstacleDistanceField::nodePosition( size_type x, size_type y, size_type z ) const
+{
+    return Vec3( origin_.x + static_cast< float >( x ) * cellSize_,
+                 origin_.y + static_cast< float >( y ) * cellSize_,
+                 origin_.z + static_cast< float >( z ) * cellSize_ );
+}
+
+
+
+float 
+OpenSteer::ObstacleDistanceField::nodeDistance( size_type x, size_type y, size_type z ) const
+{
+    return distances_[ nodeIndex( x, y, z ) ];
+}
+
+
+
+OpenSteer::Vec3 
+OpenSteer::ObstacleDistanceField::nodeGradient( size_type x, size_type y, size_type z ) const
+{
+    size_type const i = nodeIndex( x, y, z );
+    return Vec3( gradients_[ 3 * i ], gradients_[ 3 * i + 1 ], gradients_[ 3 * i + 2 ] );
+}
+
+
+
+bool 
+OpenSteer::ObstacleDistanceField::write( std::ostream& stream ) const
+{
+    FileHeader header;
+    std::copy( fileTag, fileTag + 4, header.tag );
+    header.version = fileVersion;
+    header.byteOrder = fileByteOrder;
+    header.nodeCountX = static_cast< unsigned int >( nodeCountX_ );
+    header.nodeCountY = static_cast< unsigned int >( nodeCountY_ );
+    header.nodeCountZ = static_cast< unsigned int >( nodeCountZ_ );
+    header.cellSize = cellSize_;
+    header.origin[ 0 ] = origin_.x;
+    header.origin[ 1 ] = origin_.y;
+    header.origin[ 2 ] = origin_.z;
+    
+    stream.write( reinterpret_cast< char const* >( &header ), sizeof( header ) );
+    if ( ! distances_.empty() ) {
+        stream.write( reinterpret_cast< char const* >( &distances_[ 0 ] ), distances_.size() * sizeof( float ) );
+        stream.write( reinterpret_cast< char const* >( &gradients_[ 0 ] ), gradients_.size() * sizeof( float ) );
+    }
+    return stream.good();
+}
+
+
+
+bool 
+OpenSteer::ObstacleDistanceField::read( std::istream& stream )
+{
+    FileHeader header;
+    if ( ! stream.read( reinterpret_cast< char* >( &header ), sizeof( header ) ) ||
+         ! std::equal( fileTag, fileTag + 4, header.tag ) ||
+         fileVersion != header.version ||
+         fileByteOrder != header.byteOrder ||
+         ! ( header.cellSize > 0.0f ) ) {
+        return false;
+    }
+    
+    // A field has nodes along every axis or none at all (not baked).
+    unsigned int const zeroCounts = ( 0 == header.nodeCountX ) + ( 0 == header.nodeCountY ) + ( 0 == header.nodeCountZ );
+    if ( 0 != zeroCounts && 3 != zeroCounts ) {
+        return false;
+    }
+    
+    // Check the node count against what the stream holds before allocating
+    // anything, so a corrupt header can't ask for huge amounts of memory.
+    size_type const maxCount = std::numeric_limits< size_type >::max() / nodeBytes;
+    size_type count = header.nodeCountX;
+    if ( 0 != header.nodeCountY && count > maxCount / header.nodeCountY ) {
+        return false;
+    }
+    count *= header.nodeCountY;
+    if ( 0 != header.nodeCountZ && count > maxCount / header.nodeCountZ ) {
+        return false;
+    }
+    count *= header.nodeCountZ;
+    std::streamoff const remaining = remainingBytes( stream );
+    if ( remaining < 0 || 
+         static_cast< std::streamoff >( count ) > remaining / static_cast< std::streamoff >( nodeBytes ) ) {
+        return false;
+    }
+    
+    // Read into temporaries so a truncated stream leaves the field as is.
+    std::vector< float > distances( count );
+    std::vector< float > gradients( 3 * count );
+    if ( 0 != count &&
+         ! ( stream.read( reinterpret_cast< char* >( &distances[ 0 ] ), count * sizeof( float ) ) &&
+             stream.read( reinterpret_cast< char* >( &gradients[ 0 ] ), 3 * count * sizeof( float ) ) ) ) {
+        return false;
+    }
+    
+    origin_ = Vec3( header.origin[ 0 ], header.origin[ 1 ], header.origin[ 2 ] );
+    cellSize_ = header.cellSize;
+    nodeCountX_ = header.nodeCountX;
+    nodeCountY_ = header.nodeCountY;
+    nodeCountZ_ = header.nodeCountZ;
+    distances_.swap( distances );
+    gradients_.swap( gradients );
+    return true;
+}
+
+
+
+OpenSteer::ObstacleDistanceField::size_type 
+OpenSteer::ObstacleDistanceField::nodeIndex( size_type x, size_type y, size_type z ) const
+{
+    assert( x < nodeCountX_ && y < nodeCountY_ && z < nodeCountZ_ && "Node index out of range." );
+    return ( y * nodeCountZ_ + z ) * nodeCountX_ + x;
+}
+
+
+
+void 
+OpenSteer::ObstacleDistanceField::computeGradients()
+{
+    // Central differences between the neighboring nodes (one sided at the
+    // border), zero where a neighbor has no obstacle in reach.
+    gradients_.assign( 3 * distances_.size(), 0.0f );
+    size_type const counts[ 3 ] = { nodeCountX_, nodeCountY_, nodeCountZ_ };
+    
+    for ( size_type y = 0; y < nodeCountY_; ++y ) {
+        for ( size_type z = 0; z < nodeCountZ_; ++z ) {
+            for ( size_type x = 0; x < nodeCountX_; ++x ) {
+                size_type const node[ 3 ] = { x, y, z };
+                float difference[ 3 ] = { 0.0f, 0.0f, 0.0f };
+                bool reached = true;
+                for ( size_type axis = 0; axis < 3; ++axis ) {
+                    if ( counts[ axis ] < 2 ) {
+                        continue;
+                    }
+                    size_type lower[ 3 ] = { x, y, z };
+                    size_type upper[ 3 ] = { x, y, z };
+                    lower[ axis ] = ( node[ axis ] > 0 ) ? node[ axis ] - 1 : 0;
+                    upper[ axis ] = std::min( node[ axis ] + 1, counts[ axis ] - 1 );
+                    float const d0 = distances_[ nodeIndex( lower[ 0 ], lower[ 1 ], lower[ 2 ] ) ];
+                    float const d1 = distances_[ nodeIndex( upper[ 0 ], upper[ 1 ], upper[ 2 ] ) ];
+                    reached = reached && ( d0 < FLT_MAX ) && ( d1 < FLT_MAX );
+                    difference[ axis ] = ( d1 - d0 ) / ( static_cast< float >( upper[ axis ] - lower[ axis ] ) * cellSize_ );
+                }
+                
+                if ( reached ) {
+                    Vec3 const gradient = Vec3( difference[ 0 ], difference[ 1 ], difference[ 2 ] ).normalize();
+                    size_type const i = nodeIndex( x, y, z );
+                    gradients_[ 3 * i ] = gradient.x;
+                    gradients_[ 3 * i + 1 ] = gradient.y;
+                    gradients_[ 3 * i + 2 ] = gradient.z;
+                }
+            }
+        }
+    }
+}
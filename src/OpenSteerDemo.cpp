@@ -49,6 +49,7 @@
 #include <algorithm>
 #include <sstream>
 #include <iomanip>
+#include <cstdlib>
 
 // Include headers for OpenGL (gl.h), OpenGL Utility Library (glu.h) and
 // OpenGL Utility Toolkit (glut.h).
@@ -150,6 +151,27 @@ OpenSteer::OpenSteerDemo::initialize (void)
 }
 
 
+// ----------------------------------------------------------------------------
+// run a PlugIn in batch mode (without graphics)
+
+
+int 
+OpenSteer::OpenSteerDemo::runBatch (const char* plugInName,
+                                    int argc,
+                                    char** argv)
+{
+    PlugIn* pi = PlugIn::findByName (plugInName);
+    if (!pi)
+    {
+        std::cerr << "no PlugIn named \"" << plugInName << "\", known plugins:"
+                  << std::endl;
+        PlugIn::applyToAll (printPlugIn);
+        return EXIT_FAILURE;
+    }
+    return pi->runBatch (argc, argv);
+}
+
+
 // ----------------------------------------------------------------------------
 // main update function: step simulation forward and redraw scene
 
@@ -32,6 +32,24 @@ OpenSteer::Pathway::~Pathway()
     // Nothing to do.
 }
 
+
+
+void 
+OpenSteer::Pathway::mapPointsToPath( size_t count, 
+                                     Vec3 const* points, 
+                                     float const* offsets, 
+                                     PointMapping* mappings ) const
+{
+    for ( size_t i = 0; i < count; ++i ) {
+        PointMapping& mapping = mappings[ i ];
+        mapping.pointOnPath = mapPointToPath( points[ i ], mapping.tangent, mapping.outside );
+        mapping.distanceOnPath = mapPointToPathDistance( points[ i ] );
+        if ( 0 != offsets ) {
+            mapping.pointAtOffset = mapPathDistanceToPoint( mapping.distanceOnPath + offsets[ i ] );
+        }
+    }
+}
+
 /*
 OpenSteer::Pathway& OpenSteer::Pathway::operator=( Pathway const& )
 {
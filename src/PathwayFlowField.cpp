@@ -0,0 +1,390 @@
+/**
+ * OpenSteer -- Steering Behaviors for Autonomous Characters
+ *
+ * Copyright (c) 2002-2005, Sony Computer Entertainment America
+ * Original author: Craig Reynolds <craig_reynolds@playstation.sony.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+#include "OpenSteer/PathwayFlowField.h"
+
+
+// Include std::floor, std::ceil
+#include <cmath>
+
+// Include assert
+#include <cassert>
+
+// Include std::min, std::max
+#include <algorithm>
+
+
+// Include OpenSteer::SegmentedPathway
+#include "OpenSteer/SegmentedPathway.h"
+
+// Include OpenSteer::clamp
+#include "OpenSteer/Utilities.h"
+
+#ifdef _MSC_VER
+#undef min
+#undef max
+#endif
+
+
+namespace {
+    
+    /**
+     * Returns the direction from @a center to the path point @a mapping 
+     * targets, or the path tangent oriented by @a direction if both 
+     * coincide.
+     */
+    OpenSteer::Vec3 guidance( OpenSteer::Vec3 const& center, 
+                              OpenSteer::Pathway::PointMapping const& mapping,
+                              float direction ) 
+    {
+        OpenSteer::Vec3 const toTarget = mapping.pointAtOffset - center;
+        float const length = toTarget.length();
+        if ( length > 0.0001f ) {
+            return toTarget / length;
+        }
+        return mapping.tangent * direction;
+    }
+    
+    
+    /**
+     * Number of samples along a pathway which isn't a segmented pathway
+     * used to detect changes and to find its bounding area.
+     */
+    size_t const pathwaySampleCount = 64;
+    
+} // anonymous namespace
+
+
+
+OpenSteer::PathwayFlowField::PathwayFlowField( Pathway const& pathway, 
+                                               float cellSize, 
+                                               float margin, 
+                                               float lookAhead )
+    : pathway_( &pathway ), 
+      cellSize_( cellSize ), 
+      margin_( margin ), 
+      lookAhead_( lookAhead ),
+      valid_( false ),
+      buildCount_( 0 ),
+      origin_( 0.0f, 0.0f, 0.0f ),
+      cellCountX_( 0 ),
+      cellCountZ_( 0 ),
+      cells_(),
+      signature_()
+{
+    assert( cellSize > 0.0f && "cellSize must be greater than 0." );
+}
+
+
+
+void 
+OpenSteer::PathwayFlowField::setPathway( Pathway const& pathway )
+{
+    pathway_ = &pathway;
+    invalidate();
+}
+
+
+
+OpenSteer::Pathway const& 
+OpenSteer::PathwayFlowField::pathway() const
+{
+    return *pathway_;
+}
+
+
+
+void 
+OpenSteer::PathwayFlowField::setCellSize( float cellSize )
+{
+    assert( cellSize > 0.0f && "cellSize must be greater than 0." );
+    cellSize_ = cellSize;
+    invalidate();
+}
+
+
+
+float 
+OpenSteer::PathwayFlowField::cellSize() const
+{
+    return cellSize_;
+}
+
+
+
+void 
+OpenSteer::PathwayFlowField::setMargin( float margin )
+{
+    margin_ = margin;
+    invalidate();
+}
+
+
+
+float 
+OpenSteer::PathwayFlowField::margin() const
+{
+    return margin_;
+}
+
+
+
+void 
+OpenSteer::PathwayFlowField::setLookAhead( float lookAhead )
+{
+    lookAhead_ = lookAhead;
+    invalidate();
+}
+
+
+
+float 
+OpenSteer::PathwayFlowField::lookAhead() const
+{
+    return lookAhead_;
+}
+
+
+
+void 
+OpenSteer::PathwayFlowField::invalidate()
+{
+    valid_ = false;
+}
+
+
+
+bool 
+OpenSteer::PathwayFlowField::update()
+{
+    if ( valid_ ) {
+        std::vector< Vec3 > signature;
+        takeSignature( signature );
+        if ( signature == signature_ ) {
+            return false;
+        }
+    }
+    
+    build();
+    return true;
+}
+
+
+
+bool 
+OpenSteer::PathwayFlowField::isValid() const
+{
+    return valid_;
+}
+
+
+
+bool 
+OpenSteer::PathwayFlowField::contains( Vec3 const& point ) const
+{
+    float const x = ( point.x - origin_.x ) / cellSize_;
+    float const z = ( point.z - origin_.z ) / cellSize_;
+    return ( x >= 0.0f ) && ( x < static_cast< float >( cellCountX_ ) ) &&
+           ( z >= 0.0f ) && ( z < static_cast< float >( cellCountZ_ ) );
+}
+
+
+
+bool 
+OpenSteer::PathwayFlowField::sample( Vec3 const& point, int direction, Sample& result ) const
+{
+    if ( ! valid_ || ! contains( point ) ) {
+        return false;
+    }
+    
+    // Cell centers are at half cell offsets, interpolate between the four
+    // centers around the point (clamped at the grid border).
+    float const fx = ( point.x - origin_.x ) / cellSize_ - 0.5f;
+    float const fz = ( point.z - origin_.z ) / cellSize_ - 0.5f;
+    size_type const x0 = static_cast< size_type >( clamp( std::floor( fx ), 0.0f, static_cast< float >( cellCountX_ - 2 ) ) );
+    size_type const z0 = static_cast< size_type >( clamp( std::floor( fz ), 0.0f, static_cast< float >( cellCountZ_ - 2 ) ) );
+    float const tx = clamp( fx - static_cast< float >( x0 ), 0.0f, 1.0f );
+    float const tz = clamp( fz - static_cast< float >( z0 ), 0.0f, 1.0f );
+    
+    Cell const& c00 = cell( x0, z0 );
+    Cell const& c10 = cell( x0 + 1, z0 );
+    Cell const& c01 = cell( x0, z0 + 1 );
+    Cell const& c11 = cell( x0 + 1, z0 + 1 );
+    
+    float const w00 = ( 1.0f - tx ) * ( 1.0f - tz );
+    float const w10 = tx * ( 1.0f - tz );
+    float const w01 = ( 1.0f - tx ) * tz;
+    float const w11 = tx * tz;
+    
+    Cell const& nearest = cell( ( tx < 0.5f ) ? x0 : x0 + 1, ( tz < 0.5f ) ? z0 : z0 + 1 );
+    
+    Vec3 const& nearestDirection = ( direction < 0 ) ? nearest.backward : nearest.forward;
+    Vec3 const d = ( direction < 0 ) ? 
+        ( c00.backward * w00 + c10.backward * w10 + c01.backward * w01 + c11.backward * w11 ) :
+        ( c00.forward * w00 + c10.forward * w10 + c01.forward * w01 + c11.forward * w11 );
+    float const length = d.length();
+    
+    // Opposing directions (e.g. cells on both sides of a path end) can
+    // cancel each other out, fall back to the nearest cell then.
+    result.direction = ( length > 0.0001f ) ? d / length : nearestDirection;
+    result.distanceOnPath = nearest.distanceOnPath;
+    result.outside = c00.outside * w00 + c10.outside * w10 + c01.outside * w01 + c11.outside * w11;
+    
+    return true;
+}
+
+
+
+OpenSteer::PathwayFlowField::size_type 
+OpenSteer::PathwayFlowField::cellCountX() const
+{
+    return cellCountX_;
+}
+
+
+
+OpenSteer::PathwayFlowField::size_type 
+OpenSteer::PathwayFlowField::cellCountZ() const
+{
+    return cellCountZ_;
+}
+
+
+
+OpenSteer::PathwayFlowField::Cell const& 
+OpenSteer::PathwayFlowField::cell( size_type x, size_type z ) const
+{
+    assert( x < cellCountX_ && z < cellCountZ_ && "Cell index out of range." );
+    return cells_[ z * cellCountX_ + x ];
+}
+
+
+
+OpenSteer::Vec3 const& 
+OpenSteer::PathwayFlowField::origin() const
+{
+    return origin_;
+}
+
+
+
+OpenSteer::Vec3 
+OpenSteer::PathwayFlowField::cellCenter( size_type x, size_type z ) const
+{
+    return Vec3( origin_.x + ( static_cast< float >( x ) + 0.5f ) * cellSize_,
+                 origin_.y,
+                 origin_.z + ( static_cast< float >( z ) + 0.5f ) * cellSize_ );
+}
+
+
+
+OpenSteer::PathwayFlowField::size_type 
+OpenSteer::PathwayFlowField::buildCount() const
+{
+    return buildCount_;
+}
+
+
+
+void 
+OpenSteer::PathwayFlowField::build()
+{
+    assert( pathway_->isValid() && "Pathway must be valid to build a flow field from it." );
+    
+    takeSignature( signature_ );
+    
+    // The grid covers the bounding area of the pathway points (or samples)
+    // plus the margin, the cell centers lie at their average height.
+    Vec3 minimum = signature_[ 1 ];
+    Vec3 maximum = signature_[ 1 ];
+    float height = 0.0f;
+    for ( size_type i = 1; i < signature_.size(); ++i ) {
+        Vec3 const& p = signature_[ i ];
+        minimum.set( std::min( minimum.x, p.x ), std::min( minimum.y, p.y ), std::min( minimum.z, p.z ) );
+        maximum.set( std::max( maximum.x, p.x ), std::max( maximum.y, p.y ), std::max( maximum.z, p.z ) );
+        height += p.y;
+    }
+    height /= static_cast< float >( signature_.size() - 1 );
+    
+    origin_ = Vec3( minimum.x - margin_, height, minimum.z - margin_ );
+    cellCountX_ = std::max( size_type( 2 ), static_cast< size_type >( std::ceil( ( maximum.x - minimum.x + 2.0f * margin_ ) / cellSize_ ) ) );
+    cellCountZ_ = std::max( size_type( 2 ), static_cast< size_type >( std::ceil( ( maximum.z - minimum.z + 2.0f * margin_ ) / cellSize_ ) ) );
+    cells_.resize( cellCountX_ * cellCountZ_ );
+    
+    // Map a row of cell centers at a time, each center twice: once to find
+    // the target ahead towards the path end, once towards the path start.
+    size_type const rowPointCount = 2 * cellCountX_;
+    std::vector< Vec3 > points( rowPointCount );
+    std::vector< float > offsets( rowPointCount );
+    std::vector< Pathway::PointMapping > mappings( rowPointCount );
+    for ( size_type x = 0; x < cellCountX_; ++x ) {
+        offsets[ x ] = lookAhead_;
+        offsets[ cellCountX_ + x ] = -lookAhead_;
+    }
+    
+    for ( size_type z = 0; z < cellCountZ_; ++z ) {
+        for ( size_type x = 0; x < cellCountX_; ++x ) {
+            points[ x ] = cellCenter( x, z );
+            points[ cellCountX_ + x ] = points[ x ];
+        }
+        
+        pathway_->mapPointsToPath( rowPointCount, &points[ 0 ], &offsets[ 0 ], &mappings[ 0 ] );
+        
+        for ( size_type x = 0; x < cellCountX_; ++x ) {
+            Cell& c = cells_[ z * cellCountX_ + x ];
+            c.forward = guidance( points[ x ], mappings[ x ], 1.0f );
+            c.backward = guidance( points[ x ], mappings[ cellCountX_ + x ], -1.0f );
+            c.distanceOnPath = mappings[ x ].distanceOnPath;
+            c.outside = mappings[ x ].outside;
+        }
+    }
+    
+    valid_ = true;
+    ++buildCount_;
+}
+
+
+
+void 
+OpenSteer::PathwayFlowField::takeSignature( std::vector< Vec3 >& signature ) const
+{
+    // The first element records the path length and whether it is cyclic,
+    // the others the pathway points or, if the pathway doesn't expose
+    // them, points sampled along it.
+    signature.clear();
+    signature.push_back( Vec3( pathway_->length(), pathway_->isCyclic() ? 1.0f : 0.0f, 0.0f ) );
+    
+    SegmentedPathway const* segmentedPathway = dynamic_cast< SegmentedPathway const* >( pathway_ );
+    if ( 0 != segmentedPathway ) {
+        for ( SegmentedPathway::size_type i = 0; i < segmentedPathway->pointCount(); ++i ) {
+            signature.push_back( segmentedPathway->point( i ) );
+        }
+    } else {
+        float const length = pathway_->length();
+        for ( size_type i = 0; i <= pathwaySampleCount; ++i ) {
+            float const distance = length * static_cast< float >( i ) / static_cast< float >( pathwaySampleCount );
+            signature.push_back( pathway_->mapPathDistanceToPoint( distance ) );
+        }
+    }
+}
@@ -0,0 +1,267 @@
+/**
+ * OpenSteer -- Steering Behaviors for Autonomous Characters
+ *
+ * Copyright (c) 2002-2005, Sony Computer Entertainment America
+ * Original author: Craig Reynolds <craig_reynolds@playstation.sony.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+#include "OpenSteer/PlanningGrid.h"
+
+
+// Include std::floor
+#include <cmath>
+
+
+
+int const OpenSteer::PlanningGrid::straightMoveCost;
+int const OpenSteer::PlanningGrid::diagonalMoveCost;
+int const OpenSteer::PlanningGrid::neighborOffsetX[ 8 ] = { 1, -1, 0,  0, 1,  1, -1, -1 };
+int const OpenSteer::PlanningGrid::neighborOffsetZ[ 8 ] = { 0,  0, 1, -1, 1, -1,  1, -1 };
+
+
+
+int 
+OpenSteer::PlanningGrid::octileDistance( int di, int dj )
+{
+    int const dx = std::abs( di );
+    int const dz = std::abs( dj );
+    int const straight = std::max( dx, dz ) - std::min( dx, dz );
+    return straightMoveCost * straight + diagonalMoveCost * std::min( dx, dz );
+}
+
+
+
+OpenSteer::PlanningGrid::PlanningGrid( int cellCountX, int cellCountZ, Vec3 const& origin, float cellSize )
+    : cellCountX_( cellCountX ), cellCountZ_( cellCountZ ), origin_( origin ), cellSize_( cellSize ), 
+      blocked_( cellCountX * cellCountZ, 0 )
+{
+    assert( 0 < cellCountX && 0 < cellCountZ && "Grid must contain cells." );
+    assert( 0.0f < cellSize && "Cell size must be positive." );
+}
+
+
+
+int 
+OpenSteer::PlanningGrid::cellCountX() const
+{
+    return cellCountX_;
+}
+
+
+
+int 
+OpenSteer::PlanningGrid::cellCountZ() const
+{
+    return cellCountZ_;
+}
+
+
+
+OpenSteer::PlanningGrid::size_type 
+OpenSteer::PlanningGrid::cellCount() const
+{
+    return blocked_.size();
+}
+
+
+
+OpenSteer::Vec3 const& 
+OpenSteer::PlanningGrid::origin() const
+{
+    return origin_;
+}
+
+
+
+float 
+OpenSteer::PlanningGrid::cellSize() const
+{
+    return cellSize_;
+}
+
+
+
+bool 
+OpenSteer::PlanningGrid::cellContaining( Vec3 const& point, int& i, int& j ) const
+{
+    float const x = std::floor( ( point.x - origin_.x ) / cellSize_ );
+    float const z = std::floor( ( point.z - origin_.z ) / cellSize_ );
+    if ( ( x < 0.0f ) || ( z < 0.0f ) || 
+         ( static_cast< float >( cellCountX_ ) <= x ) || ( static_cast< float >( cellCountZ_ ) <= z ) ) {
+        return false;
+    }
+    
+    i = static_cast< int >( x );
+    j = static_cast< int >( z );
+    return true;
+}
+
+
+
+OpenSteer::Vec3 
+OpenSteer::PlanningGrid::cellCenter( int i, int j ) const
+{
+    return Vec3( origin_.x + ( static_cast< float >( i ) + 0.5f ) * cellSize_, 
+                 origin_.y, 
+                 origin_.z + ( static_cast< float >( j ) + 0.5f ) * cellSize_ );
+}
+
+
+
+OpenSteer::Vec3 
+OpenSteer::PlanningGrid::cellCenterAtHeight( int cell, float y ) const
+{
+    Vec3 center = cellCenter( cell % cellCountX_, cell / cellCountX_ );
+    center.y = y;
+    return center;
+}
+
+
+
+int 
+OpenSteer::PlanningGrid::cellIndex( int i, int j ) const
+{
+    assert( 0 <= i && i < cellCountX_ && 0 <= j && j < cellCountZ_ && "Cell index out of range." );
+    return i + j * cellCountX_;
+}
+
+
+
+bool 
+OpenSteer::PlanningGrid::isBlocked( int cell ) const
+{
+    return 0 != blocked_[ cell ];
+}
+
+
+
+bool 
+OpenSteer::PlanningGrid::isBlocked( int i, int j ) const
+{
+    return isBlocked( cellIndex( i, j ) );
+}
+
+
+
+void 
+OpenSteer::PlanningGrid::setBlocked( int cell, bool blocked )
+{
+    blocked_[ cell ] = blocked ? 1 : 0;
+}
+
+
+
+int 
+OpenSteer::PlanningGrid::neighborCell( int cell, int direction ) const
+{
+    int const i = cell % cellCountX_ + neighborOffsetX[ direction ];
+    int const j = cell / cellCountX_ + neighborOffsetZ[ direction ];
+    if ( ( i < 0 ) || ( j < 0 ) || ( cellCountX_ <= i ) || ( cellCountZ_ <= j ) ) {
+        return -1;
+    }
+    return i + j * cellCountX_;
+}
+
+
+
+int 
+OpenSteer::PlanningGrid::moveCost( int cell, int direction ) const
+{
+    int const neighbor = neighborCell( cell, direction );
+    if ( ( neighbor < 0 ) || isBlocked( cell ) || isBlocked( neighbor ) ) {
+        return -1;
+    }
+    
+    int const dx = neighborOffsetX[ direction ];
+    int const dz = neighborOffsetZ[ direction ];
+    if ( ( 0 == dx ) || ( 0 == dz ) ) {
+        return straightMoveCost;
+    }
+    
+    // Diagonal moves mustn't cut the corner of a blocked cell.
+    if ( isBlocked( cell + dx ) || isBlocked( cell + dz * cellCountX_ ) ) {
+        return -1;
+    }
+    return diagonalMoveCost;
+}
+
+
+
+bool 
+OpenSteer::PlanningGrid::segmentIsFree( Vec3 const& from, Vec3 const& to ) const
+{
+    float const x0 = ( from.x - origin_.x ) / cellSize_;
+    float const z0 = ( from.z - origin_.z ) / cellSize_;
+    float const dx = ( to.x - from.x ) / cellSize_;
+    float const dz = ( to.z - from.z ) / cellSize_;
+    
+    int i = static_cast< int >( std::floor( x0 ) );
+    int j = static_cast< int >( std::floor( z0 ) );
+    int const iEnd = static_cast< int >( std::floor( x0 + dx ) );
+    int const jEnd = static_cast< int >( std::floor( z0 + dz ) );
+    int const stepX = ( 0.0f < dx ) ? 1 : -1;
+    int const stepZ = ( 0.0f < dz ) ? 1 : -1;
+    
+    // Segment parameters of the next cell boundary crossings and between
+    // crossings (traversal after Amanatides and Woo).
+    float const never = 2.0f;
+    float const deltaX = ( 0.0f != dx ) ? std::abs( 1.0f / dx ) : never;
+    float const deltaZ = ( 0.0f != dz ) ? std::abs( 1.0f / dz ) : never;
+    float nextX = never;
+    float nextZ = never;
+    if ( 0.0f != dx ) {
+        nextX = ( ( 0.0f < dx ) ? ( static_cast< float >( i + 1 ) - x0 ) : ( x0 - static_cast< float >( i ) ) ) * deltaX;
+    }
+    if ( 0.0f != dz ) {
+        nextZ = ( ( 0.0f < dz ) ? ( static_cast< float >( j + 1 ) - z0 ) : ( z0 - static_cast< float >( j ) ) ) * deltaZ;
+    }
+    
+    float const cornerTolerance = 1.0e-5f;
+    int remainingSteps = std::abs( iEnd - i ) + std::abs( jEnd - j );
+    while ( true ) {
+        if ( ( i < 0 ) || ( j < 0 ) || ( cellCountX_ <= i ) || ( cellCountZ_ <= j ) || isBlocked( i, j ) ) {
+            return false;
+        }
+        if ( ( ( i == iEnd ) && ( j == jEnd ) ) || ( remainingSteps <= 0 ) ) {
+            return true;
+        }
+        
+        if ( std::abs( nextX - nextZ ) < cornerTolerance ) {
+            // Passing a corner, both cells beside it must be free.
+            if ( ( i + stepX < 0 ) || ( cellCountX_ <= i + stepX ) || isBlocked( i + stepX, j ) ||
+                 ( j + stepZ < 0 ) || ( cellCountZ_ <= j + stepZ ) || isBlocked( i, j + stepZ ) ) {
+                return false;
+            }
+            i += stepX;
+            j += stepZ;
+            nextX += deltaX;
+            nextZ += deltaZ;
+            remainingSteps -= 2;
+        } else if ( nextX < nextZ ) {
+            i += stepX;
+            nextX += deltaX;
+            --remainingSteps;
+        } else {
+            j += stepZ;
+            nextZ += deltaZ;
+            --remainingSteps;
+        }
+    }
+}
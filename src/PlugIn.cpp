@@ -39,6 +39,7 @@
 
 #include "OpenSteer/PlugIn.h"
 #include <cstring>
+#include <cstdlib>
 
 // ----------------------------------------------------------------------------
 // PlugIn registry
@@ -69,6 +70,19 @@ OpenSteer::PlugIn::PlugIn (void)
 OpenSteer::PlugIn::~PlugIn() {}
 
 
+// ----------------------------------------------------------------------------
+// default batch mode: this PlugIn has none
+// (parameter names commented out to prevent compiler warning from "-W")
+
+
+int 
+OpenSteer::PlugIn::runBatch (int /*argc*/, char** /*argv*/)
+{
+    std::cerr << *this << " has no batch mode" << std::endl;
+    return EXIT_FAILURE;
+}
+
+
 // ----------------------------------------------------------------------------
 // returns pointer to the next PlugIn in "selection order"
 
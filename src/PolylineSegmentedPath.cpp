@@ -27,10 +27,7 @@
  */
 #include "OpenSteer/PolylineSegmentedPath.h"
 
-// Include std::accumulate
-#include <numeric>
-
-// Include std::swap, std::adjacent_find
+// Include std::swap, std::adjacent_find, std::copy, std::min
 #include <algorithm>
 
 // Include assert
@@ -50,7 +47,7 @@
 // Include OpenSteer::HasNoRadius
 #include "OpenSteer/QueryPathAlikeUtilities.h"
 
-// Include OpenSteer::clamp, OpenSteer::shrinkToFit
+// Include OpenSteer::clamp, OpenSteer::modulo, OpenSteer::shrinkToFit
 #include "OpenSteer/Utilities.h"
 
 
@@ -159,6 +156,64 @@ namespace {
     }
     
     
+    /**
+     * Rebuilds the segment length sum tree @a sums from @a segmentLengths.
+     * The leaves hold the segment lengths padded with zeros to a power of
+     * two, every inner node the sum of its children and element @c 1 the 
+     * path length.
+     */
+    void
+    buildSegmentLengthSums( FloatContainer const& segmentLengths, 
+                            FloatContainer& sums )
+    {
+        size_type leafCount = 1;
+        while ( leafCount < segmentLengths.size() ) {
+            leafCount *= 2;
+        }
+        
+        sums.assign( 2 * leafCount, 0.0f );
+        std::copy( segmentLengths.begin(), segmentLengths.end(), sums.begin() + leafCount );
+        for ( size_type i = leafCount - 1; i > 0; --i ) {
+            sums[ i ] = sums[ 2 * i ] + sums[ 2 * i + 1 ];
+        }
+    }
+    
+    
+    /**
+     * Sets the leaf of segment @a segmentIndex in the sum tree @a sums to
+     * @a segmentLength and updates the sums on its way to the root.
+     */
+    void
+    updateSegmentLengthSums( size_type segmentIndex,
+                             float segmentLength,
+                             FloatContainer& sums )
+    {
+        size_type node = sums.size() / 2 + segmentIndex;
+        assert( node < sums.size() && "segmentIndex out of range." );
+        
+        sums[ node ] = segmentLength;
+        for ( node /= 2; node > 0; node /= 2 ) {
+            sums[ node ] = sums[ 2 * node ] + sums[ 2 * node + 1 ];
+        }
+    }
+    
+    
+    /**
+     * Recalculates the segment tangent and length for segment @a segmentIndex
+     * and updates the segment length sums.
+     */
+    void
+    updateSegment( size_type segmentIndex,
+                   Vec3Container const& points , 
+                   Vec3Container& segmentTangents, 
+                   FloatContainer& segmentLengths,
+                   FloatContainer& segmentLengthSums )
+    {
+        updateSegmentTangentAndLength( segmentIndex, points, segmentTangents, segmentLengths );
+        updateSegmentLengthSums( segmentIndex, segmentLengths[ segmentIndex ], segmentLengthSums );
+    }
+    
+    
     /**
      * Checks that no adjacent points are equal. Checks the first and last
      * point if the path is cyclic, too.
@@ -193,7 +248,7 @@ namespace {
 
 
 OpenSteer::PolylineSegmentedPath::PolylineSegmentedPath()
-    : points_( 0 ), segmentTangents_( 0 ), segmentLengths_( 0 ), closedCycle_( false )
+    : points_( 0 ), segmentTangents_( 0 ), segmentLengths_( 0 ), segmentLengthSums_( 2, 0.0f ), closedCycle_( false )
 {
     
 }
@@ -202,14 +257,14 @@ OpenSteer::PolylineSegmentedPath::PolylineSegmentedPath()
 OpenSteer::PolylineSegmentedPath::PolylineSegmentedPath( size_type numOfPoints,
                                                          Vec3 const newPoints[],
                                                          bool closedCycle )
-    : points_( 0 ), segmentTangents_( 0 ), segmentLengths_( 0 ), closedCycle_( closedCycle )
+    : points_( 0 ), segmentTangents_( 0 ), segmentLengths_( 0 ), segmentLengthSums_( 0 ), closedCycle_( closedCycle )
 {
         setPath( numOfPoints, newPoints, closedCycle );
 }
 
 
 OpenSteer::PolylineSegmentedPath::PolylineSegmentedPath( PolylineSegmentedPath const& other )
-    : SegmentedPath( other ), points_( other.points_ ), segmentTangents_( other.segmentTangents_ ), segmentLengths_( other.segmentLengths_ ), closedCycle_( other.closedCycle_ )
+    : SegmentedPath( other ), points_( other.points_ ), segmentTangents_( other.segmentTangents_ ), segmentLengths_( other.segmentLengths_ ), segmentLengthSums_( other.segmentLengthSums_ ), closedCycle_( other.closedCycle_ )
 {
     // Nothing to do.
 }
@@ -238,6 +293,7 @@ OpenSteer::PolylineSegmentedPath::swap( PolylineSegmentedPath& other )
     points_.swap( other.points_ );
     segmentTangents_.swap( other.segmentTangents_ );
     segmentLengths_.swap( other.segmentLengths_ );
+    segmentLengthSums_.swap( other.segmentLengthSums_ );
     std::swap( closedCycle_, other.closedCycle_ );
 }
 
@@ -282,6 +338,8 @@ OpenSteer::PolylineSegmentedPath::setPath( size_type numOfPoints,
     shrinkToFit( points_ );
     shrinkToFit( segmentTangents_ );
     shrinkToFit( segmentLengths_ );
+    
+    buildSegmentLengthSums( segmentLengths_, segmentLengthSums_ );
 }
 
 
@@ -316,11 +374,173 @@ OpenSteer::PolylineSegmentedPath::movePoints( size_type startIndex,
                               numOfPoints, 
                               isCyclic() );
     
+    // Update the length sums of the segments recalculated above.
+    size_type const firstSegmentIndex = ( 0 < startIndex ) ? startIndex - 1 : 0;
+    size_type const lastSegmentIndex = std::min( startIndex + numOfPoints, segmentCount() );
+    for ( size_type i = firstSegmentIndex; i < lastSegmentIndex; ++i ) {
+        updateSegmentLengthSums( i, segmentLengths_[ i ], segmentLengthSums_ );
+    }
+    if ( isCyclic() && ( 0 == startIndex ) ) {
+        updateSegmentLengthSums( segmentCount() - 1, segmentLengths_.back(), segmentLengthSums_ );
+    }
+    
+    
+    assert( adjacentPathPointsDifferent( points_.begin(), points_.end(), isCyclic() ) && "Adjacent path points must be different." );
+}
+
+
+void 
+OpenSteer::PolylineSegmentedPath::setPoint( size_type pointIndex, Vec3 const& newPoint )
+{
+    assert( ( pointIndex < ( pointCount() - ( isCyclic() ? 1 : 0 ) ) ) && 
+            "pointIndex must be inside index range." );
+    
+    points_[ pointIndex ] = newPoint;
+    if ( isCyclic() && ( 0 == pointIndex ) ) {
+        points_.back() = newPoint;
+    }
+    
+    // Recalculate the segment ending at the point and the one starting at it.
+    if ( 0 < pointIndex ) {
+        updateSegment( pointIndex - 1, points_, segmentTangents_, segmentLengths_, segmentLengthSums_ );
+    } else if ( isCyclic() ) {
+        updateSegment( segmentCount() - 1, points_, segmentTangents_, segmentLengths_, segmentLengthSums_ );
+    }
+    
+    if ( pointIndex < segmentCount() ) {
+        updateSegment( pointIndex, points_, segmentTangents_, segmentLengths_, segmentLengthSums_ );
+    }
     
     assert( adjacentPathPointsDifferent( points_.begin(), points_.end(), isCyclic() ) && "Adjacent path points must be different." );
 }
 
 
+
+void 
+OpenSteer::PolylineSegmentedPath::insertPoint( size_type pointIndex, Vec3 const& newPoint )
+{
+    assert( isValid() && "Only insert points into valid paths." );
+    assert( ( pointIndex <= ( pointCount() - ( isCyclic() ? 1 : 0 ) ) ) && 
+            "pointIndex must be inside index range." );
+    
+    points_.insert( points_.begin() + pointIndex, newPoint );
+    if ( isCyclic() && ( 0 == pointIndex ) ) {
+        points_.back() = newPoint;
+    }
+    
+    // The segment ending at @a pointIndex is split in two, insert the second
+    // one (or the new first segment) and calculate both below. If a point is
+    // appended to a non-cyclic path the new segment is the last one.
+    size_type const newSegmentIndex = std::min( pointIndex, segmentCount() );
+    segmentTangents_.insert( segmentTangents_.begin() + newSegmentIndex, Vec3( 0.0f, 0.0f, 0.0f ) );
+    segmentLengths_.insert( segmentLengths_.begin() + newSegmentIndex, 0.0f );
+    
+    if ( 0 < pointIndex ) {
+        updateSegmentTangentAndLength( pointIndex - 1, points_, segmentTangents_, segmentLengths_ );
+    } else if ( isCyclic() ) {
+        updateSegmentTangentAndLength( segmentCount() - 1, points_, segmentTangents_, segmentLengths_ );
+    }
+    
+    if ( pointIndex < segmentCount() ) {
+        updateSegmentTangentAndLength( pointIndex, points_, segmentTangents_, segmentLengths_ );
+    }
+    
+    buildSegmentLengthSums( segmentLengths_, segmentLengthSums_ );
+    
+    assert( adjacentPathPointsDifferent( points_.begin(), points_.end(), isCyclic() ) && "Adjacent path points must be different." );
+}
+
+
+
+void 
+OpenSteer::PolylineSegmentedPath::erasePoint( size_type pointIndex )
+{
+    size_type const distinctPointCount = pointCount() - ( isCyclic() ? 1 : 0 );
+    assert( ( pointIndex < distinctPointCount ) && 
+            "pointIndex must be inside index range." );
+    assert( ( 2 < distinctPointCount ) && 
+            "A path needs at least two points." );
+    
+    size_type const oldSegmentCount = segmentCount();
+    
+    points_.erase( points_.begin() + pointIndex );
+    if ( isCyclic() && ( 0 == pointIndex ) ) {
+        points_.back() = points_.front();
+    }
+    
+    // The two segments meeting at the point are joined: erase the one
+    // starting at it and recalculate the one ending at it. The end point of
+    // a non-cyclic path only has a segment ending at it.
+    size_type const erasedSegmentIndex = ( pointIndex < oldSegmentCount ) ? pointIndex : pointIndex - 1;
+    segmentTangents_.erase( segmentTangents_.begin() + erasedSegmentIndex );
+    segmentLengths_.erase( segmentLengths_.begin() + erasedSegmentIndex );
+    
+    if ( ( 0 < pointIndex ) && ( pointIndex < oldSegmentCount ) ) {
+        updateSegmentTangentAndLength( pointIndex - 1, points_, segmentTangents_, segmentLengths_ );
+    } else if ( ( 0 == pointIndex ) && isCyclic() ) {
+        updateSegmentTangentAndLength( segmentCount() - 1, points_, segmentTangents_, segmentLengths_ );
+    }
+    
+    buildSegmentLengthSums( segmentLengths_, segmentLengthSums_ );
+    
+    assert( adjacentPathPointsDifferent( points_.begin(), points_.end(), isCyclic() ) && "Adjacent path points must be different." );
+}
+
+
+
+float 
+OpenSteer::PolylineSegmentedPath::segmentStartDistance( size_type segmentIndex ) const
+{
+    assert( segmentIndex < segmentCount() && "segmentIndex out of range." );
+    
+    // Sum up the left siblings on the way from the segment leaf to the root.
+    float distance = 0.0f;
+    for ( size_type node = segmentLengthSums_.size() / 2 + segmentIndex; node > 1; node /= 2 ) {
+        if ( 1 == ( node % 2 ) ) {
+            distance += segmentLengthSums_[ node - 1 ];
+        }
+    }
+    
+    return distance;
+}
+
+
+
+OpenSteer::PolylineSegmentedPath::size_type 
+OpenSteer::PolylineSegmentedPath::mapDistanceToSegmentIndex( float distance, 
+                                                             float& segmentStartDistance ) const
+{
+    assert( isValid() && "Only map distances on valid paths." );
+    
+    // Descend from the root to the first segment whose end lies at or beyond
+    // @a distance - the segment a walk along the path stops at.
+    size_type const leafCount = segmentLengthSums_.size() / 2;
+    size_type node = 1;
+    float start = 0.0f;
+    while ( node < leafCount ) {
+        size_type const left = 2 * node;
+        if ( distance <= start + segmentLengthSums_[ left ] ) {
+            node = left;
+        } else {
+            start += segmentLengthSums_[ left ];
+            node = left + 1;
+        }
+    }
+    
+    size_type segmentIndex = node - leafCount;
+    
+    // Distances beyond the path end land in the padding leaves.
+    if ( segmentIndex >= segmentCount() ) {
+        segmentIndex = segmentCount() - 1;
+        start = this->segmentStartDistance( segmentIndex );
+    }
+    
+    segmentStartDistance = start;
+    return segmentIndex;
+}
+
+
+
 bool
 OpenSteer::PolylineSegmentedPath::isValid() const 
 {
@@ -345,8 +565,12 @@ OpenSteer::PolylineSegmentedPath::mapPointToPath (const Vec3& point,
 OpenSteer::Vec3 
 OpenSteer::PolylineSegmentedPath::mapPathDistanceToPoint (float pathDistance) const
 {
+    float const distance = isCyclic() ? modulo( pathDistance, length() ) : pathDistance;
+    float segmentStart = 0.0f;
+    size_type const segmentIndex = mapDistanceToSegmentIndex( distance, segmentStart );
+    
     PathDistanceToPointMapping mapping;
-    mapDistanceToPathAlike( *this, pathDistance, mapping );
+    mapDistanceToPathAlikeNearSegment( *this, pathDistance, segmentIndex, segmentStart, mapping );
     return mapping.pointOnPathCenterLine;
 }
 
@@ -370,7 +594,7 @@ OpenSteer::PolylineSegmentedPath::isCyclic() const
 float 
 OpenSteer::PolylineSegmentedPath::length() const
 {
-    return std::accumulate( segmentLengths_.begin(), segmentLengths_.end(), 0.0f );
+    return segmentLengthSums_[ 1 ];
 }
 
 
@@ -28,7 +28,7 @@
 #include "OpenSteer/PolylineSegmentedPathwaySegmentRadii.h"
 
 
-// Include std::swap, std::copy, std::find_if
+// Include std::swap, std::copy, std::find_if, std::min
 #include <algorithm>
 
 // Include std::less, std::bind2nd
@@ -44,7 +44,7 @@
 // Include OpenSteer::HasSegmentRadii
 #include "OpenSteer/QueryPathAlikeUtilities.h"
 
-// Include OpenSteer::shrinkToFit
+// Include OpenSteer::shrinkToFit, OpenSteer::modulo
 #include "OpenSteer/Utilities.h"
 
 // Include OpenSteer::size_t
@@ -165,6 +165,43 @@ OpenSteer::PolylineSegmentedPathwaySegmentRadii::movePoints( size_type startInde
 
 
 
+void 
+OpenSteer::PolylineSegmentedPathwaySegmentRadii::setPoint( size_type pointIndex, Vec3 const& newPoint )
+{
+    path_.setPoint( pointIndex, newPoint );
+}
+
+
+
+void 
+OpenSteer::PolylineSegmentedPathwaySegmentRadii::insertPoint( size_type pointIndex, Vec3 const& newPoint )
+{
+    // Same segment index rules as PolylineSegmentedPath::insertPoint. A 
+    // point appended to a non-cyclic pathway splits no segment, the new last
+    // segment takes the radius of the old last one.
+    size_type const oldSegmentCount = segmentCount();
+    size_type const splitSegmentIndex = ( 0 < pointIndex ) ? std::min( pointIndex - 1, oldSegmentCount - 1 ) : ( isCyclic() ? oldSegmentCount - 1 : 0 );
+    size_type const newSegmentIndex = std::min( pointIndex, oldSegmentCount );
+    
+    path_.insertPoint( pointIndex, newPoint );
+    segmentRadii_.insert( segmentRadii_.begin() + newSegmentIndex, segmentRadii_[ splitSegmentIndex ] );
+}
+
+
+
+void 
+OpenSteer::PolylineSegmentedPathwaySegmentRadii::erasePoint( size_type pointIndex )
+{
+    // Same segment index rules as PolylineSegmentedPath::erasePoint.
+    size_type const erasedSegmentIndex = ( pointIndex < segmentCount() ) ? pointIndex : pointIndex - 1;
+    
+    path_.erasePoint( pointIndex );
+    segmentRadii_.erase( segmentRadii_.begin() + erasedSegmentIndex );
+}
+
+
+
+
 void 
 OpenSteer::PolylineSegmentedPathwaySegmentRadii::setPathway( size_type numOfPoints,
                                                              Vec3 const points[],
@@ -241,8 +278,12 @@ OpenSteer::PolylineSegmentedPathwaySegmentRadii::mapPointToPath (const Vec3& poi
 OpenSteer::Vec3 
 OpenSteer::PolylineSegmentedPathwaySegmentRadii::mapPathDistanceToPoint (float pathDistance) const
 {
+    float const distance = isCyclic() ? modulo( pathDistance, length() ) : pathDistance;
+    float segmentStart = 0.0f;
+    size_type const segmentIndex = path_.mapDistanceToSegmentIndex( distance, segmentStart );
+    
     PathDistanceToPointMapping mapping;
-    mapDistanceToPathAlike( *this, pathDistance, mapping );
+    mapDistanceToPathAlikeNearSegment( *this, pathDistance, segmentIndex, segmentStart, mapping );
     return mapping.pointOnPathCenterLine;    
 }
 
@@ -258,6 +299,17 @@ OpenSteer::PolylineSegmentedPathwaySegmentRadii::mapPointToPathDistance (const V
 
 
 
+void 
+OpenSteer::PolylineSegmentedPathwaySegmentRadii::mapPointsToPath( size_t count, 
+                                                         Vec3 const* points, 
+                                                         float const* offsets, 
+                                                         PointMapping* mappings ) const
+{
+    mapPointsAndOffsetsToPathAlike( *this, points, offsets, count, mappings );
+}
+
+
+
 bool 
 OpenSteer::PolylineSegmentedPathwaySegmentRadii::isCyclic() const
 {
@@ -41,6 +41,9 @@
 // Include OpenSteer::HasSingleRadius
 #include "OpenSteer/QueryPathAlikeUtilities.h"
 
+// Include OpenSteer::modulo
+#include "OpenSteer/Utilities.h"
+
 // Include OPENSTEER_UNUSED_PARAMETER
 #include "OpenSteer/UnusedParameter.h"
 
@@ -118,6 +121,31 @@ OpenSteer::PolylineSegmentedPathwaySingleRadius::movePoints( size_type startInde
 
 
 
+void 
+OpenSteer::PolylineSegmentedPathwaySingleRadius::setPoint( size_type pointIndex, Vec3 const& newPoint )
+{
+    path_.setPoint( pointIndex, newPoint );
+}
+
+
+
+void 
+OpenSteer::PolylineSegmentedPathwaySingleRadius::insertPoint( size_type pointIndex, Vec3 const& newPoint )
+{
+    path_.insertPoint( pointIndex, newPoint );
+}
+
+
+
+void 
+OpenSteer::PolylineSegmentedPathwaySingleRadius::erasePoint( size_type pointIndex )
+{
+    path_.erasePoint( pointIndex );
+}
+
+
+
+
 void 
 OpenSteer::PolylineSegmentedPathwaySingleRadius::setPathway( size_type numOfPoints,
                                                              Vec3 const points[],
@@ -172,8 +200,12 @@ OpenSteer::PolylineSegmentedPathwaySingleRadius::mapPointToPath (const Vec3& poi
 OpenSteer::Vec3 
 OpenSteer::PolylineSegmentedPathwaySingleRadius::mapPathDistanceToPoint (float pathDistance) const
 {
+    float const distance = isCyclic() ? modulo( pathDistance, length() ) : pathDistance;
+    float segmentStart = 0.0f;
+    size_type const segmentIndex = path_.mapDistanceToSegmentIndex( distance, segmentStart );
+    
     PathDistanceToPointMapping mapping;
-    mapDistanceToPathAlike( *this, pathDistance, mapping );
+    mapDistanceToPathAlikeNearSegment( *this, pathDistance, segmentIndex, segmentStart, mapping );
     return mapping.pointOnPathCenterLine;
 }
 
@@ -189,6 +221,17 @@ OpenSteer::PolylineSegmentedPathwaySingleRadius::mapPointToPathDistance (const V
 
 
 
+void 
+OpenSteer::PolylineSegmentedPathwaySingleRadius::mapPointsToPath( size_t count, 
+                                                         Vec3 const* points, 
+                                                         float const* offsets, 
+                                                         PointMapping* mappings ) const
+{
+    mapPointsAndOffsetsToPathAlike( *this, points, offsets, count, mappings );
+}
+
+
+
 bool 
 OpenSteer::PolylineSegmentedPathwaySingleRadius::isCyclic() const
 {
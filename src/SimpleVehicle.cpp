@@ -77,6 +77,9 @@ int OpenSteer::SimpleVehicle::serialNumberCounter = 0;
 
 OpenSteer::SimpleVehicle::SimpleVehicle (void)
 {
+    // predictions are not cached unless asked for
+    _cachePredictions = false;
+
     // set inital state
     reset ();
 
@@ -154,6 +157,8 @@ OpenSteer::SimpleVehicle::applyBrakingForce (const float rate, const float delta
                                maxForce ());
 
     setSpeed (speed () - (clipBraking * deltaTime));
+
+    if (_cachePredictions) updatePredictionCache ();
 }
 
 
@@ -166,6 +171,8 @@ void
 OpenSteer::SimpleVehicle::applySteeringForce (const Vec3& force,
                                               const float elapsedTime)
 {
+    // remembered for coasting (see coast)
+    _lastSteeringForce = force;
 
     const Vec3 adjustedForce = adjustRawSteeringForce (force, elapsedTime);
 
@@ -209,6 +216,9 @@ OpenSteer::SimpleVehicle::applySteeringForce (const Vec3& force,
     blendIntoAccumulator (elapsedTime * 0.06f, // QQQ
                           position (),
                           _smoothedPosition);
+
+    // predictions for the new state, shared by everyone reading them
+    if (_cachePredictions) updatePredictionCache ();
 }
 
 
@@ -327,4 +337,47 @@ OpenSteer::SimpleVehicle::predictFuturePosition (const float predictionTime) con
 }
 
 
+// ----------------------------------------------------------------------------
+// per-tick cache of predicted positions
+//
+// Between two horizons the cached positions are interpolated linearly, which
+// is exact for the straight line prediction above and close for curved ones
+// (such as MapDriver's) since the horizons are dense where most predictions
+// are made.
+
+
+const float
+OpenSteer::SimpleVehicle::predictionCacheHorizons [predictionCacheSize] =
+    {0, 0.25f, 0.5f, 0.75f, 1, 1.5f, 2, 3, 4, 6, 8, 12, 16};
+
+
+void 
+OpenSteer::SimpleVehicle::updatePredictionCache (void)
+{
+    for (int i = 0; i < predictionCacheSize; i++)
+        _predictionCache[i] = predictFuturePosition (predictionCacheHorizons[i]);
+    _predictionCacheValid = true;
+}
+
+
+OpenSteer::Vec3 
+OpenSteer::SimpleVehicle::cachedFuturePosition (const float predictionTime) const
+{
+    const int last = predictionCacheSize - 1;
+    if (!_predictionCacheValid ||
+        (predictionTime < 0) ||
+        (predictionTime > predictionCacheHorizons[last]))
+        return predictFuturePosition (predictionTime);
+
+    // find the pair of horizons bracketing predictionTime
+    int i = 1;
+    while (predictionCacheHorizons[i] < predictionTime) i++;
+    const float t0 = predictionCacheHorizons[i-1];
+    const float t1 = predictionCacheHorizons[i];
+    return interpolate ((predictionTime - t0) / (t1 - t0),
+                        _predictionCache[i-1],
+                        _predictionCache[i]);
+}
+
+
 // ----------------------------------------------------------------------------
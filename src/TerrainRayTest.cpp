@@ -28,6 +28,15 @@
 #include <cmath>
 #include <memory.h>
 
+#ifdef _WIN32
+	#include <windows.h>
+#else
+	#include <fcntl.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <unistd.h>
+#endif
+
 
 // To include OpenSteer::maxXXX instead of using __max
 #include "OpenSteer/Utilities.h"
@@ -40,21 +49,73 @@ using namespace std;
 
 
 
-RayTester::RayTester() : data(NULL) {
+RayTester::RayTester() : data(NULL), compactLayout(false), heights(NULL), cellMaxY(NULL), gridX(NULL), gridZ(NULL),
+							mapping(NULL), mappingSize(0) {
+	#ifdef TRT_HEIGHT_PYRAMID
+		pyramid=NULL;
+		levels=0;
+	#endif
 }
 
 
 RayTester::~RayTester() {
-	if( data!=NULL )
-		free( data );
+	Release();
+}
+
+
+void RayTester::Release() {
+	if( mapping!=NULL ) {
+		#ifdef _WIN32
+			UnmapViewOfFile( mapping );
+			CloseHandle( (HANDLE)mappingHandle );
+			CloseHandle( (HANDLE)mappingFile );
+		#else
+			munmap( mapping, mappingSize );
+		#endif
+		mapping=NULL;
+		mappingSize=0;
+	} else {
+		if( data!=NULL )
+			free( data );
+		#ifdef TRT_HEIGHT_PYRAMID
+			if( pyramid!=NULL )
+				free( pyramid );
+		#endif
+	}
+
+	free( heights );
+	free( cellMaxY );
+	free( gridX );
+	free( gridZ );
+
 	data=NULL;
+	heights=cellMaxY=NULL;
+	gridX=gridZ=NULL;
+	#ifdef TRT_HEIGHT_PYRAMID
+		pyramid=NULL;
+		levels=0;
+	#endif
+}
+
+
+void RayTester::SetCompactLayout( bool compact ) {
+	compactLayout=compact;
+}
+
+
+bool RayTester::CompactLayout() const {
+	return heights!=NULL;
 }
 
 
 void RayTester::LoadData( char *fname,	TRTScalar xMin, TRTScalar xMax,
 										TRTScalar yMin, TRTScalar yMax,
 										TRTScalar zMin, TRTScalar zMax ) {
+	Release();
+
 	FILE *inf=fopen(fname,"rb");
+	if( inf==NULL )
+		return;
 
 	fread(&width,sizeof(width),1,inf);
 	fread(&height,sizeof(height),1,inf);
@@ -105,7 +166,6 @@ void RayTester::LoadData( char *fname,	TRTScalar xMin, TRTScalar xMax,
 			TRTScalar zNewRange = zMax-zMin;
 			for(y=0, curVert=0; y<height; y++)
 				for(x=0; x<width; x++, curVert++){
-					fread(tempVert,sizeof(float),3,inf);
 					data[curVert].pos[0] = xNewRange*((data[curVert].pos[0]-minx)/xrange)+xMin;
 					data[curVert].pos[1] = yNewRange*((data[curVert].pos[1]-miny)/yrange)+yMin;
 					data[curVert].pos[2] = zNewRange*((data[curVert].pos[2]-minz)/zrange)+zMin;
@@ -148,7 +208,339 @@ void RayTester::LoadData( char *fname,	TRTScalar xMin, TRTScalar xMax,
 				#endif
 			}
 
+	if( compactLayout )
+		MakeCompact();
+
+	#ifdef TRT_HEIGHT_PYRAMID
+		BuildPyramid();
+	#endif
+}
+
+
+void RayTester::MakeCompact() {
+
+	// vertex x and z come from the grid, so only the heights are kept per vertex; the last row
+	//	and column keep a maxy of zero like the full layout's
+	heights = (float *)malloc( width*height*sizeof(float) );
+	cellMaxY = (float *)calloc( width*height, sizeof(float) );
+	gridX = (TRTScalar *)malloc( width*sizeof(TRTScalar) );
+	gridZ = (TRTScalar *)malloc( height*sizeof(TRTScalar) );
+
+	int x,y,curVert;
+	for(x=0; x<width; x++)
+		gridX[x]=minx+x*xstep;
+	for(y=0; y<height; y++)
+		gridZ[y]=minz+y*zstep;
+
+	for(curVert=0; curVert<width*height; curVert++)
+		heights[curVert]=(float)data[curVert].pos[1];
+
+	for(y=0, curVert=0; y<height-1; y++, curVert++)
+		for(x=0; x<width-1; x++, curVert++)
+			cellMaxY[curVert] = OpenSteer::maxXXX( OpenSteer::maxXXX( heights[curVert], heights[curVert+1] ),
+											OpenSteer::maxXXX( heights[curVert+width], heights[curVert+width+1] ) );
+
+	free( data );
+	data=NULL;
+}
+
+
+// Compiled terrain file layout: the header, padded to TRT_COMPILED_ALIGN bytes, then the
+//	width*height GridCells, then the pyramid levels above level 0
+#define TRT_COMPILED_VERSION	2
+#define TRT_COMPILED_ALIGN		64
+
+struct CompiledHeader {
+	char magic[4];						// "TRTC"
+	int version;
+	int byteOrder;						// 0x01020304 as written
+	int scalarSize, cellSize;			// sizeof(TRTScalar), sizeof(GridCell)
+	int width, height;
+	int levels;							// 0 if there is no pyramid
+	int levelWidth[32], levelOffset[32];
+	TRTScalar minx,maxx,miny,maxy,minz,maxz;
+};
+
+
+bool RayTester::SaveCompiled( const char *fname ) const {
+	if( data==NULL )
+		return false;
+
+	CompiledHeader header;
+	memset( &header, 0, sizeof(header) );
+	memcpy( header.magic, "TRTC", 4 );
+	header.version=TRT_COMPILED_VERSION;
+	header.byteOrder=0x01020304;
+	header.scalarSize=sizeof(TRTScalar);
+	header.cellSize=sizeof(GridCell);
+	header.width=width;
+	header.height=height;
+	header.minx=minx;	header.maxx=maxx;
+	header.miny=miny;	header.maxy=maxy;
+	header.minz=minz;	header.maxz=maxz;
+
+	#ifdef TRT_HEIGHT_PYRAMID
+		size_t pyramidSize=0;
+		if( pyramid!=NULL ) {
+			header.levels=levels;
+			memcpy( header.levelWidth, levelWidth, sizeof(levelWidth) );
+			memcpy( header.levelOffset, levelOffset, sizeof(levelOffset) );
+			pyramidSize=levelOffset[levels-1]+levelWidth[levels-1];		// the top level is one row
+		}
+	#endif
+
+	FILE *outf=fopen(fname,"wb");
+	if( outf==NULL )
+		return false;
+
+	char padding[TRT_COMPILED_ALIGN]={ 0 };
+	size_t headerSize=(sizeof(header)+TRT_COMPILED_ALIGN-1)/TRT_COMPILED_ALIGN*TRT_COMPILED_ALIGN;
+
+	bool ok = fwrite( &header, sizeof(header), 1, outf )==1 &&
+				fwrite( padding, 1, headerSize-sizeof(header), outf )==headerSize-sizeof(header) &&
+				fwrite( data, sizeof(GridCell), (size_t)width*height, outf )==(size_t)width*height;
+	#ifdef TRT_HEIGHT_PYRAMID
+		if( ok && pyramidSize>0 )
+			ok = fwrite( pyramid, sizeof(TRTScalar), pyramidSize, outf )==pyramidSize;
+	#endif
+
+	return fclose( outf )==0 && ok;
+}
+
+
+bool RayTester::LoadCompiled( const char *fname,	TRTScalar xMin, TRTScalar xMax,
+													TRTScalar yMin, TRTScalar yMax,
+													TRTScalar zMin, TRTScalar zMax ) {
+	Release();
+
+	// map the whole file read-only and shared
+	void *view=NULL;
+	size_t size=0;
+	#ifdef _WIN32
+		HANDLE file=CreateFileA( fname, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL );
+		if( file==INVALID_HANDLE_VALUE )
+			return false;
+		LARGE_INTEGER fileSize;
+		HANDLE handle=NULL;
+		if( GetFileSizeEx( file, &fileSize ) && fileSize.QuadPart>=(LONGLONG)sizeof(CompiledHeader) &&
+				( handle=CreateFileMappingA( file, NULL, PAGE_READONLY, 0, 0, NULL ) )!=NULL )
+			view=MapViewOfFile( handle, FILE_MAP_READ, 0, 0, 0 );
+		if( view==NULL ) {
+			if( handle!=NULL )
+				CloseHandle( handle );
+			CloseHandle( file );
+			return false;
+		}
+		size=(size_t)fileSize.QuadPart;
+		mappingFile=file;
+		mappingHandle=handle;
+	#else
+		int fd=open( fname, O_RDONLY );
+		if( fd<0 )
+			return false;
+		struct stat info;
+		if( fstat( fd, &info )==0 && info.st_size>=(off_t)sizeof(CompiledHeader) ) {
+			size=(size_t)info.st_size;
+			view=mmap( NULL, size, PROT_READ, MAP_SHARED, fd, 0 );
+			if( view==MAP_FAILED )
+				view=NULL;
+		}
+		close( fd );
+		if( view==NULL )
+			return false;
+	#endif
+	mapping=view;
+	mappingSize=size;
+
+	// check that the file was written by a compatible tester and is complete
+	const CompiledHeader &header=*(const CompiledHeader *)view;
+	size_t headerSize=(sizeof(header)+TRT_COMPILED_ALIGN-1)/TRT_COMPILED_ALIGN*TRT_COMPILED_ALIGN;
+	size_t cells=(size_t)header.width*header.height;
+	size_t pyramidSize=( header.levels>1 && header.levels<=32 ? header.levelOffset[header.levels-1]+header.levelWidth[header.levels-1] : 0 );
+
+	if( memcmp( header.magic, "TRTC", 4 )!=0 || header.version!=TRT_COMPILED_VERSION || header.byteOrder!=0x01020304 ||
+			header.scalarSize!=(int)sizeof(TRTScalar) || header.cellSize!=(int)sizeof(GridCell) ||
+			header.width<2 || header.height<2 || header.levels<0 || header.levels>32 ||
+			size<headerSize+cells*sizeof(GridCell)+pyramidSize*sizeof(TRTScalar) ) {
+		Release();
+		return false;
+	}
+
+	width=header.width;
+	height=header.height;
+	data=(GridCell *)( (char *)view+headerSize );
+
+	#ifdef TRT_HEIGHT_PYRAMID
+		if( pyramidSize>0 ) {
+			pyramid=(TRTScalar *)( (char *)data+cells*sizeof(GridCell) );
+			levels=header.levels;
+			memcpy( levelWidth, header.levelWidth, sizeof(levelWidth) );
+			memcpy( levelOffset, header.levelOffset, sizeof(levelOffset) );
+		}
+	#endif
+
+	minx=header.minx;	maxx=header.maxx;
+	miny=header.miny;	maxy=header.maxy;
+	minz=header.minz;	maxz=header.maxz;
+	xrange=maxx-minx;
+	yrange=maxy-miny;
+	zrange=maxz-minz;
+	xstep=xrange/(width-1);
+	zstep=zrange/(height-1);
+
+	#ifdef TRT_TRANSFORM_DATA
+		(void)xMin; (void)xMax; (void)yMin; (void)yMax; (void)zMin; (void)zMax;
+		transformData=false;
+	#else
+		if( ( transformData = (xMin!=xMax && yMin!=yMax && zMin!=zMax) ) ) {
+			_xMin=xMin;
+			_xRange=xMax-xMin;
+			_yMin=yMin;
+			_yRange=yMax-yMin;
+			_zMin=zMin;
+			_zRange=zMax-zMin;
+		}
+	#endif
+
+	return true;
+}
+
+
+bool RayTester::CompileData( char *srcName, const char *dstName ) {
+	RayTester tester;
+	tester.LoadData( srcName );
+	return tester.SaveCompiled( dstName );
+}
+
+
+#ifdef TRT_HEIGHT_PYRAMID
+void RayTester::BuildPyramid() {
+
+	// SkipBlocks finds the cells at a block's edges from the first row and column of vertices,
+	//	which is only what RayCastLocal reads if every row and column is straight (as they are
+	//	in the compact layout)
+	int x,y;
+	for(y=0; y<height && heights==NULL; y++)
+		for(x=0; x<width; x++)
+			if( data[x+y*width].pos[0]!=data[x].pos[0] || data[x+y*width].pos[2]!=data[y*width].pos[2] ||
+					( x>0 && !( data[x].pos[0]>data[x-1].pos[0] ) ) || ( y>0 && !( data[y*width].pos[2]>data[(y-1)*width].pos[2] ) ) )
+				return;
+
+	int levelHeight[32];
+	int size=0;
+	levelWidth[0]=width-1;
+	levelHeight[0]=height-1;
+	levelOffset[0]=0;
+	for(levels=1; levels<32 && ( levelWidth[levels-1]>1 || levelHeight[levels-1]>1 ); levels++){
+		levelWidth[levels]=(levelWidth[levels-1]+1)/2;
+		levelHeight[levels]=(levelHeight[levels-1]+1)/2;
+		levelOffset[levels]=size;
+		size+=levelWidth[levels]*levelHeight[levels];
+	}
+
+	if( levels<2 )
+		return;
+
+	pyramid = (TRTScalar *)malloc( size*sizeof(TRTScalar) );
+
+	for(int l=1; l<levels; l++){
+		TRTScalar *level=pyramid+levelOffset[l];
+		for(y=0; y<levelHeight[l]; y++)
+			for(x=0; x<levelWidth[l]; x++){
+				TRTScalar top=-TRT_INFINITY;
+				for(int j=2*y; j<2*y+2 && j<levelHeight[l-1]; j++)
+					for(int i=2*x; i<2*x+2 && i<levelWidth[l-1]; i++){
+						TRTScalar below = ( l>1 ? pyramid[levelOffset[l-1]+i+j*levelWidth[l-1]] : heights!=NULL ? cellMaxY[i+j*width] : data[i+j*width].maxy );
+						if( below>top )
+							top=below;
+					}
+				level[x+y*levelWidth[l]]=top;
+			}
+	}
+}
+
+
+template< class Cells >
+bool RayTester::SkipBlocks( const Cells &cells, int &xidx, int &zidx, TRTScalar &lasty, const TRTScalar *realEyePos, const TRTScalar *realViewNorm, TRTScalar maxt ) const {
+
+	// The ray enters cell (xidx,zidx) at height lasty. Find the largest block around the cell
+	//	that lies below the ray where it enters and where it leaves, then put the ray into the
+	//	cell beyond the block, exactly as stepping through the cells would have.
+	if( xidx<0 || zidx<0 || xidx>=width-1 || zidx>=height-1 )
+		return true;
+
+	int level=0;
+	while( level+1<levels && lasty>=pyramid[levelOffset[level+1]+(xidx>>(level+1))+(zidx>>(level+1))*levelWidth[level+1]] )
+		level++;
+
+	bool right=realViewNorm[0]>0, down=realViewNorm[2]>0;
+	int x0=0,x1=0,z0=0,z1=0;
+	TRTScalar tx=0,tz=0,tval=0;
+
+	for( ; level>0; level-- ){
+		// block in cells [x0,x1) x [z0,z1)
+		x0=(xidx>>level)<<level;
+		z0=(zidx>>level)<<level;
+		x1=( x0+(1<<level)<width-1 ? x0+(1<<level) : width-1 );
+		z1=( z0+(1<<level)<height-1 ? z0+(1<<level) : height-1 );
+
+		tx=( cells.ColumnX( right ? x1 : x0 )-realEyePos[0] )/realViewNorm[0];
+		tz=( cells.RowZ( down ? z1 : z0 )-realEyePos[2] )/realViewNorm[2];
+		tval=( tx<tz ? tx : tz );
+
+		if( realEyePos[1]+tval*realViewNorm[1]>=pyramid[levelOffset[level]+(xidx>>level)+(zidx>>level)*levelWidth[level]] )
+			break;
+	}
+
+	if( level==0 )
+		return true;
+
+	if( tval>maxt )		// Check if maxt value surpassed
+		return false;
+
+	// The cell stepping crosses an x edge before a z edge only if it is strictly closer. The
+	//	cell along the other axis is estimated from the exit point and then settled by the same
+	//	comparisons of edge t values the stepping makes.
+	if( tx<tz ) {
+		int z=(int)((realEyePos[2]+tx*realViewNorm[2]-minz)/zstep);
+		if( down ) {
+			z = ( z<zidx ? zidx : z>z1-1 ? z1-1 : z );
+			while( z>zidx && ( cells.RowZ( z )-realEyePos[2] )/realViewNorm[2]>tx )
+				z--;
+			while( z<z1-1 && ( cells.RowZ( z+1 )-realEyePos[2] )/realViewNorm[2]<=tx )
+				z++;
+		} else {
+			z = ( z<z0 ? z0 : z>zidx ? zidx : z );
+			while( z<zidx && ( cells.RowZ( z+1 )-realEyePos[2] )/realViewNorm[2]>tx )
+				z++;
+			while( z>z0 && ( cells.RowZ( z )-realEyePos[2] )/realViewNorm[2]<=tx )
+				z--;
+		}
+		xidx = ( right ? x1 : x0-1 );
+		zidx = z;
+	} else {
+		int x=(int)((realEyePos[0]+tz*realViewNorm[0]-minx)/xstep);
+		if( right ) {
+			x = ( x<xidx ? xidx : x>x1-1 ? x1-1 : x );
+			while( x>xidx && ( cells.ColumnX( x )-realEyePos[0] )/realViewNorm[0]>=tz )
+				x--;
+			while( x<x1-1 && ( cells.ColumnX( x+1 )-realEyePos[0] )/realViewNorm[0]<tz )
+				x++;
+		} else {
+			x = ( x<x0 ? x0 : x>xidx ? xidx : x );
+			while( x<xidx && ( cells.ColumnX( x+1 )-realEyePos[0] )/realViewNorm[0]>=tz )
+				x++;
+			while( x>x0 && ( cells.ColumnX( x )-realEyePos[0] )/realViewNorm[0]<tz )
+				x--;
+		}
+		xidx = x;
+		zidx = ( down ? z1 : z0-1 );
+	}
+
+	lasty=realEyePos[1]+tval*realViewNorm[1];
+	return true;
 }
+#endif
 
 
 void RayTester::RayCast( RayTestInfo &results, const TRTScalar *eyePos, const TRTScalar *viewNorm, TRTScalar maxt ) const {
@@ -175,6 +567,89 @@ void RayTester::RayCast( RayTestInfo &results, const TRTScalar *eyePos, const TR
 			realViewNorm[2]=viewNorm[2];
 		}
 
+	RayCastLocal( results, realEyePos, realViewNorm, maxt );
+}
+
+
+void RayTester::RayCastBatch( RayTestInfo *results, const TRTScalar *eyePos, const TRTScalar *viewNorm, int count, TRTScalar maxt ) const {
+
+	// the rays are independent and the tester is only read
+	#ifdef _OPENMP
+		#pragma omp parallel for schedule(dynamic,16) if( count>=TRT_PARALLEL_RAYS )
+	#endif
+	for(int i=0; i<count; i++)
+		RayCast( results[i], eyePos+i*3, viewNorm+i*3, maxt );
+}
+
+
+// The traversal reads cells through one of these, addressing vertices by index into the grid
+//	and by column and row
+
+struct RayTester::FullCells {
+	const RayTester &tester;
+	FullCells( const RayTester &t ) : tester(t) {}
+
+	TRTScalar MaxY( int idx ) const { return tester.data[idx].maxy; }
+	TRTScalar X( int idx, int ) const { return tester.data[idx].pos[0]; }
+	TRTScalar Z( int idx, int ) const { return tester.data[idx].pos[2]; }
+	TRTScalar ColumnX( int x ) const { return tester.data[x].pos[0]; }
+	TRTScalar RowZ( int z ) const { return tester.data[z*tester.width].pos[2]; }
+	const TRTScalar *Vertex( TRTScalar *, int idx, int, int ) const { return tester.data[idx].pos; }
+
+	#ifdef TRT_PRECOMPUTE_NORMALS
+		void UpLeftNormal( TRTScalar *norm, int idx, int, int ) const {
+			memcpy( norm, tester.data[idx].upLeftNorm, sizeof(TRTScalar)*3 );
+		}
+		void LowRightNormal( TRTScalar *norm, int idx, int, int ) const {
+			memcpy( norm, tester.data[idx].lowRightNorm, sizeof(TRTScalar)*3 );
+		}
+	#endif
+};
+
+
+struct RayTester::CompactCells {
+	const RayTester &tester;
+	CompactCells( const RayTester &t ) : tester(t) {}
+
+	TRTScalar MaxY( int idx ) const { return tester.cellMaxY[idx]; }
+	TRTScalar X( int, int x ) const { return tester.gridX[x]; }
+	TRTScalar Z( int, int z ) const { return tester.gridZ[z]; }
+	TRTScalar ColumnX( int x ) const { return tester.gridX[x]; }
+	TRTScalar RowZ( int z ) const { return tester.gridZ[z]; }
+	const TRTScalar *Vertex( TRTScalar *v, int idx, int x, int z ) const {
+		v[0]=tester.gridX[x];
+		v[1]=tester.heights[idx];
+		v[2]=tester.gridZ[z];
+		return v;
+	}
+
+	// normals are only worked out for the triangle that was hit
+	#ifdef TRT_PRECOMPUTE_NORMALS
+		void UpLeftNormal( TRTScalar *norm, int idx, int x, int z ) const {
+			TRTScalar u[3], v[3], w[3];
+			tester.GetNormal( norm, Vertex( u, idx, x, z ), Vertex( v, idx+tester.width, x, z+1 ), Vertex( w, idx+1, x+1, z ) );
+			tester.Normalize( norm );
+		}
+		void LowRightNormal( TRTScalar *norm, int idx, int x, int z ) const {
+			TRTScalar u[3], v[3], w[3];
+			tester.GetNormal( norm, Vertex( u, idx+tester.width+1, x+1, z+1 ), Vertex( v, idx+1, x+1, z ), Vertex( w, idx+tester.width, x, z+1 ) );
+			tester.Normalize( norm );
+		}
+	#endif
+};
+
+
+void RayTester::RayCastLocal( RayTestInfo &results, const TRTScalar *realEyePos, const TRTScalar *realViewNorm, TRTScalar maxt ) const {
+	if( heights!=NULL )
+		RayCastCells( CompactCells( *this ), results, realEyePos, realViewNorm, maxt );
+	else
+		RayCastCells( FullCells( *this ), results, realEyePos, realViewNorm, maxt );
+}
+
+
+template< class Cells >
+void RayTester::RayCastCells( const Cells &cells, RayTestInfo &results, const TRTScalar *realEyePos, const TRTScalar *realViewNorm, TRTScalar maxt ) const {
+
 	// find the initial grid cell
 	int xidx=(int)((realEyePos[0]-minx)/xstep);
 	int zidx=(int)((realEyePos[2]-minz)/zstep);
@@ -184,9 +659,17 @@ void RayTester::RayCast( RayTestInfo &results, const TRTScalar *eyePos, const TR
 	TRTScalar newLasty=lasty;
 
 	int idx = xidx+zidx*width;			// the current grid cell
+	int cx=xidx, cz=zidx;				// its column and row
+	TRTScalar corner[4][3];				// room for vertices the compact layout has to assemble
 	TRTScalar tval,tval1=-1,tval2=-1;	// t parameter values for intersection
 	bool mustTest;						// flag for whether or not we test against triangles
 
+	#ifdef TRT_HEIGHT_PYRAMID
+		// after each step, jump over blocks of cells the ray passes above; axis-aligned rays
+		//	are left to the cell stepping
+		bool skipBlocks=( pyramid!=NULL && realViewNorm[0]!=0 && realViewNorm[2]!=0 );
+	#endif
+
 	// for speed, perform computations according to quadrant
 
 	if( realViewNorm[0]>0 ) {				// Moving to the right
@@ -214,14 +697,15 @@ void RayTester::RayCast( RayTestInfo &results, const TRTScalar *eyePos, const TR
 
 				lasty = realEyePos[1]+tval*realViewNorm[1];
 				idx = xidx+zidx*width;
+				cx=xidx; cz=zidx;
 			}
 
 			while( xidx<width-1 && zidx<height-1 ) {
 
 				// only compute intersection if we have to -- we may have to test triangles anyway
-				if( !( mustTest=(lasty<data[idx].maxy) ) ) {
-					tval1=( data[idx+width+1].pos[0]-realEyePos[0] )/realViewNorm[0];
-					tval2=( data[idx+width+1].pos[2]-realEyePos[2] )/realViewNorm[2];
+				if( !( mustTest=(lasty<cells.MaxY( idx )) ) ) {
+					tval1=( cells.X( idx+width+1, cx+1 )-realEyePos[0] )/realViewNorm[0];
+					tval2=( cells.Z( idx+width+1, cz+1 )-realEyePos[2] )/realViewNorm[2];
 
 					if( tval1 < tval2 ){		// Hits right edge
 						xidx++;
@@ -237,32 +721,34 @@ void RayTester::RayCast( RayTestInfo &results, const TRTScalar *eyePos, const TR
 					}
 
 					newLasty=realEyePos[1]+tval*realViewNorm[1];
-					mustTest=( newLasty<data[idx].maxy );
+					mustTest=( newLasty<cells.MaxY( idx ) );
 				}
 
 				// if the mustTest is true, the ray intersects the y-bounds of the cell
 				if( mustTest ) {
-					RayCastTriangle( results, realEyePos, realViewNorm, data[idx].pos, data[idx+width].pos, data[idx+1].pos );
+					RayCastTriangle( results, realEyePos, realViewNorm, cells.Vertex( corner[0], idx, cx, cz ),
+										cells.Vertex( corner[1], idx+width, cx, cz+1 ), cells.Vertex( corner[2], idx+1, cx+1, cz ) );
 					if( results.hitOccurred ){
 						if( results.t>maxt ) {		// Check if maxt value surpassed
 							results.hitOccurred=false;
 							return;
 						}
 						#ifdef TRT_PRECOMPUTE_NORMALS
-							memcpy( results.norm, data[idx].upLeftNorm, sizeof(TRTScalar)*3 );
+							cells.UpLeftNormal( results.norm, idx, cx, cz );
 						#endif
 						RectifyResults( results );
 						return;
 					}
 
-					RayCastTriangle( results, realEyePos, realViewNorm, data[idx+width+1].pos, data[idx+1].pos, data[idx+width].pos );
+					RayCastTriangle( results, realEyePos, realViewNorm, cells.Vertex( corner[3], idx+width+1, cx+1, cz+1 ),
+										cells.Vertex( corner[2], idx+1, cx+1, cz ), cells.Vertex( corner[1], idx+width, cx, cz+1 ) );
 					if( results.hitOccurred ){
 						if( results.t>maxt ) {		// Check if maxt value surpassed
 							results.hitOccurred=false;
 							return;
 						}
 						#ifdef TRT_PRECOMPUTE_NORMALS
-							memcpy( results.norm, data[idx].lowRightNorm, sizeof(TRTScalar)*3 );
+							cells.LowRightNormal( results.norm, idx, cx, cz );
 						#endif
 						RectifyResults( results );
 						return;
@@ -270,9 +756,9 @@ void RayTester::RayCast( RayTestInfo &results, const TRTScalar *eyePos, const TR
 				}
 
 				// we didn't intersect -- so update the index
-				if( lasty<data[idx].maxy ) {	// in this case, we haven't updated xidx or zidx yet
-					tval1=( data[idx+width+1].pos[0]-realEyePos[0] )/realViewNorm[0];
-					tval2=( data[idx+width+1].pos[2]-realEyePos[2] )/realViewNorm[2];
+				if( lasty<cells.MaxY( idx ) ) {	// in this case, we haven't updated xidx or zidx yet
+					tval1=( cells.X( idx+width+1, cx+1 )-realEyePos[0] )/realViewNorm[0];
+					tval2=( cells.Z( idx+width+1, cz+1 )-realEyePos[2] )/realViewNorm[2];
 
 					if( tval1 < tval2 ){		// Hits right edge
 						xidx++;
@@ -288,11 +774,23 @@ void RayTester::RayCast( RayTestInfo &results, const TRTScalar *eyePos, const TR
 					}
 
 					newLasty=realEyePos[1]+tval*realViewNorm[1];
-					mustTest=( newLasty<data[idx].maxy );
+					mustTest=( newLasty<cells.MaxY( idx ) );
 				}
 				idx = xidx+zidx*width;
+				cx=xidx; cz=zidx;
 				lasty=newLasty;
 
+				#ifdef TRT_HEIGHT_PYRAMID
+					if( skipBlocks ) {
+						if( !SkipBlocks( cells, xidx, zidx, lasty, realEyePos, realViewNorm, maxt ) ) {
+							results.hitOccurred=false;
+							return;
+						}
+						idx = xidx+zidx*width;
+						cx=xidx; cz=zidx;
+					}
+				#endif
+
 			}
 
 		} else {						// ... else moving upwards
@@ -307,10 +805,12 @@ void RayTester::RayCast( RayTestInfo &results, const TRTScalar *eyePos, const TR
 					tval=tval1;
 					xidx=0;
 					zidx=(int)((realEyePos[2]+tval*realViewNorm[2]-minz)/zstep);
+					if( zidx>height-2 )		// the last row and column of vertices start no cells
+						zidx=height-2;
 				} else {					// Hits bottom edge of terrain
 					tval=tval2;
 					xidx=(int)((realEyePos[0]+tval*realViewNorm[0]-minx)/xstep);
-					zidx=height-1;
+					zidx=height-2;
 				}
 
 				if( tval>maxt || tval<0 ) {		// Check if maxt value surpassed
@@ -320,15 +820,16 @@ void RayTester::RayCast( RayTestInfo &results, const TRTScalar *eyePos, const TR
 
 				lasty = realEyePos[1]+tval*realViewNorm[1];
 				idx = xidx+zidx*width;
+				cx=xidx; cz=zidx;
 			}
 
 			while( xidx<width-1 && zidx>=0 ) {
 
 				// only compute intersection if we have to -- we may have to test triangles anyway
-				if( !( mustTest=(lasty<data[idx].maxy) ) ) {
-					tval1 = ( data[idx+1].pos[0]-realEyePos[0] )/realViewNorm[0];
+				if( !( mustTest=(lasty<cells.MaxY( idx )) ) ) {
+					tval1 = ( cells.X( idx+1, cx+1 )-realEyePos[0] )/realViewNorm[0];
 					if( realViewNorm[2]!=0 )
-						tval2 = ( data[idx+1].pos[2]-realEyePos[2] )/realViewNorm[2];
+						tval2 = ( cells.Z( idx+1, cz )-realEyePos[2] )/realViewNorm[2];
 
 					if( realViewNorm[2]==0 || tval1 < tval2 ){		// Hits right edge
 						xidx++;
@@ -344,32 +845,34 @@ void RayTester::RayCast( RayTestInfo &results, const TRTScalar *eyePos, const TR
 					}
 
 					newLasty=realEyePos[1]+tval*realViewNorm[1];
-					mustTest=( newLasty<data[idx].maxy );
+					mustTest=( newLasty<cells.MaxY( idx ) );
 				}
 
 				// if the mustTest is true, the ray intersects the y-bounds of the cell
 				if( mustTest ) {
-					RayCastTriangle( results, realEyePos, realViewNorm, data[idx].pos, data[idx+width].pos, data[idx+1].pos );
+					RayCastTriangle( results, realEyePos, realViewNorm, cells.Vertex( corner[0], idx, cx, cz ),
+										cells.Vertex( corner[1], idx+width, cx, cz+1 ), cells.Vertex( corner[2], idx+1, cx+1, cz ) );
 					if( results.hitOccurred ){
 						if( results.t>maxt ) {		// Check if maxt value surpassed
 							results.hitOccurred=false;
 							return;
 						}
 						#ifdef TRT_PRECOMPUTE_NORMALS
-							memcpy( results.norm, data[idx].upLeftNorm, sizeof(TRTScalar)*3 );
+							cells.UpLeftNormal( results.norm, idx, cx, cz );
 						#endif
 						RectifyResults( results );
 						return;
 					}
 
-					RayCastTriangle( results, realEyePos, realViewNorm, data[idx+width+1].pos, data[idx+1].pos, data[idx+width].pos );
+					RayCastTriangle( results, realEyePos, realViewNorm, cells.Vertex( corner[3], idx+width+1, cx+1, cz+1 ),
+										cells.Vertex( corner[2], idx+1, cx+1, cz ), cells.Vertex( corner[1], idx+width, cx, cz+1 ) );
 					if( results.hitOccurred ){
 						if( results.t>maxt ) {		// Check if maxt value surpassed
 							results.hitOccurred=false;
 							return;
 						}
 						#ifdef TRT_PRECOMPUTE_NORMALS
-							memcpy( results.norm, data[idx].lowRightNorm, sizeof(TRTScalar)*3 );
+							cells.LowRightNormal( results.norm, idx, cx, cz );
 						#endif
 						RectifyResults( results );
 						return;
@@ -377,10 +880,10 @@ void RayTester::RayCast( RayTestInfo &results, const TRTScalar *eyePos, const TR
 				}
 
 				// we didn't intersect -- so update the index
-				if( lasty<data[idx].maxy ) {	// in this case, we haven't updated xidx or zidx yet
-					tval1 = ( data[idx+1].pos[0]-realEyePos[0] )/realViewNorm[0];
+				if( lasty<cells.MaxY( idx ) ) {	// in this case, we haven't updated xidx or zidx yet
+					tval1 = ( cells.X( idx+1, cx+1 )-realEyePos[0] )/realViewNorm[0];
 					if( realViewNorm[2]!=0 )
-						tval2 = ( data[idx+1].pos[2]-realEyePos[2] )/realViewNorm[2];
+						tval2 = ( cells.Z( idx+1, cz )-realEyePos[2] )/realViewNorm[2];
 
 					if( realViewNorm[2]==0 || tval1 < tval2 ){		// Hits right edge
 						xidx++;
@@ -396,10 +899,22 @@ void RayTester::RayCast( RayTestInfo &results, const TRTScalar *eyePos, const TR
 					}
 
 					newLasty=realEyePos[1]+tval*realViewNorm[1];
-					mustTest=( newLasty<data[idx].maxy );
+					mustTest=( newLasty<cells.MaxY( idx ) );
 				}
 				idx = xidx+zidx*width;
+				cx=xidx; cz=zidx;
 				lasty=newLasty;
+
+				#ifdef TRT_HEIGHT_PYRAMID
+					if( skipBlocks ) {
+						if( !SkipBlocks( cells, xidx, zidx, lasty, realEyePos, realViewNorm, maxt ) ) {
+							results.hitOccurred=false;
+							return;
+						}
+						idx = xidx+zidx*width;
+						cx=xidx; cz=zidx;
+					}
+				#endif
 			}
 		}
 	} else {							// else moving to the left
@@ -413,11 +928,13 @@ void RayTester::RayCast( RayTestInfo &results, const TRTScalar *eyePos, const TR
 
 				if( realViewNorm[0]!=0 && tval1 > tval2 ){		// Hits right edge of terrain
 					tval=tval1;
-					xidx=width-1;
+					xidx=width-2;
 					zidx=(int)((realEyePos[2]+tval*realViewNorm[2]-minz)/zstep);
 				} else {					// Hits top edge of terrain
 					tval=tval2;
 					xidx=(int)((realEyePos[0]+tval*realViewNorm[0]-minx)/xstep);
+					if( xidx>width-2 )		// the last row and column of vertices start no cells
+						xidx=width-2;
 					zidx=0;
 				}
 
@@ -428,15 +945,16 @@ void RayTester::RayCast( RayTestInfo &results, const TRTScalar *eyePos, const TR
 
 				lasty = realEyePos[1]+tval*realViewNorm[1];
 				idx = xidx+zidx*width;
+				cx=xidx; cz=zidx;
 			}
 
 			while( xidx>=0 && zidx<height-1 ) {
 
 				// only compute intersection if we have to -- we may have to test triangles anyway
-				if( !( mustTest=(lasty<data[idx].maxy) ) ) {
+				if( !( mustTest=(lasty<cells.MaxY( idx )) ) ) {
 					if( realViewNorm[0]!=0 )
-						tval1 = ( data[idx+width].pos[0]-realEyePos[0] )/realViewNorm[0];
-					tval2 = ( data[idx+width].pos[2]-realEyePos[2] )/realViewNorm[2];
+						tval1 = ( cells.X( idx+width, cx )-realEyePos[0] )/realViewNorm[0];
+					tval2 = ( cells.Z( idx+width, cz+1 )-realEyePos[2] )/realViewNorm[2];
 
 					if( realViewNorm[0]!=0 && tval1 < tval2 ){		// Hits right edge
 						xidx--;
@@ -452,32 +970,34 @@ void RayTester::RayCast( RayTestInfo &results, const TRTScalar *eyePos, const TR
 					}
 
 					newLasty=realEyePos[1]+tval*realViewNorm[1];
-					mustTest=( newLasty<data[idx].maxy );
+					mustTest=( newLasty<cells.MaxY( idx ) );
 				}
 
 				// if the mustTest is true, the ray intersects the y-bounds of the cell
 				if( mustTest ) {
-					RayCastTriangle( results, realEyePos, realViewNorm, data[idx].pos, data[idx+width].pos, data[idx+1].pos );
+					RayCastTriangle( results, realEyePos, realViewNorm, cells.Vertex( corner[0], idx, cx, cz ),
+										cells.Vertex( corner[1], idx+width, cx, cz+1 ), cells.Vertex( corner[2], idx+1, cx+1, cz ) );
 					if( results.hitOccurred ){
 						if( results.t>maxt ) {		// Check if maxt value surpassed
 							results.hitOccurred=false;
 							return;
 						}
 						#ifdef TRT_PRECOMPUTE_NORMALS
-							memcpy( results.norm, data[idx].upLeftNorm, sizeof(TRTScalar)*3 );
+							cells.UpLeftNormal( results.norm, idx, cx, cz );
 						#endif
 						RectifyResults( results );
 						return;
 					}
 
-					RayCastTriangle( results, realEyePos, realViewNorm, data[idx+width+1].pos, data[idx+1].pos, data[idx+width].pos );
+					RayCastTriangle( results, realEyePos, realViewNorm, cells.Vertex( corner[3], idx+width+1, cx+1, cz+1 ),
+										cells.Vertex( corner[2], idx+1, cx+1, cz ), cells.Vertex( corner[1], idx+width, cx, cz+1 ) );
 					if( results.hitOccurred ){
 						if( results.t>maxt ) {		// Check if maxt value surpassed
 							results.hitOccurred=false;
 							return;
 						}
 						#ifdef TRT_PRECOMPUTE_NORMALS
-							memcpy( results.norm, data[idx].lowRightNorm, sizeof(TRTScalar)*3 );
+							cells.LowRightNormal( results.norm, idx, cx, cz );
 						#endif
 						RectifyResults( results );
 						return;
@@ -485,10 +1005,10 @@ void RayTester::RayCast( RayTestInfo &results, const TRTScalar *eyePos, const TR
 				}
 
 				// we didn't intersect -- so update the index
-				if( lasty<data[idx].maxy ) {	// in this case, we haven't updated xidx or zidx yet
+				if( lasty<cells.MaxY( idx ) ) {	// in this case, we haven't updated xidx or zidx yet
 					if( realViewNorm[0]!=0 )
-						tval1 = ( data[idx+width].pos[0]-realEyePos[0] )/realViewNorm[0];
-					tval2 = ( data[idx+width].pos[2]-realEyePos[2] )/realViewNorm[2];
+						tval1 = ( cells.X( idx+width, cx )-realEyePos[0] )/realViewNorm[0];
+					tval2 = ( cells.Z( idx+width, cz+1 )-realEyePos[2] )/realViewNorm[2];
 
 					if( realViewNorm[0]!=0 && tval1 < tval2 ){		// Hits right edge
 						xidx--;
@@ -504,10 +1024,22 @@ void RayTester::RayCast( RayTestInfo &results, const TRTScalar *eyePos, const TR
 					}
 
 					newLasty=realEyePos[1]+tval*realViewNorm[1];
-					mustTest=( newLasty<data[idx].maxy );
+					mustTest=( newLasty<cells.MaxY( idx ) );
 				}
 				idx = xidx+zidx*width;
+				cx=xidx; cz=zidx;
 				lasty=newLasty;
+
+				#ifdef TRT_HEIGHT_PYRAMID
+					if( skipBlocks ) {
+						if( !SkipBlocks( cells, xidx, zidx, lasty, realEyePos, realViewNorm, maxt ) ) {
+							results.hitOccurred=false;
+							return;
+						}
+						idx = xidx+zidx*width;
+						cx=xidx; cz=zidx;
+					}
+				#endif
 			}
 		} else{							// ... else moving upwards
 
@@ -520,12 +1052,16 @@ void RayTester::RayCast( RayTestInfo &results, const TRTScalar *eyePos, const TR
 
 				if( realViewNorm[2]==0 || ( realViewNorm[0]!=0 && tval1 > tval2 ) ){		// Hits right edge of terrain
 					tval=tval1;
-					xidx=width-1;
+					xidx=width-2;
 					zidx=(int)((realEyePos[2]+tval*realViewNorm[2]-minz)/zstep);
+					if( zidx>height-2 )		// the last row and column of vertices start no cells
+						zidx=height-2;
 				} else {					// Hits bottom edge of terrain
 					tval=tval2;
 					xidx=(int)((realEyePos[0]+tval*realViewNorm[0]-minx)/xstep);
-					zidx=height-1;
+					if( xidx>width-2 )		// the last row and column of vertices start no cells
+						xidx=width-2;
+					zidx=height-2;
 				}
 
 				if( tval>maxt || tval<0 ) {		// Check if maxt value surpassed
@@ -535,6 +1071,7 @@ void RayTester::RayCast( RayTestInfo &results, const TRTScalar *eyePos, const TR
 
 				lasty = realEyePos[1]+tval*realViewNorm[1];
 				idx = xidx+zidx*width;
+				cx=xidx; cz=zidx;
 			}
 
 			while( xidx>=0 && zidx>=0 ) {
@@ -542,11 +1079,11 @@ void RayTester::RayCast( RayTestInfo &results, const TRTScalar *eyePos, const TR
 				// only compute intersection if we have to -- we may have to test triangles anyway
 				if( realViewNorm[0]==0 && realViewNorm[2]==0 )
 					mustTest=true;
-                else if( !( mustTest=(lasty<data[idx].maxy) ) ) {
+                else if( !( mustTest=(lasty<cells.MaxY( idx )) ) ) {
 					if( realViewNorm[0]!=0 )
-						tval1 = ( data[idx].pos[0]-realEyePos[0] )/realViewNorm[0];
+						tval1 = ( cells.X( idx, cx )-realEyePos[0] )/realViewNorm[0];
 					if( realViewNorm[2]!=0 )
-						tval2 = ( data[idx].pos[2]-realEyePos[2] )/realViewNorm[2];
+						tval2 = ( cells.Z( idx, cz )-realEyePos[2] )/realViewNorm[2];
 
 					if( realViewNorm[2]==0 || ( realViewNorm[0]!=0 && tval1 < tval2 ) ){		// Hits right edge
 						xidx--;
@@ -562,32 +1099,34 @@ void RayTester::RayCast( RayTestInfo &results, const TRTScalar *eyePos, const TR
 					}
 
 					newLasty=realEyePos[1]+tval*realViewNorm[1];
-					mustTest=( newLasty<data[idx].maxy );
+					mustTest=( newLasty<cells.MaxY( idx ) );
 				}
 
 				// if the mustTest is true, the ray intersects the y-bounds of the cell
 				if( mustTest ) {
-					RayCastTriangle( results, realEyePos, realViewNorm, data[idx].pos, data[idx+width].pos, data[idx+1].pos );
+					RayCastTriangle( results, realEyePos, realViewNorm, cells.Vertex( corner[0], idx, cx, cz ),
+										cells.Vertex( corner[1], idx+width, cx, cz+1 ), cells.Vertex( corner[2], idx+1, cx+1, cz ) );
 					if( results.hitOccurred ){
 						if( results.t>maxt ) {		// Check if maxt value surpassed
 							results.hitOccurred=false;
 							return;
 						}
 						#ifdef TRT_PRECOMPUTE_NORMALS
-							memcpy( results.norm, data[idx].upLeftNorm, sizeof(TRTScalar)*3 );
+							cells.UpLeftNormal( results.norm, idx, cx, cz );
 						#endif
 						RectifyResults( results );
 						return;
 					}
 
-					RayCastTriangle( results, realEyePos, realViewNorm, data[idx+width+1].pos, data[idx+1].pos, data[idx+width].pos );
+					RayCastTriangle( results, realEyePos, realViewNorm, cells.Vertex( corner[3], idx+width+1, cx+1, cz+1 ),
+										cells.Vertex( corner[2], idx+1, cx+1, cz ), cells.Vertex( corner[1], idx+width, cx, cz+1 ) );
 					if( results.hitOccurred ){
 						if( results.t>maxt ) {		// Check if maxt value surpassed
 							results.hitOccurred=false;
 							return;
 						}
 						#ifdef TRT_PRECOMPUTE_NORMALS
-							memcpy( results.norm, data[idx].lowRightNorm, sizeof(TRTScalar)*3 );
+							cells.LowRightNormal( results.norm, idx, cx, cz );
 						#endif
 						RectifyResults( results );
 						return;
@@ -598,9 +1137,9 @@ void RayTester::RayCast( RayTestInfo &results, const TRTScalar *eyePos, const TR
 				}
 
 				// we didn't intersect -- so update the index
-				if( lasty<data[idx].maxy ) {	// in this case, we haven't updated xidx or zidx yet
-					tval1 = ( data[idx].pos[0]-realEyePos[0] )/realViewNorm[0];
-					tval2 = ( data[idx].pos[2]-realEyePos[2] )/realViewNorm[2];
+				if( lasty<cells.MaxY( idx ) ) {	// in this case, we haven't updated xidx or zidx yet
+					tval1 = ( cells.X( idx, cx )-realEyePos[0] )/realViewNorm[0];
+					tval2 = ( cells.Z( idx, cz )-realEyePos[2] )/realViewNorm[2];
 
 					if( realViewNorm[2]==0 || ( realViewNorm[0]!=0 && tval1 < tval2 ) ){		// Hits right edge
 						xidx--;
@@ -616,10 +1155,22 @@ void RayTester::RayCast( RayTestInfo &results, const TRTScalar *eyePos, const TR
 					}
 
 					newLasty=realEyePos[1]+tval*realViewNorm[1];
-					mustTest=( newLasty<data[idx].maxy );
+					mustTest=( newLasty<cells.MaxY( idx ) );
 				}
 				idx = xidx+zidx*width;
+				cx=xidx; cz=zidx;
 				lasty=newLasty;
+
+				#ifdef TRT_HEIGHT_PYRAMID
+					if( skipBlocks ) {
+						if( !SkipBlocks( cells, xidx, zidx, lasty, realEyePos, realViewNorm, maxt ) ) {
+							results.hitOccurred=false;
+							return;
+						}
+						idx = xidx+zidx*width;
+						cx=xidx; cz=zidx;
+					}
+				#endif
 			}
 		}
 	}
@@ -721,7 +1272,7 @@ void RayTester::RectifyResults( RayTestInfo &results ) const {
 
 
 void RayTester::GetNormal( TRTScalar *r, const TRTScalar *u, const TRTScalar *v, const TRTScalar *w) const {
-	static TRTScalar vx,vy,vz,wx,wy,wz;
+	TRTScalar vx,vy,vz,wx,wy,wz;
 
 	vx=v[0]-u[0];
 	wx=w[0]-u[0];
@@ -55,8 +55,21 @@
 //#define TRT_NORMALIZE
 
 
+// With a pyramid of the highest points over blocks of 2x2, 4x4, ... cells, rays skip whole
+//	blocks they pass over instead of stepping through every cell. It costs about a third more
+//	memory than the per-cell maxy. Only used if the vertices lie on a rectilinear grid.
+
+#define TRT_HEIGHT_PYRAMID
+
+
+// Batches of at least TRT_PARALLEL_RAYS rays are spread over threads when OpenMP is enabled.
+
+#define TRT_PARALLEL_RAYS		32
+
+
 // Set up the typedef for floating point values
 #include <float.h>
+#include <stddef.h>
 #ifdef TRT_DOUBLE_PRECISION
 	typedef double TRTScalar;
 	#define	TRT_INFINITY	DBL_MAX
@@ -87,8 +100,34 @@ public:
 								TRTScalar yMin=0, TRTScalar yMax=0,
 								TRTScalar zMin=0, TRTScalar zMax=0 );
 
+	// Compiled terrain files hold the grid cells as the tester keeps them in memory, with maxy,
+	//	normals and the height pyramid already computed. LoadCompiled maps the file and traces
+	//	against it in place, so it takes the same short time for any terrain size and processes
+	//	using the same file share its pages. A file only loads into a tester built with the same
+	//	byte order, TRTScalar and options as the one that saved it. With TRT_TRANSFORM_DATA the
+	//	data set is saved already transformed and LoadCompiled ignores its ranges.
+	bool SaveCompiled( const char *fname ) const;
+	bool LoadCompiled( const char *fname,	TRTScalar xMin=0, TRTScalar xMax=0,
+											TRTScalar yMin=0, TRTScalar yMax=0,
+											TRTScalar zMin=0, TRTScalar zMax=0 );
+
+	// Converts a file in LoadData's format into a compiled terrain file
+	static bool CompileData( char *srcName, const char *dstName );
+
+	// The compact layout keeps single-precision heights and a separate array of the cells' maxy,
+	//	with x and z implied by the grid and normals worked out for hits only: 8 bytes per vertex
+	//	instead of sizeof(GridCell). Positions snap to a regular grid and heights to floats,
+	//	otherwise the results match the full layout. It takes effect at the next LoadData and
+	//	cannot be saved compiled.
+	void SetCompactLayout( bool compact );
+	bool CompactLayout() const;
+
 	void RayCast( RayTestInfo &results, const TRTScalar *eyePos, const TRTScalar *viewNorm, TRTScalar maxt=TRT_INFINITY ) const;
 
+	// eyePos and viewNorm hold count consecutive xyz triples; results[i] is what RayCast
+	//	returns for ray i
+	void RayCastBatch( RayTestInfo *results, const TRTScalar *eyePos, const TRTScalar *viewNorm, int count, TRTScalar maxt=TRT_INFINITY ) const;
+
 private:
 
 	int width, height;
@@ -105,18 +144,53 @@ private:
 
 	GridCell *data;
 
+	bool compactLayout;					// requested for the next LoadData
+	float *heights, *cellMaxY;			// compact layout, NULL otherwise
+	TRTScalar *gridX, *gridZ;
+
+	struct FullCells;
+	struct CompactCells;
+	friend struct FullCells;
+	friend struct CompactCells;
+
+	void MakeCompact();
+
+	// set while data (and the pyramid) point into a mapped compiled file
+	void *mapping;
+	size_t mappingSize;
+	#ifdef _WIN32
+		void *mappingFile, *mappingHandle;
+	#endif
+
+	void Release();
+
 	bool transformData;
 
 	TRTScalar minx,maxx,xrange,xstep;
 	TRTScalar miny,maxy,yrange;
 	TRTScalar minz,maxz,zrange,zstep;
 
+	#ifdef TRT_HEIGHT_PYRAMID
+		// level 0 is the cells' maxy; level l>0 holds the maximum over 2^l x 2^l cells
+		TRTScalar *pyramid;
+		int levels;
+		int levelWidth[32], levelOffset[32];
+
+		void BuildPyramid();
+		template< class Cells >
+		bool SkipBlocks( const Cells &cells, int &xidx, int &zidx, TRTScalar &lasty, const TRTScalar *realEyePos, const TRTScalar *realViewNorm, TRTScalar maxt ) const;
+	#endif
+
 	#ifndef TRT_TRANSFORM_DATA
 		TRTScalar _xMin,_xRange;
 		TRTScalar _yMin,_yRange;
 		TRTScalar _zMin,_zRange;
 	#endif
 
+	void RayCastLocal( RayTestInfo &results, const TRTScalar *realEyePos, const TRTScalar *realViewNorm, TRTScalar maxt ) const;
+	template< class Cells >
+	void RayCastCells( const Cells &cells, RayTestInfo &results, const TRTScalar *realEyePos, const TRTScalar *realViewNorm, TRTScalar maxt ) const;
+
 	void RayCastTriangle( RayTestInfo &results, const TRTScalar *eyePos, const TRTScalar *viewNorm, 
 							const TRTScalar *vert0, const TRTScalar *vert1, const TRTScalar *vert2 ) const;
 
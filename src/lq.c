@@ -64,6 +64,8 @@
 
 
 #include <stdlib.h>
+#include <string.h> /* for memset */
+#include <math.h>   /* for pow */
 #include <float.h>
 #include <limits.h> /* for INT_MAX */
 #include "OpenSteer/lq.h"
@@ -80,6 +82,30 @@
 #endif
 
 
+/* ------------------------------------------------------------------ */
+/* A bin: the head of its client proxy list plus a running count of
+   the proxies on that list.  The list head must be the first slot: a
+   bin ID (lqClientProxy**) points at it, so a bin ID can be converted
+   back to its bin.  */
+
+
+typedef struct lqBin
+{
+    /* pointer to the first client proxy in this bin, or NULL */
+    lqClientProxy* contents;
+
+    /* number of client proxies currently in this bin */
+    int population;
+
+    /* the database this bin belongs to */
+    struct lqInternalDB* lq;
+
+} lqBin;
+
+
+#define lqBinForID(binID) ((lqBin*) (binID))
+
+
 /* ------------------------------------------------------------------ */
 /* This structure represents the spatial database.  Typically one of
    these would be created, by a call to lqCreateDatabase, for a given
@@ -98,15 +124,53 @@ typedef struct lqInternalDB
     /* number of sub-brick divisions in each direction */
     int divx, divy, divz;
 
-    /* pointer to an array of pointers, one for each bin */
-    lqClientProxy** bins;
+    /* pointer to an array of bins */
+    lqBin* bins;
 
     /* extra bin for "everything else" (points outside super-brick) */
-    lqClientProxy* other;
+    lqBin other;
+
+    /* the remaining slots are maintained incrementally by lqAddToBin
+       and lqRemoveFromBin so that population statistics are cheap */
+
+    /* total number of client proxies in all bins, including "other" */
+    int population;
+
+    /* number of regular bins (not "other") which are not empty */
+    int nonEmptyBinCount;
+
+    /* largest population of any regular bin */
+    int maxBinPopulation;
+
+    /* occupancy histogram: occupancy[n] is the number of regular bins
+       holding exactly n proxies (for n > 0), occupancySize is the
+       allocated length of that array */
+    int* occupancy;
+    int occupancySize;
+
+    /* query statistics accumulated by the locality query functions
+       since the last lqResetQueryStats (or automatic re-grid), only
+       while recordQueryStats is set or automatic tuning is on */
+    lqQueryStats queryStats;
+    int recordQueryStats;
+
+    /* automatic tuning: when autoTuneWindow > 0, every autoTuneWindow
+       queries the cost ratio is compared with autoTuneThreshold and
+       the lattice is re-gridded if needed (see lqSetAutoTune) */
+    float autoTuneThreshold;
+    int autoTuneWindow;
 
 } lqInternalDB;
 
 
+/* ------------------------------------------------------------------ */
+/* Queries only write to the database (statistics, automatic re-grid)
+   when recording has been asked for, otherwise they are read-only.  */
+
+#define lqRecordingQueries(lq) \
+    ((lq)->recordQueryStats || ((lq)->autoTuneWindow > 0))
+
+
 /* ------------------------------------------------------------------ */
 /* Allocate and initialize an LQ database, return a pointer to it.
    The application needs to call this before using the LQ facility.
@@ -140,6 +204,7 @@ lqInternalDB* lqCreateDatabase (float originx, float originy, float originz,
 void lqDeleteDatabase(lqDB* lq)
 {
     free (lq->bins);
+    free (lq->occupancy);
     free (lq);
 }
 
@@ -150,6 +215,9 @@ void lqDeleteDatabase(lqDB* lq)
    contents. */
 
 
+void lqAllocateBins (lqInternalDB* lq, int divx, int divy, int divz);
+
+
 void lqInitDatabase (lqInternalDB* lq,
 		     float originx, float originy, float originz,
 		     float sizex, float sizey, float sizez,
@@ -161,17 +229,44 @@ void lqInitDatabase (lqInternalDB* lq,
     lq->sizex = sizex;
     lq->sizey = sizey;
     lq->sizez = sizez;
+    lq->other.contents = NULL;
+    lq->other.population = 0;
+    lq->other.lq = lq;
+    lq->population = 0;
+    lq->occupancySize = 16;
+    lq->occupancy = (int*) calloc (lq->occupancySize, sizeof (int));
+    lqAllocateBins (lq, divx, divy, divz);
+    lqResetQueryStats (lq);
+    lq->recordQueryStats = 0;
+    lq->autoTuneThreshold = 0;
+    lq->autoTuneWindow = 0;
+}
+
+
+/* ------------------------------------------------------------------ */
+/* Allocate and clear the bin array for the given subdivisions, and
+   clear the occupancy statistics of the regular bins.  */
+
+
+void lqAllocateBins (lqInternalDB* lq, int divx, int divy, int divz)
+{
+    int i;
+    int bincount = divx * divy * divz;
+    int arraysize = sizeof (lqBin) * bincount;
+
     lq->divx = divx;
     lq->divy = divy;
     lq->divz = divz;
+    lq->bins = (lqBin*) malloc (arraysize);
+    for (i=0; i<bincount; i++)
     {
-	int i;
-	int bincount = divx * divy * divz;
-	int arraysize = sizeof (lqClientProxy*) * bincount;
-	lq->bins = (lqClientProxy**) malloc (arraysize);
-	for (i=0; i<bincount; i++) lq->bins[i] = NULL;
+	lq->bins[i].contents = NULL;
+	lq->bins[i].population = 0;
+	lq->bins[i].lq = lq;
     }
-    lq->other = NULL;
+    lq->nonEmptyBinCount = 0;
+    lq->maxBinPopulation = 0;
+    memset (lq->occupancy, 0, lq->occupancySize * sizeof (int));
 }
 
 
@@ -195,12 +290,12 @@ lqClientProxy** lqBinForLocation (lqInternalDB* lq,
     int i, ix, iy, iz;
 
     /* if point outside super-brick, return the "other" bin */
-    if (x < lq->originx)              return &(lq->other);
-    if (y < lq->originy)              return &(lq->other);
-    if (z < lq->originz)              return &(lq->other);
-    if (x >= lq->originx + lq->sizex) return &(lq->other);
-    if (y >= lq->originy + lq->sizey) return &(lq->other);
-    if (z >= lq->originz + lq->sizez) return &(lq->other);
+    if (x < lq->originx)              return &(lq->other.contents);
+    if (y < lq->originy)              return &(lq->other.contents);
+    if (z < lq->originz)              return &(lq->other.contents);
+    if (x >= lq->originx + lq->sizex) return &(lq->other.contents);
+    if (y >= lq->originy + lq->sizey) return &(lq->other.contents);
+    if (z >= lq->originz + lq->sizez) return &(lq->other.contents);
 
     /* if point inside super-brick, compute the bin coordinates */
     ix = (int) (((x - lq->originx) / lq->sizex) * lq->divx);
@@ -211,7 +306,7 @@ lqClientProxy** lqBinForLocation (lqInternalDB* lq,
     i = lqBinCoordsToBinIndex (lq, ix, iy, iz);
 
     /* return pointer to that bin */
-    return &(lq->bins[i]);
+    return &(lq->bins[i].contents);
 }
 
 
@@ -227,6 +322,58 @@ void lqInitClientProxy (lqClientProxy* proxy, void* clientObject)
     proxy->next   = NULL;
     proxy->bin    = NULL;
     proxy->object = clientObject;
+    proxy->categories = lqDefaultCategories;
+}
+
+
+/* ------------------------------------------------------------------ */
+/* Adjust the population count of a bin (and of its database) by +1 or
+   -1.  For regular bins also maintain the non-empty bin count, the
+   occupancy histogram and the maximum bin population.  */
+
+
+void lqAdjustBinPopulation (lqClientProxy** binID, int delta);
+
+void lqAdjustBinPopulation (lqClientProxy** binID, int delta)
+{
+    lqBin* bin = lqBinForID (binID);
+    lqInternalDB* lq = bin->lq;
+    int before = bin->population;
+    int after = before + delta;
+
+    bin->population = after;
+    lq->population += delta;
+
+    /* the "other" bin is not part of the occupancy statistics */
+    if (bin == &lq->other) return;
+
+    /* move this bin from one histogram entry to the next */
+    if (before > 0) lq->occupancy[before]--; else lq->nonEmptyBinCount++;
+    if (after > 0)
+    {
+	/* grow the histogram as needed */
+	if (after >= lq->occupancySize)
+	{
+	    int i;
+	    int newSize = lq->occupancySize * 2;
+	    lq->occupancy = (int*) realloc (lq->occupancy,
+					    newSize * sizeof (int));
+	    for (i = lq->occupancySize; i < newSize; i++) lq->occupancy[i] = 0;
+	    lq->occupancySize = newSize;
+	}
+	lq->occupancy[after]++;
+    }
+    else
+    {
+	lq->nonEmptyBinCount--;
+    }
+
+    /* update max: it can only move by one step per adjustment */
+    if (after > lq->maxBinPopulation)
+	lq->maxBinPopulation = after;
+    else if ((lq->maxBinPopulation > 0) &&
+	     (lq->occupancy[lq->maxBinPopulation] == 0))
+	lq->maxBinPopulation--;
 }
 
 
@@ -254,6 +401,9 @@ void lqAddToBin (lqClientProxy* object, lqClientProxy** bin)
 
     /* record bin ID in proxy object */
     object->bin = bin;
+
+    /* count it */
+    lqAdjustBinPopulation (bin, +1);
 }
 
 
@@ -278,6 +428,9 @@ void lqRemoveFromBin (lqClientProxy* object)
 	/* If there is a next object, link its "prev" pointer to the
 	   object before this one. */
 	if (object->next != NULL) object->next->prev = object->prev;
+
+	/* uncount it */
+	lqAdjustBinPopulation (object->bin, -1);
     }
 
     /* Null out prev, next and bin pointers of this object. */
@@ -332,7 +485,10 @@ void lqUpdateForNewLocation  (lqInternalDB* lq,
                                                                       \
 	/* apply function if client object within sphere */           \
 	if (distanceSquared < radiusSquared)                          \
+	{                                                             \
 	    (*func) (co->object, distanceSquared, state);             \
+	    hits++;                                                   \
+	}                                                             \
                                                                       \
 	/* consider next client object in bin list */                 \
 	co = co->next;                                                \
@@ -378,6 +534,8 @@ void lqMapOverAllObjectsInLocalityClipped (lqInternalDB* lq,
     lqClientProxy* co;
     lqClientProxy** bin;
     float radiusSquared = radius * radius;
+    long candidates = 0;
+    long hits = 0;
 
 #ifdef BOIDS_LQ_DEBUG
     if (lqAnnoteEnable) drawBallGL (x, y, z, radius);
@@ -396,8 +554,9 @@ void lqMapOverAllObjectsInLocalityClipped (lqInternalDB* lq,
 	    for (k = minBinZ; k <= maxBinZ; k++)
 	    {
 		/* get current bin's client object list */
-		bin = &lq->bins[iindex + jindex + kindex];
+		bin = &lq->bins[iindex + jindex + kindex].contents;
 		co = *bin;
+		candidates += lqBinForID (bin)->population;
 
 #ifdef BOIDS_LQ_DEBUG
 		if (lqAnnoteEnable) drawBin (lq, bin);
@@ -413,6 +572,15 @@ void lqMapOverAllObjectsInLocalityClipped (lqInternalDB* lq,
 	}
 	iindex += slab;
     }
+
+    /* record query statistics */
+    if (lqRecordingQueries (lq))
+    {
+	lq->queryStats.binsVisited +=
+	    (maxBinX - minBinX + 1) * (maxBinY - minBinY + 1) * (maxBinZ - minBinZ + 1);
+	lq->queryStats.candidatesTested += candidates;
+	lq->queryStats.hits += hits;
+    }
 }
 
 
@@ -433,14 +601,208 @@ void lqMapOverAllOutsideObjects (lqInternalDB* lq,
 				 lqCallBackFunction func,
 				 void* clientQueryState)
 {
-    lqClientProxy* co = lq->other;
+    lqClientProxy* co = lq->other.contents;
     float radiusSquared = radius * radius;
+    long hits = 0;
 
     /* traverse the "other" bin's client object list */
     lqTraverseBinClientObjectList (co,
 				   radiusSquared,
 				   func,
 				   clientQueryState);
+
+    /* record query statistics */
+    if (lqRecordingQueries (lq))
+    {
+	lq->queryStats.binsVisited += 1;
+	lq->queryStats.candidatesTested += lq->other.population;
+	lq->queryStats.hits += hits;
+    }
+}
+
+
+/* ------------------------------------------------------------------ */
+/* Query statistics and automatic tuning of the lattice subdivisions */
+
+
+void lqResetQueryStats (lqInternalDB* lq)
+{
+    lq->queryStats.queryCount = 0;
+    lq->queryStats.binsVisited = 0;
+    lq->queryStats.candidatesTested = 0;
+    lq->queryStats.hits = 0;
+    lq->queryStats.radiusSum = 0;
+}
+
+
+void lqGetQueryStats (lqInternalDB* lq, lqQueryStats* stats)
+{
+    *stats = lq->queryStats;
+}
+
+
+void lqSetQueryStatsRecording (lqInternalDB* lq, int record)
+{
+    lq->recordQueryStats = record;
+}
+
+
+void lqGetDivisions (lqInternalDB* lq, int* divx, int* divy, int* divz)
+{
+    *divx = lq->divx;
+    *divy = lq->divy;
+    *divz = lq->divz;
+}
+
+
+/* the work done per object found: bins visited plus objects tested,
+   divided by the number of objects found (at least one) */
+
+float lqQueryCostRatio (lqInternalDB* lq)
+{
+    const lqQueryStats* qs = &lq->queryStats;
+    long hits = (qs->hits > 0) ? qs->hits : 1;
+    return ((float) (qs->binsVisited + qs->candidatesTested)) / ((float) hits);
+}
+
+
+/* Choose a bin edge length close to the mean query radius, so that a
+   typical query visits about three bins along each axis.  An axis
+   which currently has a single division is assumed to be "flat" (e.g.
+   pedestrians on a ground plane) and is left alone.  The total bin
+   count is then limited to lqMaxBinsPerObject times the population so
+   that sparse populations do not pay for scanning empty bins.  */
+
+#define lqMaxBinsPerObject 8
+#define lqMaxDivisions 256
+#define lqMaxInt(a, b) (((a) > (b)) ? (a) : (b))
+
+int lqRecommendDivisionForAxis (float size, float edge, int current);
+
+int lqRecommendDivisionForAxis (float size, float edge, int current)
+{
+    int div;
+    if (current <= 1) return current;
+    div = (int) ((size / edge) + 0.5f);
+    if (div < 1) div = 1;
+    if (div > lqMaxDivisions) div = lqMaxDivisions;
+    return div;
+}
+
+void lqRecommendDivisions (lqInternalDB* lq, int* divx, int* divy, int* divz)
+{
+    const lqQueryStats* qs = &lq->queryStats;
+    float edge;
+    int maxBins, bins, axes;
+
+    /* without any queries there is nothing to go on */
+    if ((qs->queryCount == 0) || (qs->radiusSum <= 0))
+    {
+	lqGetDivisions (lq, divx, divy, divz);
+	return;
+    }
+
+    edge = qs->radiusSum / qs->queryCount;
+    *divx = lqRecommendDivisionForAxis (lq->sizex, edge, lq->divx);
+    *divy = lqRecommendDivisionForAxis (lq->sizey, edge, lq->divy);
+    *divz = lqRecommendDivisionForAxis (lq->sizez, edge, lq->divz);
+
+    /* limit the number of bins relative to the population */
+    maxBins = lqMaxBinsPerObject * ((lq->population > 0) ? lq->population : 1);
+    bins = (*divx) * (*divy) * (*divz);
+    axes = (*divx > 1) + (*divy > 1) + (*divz > 1);
+    if ((bins > maxBins) && (axes > 0))
+    {
+	float scale = (float) pow (((double) maxBins) / bins, 1.0 / axes);
+	if (*divx > 1) *divx = lqMaxInt (1, (int) (*divx * scale));
+	if (*divy > 1) *divy = lqMaxInt (1, (int) (*divy * scale));
+	if (*divz > 1) *divz = lqMaxInt (1, (int) (*divz * scale));
+    }
+}
+
+
+/* Change the number of subdivisions.  Only the bin array is
+   reallocated: each client proxy already in a bin stays where it is in
+   memory and is simply relinked into the bin for its stored location,
+   so tokens which contain proxies remain valid.  */
+
+void lqSetDivisions (lqInternalDB* lq, int divx, int divy, int divz)
+{
+    lqBin* oldBins = lq->bins;
+    int oldBinCount = lq->divx * lq->divy * lq->divz;
+    lqClientProxy* outside = lq->other.contents;
+    lqClientProxy* co;
+    lqClientProxy* next;
+    int i;
+
+    if ((divx == lq->divx) && (divy == lq->divy) && (divz == lq->divz)) return;
+
+    /* start with an empty lattice */
+    lqAllocateBins (lq, divx, divy, divz);
+    lq->other.contents = NULL;
+    lq->other.population = 0;
+    lq->population = 0;
+
+    /* relink every proxy from the old bins (and "other") */
+    for (i = 0; i <= oldBinCount; i++)
+    {
+	co = (i < oldBinCount) ? oldBins[i].contents : outside;
+	while (co != NULL)
+	{
+	    next = co->next;
+	    lqAddToBin (co, lqBinForLocation (lq, co->x, co->y, co->z));
+	    co = next;
+	}
+    }
+
+    free (oldBins);
+}
+
+
+/* Check the statistics gathered over the last autoTuneWindow queries,
+   re-grid if the cost ratio is over the threshold and a different
+   subdivision is recommended, then start a new window. */
+
+int lqAutoTune (lqInternalDB* lq, float costRatioThreshold)
+{
+    int divx, divy, divz;
+    int changed = 0;
+
+    if (lqQueryCostRatio (lq) > costRatioThreshold)
+    {
+	lqRecommendDivisions (lq, &divx, &divy, &divz);
+	changed = ((divx != lq->divx) || (divy != lq->divy) || (divz != lq->divz));
+	if (changed) lqSetDivisions (lq, divx, divy, divz);
+    }
+    lqResetQueryStats (lq);
+    return changed;
+}
+
+
+void lqSetAutoTune (lqInternalDB* lq, float costRatioThreshold, int queryWindow)
+{
+    lq->autoTuneThreshold = costRatioThreshold;
+    lq->autoTuneWindow = queryWindow;
+    lqResetQueryStats (lq);
+}
+
+
+/* called at the start of each locality query (before any bin is
+   visited, so a re-grid never happens in the middle of a traversal),
+   does nothing unless recording or automatic tuning is on */
+
+void lqNoteQuery (lqInternalDB* lq, float radius);
+
+void lqNoteQuery (lqInternalDB* lq, float radius)
+{
+    if (! lqRecordingQueries (lq)) return;
+    if ((lq->autoTuneWindow > 0) &&
+	(lq->queryStats.queryCount >= lq->autoTuneWindow))
+    {
+	lqAutoTune (lq, lq->autoTuneThreshold);
+    }
+    lq->queryStats.queryCount++;
+    lq->queryStats.radiusSum += radius;
 }
 
 
@@ -480,6 +842,9 @@ void lqMapOverAllObjectsInLocality (lqInternalDB* lq,
 	 ((z - radius) >= lq->originz + lq->sizez));
     int minBinX, minBinY, minBinZ, maxBinX, maxBinY, maxBinZ;
 
+    /* count this query, perhaps re-grid first (see lqSetAutoTune) */
+    lqNoteQuery (lq, radius);
+
     /* is the sphere completely outside the "super brick"? */
     if (completelyOutside)
     {
@@ -520,6 +885,240 @@ void lqMapOverAllObjectsInLocality (lqInternalDB* lq,
 }
 
 
+/* ------------------------------------------------------------------ */
+/* Does a category bit mask pass a query's include and exclude masks? */
+
+
+#define lqCategoriesMatch(categories, includeMask, excludeMask) \
+    ((((categories) & (includeMask)) != 0) &&                   \
+     (((categories) & (excludeMask)) == 0))
+
+
+/* ------------------------------------------------------------------ */
+/* Like lqTraverseBinClientObjectList but skips (without computing the
+   distance) each client object whose categories do not pass the
+   given include and exclude masks.  */
+
+
+#define lqTraverseBinClientObjectListFiltered(co, radiusSquared,         \
+                                              include, exclude,          \
+                                              func, state)               \
+    while (co != NULL)                                                \
+    {                                                                 \
+	if (lqCategoriesMatch (co->categories, include, exclude))     \
+	{                                                             \
+	    float dx = x - co->x;                                     \
+	    float dy = y - co->y;                                     \
+	    float dz = z - co->z;                                     \
+	    float distanceSquared = (dx * dx) + (dy * dy) + (dz * dz);\
+                                                                      \
+	    if (distanceSquared < radiusSquared)                      \
+	    {                                                         \
+		(*func) (co->object, distanceSquared, state);         \
+		hits++;                                               \
+	    }                                                         \
+	}                                                             \
+	co = co->next;                                                \
+    }
+
+
+/* ------------------------------------------------------------------ */
+/* Category filtered versions of lqMapOverAllObjectsInLocalityClipped
+   and lqMapOverAllOutsideObjects, used by
+   lqMapOverAllObjectsInLocalityFiltered */
+
+
+void lqMapOverAllObjectsInLocalityClippedFiltered (lqInternalDB* lq, 
+                                                   float x, float y, float z,
+                                                   float radius,
+                                                   unsigned int includeMask,
+                                                   unsigned int excludeMask,
+                                                   lqCallBackFunction func,
+                                                   void* clientQueryState,
+                                                   int minBinX,
+                                                   int minBinY, 
+                                                   int minBinZ,
+                                                   int maxBinX,
+                                                   int maxBinY,
+                                                   int maxBinZ);
+
+void lqMapOverAllObjectsInLocalityClippedFiltered (lqInternalDB* lq, 
+						   float x, float y, float z,
+						   float radius,
+						   unsigned int includeMask,
+						   unsigned int excludeMask,
+						   lqCallBackFunction func,
+						   void* clientQueryState,
+						   int minBinX,
+						   int minBinY, 
+						   int minBinZ,
+						   int maxBinX,
+						   int maxBinY,
+						   int maxBinZ)
+{
+    int i, j, k;
+    int iindex, jindex, kindex;
+    int slab = lq->divy * lq->divz;
+    int row = lq->divz;
+    int istart = minBinX * slab;
+    int jstart = minBinY * row;
+    int kstart = minBinZ;
+    lqClientProxy* co;
+    float radiusSquared = radius * radius;
+    long candidates = 0;
+    long hits = 0;
+
+    /* loop for x bins across diameter of sphere */
+    iindex = istart;
+    for (i = minBinX; i <= maxBinX; i++)
+    {
+	/* loop for y bins across diameter of sphere */
+	jindex = jstart;
+	for (j = minBinY; j <= maxBinY; j++)
+	{
+	    /* loop for z bins across diameter of sphere */
+	    kindex = kstart;
+	    for (k = minBinZ; k <= maxBinZ; k++)
+	    {
+		/* traverse current bin's client object list */
+		co = lq->bins[iindex + jindex + kindex].contents;
+		candidates += lq->bins[iindex + jindex + kindex].population;
+		lqTraverseBinClientObjectListFiltered (co,
+						       radiusSquared,
+						       includeMask,
+						       excludeMask,
+						       func,
+						       clientQueryState);
+		kindex += 1;
+	    }
+	    jindex += row;
+	}
+	iindex += slab;
+    }
+
+    /* record query statistics */
+    if (lqRecordingQueries (lq))
+    {
+	lq->queryStats.binsVisited +=
+	    (maxBinX - minBinX + 1) * (maxBinY - minBinY + 1) * (maxBinZ - minBinZ + 1);
+	lq->queryStats.candidatesTested += candidates;
+	lq->queryStats.hits += hits;
+    }
+}
+
+
+void lqMapOverAllOutsideObjectsFiltered (lqInternalDB* lq, 
+                                         float x, float y, float z,
+                                         float radius,
+                                         unsigned int includeMask,
+                                         unsigned int excludeMask,
+                                         lqCallBackFunction func,
+                                         void* clientQueryState);
+
+void lqMapOverAllOutsideObjectsFiltered (lqInternalDB* lq, 
+					 float x, float y, float z,
+					 float radius,
+					 unsigned int includeMask,
+					 unsigned int excludeMask,
+					 lqCallBackFunction func,
+					 void* clientQueryState)
+{
+    lqClientProxy* co = lq->other.contents;
+    float radiusSquared = radius * radius;
+    long hits = 0;
+
+    /* traverse the "other" bin's client object list */
+    lqTraverseBinClientObjectListFiltered (co,
+					   radiusSquared,
+					   includeMask,
+					   excludeMask,
+					   func,
+					   clientQueryState);
+
+    /* record query statistics */
+    if (lqRecordingQueries (lq))
+    {
+	lq->queryStats.binsVisited += 1;
+	lq->queryStats.candidatesTested += lq->other.population;
+	lq->queryStats.hits += hits;
+    }
+}
+
+
+/* ------------------------------------------------------------------ */
+/* Like lqMapOverAllObjectsInLocality but only applies the function to
+   objects whose category bit mask shares at least one bit with
+   includeMask and no bits with excludeMask. */
+
+
+void lqMapOverAllObjectsInLocalityFiltered (lqInternalDB* lq, 
+					    float x, float y, float z,
+					    float radius,
+					    unsigned int includeMask,
+					    unsigned int excludeMask,
+					    lqCallBackFunction func,
+					    void* clientQueryState)
+{
+    int partlyOut = 0;
+    int completelyOutside = 
+	(((x + radius) < lq->originx) ||
+	 ((y + radius) < lq->originy) ||
+	 ((z + radius) < lq->originz) ||
+	 ((x - radius) >= lq->originx + lq->sizex) ||
+	 ((y - radius) >= lq->originy + lq->sizey) ||
+	 ((z - radius) >= lq->originz + lq->sizez));
+    int minBinX, minBinY, minBinZ, maxBinX, maxBinY, maxBinZ;
+
+    /* a query which excludes every category it includes finds nothing */
+    if ((includeMask & ~excludeMask) == 0) return;
+
+    /* count this query, perhaps re-grid first (see lqSetAutoTune) */
+    lqNoteQuery (lq, radius);
+
+    /* is the sphere completely outside the "super brick"? */
+    if (completelyOutside)
+    {
+	lqMapOverAllOutsideObjectsFiltered (lq, x, y, z, radius,
+					    includeMask, excludeMask,
+					    func, clientQueryState);
+	return;
+    }
+
+    /* compute min and max bin coordinates for each dimension */
+    minBinX = (int) ((((x - radius) - lq->originx) / lq->sizex) * lq->divx);
+    minBinY = (int) ((((y - radius) - lq->originy) / lq->sizey) * lq->divy);
+    minBinZ = (int) ((((z - radius) - lq->originz) / lq->sizez) * lq->divz);
+    maxBinX = (int) ((((x + radius) - lq->originx) / lq->sizex) * lq->divx);
+    maxBinY = (int) ((((y + radius) - lq->originy) / lq->sizey) * lq->divy);
+    maxBinZ = (int) ((((z + radius) - lq->originz) / lq->sizez) * lq->divz);
+
+    /* clip bin coordinates */
+    if (minBinX < 0)         {partlyOut = 1; minBinX = 0;}
+    if (minBinY < 0)         {partlyOut = 1; minBinY = 0;}
+    if (minBinZ < 0)         {partlyOut = 1; minBinZ = 0;}
+    if (maxBinX >= lq->divx) {partlyOut = 1; maxBinX = lq->divx - 1;}
+    if (maxBinY >= lq->divy) {partlyOut = 1; maxBinY = lq->divy - 1;}
+    if (maxBinZ >= lq->divz) {partlyOut = 1; maxBinZ = lq->divz - 1;}
+
+    /* map function over outside objects if necessary (if clipped) */
+    if (partlyOut) 
+	lqMapOverAllOutsideObjectsFiltered (lq, x, y, z, radius,
+					    includeMask, excludeMask,
+					    func, clientQueryState);
+    
+    /* map function over objects in bins */
+    lqMapOverAllObjectsInLocalityClippedFiltered (lq,
+						  x, y, z,
+						  radius,
+						  includeMask,
+						  excludeMask,
+						  func,
+						  clientQueryState,
+						  minBinX, minBinY, minBinZ,
+						  maxBinX, maxBinY, maxBinZ);
+}
+
+
 /* ------------------------------------------------------------------ */
 /* internal helper function */
 
@@ -623,63 +1222,70 @@ void lqMapOverAllObjects (lqInternalDB* lq,
     int bincount = lq->divx * lq->divy * lq->divz;
     for (i=0; i<bincount; i++)
     {
-	lqMapOverAllObjectsInBin (lq->bins[i], func, clientQueryState);
+	lqMapOverAllObjectsInBin (lq->bins[i].contents, func, clientQueryState);
     }
-    lqMapOverAllObjectsInBin (lq->other, func, clientQueryState);
+    lqMapOverAllObjectsInBin (lq->other.contents, func, clientQueryState);
 }
 
 /* ------------------------------------------------------------------ */
-/* looks at all bins (except "other") finding the min and max bin
-   populations and the average of NON-EMPTY bin populations.  (The
-   average over all bins is a constant (population/bincount))  */
+/* Population statistics.  These read the counts maintained by
+   lqAddToBin and lqRemoveFromBin rather than walking the bins. */
 
-#ifndef NO_LQ_BIN_STATS
 
-void lqgbpsCounter (void* clientObject    USUSED_PARAM,
-                    float distanceSquared USUSED_PARAM,
-                    void* clientQueryState);
+int lqGetPopulation (lqInternalDB* lq)
+{
+    return lq->population;
+}
+
 
-void lqgbpsCounter (void* clientObject    USUSED_PARAM,
-                    float distanceSquared USUSED_PARAM,
-                    void* clientQueryState)
+int lqGetBinPopulation (lqClientProxy** bin)
 {
-    (*(int*)clientQueryState)++;
+    return lqBinForID (bin)->population;
 }
 
-void lqGetBinPopulationStats (lqInternalDB* lq,
-                              int* min,
-                              int* max,
-                              float* average)
+
+void lqGetPopulationStats (lqInternalDB* lq, lqPopulationStats* stats)
 {
     int minPop = INT_MAX;
-    int maxPop = 0;
-    int totalCount = 0;
-    int nonEmptyBinCount = 0;
-    int bincount = lq->divx * lq->divy * lq->divz;
-    int i;
+    int n;
 
-    for (i=0; i<bincount; i++)
+    /* smallest non-empty occupancy: scan the histogram up to max */
+    for (n = 1; n <= lq->maxBinPopulation; n++)
     {
-        /* clear the counter */
-        int objectCount = 0;
-
-        /* apply counting function to each object in bin[i] */
-	lqMapOverAllObjectsInBin (lq->bins[i], lqgbpsCounter, &objectCount);
-
-        /* collect data: max and min population, count objects and non-empty bins */
-        if (objectCount > 0)
-        {
-            nonEmptyBinCount++;
-            if (maxPop < objectCount) maxPop = objectCount;
-            if (minPop > objectCount) minPop = objectCount;
-            totalCount += objectCount;
-        }
+	if (lq->occupancy[n] > 0) {minPop = n; break;}
     }
 
+    stats->population = lq->population;
+    stats->outsidePopulation = lq->other.population;
+    stats->binCount = lq->divx * lq->divy * lq->divz;
+    stats->nonEmptyBinCount = lq->nonEmptyBinCount;
+    stats->minBinPopulation = minPop;
+    stats->maxBinPopulation = lq->maxBinPopulation;
+    stats->averageBinPopulation =
+	((float) (lq->population - lq->other.population)) /
+	((float) lq->nonEmptyBinCount);
+}
+
+
+/* ------------------------------------------------------------------ */
+/* finds the min and max bin populations and the average of NON-EMPTY
+   bin populations, excluding the "other" bin.  (The average over all
+   bins is a constant (population/bincount))  */
+
+#ifndef NO_LQ_BIN_STATS
+
+void lqGetBinPopulationStats (lqInternalDB* lq,
+                              int* min,
+                              int* max,
+                              float* average)
+{
+    lqPopulationStats stats;
+    lqGetPopulationStats (lq, &stats);
+
     /* set return values */
-    *min = minPop;
-    *max = maxPop;
-    *average = ((float) totalCount) / ((float) nonEmptyBinCount);
+    *min = stats.minBinPopulation;
+    *max = stats.maxBinPopulation;
+    *average = stats.averageBinPopulation;
 }
 
 #endif /* NO_LQ_BIN_STATS */
@@ -703,9 +1309,9 @@ void lqRemoveAllObjects (lqInternalDB* lq)
     int bincount = lq->divx * lq->divy * lq->divz;
     for (i=0; i<bincount; i++)
     {
-	lqRemoveAllObjectsInBin (lq->bins[i]);
+	lqRemoveAllObjectsInBin (lq->bins[i].contents);
     }
-    lqRemoveAllObjectsInBin (lq->other);
+    lqRemoveAllObjectsInBin (lq->other.contents);
 }
 
 
@@ -38,13 +38,26 @@
 
 #include "OpenSteer/OpenSteerDemo.h"        // OpenSteerDemo application
 #include "OpenSteer/Draw.h"                 // OpenSteerDemo graphics
+#include "TerrainRayTest.h"                 // RayTester::CompileData
 
 // To include EXIT_SUCCESS
 #include <cstdlib>
 
+// To include std::strcmp
+#include <cstring>
+
 
 int main (int argc, char **argv) 
 {
+    // "--batch <PlugIn name> [arguments]" runs a PlugIn without graphics
+    if ((argc > 2) && (std::strcmp (argv[1], "--batch") == 0))
+        return OpenSteer::OpenSteerDemo::runBatch (argv[2], argc - 3, argv + 3);
+
+    // "--compile-terrain <terrain.data> <compiled file>" converts a terrain
+    // for RayTester::LoadCompiled
+    if ((argc > 3) && (std::strcmp (argv[1], "--compile-terrain") == 0))
+        return RayTester::CompileData (argv[2], argv[3]) ? EXIT_SUCCESS : EXIT_FAILURE;
+
     // initialize OpenSteerDemo application
     OpenSteer::OpenSteerDemo::initialize ();
 
@@ -0,0 +1,326 @@
+/**
+ * OpenSteer -- Steering Behaviors for Autonomous Characters
+ *
+ * Copyright (c) 2002-2005, Sony Computer Entertainment America
+ * Original author: Craig Reynolds <craig_reynolds@playstation.sony.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+#include "CatmullRomSegmentedPathwayTest.h"
+
+
+// Include std::copy
+#include <algorithm>
+
+
+// Include OpenSteer::distance
+#include "OpenSteer/Vec3Utilities.h"
+
+
+
+// Register test suite.
+CPPUNIT_TEST_SUITE_REGISTRATION( OpenSteer::CatmullRomSegmentedPathwayTest );
+
+
+namespace {
+    
+    /**
+     * Absolute tolerance for distances and positions compared in the tests.
+     */
+    float const tolerance = 0.001f;
+    
+    
+    /**
+     * Returns @c true if @a lhs and @a rhs are nearer than @c tolerance.
+     */
+    bool near( OpenSteer::Vec3 const& lhs, OpenSteer::Vec3 const& rhs ) {
+        return OpenSteer::distance( lhs, rhs ) < tolerance;
+    }
+    
+    
+    /**
+     * Returns @c true if both pathways have the same segment lengths and 
+     * segment points.
+     */
+    bool sameShape( OpenSteer::CatmullRomSegmentedPathway const& lhs, 
+                    OpenSteer::CatmullRomSegmentedPathway const& rhs ) {
+        
+        if ( lhs.segmentCount() != rhs.segmentCount() ) {
+            return false;
+        }
+        
+        for ( OpenSteer::size_t i = 0; i < lhs.segmentCount(); ++i ) {
+            if ( lhs.segmentLength( i ) != rhs.segmentLength( i ) ) {
+                return false;
+            }
+            
+            for ( int j = 0; j <= 8; ++j ) {
+                float const segmentDistance = 0.125f * static_cast< float >( j ) * lhs.segmentLength( i );
+                if ( lhs.mapSegmentDistanceToPoint( i, segmentDistance ) != rhs.mapSegmentDistanceToPoint( i, segmentDistance ) ) {
+                    return false;
+                }
+            }
+        }
+        
+        return lhs.length() == rhs.length();
+    }
+    
+} // anonymous namespace
+
+
+
+OpenSteer::size_t const OpenSteer::CatmullRomSegmentedPathwayTest::pointCount_;
+OpenSteer::Vec3 const OpenSteer::CatmullRomSegmentedPathwayTest::points_[ OpenSteer::CatmullRomSegmentedPathwayTest::pointCount_ ] = {  
+    OpenSteer::Vec3( 0.0f, 0.0f, 0.0f ),
+    OpenSteer::Vec3( 4.0f, 0.0f, 0.0f ),
+    OpenSteer::Vec3( 6.0f, 0.0f, 3.0f ),
+    OpenSteer::Vec3( 4.0f, 0.0f, 6.0f ),
+    OpenSteer::Vec3( 0.0f, 0.0f, 6.0f ) };
+float const OpenSteer::CatmullRomSegmentedPathwayTest::radii_[ OpenSteer::CatmullRomSegmentedPathwayTest::pointCount_ ] = {
+    1.0f, 2.0f, 1.0f, 3.0f, 1.0f };
+
+
+
+OpenSteer::CatmullRomSegmentedPathwayTest::CatmullRomSegmentedPathwayTest()
+{
+    // Nothing to do.
+}
+
+
+
+OpenSteer::CatmullRomSegmentedPathwayTest::~CatmullRomSegmentedPathwayTest()
+{
+    // Nothing to do.
+}
+
+
+
+
+void 
+OpenSteer::CatmullRomSegmentedPathwayTest::setUp()
+{
+    TestFixture::setUp();
+    
+    path_.reset( new CatmullRomSegmentedPathway( pointCount_, points_, radii_, false ) );
+    cyclicPath_.reset( new CatmullRomSegmentedPathway( pointCount_, points_, radii_, true ) );
+}
+
+
+
+void 
+OpenSteer::CatmullRomSegmentedPathwayTest::tearDown()
+{
+    TestFixture::tearDown();
+    
+    path_.reset();
+    cyclicPath_.reset();
+}
+
+
+
+void
+OpenSteer::CatmullRomSegmentedPathwayTest::testConstruction()
+{
+    CPPUNIT_ASSERT( ! CatmullRomSegmentedPathway().isValid() );
+    
+    CPPUNIT_ASSERT( path_->isValid() );
+    CPPUNIT_ASSERT( ! path_->isCyclic() );
+    CPPUNIT_ASSERT_EQUAL( pointCount_, path_->pointCount() );
+    CPPUNIT_ASSERT_EQUAL( pointCount_ - 1, path_->segmentCount() );
+    
+    CPPUNIT_ASSERT( cyclicPath_->isCyclic() );
+    CPPUNIT_ASSERT_EQUAL( pointCount_ + 1, cyclicPath_->pointCount() );
+    CPPUNIT_ASSERT_EQUAL( pointCount_, cyclicPath_->segmentCount() );
+    CPPUNIT_ASSERT_EQUAL( cyclicPath_->point( 0 ), cyclicPath_->point( pointCount_ ) );
+    
+    // The curve runs through all points and is longer than the polyline
+    // through them.
+    float lengthSum = 0.0f;
+    float polylineLength = 0.0f;
+    for ( size_t i = 0; i < path_->segmentCount(); ++i ) {
+        CPPUNIT_ASSERT_EQUAL( points_[ i ], path_->segmentStart( i ) );
+        CPPUNIT_ASSERT_EQUAL( points_[ i + 1 ], path_->segmentEnd( i ) );
+        CPPUNIT_ASSERT( near( points_[ i ], path_->mapSegmentDistanceToPoint( i, 0.0f ) ) );
+        CPPUNIT_ASSERT( near( points_[ i + 1 ], path_->mapSegmentDistanceToPoint( i, path_->segmentLength( i ) ) ) );
+        
+        lengthSum += path_->segmentLength( i );
+        polylineLength += distance( points_[ i ], points_[ i + 1 ] );
+    }
+    CPPUNIT_ASSERT_DOUBLES_EQUAL( lengthSum, path_->length(), tolerance );
+    CPPUNIT_ASSERT( polylineLength < path_->length() );
+    
+    CatmullRomSegmentedPathway copy( *cyclicPath_ );
+    CPPUNIT_ASSERT( sameShape( copy, *cyclicPath_ ) );
+    copy = *path_;
+    CPPUNIT_ASSERT( sameShape( copy, *path_ ) );
+}
+
+
+
+void
+OpenSteer::CatmullRomSegmentedPathwayTest::testStraightPathway()
+{
+    Vec3 const points[] = { Vec3( 0.0f, 0.0f, 0.0f ), 
+                            Vec3( 1.0f, 0.0f, 0.0f ), 
+                            Vec3( 2.0f, 0.0f, 0.0f ), 
+                            Vec3( 3.0f, 0.0f, 0.0f ) };
+    float const radii[] = { 1.0f, 1.0f, 1.0f, 1.0f };
+    CatmullRomSegmentedPathway const path( 4, points, radii, false );
+    
+    CPPUNIT_ASSERT_DOUBLES_EQUAL( 3.0f, path.length(), tolerance );
+    CPPUNIT_ASSERT( near( Vec3( 1.5f, 0.0f, 0.0f ), path.mapPathDistanceToPoint( 1.5f ) ) );
+    
+    Vec3 tangent( 0.0f, 0.0f, 0.0f );
+    float outside = 0.0f;
+    Vec3 const pointOnPath = path.mapPointToPath( Vec3( 2.25f, 3.0f, 0.0f ), tangent, outside );
+    CPPUNIT_ASSERT( near( Vec3( 2.25f, 0.0f, 0.0f ), pointOnPath ) );
+    CPPUNIT_ASSERT( near( Vec3( 1.0f, 0.0f, 0.0f ), tangent ) );
+    CPPUNIT_ASSERT_DOUBLES_EQUAL( 2.0f, outside, tolerance );
+}
+
+
+
+void
+OpenSteer::CatmullRomSegmentedPathwayTest::testArcLengths()
+{
+    // Points at equal distances along a segment are equally far apart if the
+    // arc length lookup is exact.
+    int const steps = 64;
+    for ( size_t i = 0; i < path_->segmentCount(); ++i ) {
+        float const step = path_->segmentLength( i ) / static_cast< float >( steps );
+        Vec3 previous = path_->mapSegmentDistanceToPoint( i, 0.0f );
+        for ( int j = 1; j <= steps; ++j ) {
+            float const segmentDistance = static_cast< float >( j ) * step;
+            Vec3 const current = path_->mapSegmentDistanceToPoint( i, segmentDistance );
+            CPPUNIT_ASSERT_DOUBLES_EQUAL( step, distance( previous, current ), 0.01f * step );
+            previous = current;
+            
+            float const parameter = path_->mapSegmentDistanceToParameter( i, segmentDistance );
+            CPPUNIT_ASSERT_DOUBLES_EQUAL( segmentDistance, path_->mapParameterToSegmentDistance( i, parameter ), tolerance );
+        }
+    }
+}
+
+
+
+void
+OpenSteer::CatmullRomSegmentedPathwayTest::testPointToPathMappings()
+{
+    // Points offset sideways from the center line map back to the center 
+    // line point they are offset from. Path queries prefer the segment with
+    // the nearest boundary, so a single radius is used to get the nearest 
+    // center line point.
+    float const radii[ pointCount_ ] = { 1.0f, 1.0f, 1.0f, 1.0f, 1.0f };
+    CatmullRomSegmentedPathway const path( pointCount_, points_, radii, true );
+    float const sideOffset = 0.5f;
+    for ( int i = 0; i <= 40; ++i ) {
+        float const pathDistance = 0.025f * static_cast< float >( i ) * path.length();
+        Vec3 const pointOnPath = path.mapPathDistanceToPoint( pathDistance );
+        
+        Vec3 tangent( 0.0f, 0.0f, 0.0f );
+        float outside = 0.0f;
+        path.mapPointToPath( pointOnPath, tangent, outside );
+        CPPUNIT_ASSERT_DOUBLES_EQUAL( -1.0f, outside, tolerance );
+        Vec3 const side( tangent.z, 0.0f, -tangent.x );
+        Vec3 const point = pointOnPath + sideOffset * side;
+        
+        Vec3 const mappedPoint = path.mapPointToPath( point, tangent, outside );
+        CPPUNIT_ASSERT( near( pointOnPath, mappedPoint ) );
+        CPPUNIT_ASSERT_DOUBLES_EQUAL( 0.0f, tangent.dot( side ), tolerance );
+        CPPUNIT_ASSERT_DOUBLES_EQUAL( sideOffset - 1.0f, outside, tolerance );
+        
+        float const mappedDistance = path.mapPointToPathDistance( point );
+        CPPUNIT_ASSERT( near( pointOnPath, path.mapPathDistanceToPoint( mappedDistance ) ) );
+    }
+}
+
+
+
+void
+OpenSteer::CatmullRomSegmentedPathwayTest::testDistanceToPathMappings()
+{
+    float segmentStartDistance = 0.0f;
+    for ( size_t i = 0; i < path_->segmentCount(); ++i ) {
+        CPPUNIT_ASSERT( near( points_[ i ], path_->mapPathDistanceToPoint( segmentStartDistance ) ) );
+        segmentStartDistance += path_->segmentLength( i );
+    }
+    
+    CPPUNIT_ASSERT( near( points_[ 0 ], path_->mapPathDistanceToPoint( -1.0f ) ) );
+    CPPUNIT_ASSERT( near( points_[ pointCount_ - 1 ], path_->mapPathDistanceToPoint( path_->length() + 1.0f ) ) );
+    
+    float const cyclicLength = cyclicPath_->length();
+    CPPUNIT_ASSERT( near( cyclicPath_->mapPathDistanceToPoint( 1.0f ), cyclicPath_->mapPathDistanceToPoint( cyclicLength + 1.0f ) ) );
+}
+
+
+
+void
+OpenSteer::CatmullRomSegmentedPathwayTest::testRadii()
+{
+    for ( size_t i = 0; i < path_->segmentCount(); ++i ) {
+        float const segmentLength = path_->segmentLength( i );
+        CPPUNIT_ASSERT_EQUAL( radii_[ i ], path_->pointRadius( i ) );
+        CPPUNIT_ASSERT_DOUBLES_EQUAL( radii_[ i ], path_->mapSegmentDistanceToRadius( i, 0.0f ), tolerance );
+        CPPUNIT_ASSERT_DOUBLES_EQUAL( 0.5f * ( radii_[ i ] + radii_[ i + 1 ] ), path_->mapSegmentDistanceToRadius( i, 0.5f * segmentLength ), tolerance );
+        CPPUNIT_ASSERT_DOUBLES_EQUAL( radii_[ i + 1 ], path_->mapSegmentDistanceToRadius( i, segmentLength ), tolerance );
+    }
+    
+    // The radius of the first point of a cyclic pathway is also the radius 
+    // at the end of the last segment.
+    cyclicPath_->setPointRadius( 0, 5.0f );
+    size_t const lastSegmentIndex = cyclicPath_->segmentCount() - 1;
+    CPPUNIT_ASSERT_DOUBLES_EQUAL( 5.0f, cyclicPath_->mapSegmentDistanceToRadius( lastSegmentIndex, cyclicPath_->segmentLength( lastSegmentIndex ) ), tolerance );
+}
+
+
+
+void
+OpenSteer::CatmullRomSegmentedPathwayTest::testMovePoints()
+{
+    Vec3 points[ pointCount_ ];
+    std::copy( points_, points_ + pointCount_, points );
+    points[ 2 ] = Vec3( 7.0f, 0.0f, 2.0f );
+    points[ 3 ] = Vec3( 5.0f, 0.0f, 7.0f );
+    
+    path_->movePoints( 2, 2, points + 2 );
+    CPPUNIT_ASSERT( sameShape( CatmullRomSegmentedPathway( pointCount_, points, radii_, false ), *path_ ) );
+    
+    points[ 0 ] = Vec3( -1.0f, 0.0f, 1.0f );
+    path_->movePoints( 0, 1, points );
+    CPPUNIT_ASSERT( sameShape( CatmullRomSegmentedPathway( pointCount_, points, radii_, false ), *path_ ) );
+}
+
+
+
+void
+OpenSteer::CatmullRomSegmentedPathwayTest::testMovePointsCyclicPath()
+{
+    Vec3 points[ pointCount_ ];
+    std::copy( points_, points_ + pointCount_, points );
+    
+    // Moving the first point reshapes the segments at the end of the cycle.
+    points[ 0 ] = Vec3( -1.0f, 0.0f, 2.0f );
+    cyclicPath_->movePoints( 0, 1, points );
+    CPPUNIT_ASSERT_EQUAL( points[ 0 ], cyclicPath_->point( pointCount_ ) );
+    CPPUNIT_ASSERT( sameShape( CatmullRomSegmentedPathway( pointCount_, points, radii_, true ), *cyclicPath_ ) );
+    
+    points[ 4 ] = Vec3( 1.0f, 0.0f, 7.0f );
+    cyclicPath_->movePoints( 4, 1, points + 4 );
+    CPPUNIT_ASSERT( sameShape( CatmullRomSegmentedPathway( pointCount_, points, radii_, true ), *cyclicPath_ ) );
+}
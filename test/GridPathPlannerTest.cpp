@@ -0,0 +1,297 @@
+/**
+ * OpenSteer -- Steering Behaviors for Autonomous Characters
+ *
+ * Copyright (c) 2002-2005, Sony Computer Entertainment America
+ * Original author: Craig Reynolds <craig_reynolds@playstation.sony.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ *
+ * @file
+ *
+ * Unit test for @c OpenSteer::GridPathPlanner.
+ */
+#include "GridPathPlannerTest.h"
+
+
+// Include std::vector
+#include <vector>
+
+
+// Include OpenSteer::Vec3
+#include "OpenSteer/Vec3.h"
+
+// Include OpenSteer::GridTestRandom, OpenSteer::flatRouteCost, OpenSteer::routeLength, OpenSteer::routeAvoidsBlockedCells
+#include "GridPlannerTestUtilities.h"
+
+
+
+// Register test suite.
+CPPUNIT_TEST_SUITE_REGISTRATION( OpenSteer::GridPathPlannerTest );
+
+
+namespace {
+
+    using namespace OpenSteer;
+    
+    /**
+     * Blocks each cell of @a planner with probability @a density and marks
+     * it in @a blocked.
+     */
+    void blockRandomCells( GridPathPlanner& planner, 
+                           float density, 
+                           GridTestRandom& random, 
+                           std::vector< char >& blocked ) {
+        int const cellCountX = planner.cellCountX();
+        blocked.assign( cellCountX * planner.cellCountZ(), 0 );
+        for ( int cell = 0; cell < static_cast< int >( blocked.size() ); ++cell ) {
+            if ( random() < density ) {
+                blocked[ cell ] = 1;
+                planner.setBlocked( cell % cellCountX, cell / cellCountX, true );
+            }
+        }
+    }
+    
+    
+    /**
+     * Returns a random position inside of @a cell of @a planner.
+     */
+    Vec3 randomPointInCell( GridPathPlanner const& planner, int cell, GridTestRandom& random ) {
+        int const cellCountX = planner.cellCountX();
+        return planner.cellCenter( cell % cellCountX, cell / cellCountX ) + 
+               Vec3( random() - 0.5f, 0.0f, random() - 0.5f ) * planner.cellSize();
+    }
+    
+    
+    /**
+     * Plans a route between random points of @a planner and checks that one
+     * is found exactly if the flat search over @a blocked finds one, that it 
+     * runs from start to goal and is no longer than the flat grid route.
+     * Returns @c true and stores the route in @a route if one was found.
+     */
+    bool checkRandomRoute( GridPathPlanner& planner, 
+                           std::vector< char > const& blocked, 
+                           GridTestRandom& random, 
+                           GridPathPlanner::Route& route ) {
+        int const cellCount = static_cast< int >( blocked.size() );
+        int const startCell = random( cellCount );
+        int const goalCell = random( cellCount );
+        Vec3 const start = randomPointInCell( planner, startCell, random );
+        Vec3 const goal = randomPointInCell( planner, goalCell, random );
+        
+        int const flatCost = flatRouteCost( blocked, planner.cellCountX(), planner.cellCountZ(), startCell, goalCell );
+        bool const found = planner.findRoute( start, goal, route );
+        CPPUNIT_ASSERT_EQUAL( 0 <= flatCost, found );
+        if ( ! found ) {
+            return false;
+        }
+        
+        CPPUNIT_ASSERT( 2 <= route.points.size() );
+        CPPUNIT_ASSERT_EQUAL( route.points.size() - 1, route.radii.size() );
+        CPPUNIT_ASSERT( start == route.points.front() );
+        CPPUNIT_ASSERT( goal == route.points.back() );
+        
+        // Diagonal moves cost 14 but are 10 * sqrt( 2 ) long, start and goal
+        // lie up to half a cell diagonal from their cell centers. Shortening
+        // the grid route to waypoints in line of sight never lengthens it.
+        float const flatLength = 0.10102f * static_cast< float >( flatCost ) * planner.cellSize();
+        float const endOffsets = 1.4143f * planner.cellSize();
+        float const length = routeLength( route.points );
+        CPPUNIT_ASSERT( length <= flatLength + endOffsets );
+        CPPUNIT_ASSERT( ( goal - start ).length() <= length + 0.001f );
+        
+        return true;
+    }
+
+} // anonymous namespace
+
+
+
+int const OpenSteer::GridPathPlannerTest::cellCount_;
+
+
+
+OpenSteer::GridPathPlannerTest::GridPathPlannerTest()
+{
+    // Nothing to do.
+}
+
+
+
+OpenSteer::GridPathPlannerTest::~GridPathPlannerTest()
+{
+    // Nothing to do.
+}
+
+
+
+
+void 
+OpenSteer::GridPathPlannerTest::setUp()
+{
+    TestFixture::setUp();
+    
+    planner_.reset( new GridPathPlanner( cellCount_, cellCount_, Vec3( 0.0f, 0.0f, 0.0f ), 1.0f ) );
+}
+
+
+
+void 
+OpenSteer::GridPathPlannerTest::tearDown()
+{
+    TestFixture::tearDown();
+}
+
+
+
+void 
+OpenSteer::GridPathPlannerTest::testRoutesMatchDijkstra()
+{
+    GridTestRandom random( 7 );
+    for ( int grid = 0; grid < 60; ++grid ) {
+        int const cellCountX = 4 + random( 13 );
+        int const cellCountZ = 4 + random( 13 );
+        Vec3 const origin( 10.0f * random() - 5.0f, random(), 10.0f * random() - 5.0f );
+        GridPathPlanner planner( cellCountX, cellCountZ, origin, 0.5f + random() );
+        
+        std::vector< char > blocked;
+        blockRandomCells( planner, 0.3f, random, blocked );
+        
+        for ( int query = 0; query < 20; ++query ) {
+            GridPathPlanner::Route route;
+            checkRandomRoute( planner, blocked, random, route );
+        }
+    }
+}
+
+
+
+void 
+OpenSteer::GridPathPlannerTest::testRoutesAvoidBlockedCells()
+{
+    GridTestRandom random( 13 );
+    for ( int grid = 0; grid < 40; ++grid ) {
+        GridPathPlanner planner( cellCount_, cellCount_, Vec3( 0.0f, 0.0f, 0.0f ), 0.5f + random() );
+        
+        std::vector< char > blocked;
+        blockRandomCells( planner, 0.2f + 0.2f * random(), random, blocked );
+        
+        for ( int query = 0; query < 20; ++query ) {
+            GridPathPlanner::Route route;
+            if ( checkRandomRoute( planner, blocked, random, route ) ) {
+                CPPUNIT_ASSERT( routeAvoidsBlockedCells( planner, route.points ) );
+            }
+        }
+    }
+}
+
+
+
+void 
+OpenSteer::GridPathPlannerTest::testReplanAfterSetBlocked()
+{
+    GridTestRandom random( 17 );
+    std::vector< char > blocked;
+    blockRandomCells( *planner_, 0.3f, random, blocked );
+    
+    // Few goals keep the searches alive so they get repaired instead of 
+    // replaced.
+    int const cellCount = cellCount_ * cellCount_;
+    for ( int round = 0; round < 50; ++round ) {
+        for ( int edit = 0; edit < 5; ++edit ) {
+            int const cell = random( cellCount );
+            blocked[ cell ] = ( 0 == blocked[ cell ] ) ? 1 : 0;
+            planner_->setBlocked( cell % cellCount_, cell / cellCount_, 0 != blocked[ cell ] );
+        }
+        
+        for ( int query = 0; query < 20; ++query ) {
+            GridPathPlanner::Route route;
+            if ( checkRandomRoute( *planner_, blocked, random, route ) ) {
+                CPPUNIT_ASSERT( routeAvoidsBlockedCells( *planner_, route.points ) );
+            }
+        }
+    }
+    
+    CPPUNIT_ASSERT( 0 < planner_->statistics().repairedCells );
+}
+
+
+
+void 
+OpenSteer::GridPathPlannerTest::testCacheInvalidation()
+{
+    Vec3 const start( 0.5f, 0.0f, 0.5f );
+    Vec3 const goal( 15.5f, 0.0f, 0.5f );
+    GridPathPlanner::Route route;
+    
+    CPPUNIT_ASSERT( planner_->findRoute( start, goal, route ) );
+    CPPUNIT_ASSERT_EQUAL( GridPathPlanner::size_type( 1 ), planner_->statistics().searches );
+    CPPUNIT_ASSERT_EQUAL( GridPathPlanner::size_type( 0 ), planner_->statistics().cacheHits );
+    
+    // Other points in the same cells are answered from the cache.
+    Vec3 const nearStart = start + Vec3( 0.2f, 0.0f, 0.1f );
+    CPPUNIT_ASSERT( planner_->findRoute( nearStart, goal, route ) );
+    CPPUNIT_ASSERT_EQUAL( GridPathPlanner::size_type( 1 ), planner_->statistics().searches );
+    CPPUNIT_ASSERT_EQUAL( GridPathPlanner::size_type( 1 ), planner_->statistics().cacheHits );
+    CPPUNIT_ASSERT( nearStart == route.points.front() );
+    CPPUNIT_ASSERT_DOUBLES_EQUAL( ( goal - nearStart ).length(), routeLength( route.points ), 0.001f );
+    
+    // Setting a cell to its current state keeps the cache.
+    planner_->setBlocked( 8, 8, false );
+    CPPUNIT_ASSERT( planner_->findRoute( start, goal, route ) );
+    CPPUNIT_ASSERT_EQUAL( GridPathPlanner::size_type( 1 ), planner_->statistics().searches );
+    CPPUNIT_ASSERT_EQUAL( GridPathPlanner::size_type( 2 ), planner_->statistics().cacheHits );
+    
+    // Blocking a cell on the route bumps the revision, the route is planned
+    // again around the cell.
+    planner_->setBlocked( 8, 0, true );
+    CPPUNIT_ASSERT( planner_->findRoute( start, goal, route ) );
+    CPPUNIT_ASSERT_EQUAL( GridPathPlanner::size_type( 2 ), planner_->statistics().searches );
+    CPPUNIT_ASSERT_EQUAL( GridPathPlanner::size_type( 2 ), planner_->statistics().cacheHits );
+    CPPUNIT_ASSERT( routeAvoidsBlockedCells( *planner_, route.points ) );
+    CPPUNIT_ASSERT( 15.0f < routeLength( route.points ) );
+    
+    // So does a change far away from the route.
+    planner_->setBlocked( 8, 15, true );
+    CPPUNIT_ASSERT( planner_->findRoute( start, goal, route ) );
+    CPPUNIT_ASSERT_EQUAL( GridPathPlanner::size_type( 3 ), planner_->statistics().searches );
+    
+    // Unreachable goals are cached, too.
+    for ( int j = 0; j < cellCount_; ++j ) {
+        planner_->setBlocked( 8, j, true );
+    }
+    CPPUNIT_ASSERT( ! planner_->findRoute( start, goal, route ) );
+    CPPUNIT_ASSERT( ! planner_->findRoute( start, goal, route ) );
+    CPPUNIT_ASSERT_EQUAL( GridPathPlanner::size_type( 4 ), planner_->statistics().searches );
+    CPPUNIT_ASSERT_EQUAL( GridPathPlanner::size_type( 3 ), planner_->statistics().cacheHits );
+    
+    // Changing the radius range and clearing drop the cached routes.
+    planner_->setBlocked( 8, 0, false );
+    CPPUNIT_ASSERT( planner_->findRoute( start, goal, route ) );
+    planner_->setRouteRadiusRange( 0.1f, 2.0f );
+    CPPUNIT_ASSERT( planner_->findRoute( start, goal, route ) );
+    planner_->clearCache();
+    CPPUNIT_ASSERT( planner_->findRoute( start, goal, route ) );
+    CPPUNIT_ASSERT_EQUAL( GridPathPlanner::size_type( 7 ), planner_->statistics().searches );
+    CPPUNIT_ASSERT_EQUAL( GridPathPlanner::size_type( 3 ), planner_->statistics().cacheHits );
+    
+    planner_->resetStatistics();
+    CPPUNIT_ASSERT_EQUAL( GridPathPlanner::size_type( 0 ), planner_->statistics().searches );
+    CPPUNIT_ASSERT_EQUAL( GridPathPlanner::size_type( 0 ), planner_->statistics().cacheHits );
+}
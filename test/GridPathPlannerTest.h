@@ -0,0 +1,92 @@
+/**
+ * OpenSteer -- Steering Behaviors for Autonomous Characters
+ *
+ * Copyright (c) 2002-2005, Sony Computer Entertainment America
+ * Original author: Craig Reynolds <craig_reynolds@playstation.sony.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ *
+ * @file
+ *
+ * Unit test for @c OpenSteer::GridPathPlanner.
+ */
+
+#ifndef OPENSTEER_GRIDPATHPLANNERTEST_H
+#define OPENSTEER_GRIDPATHPLANNERTEST_H
+
+// Include std::auto_ptr
+#include <memory>
+
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <cppunit/TestFixture.h>
+
+
+
+// Include OpenSteer::GridPathPlanner
+#include "OpenSteer/GridPathPlanner.h"
+
+
+namespace OpenSteer {
+
+
+    class GridPathPlannerTest : public CppUnit::TestFixture {
+    public:
+        GridPathPlannerTest();
+        virtual ~GridPathPlannerTest();
+        
+        virtual void setUp();
+        virtual void tearDown();
+        
+        CPPUNIT_TEST_SUITE(GridPathPlannerTest);
+        CPPUNIT_TEST(testRoutesMatchDijkstra);
+        CPPUNIT_TEST(testRoutesAvoidBlockedCells);
+        CPPUNIT_TEST(testReplanAfterSetBlocked);
+        CPPUNIT_TEST(testCacheInvalidation);
+        CPPUNIT_TEST_SUITE_END();
+    
+    private:
+        /**
+         * Not implemented to make it non-copyable.
+         */
+        GridPathPlannerTest( GridPathPlannerTest const& );
+        
+        /**
+         * Not implemented to make it non-copyable.
+         */
+        GridPathPlannerTest& operator=( GridPathPlannerTest );
+    
+    private:
+        void testRoutesMatchDijkstra();
+        void testRoutesAvoidBlockedCells();
+        void testReplanAfterSetBlocked();
+        void testCacheInvalidation();
+        
+        
+        // Free grid of @c cellCount_ times @c cellCount_ unit cells.
+        std::auto_ptr< GridPathPlanner > planner_;
+        static int const cellCount_ = 16;
+    
+    }; // GridPathPlannerTest
+
+
+} // namespace OpenSteer
+
+#endif // OPENSTEER_GRIDPATHPLANNERTEST_H
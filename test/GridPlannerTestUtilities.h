@@ -0,0 +1,187 @@
+/**
+ * OpenSteer -- Steering Behaviors for Autonomous Characters
+ *
+ * Copyright (c) 2002-2005, Sony Computer Entertainment America
+ * Original author: Craig Reynolds <craig_reynolds@playstation.sony.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ *
+ * @file
+ *
+ * Reference search and route checks shared by the unit tests of the grid
+ * route planners.
+ */
+
+#ifndef OPENSTEER_GRIDPLANNERTESTUTILITIES_H
+#define OPENSTEER_GRIDPLANNERTESTUTILITIES_H
+
+// Include std::vector
+#include <vector>
+
+// Include std::priority_queue
+#include <queue>
+
+// Include std::greater
+#include <functional>
+
+// Include std::pair
+#include <utility>
+
+// Include std::sqrt
+#include <cmath>
+
+
+
+// Include OpenSteer::Vec3
+#include "OpenSteer/Vec3.h"
+
+// Include OpenSteer::size_t
+#include "OpenSteer/StandardTypes.h"
+
+
+namespace OpenSteer {
+
+
+    /**
+     * Deterministic random numbers in [0, 1).
+     */
+    class GridTestRandom {
+    public:
+        explicit GridTestRandom( unsigned long seed ) : state_( seed ) {}
+        
+        float operator()() {
+            state_ = ( state_ * 1103515245UL + 12345UL ) & 0x7fffffffUL;
+            return static_cast< float >( state_ ) / 2147483648.0f;
+        }
+        
+        /**
+         * Returns a random integer in [0, @a count).
+         */
+        int operator()( int count ) {
+            return static_cast< int >( ( *this )() * static_cast< float >( count ) ) % count;
+        }
+    
+    private:
+        unsigned long state_;
+    };
+    
+    
+    /**
+     * Returns the cost of the cheapest move sequence from cell @a start to
+     * cell @a goal of a grid of @a cellCountX times @a cellCountZ cells,
+     * or @c -1 if there is none. Plain Dijkstra over the eight connected
+     * grid with the planners' rules: straight moves cost @c 10, diagonal
+     * ones @c 14 and mustn't cut the corner of a blocked cell.
+     */
+    inline int flatRouteCost( std::vector< char > const& blocked, int cellCountX, int cellCountZ, int start, int goal ) {
+        if ( ( 0 != blocked[ start ] ) || ( 0 != blocked[ goal ] ) ) {
+            return -1;
+        }
+        
+        typedef std::pair< int, int > Entry;
+        std::priority_queue< Entry, std::vector< Entry >, std::greater< Entry > > queue;
+        std::vector< int > costs( blocked.size(), -1 );
+        costs[ start ] = 0;
+        queue.push( Entry( 0, start ) );
+        while ( ! queue.empty() ) {
+            Entry const entry = queue.top();
+            queue.pop();
+            int const cell = entry.second;
+            if ( entry.first != costs[ cell ] ) {
+                continue;
+            }
+            if ( cell == goal ) {
+                return entry.first;
+            }
+            
+            int const i = cell % cellCountX;
+            int const j = cell / cellCountX;
+            for ( int dz = -1; dz <= 1; ++dz ) {
+                for ( int dx = -1; dx <= 1; ++dx ) {
+                    int const ni = i + dx;
+                    int const nj = j + dz;
+                    if ( ( ( 0 == dx ) && ( 0 == dz ) ) ||
+                         ( ni < 0 ) || ( nj < 0 ) || ( cellCountX <= ni ) || ( cellCountZ <= nj ) ||
+                         ( 0 != blocked[ ni + nj * cellCountX ] ) ) {
+                        continue;
+                    }
+                    
+                    bool const diagonal = ( 0 != dx ) && ( 0 != dz );
+                    if ( diagonal && ( ( 0 != blocked[ ni + j * cellCountX ] ) || ( 0 != blocked[ i + nj * cellCountX ] ) ) ) {
+                        continue;
+                    }
+                    
+                    int const cost = entry.first + ( diagonal ? 14 : 10 );
+                    int const neighbor = ni + nj * cellCountX;
+                    if ( ( costs[ neighbor ] < 0 ) || ( cost < costs[ neighbor ] ) ) {
+                        costs[ neighbor ] = cost;
+                        queue.push( Entry( cost, neighbor ) );
+                    }
+                }
+            }
+        }
+        
+        return -1;
+    }
+    
+    
+    /**
+     * Returns the length of the polyline through @a points.
+     */
+    inline float routeLength( std::vector< Vec3 > const& points ) {
+        float length = 0.0f;
+        for ( size_t k = 1; k < points.size(); ++k ) {
+            length += ( points[ k ] - points[ k - 1 ] ).length();
+        }
+        return length;
+    }
+    
+    
+    /**
+     * Returns @c true if points sampled densely along the polyline through
+     * @a points all lie in free cells of @a planner.
+     *
+     * @c Planner must provide <code>float cellSize() const</code>,
+     * <code>bool cellContaining( Vec3 const&, int&, int& ) const</code> and
+     * <code>bool isBlocked( int, int ) const</code>.
+     */
+    template< typename Planner >
+    bool routeAvoidsBlockedCells( Planner const& planner, std::vector< Vec3 > const& points ) {
+        float const step = 0.0625f * planner.cellSize();
+        for ( size_t k = 1; k < points.size(); ++k ) {
+            Vec3 const segment = points[ k ] - points[ k - 1 ];
+            int const samples = static_cast< int >( std::ceil( segment.length() / step ) );
+            for ( int s = 0; s <= samples; ++s ) {
+                float const t = ( 0 < samples ) ? static_cast< float >( s ) / static_cast< float >( samples ) : 0.0f;
+                int i = 0;
+                int j = 0;
+                if ( ! planner.cellContaining( points[ k - 1 ] + segment * t, i, j ) || planner.isBlocked( i, j ) ) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+
+} // namespace OpenSteer
+
+
+#endif // OPENSTEER_GRIDPLANNERTESTUTILITIES_H
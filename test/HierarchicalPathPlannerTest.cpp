@@ -0,0 +1,262 @@
+/**
+ * OpenSteer -- Steering Behaviors for Autonomous Characters
+ *
+ * Copyright (c) 2002-2005, Sony Computer Entertainment America
+ * Original author: Craig Reynolds <craig_reynolds@playstation.sony.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ *
+ * @file
+ *
+ * Unit test for @c OpenSteer::HierarchicalPathPlanner.
+ */
+#include "HierarchicalPathPlannerTest.h"
+
+
+// Include std::vector
+#include <vector>
+
+
+// Include OpenSteer::PolylineSegmentedPathwaySegmentRadii
+#include "OpenSteer/PolylineSegmentedPathwaySegmentRadii.h"
+
+// Include OpenSteer::Vec3
+#include "OpenSteer/Vec3.h"
+
+// Include OpenSteer::GridTestRandom, OpenSteer::flatRouteCost, OpenSteer::routeLength, OpenSteer::routeAvoidsBlockedCells
+#include "GridPlannerTestUtilities.h"
+
+
+
+// Register test suite.
+CPPUNIT_TEST_SUITE_REGISTRATION( OpenSteer::HierarchicalPathPlannerTest );
+
+
+namespace {
+
+    using namespace OpenSteer;
+    
+    /**
+     * Moves a vehicle from @a start along the pathways @a planner emits for
+     * @a route in steps of a quarter cell and stores the positions it 
+     * passed in @a positions. Returns @c true if the vehicle arrived at 
+     * @a goal, @c false if a leg became impassable or the route stalled.
+     */
+    bool followRoute( HierarchicalPathPlanner& planner, 
+                      HierarchicalPathPlanner::Route& route, 
+                      Vec3 const& start, 
+                      Vec3 const& goal, 
+                      std::vector< Vec3 >& positions ) {
+        PolylineSegmentedPathwaySegmentRadii pathway;
+        Vec3 position = start;
+        positions.assign( 1, start );
+        if ( ! planner.advanceRoute( route, position, pathway ) ) {
+            return false;
+        }
+        
+        float const step = 0.25f * planner.cellSize();
+        int const maxSteps = 100000;
+        size_t next = 1;
+        for ( int steps = 0; ( position != goal ) && ( steps < maxSteps ); ++steps ) {
+            // At the end of a pathway short of the goal.
+            if ( pathway.pointCount() <= next ) {
+                return false;
+            }
+            
+            Vec3 const offset = pathway.point( next ) - position;
+            float const distance = offset.length();
+            if ( distance <= step ) {
+                position = pathway.point( next );
+                ++next;
+            } else {
+                position += offset * ( step / distance );
+            }
+            positions.push_back( position );
+            
+            // A new pathway starts at the vehicle.
+            HierarchicalPathPlanner::size_type const leg = route.currentLeg();
+            if ( ! planner.advanceRoute( route, position, pathway ) ) {
+                return false;
+            }
+            if ( route.currentLeg() != leg ) {
+                next = 1;
+            }
+        }
+        
+        return position == goal;
+    }
+
+} // anonymous namespace
+
+
+
+int const OpenSteer::HierarchicalPathPlannerTest::cellCount_;
+int const OpenSteer::HierarchicalPathPlannerTest::clusterSize_;
+
+
+
+OpenSteer::HierarchicalPathPlannerTest::HierarchicalPathPlannerTest()
+{
+    // Nothing to do.
+}
+
+
+
+OpenSteer::HierarchicalPathPlannerTest::~HierarchicalPathPlannerTest()
+{
+    // Nothing to do.
+}
+
+
+
+
+void 
+OpenSteer::HierarchicalPathPlannerTest::setUp()
+{
+    TestFixture::setUp();
+    
+    planner_.reset( new HierarchicalPathPlanner( cellCount_, cellCount_, Vec3( 0.0f, 0.0f, 0.0f ), 1.0f, clusterSize_ ) );
+}
+
+
+
+void 
+OpenSteer::HierarchicalPathPlannerTest::tearDown()
+{
+    TestFixture::tearDown();
+}
+
+
+
+void 
+OpenSteer::HierarchicalPathPlannerTest::testRoutesMatchFlatSearch()
+{
+    GridTestRandom random( 11 );
+    for ( int grid = 0; grid < 60; ++grid ) {
+        int const cellCountX = 8 + random( 25 );
+        int const cellCountZ = 8 + random( 25 );
+        int const cellCount = cellCountX * cellCountZ;
+        float const cellSize = 0.5f + random();
+        Vec3 const origin( 10.0f * random() - 5.0f, random(), 10.0f * random() - 5.0f );
+        HierarchicalPathPlanner planner( cellCountX, cellCountZ, origin, cellSize, 2 + random( 6 ) );
+        planner.setRefinedLegCount( 1 + random( 4 ) );
+        
+        std::vector< char > blocked( cellCount, 0 );
+        for ( int cell = 0; cell < cellCount; ++cell ) {
+            if ( random() < 0.3f ) {
+                blocked[ cell ] = 1;
+                planner.setBlocked( cell % cellCountX, cell / cellCountX, true );
+            }
+        }
+        
+        for ( int query = 0; query < 20; ++query ) {
+            int const startCell = random( cellCount );
+            int const goalCell = random( cellCount );
+            Vec3 const start = planner.cellCenter( startCell % cellCountX, startCell / cellCountX ) + 
+                               Vec3( random() - 0.5f, 0.0f, random() - 0.5f ) * cellSize;
+            Vec3 const goal = planner.cellCenter( goalCell % cellCountX, goalCell / cellCountX ) + 
+                              Vec3( random() - 0.5f, 0.0f, random() - 0.5f ) * cellSize;
+            
+            int const flatCost = flatRouteCost( blocked, cellCountX, cellCountZ, startCell, goalCell );
+            HierarchicalPathPlanner::Route route;
+            bool const found = planner.findRoute( start, goal, route );
+            CPPUNIT_ASSERT_EQUAL( 0 <= flatCost, found );
+            if ( ! found ) {
+                continue;
+            }
+            
+            std::vector< Vec3 > positions;
+            CPPUNIT_ASSERT( followRoute( planner, route, start, goal, positions ) );
+            CPPUNIT_ASSERT( routeAvoidsBlockedCells( planner, positions ) );
+            
+            // Diagonal moves cost 14 but are 10 * sqrt( 2 ) long, start and
+            // goal lie up to half a cell diagonal from their cell centers. 
+            // Routes over the portals are longer than flat ones, but not by
+            // much on these grids.
+            float const flatLength = 0.10102f * static_cast< float >( flatCost ) * cellSize;
+            float const endOffsets = 1.4143f * cellSize;
+            CPPUNIT_ASSERT( routeLength( positions ) <= 1.5f * flatLength + endOffsets );
+        }
+    }
+}
+
+
+
+void 
+OpenSteer::HierarchicalPathPlannerTest::testAdvanceWithOneRefinedLeg()
+{
+    Vec3 const start( 0.5f, 0.0f, 0.5f );
+    Vec3 const goal( 15.5f, 0.0f, 15.5f );
+    
+    // The first legs run from the start to a portal of its own cluster, the
+    // refined legs must reach across the cluster border for the vehicle to
+    // get to the next leg.
+    for ( HierarchicalPathPlanner::size_type legCount = 1; legCount <= 4; ++legCount ) {
+        planner_->setRefinedLegCount( legCount );
+        
+        HierarchicalPathPlanner::Route route;
+        CPPUNIT_ASSERT( planner_->findRoute( start, goal, route ) );
+        
+        std::vector< Vec3 > positions;
+        CPPUNIT_ASSERT( followRoute( *planner_, route, start, goal, positions ) );
+        CPPUNIT_ASSERT_EQUAL( route.legCount() - 1, route.currentLeg() );
+        
+        // Nothing is in the way, only the portals bend the route a little.
+        CPPUNIT_ASSERT( routeLength( positions ) <= 1.1f * ( goal - start ).length() );
+    }
+}
+
+
+
+void 
+OpenSteer::HierarchicalPathPlannerTest::testSetBlockedUpdatesPortals()
+{
+    Vec3 const start( 0.5f, 0.0f, 0.5f );
+    Vec3 const goal( 15.5f, 0.0f, 0.5f );
+    HierarchicalPathPlanner::Route route;
+    CPPUNIT_ASSERT( planner_->findRoute( start, goal, route ) );
+    
+    // Wall along the first column of the second cluster column.
+    for ( int j = 0; j < cellCount_; ++j ) {
+        planner_->setBlocked( clusterSize_, j, true );
+    }
+    CPPUNIT_ASSERT( ! planner_->findRoute( start, goal, route ) );
+    
+    // A gap in the wall is the only way through.
+    int const gap = cellCount_ - 3;
+    planner_->setBlocked( clusterSize_, gap, false );
+    CPPUNIT_ASSERT( planner_->findRoute( start, goal, route ) );
+    
+    std::vector< Vec3 > positions;
+    CPPUNIT_ASSERT( followRoute( *planner_, route, start, goal, positions ) );
+    CPPUNIT_ASSERT( routeAvoidsBlockedCells( *planner_, positions ) );
+    
+    bool passedGap = false;
+    for ( size_t k = 0; k < positions.size(); ++k ) {
+        int i = 0;
+        int j = 0;
+        planner_->cellContaining( positions[ k ], i, j );
+        passedGap = passedGap || ( ( clusterSize_ == i ) && ( gap == j ) );
+    }
+    CPPUNIT_ASSERT( passedGap );
+    
+    planner_->setBlocked( clusterSize_, gap, true );
+    CPPUNIT_ASSERT( ! planner_->findRoute( start, goal, route ) );
+}
@@ -0,0 +1,92 @@
+/**
+ * OpenSteer -- Steering Behaviors for Autonomous Characters
+ *
+ * Copyright (c) 2002-2005, Sony Computer Entertainment America
+ * Original author: Craig Reynolds <craig_reynolds@playstation.sony.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ *
+ * @file
+ *
+ * Unit test for @c OpenSteer::HierarchicalPathPlanner.
+ */
+
+#ifndef OPENSTEER_HIERARCHICALPATHPLANNERTEST_H
+#define OPENSTEER_HIERARCHICALPATHPLANNERTEST_H
+
+// Include std::auto_ptr
+#include <memory>
+
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <cppunit/TestFixture.h>
+
+
+
+// Include OpenSteer::HierarchicalPathPlanner
+#include "OpenSteer/HierarchicalPathPlanner.h"
+
+
+namespace OpenSteer {
+
+
+    class HierarchicalPathPlannerTest : public CppUnit::TestFixture {
+    public:
+        HierarchicalPathPlannerTest();
+        virtual ~HierarchicalPathPlannerTest();
+        
+        virtual void setUp();
+        virtual void tearDown();
+        
+        CPPUNIT_TEST_SUITE(HierarchicalPathPlannerTest);
+        CPPUNIT_TEST(testRoutesMatchFlatSearch);
+        CPPUNIT_TEST(testAdvanceWithOneRefinedLeg);
+        CPPUNIT_TEST(testSetBlockedUpdatesPortals);
+        CPPUNIT_TEST_SUITE_END();
+    
+    private:
+        /**
+         * Not implemented to make it non-copyable.
+         */
+        HierarchicalPathPlannerTest( HierarchicalPathPlannerTest const& );
+        
+        /**
+         * Not implemented to make it non-copyable.
+         */
+        HierarchicalPathPlannerTest& operator=( HierarchicalPathPlannerTest );
+    
+    private:
+        void testRoutesMatchFlatSearch();
+        void testAdvanceWithOneRefinedLeg();
+        void testSetBlockedUpdatesPortals();
+        
+        
+        // Free grid of @c cellCount_ times @c cellCount_ unit cells in 
+        // clusters of @c clusterSize_ cells.
+        std::auto_ptr< HierarchicalPathPlanner > planner_;
+        static int const cellCount_ = 16;
+        static int const clusterSize_ = 4;
+    
+    }; // HierarchicalPathPlannerTest
+
+
+} // namespace OpenSteer
+
+#endif // OPENSTEER_HIERARCHICALPATHPLANNERTEST_H
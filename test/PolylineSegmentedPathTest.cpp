@@ -357,6 +357,200 @@ OpenSteer::PolylineSegmentedPathTest::testMovePointsCyclicPath()
 
 
 
+void 
+OpenSteer::PolylineSegmentedPathTest::testSetPoint()
+{
+    // Move an inner point of non-cyclic path.
+    PolylineSegmentedPath path0( *path_ );
+    path0.setPoint( 1, Vec3( 1.0f, 0.0f, 0.0f ) );
+    CPPUNIT_ASSERT_EQUAL( pointCount_, path0.pointCount() );
+    CPPUNIT_ASSERT_EQUAL( segmentCount_, path0.segmentCount() );
+    CPPUNIT_ASSERT_EQUAL( Vec3( 1.0f, 0.0f, 0.0f ), path0.point( 1 ) );
+    CPPUNIT_ASSERT_EQUAL( 1.0f, path0.segmentLength( 0 ) );
+    CPPUNIT_ASSERT_EQUAL( 2.0f, path0.segmentLength( 1 ) );
+    CPPUNIT_ASSERT_EQUAL( sqrtXXX( 5.0f ), path0.segmentLength( 2 ) );
+    CPPUNIT_ASSERT_EQUAL( Vec3( 1.0f, 0.0f, 0.0f ), path0.mapSegmentDistanceToTangent( 1, 0.0f ) );
+    CPPUNIT_ASSERT( equalsRelative( pathLength_, path0.length() ) );
+    
+    // Move the end point of non-cyclic path.
+    path0 = *path_;
+    path0.setPoint( 3, Vec3( 3.0f, 2.0f, 0.0f ) );
+    CPPUNIT_ASSERT_EQUAL( 2.0f, path0.segmentLength( 2 ) );
+    CPPUNIT_ASSERT( equalsRelative( 5.0f, path0.length() ) );
+    
+    // Move the start point of cyclic path, the cycle closing segment follows.
+    path0 = *cyclicPath_;
+    path0.setPoint( 0, Vec3( 1.0f, -1.0f, 0.0f ) );
+    CPPUNIT_ASSERT_EQUAL( cyclicPointCount_, path0.pointCount() );
+    CPPUNIT_ASSERT_EQUAL( cyclicSegmentCount_, path0.segmentCount() );
+    CPPUNIT_ASSERT_EQUAL( Vec3( 1.0f, -1.0f, 0.0f ), path0.point( 0 ) );
+    CPPUNIT_ASSERT_EQUAL( path0.point( 0 ), path0.point( 4 ) );
+    CPPUNIT_ASSERT_EQUAL( sqrtXXX( 2.0f ), path0.segmentLength( 0 ) );
+    CPPUNIT_ASSERT_EQUAL( sqrtXXX( 10.0f ), path0.segmentLength( 3 ) );
+    CPPUNIT_ASSERT( equalsRelative( 1.0f + sqrtXXX( 2.0f ) + sqrtXXX( 5.0f ) + sqrtXXX( 10.0f ), path0.length() ) );
+    
+    // Same results as moving the point with movePoints.
+    PolylineSegmentedPath path1( *cyclicPath_ );
+    Vec3 const points[] = { Vec3( 1.0f, -1.0f, 0.0f ) };
+    path1.movePoints( 0, 1, points );
+    for ( size_t i = 0; i < path1.segmentCount(); ++i ) {
+        CPPUNIT_ASSERT_EQUAL( path1.segmentLength( i ), path0.segmentLength( i ) );
+    }
+    CPPUNIT_ASSERT( equalsRelative( path1.length(), path0.length() ) );
+}
+
+
+
+void 
+OpenSteer::PolylineSegmentedPathTest::testInsertPoint()
+{
+    // Split the second segment of non-cyclic path.
+    PolylineSegmentedPath path0( *path_ );
+    path0.insertPoint( 2, Vec3( 2.0f, 1.0f, 0.0f ) );
+    CPPUNIT_ASSERT_EQUAL( pointCount_ + 1, path0.pointCount() );
+    CPPUNIT_ASSERT_EQUAL( segmentCount_ + 1, path0.segmentCount() );
+    CPPUNIT_ASSERT_EQUAL( points_[ 1 ], path0.point( 1 ) );
+    CPPUNIT_ASSERT_EQUAL( Vec3( 2.0f, 1.0f, 0.0f ), path0.point( 2 ) );
+    CPPUNIT_ASSERT_EQUAL( points_[ 2 ], path0.point( 3 ) );
+    CPPUNIT_ASSERT_EQUAL( 2.0f, path0.segmentLength( 0 ) );
+    CPPUNIT_ASSERT_EQUAL( 1.0f, path0.segmentLength( 1 ) );
+    CPPUNIT_ASSERT_EQUAL( sqrtXXX( 2.0f ), path0.segmentLength( 2 ) );
+    CPPUNIT_ASSERT_EQUAL( sqrtXXX( 5.0f ), path0.segmentLength( 3 ) );
+    CPPUNIT_ASSERT_EQUAL( Vec3( 0.0f, 1.0f, 0.0f ), path0.mapSegmentDistanceToTangent( 1, 0.0f ) );
+    CPPUNIT_ASSERT( equalsRelative( 3.0f + sqrtXXX( 2.0f ) + sqrtXXX( 5.0f ), path0.length() ) );
+    
+    // Prepend and append points to non-cyclic path.
+    path0 = *path_;
+    path0.insertPoint( 0, Vec3( -1.0f, 0.0f, 0.0f ) );
+    path0.insertPoint( path0.pointCount(), Vec3( 2.0f, 3.0f, 0.0f ) );
+    CPPUNIT_ASSERT_EQUAL( pointCount_ + 2, path0.pointCount() );
+    CPPUNIT_ASSERT_EQUAL( segmentCount_ + 2, path0.segmentCount() );
+    CPPUNIT_ASSERT_EQUAL( Vec3( -1.0f, 0.0f, 0.0f ), path0.point( 0 ) );
+    CPPUNIT_ASSERT_EQUAL( Vec3( 2.0f, 3.0f, 0.0f ), path0.point( 5 ) );
+    CPPUNIT_ASSERT_EQUAL( 1.0f, path0.segmentLength( 0 ) );
+    CPPUNIT_ASSERT_EQUAL( 2.0f, path0.segmentLength( 1 ) );
+    CPPUNIT_ASSERT_EQUAL( 1.0f, path0.segmentLength( 4 ) );
+    CPPUNIT_ASSERT( equalsRelative( pathLength_ + 2.0f, path0.length() ) );
+    
+    // Insert a new first point into cyclic path, the cycle closing segment
+    // ends at it.
+    path0 = *cyclicPath_;
+    path0.insertPoint( 0, Vec3( 0.0f, -1.0f, 0.0f ) );
+    CPPUNIT_ASSERT_EQUAL( cyclicPointCount_ + 1, path0.pointCount() );
+    CPPUNIT_ASSERT_EQUAL( cyclicSegmentCount_ + 1, path0.segmentCount() );
+    CPPUNIT_ASSERT_EQUAL( Vec3( 0.0f, -1.0f, 0.0f ), path0.point( 0 ) );
+    CPPUNIT_ASSERT_EQUAL( path0.point( 0 ), path0.point( 5 ) );
+    CPPUNIT_ASSERT_EQUAL( 1.0f, path0.segmentLength( 0 ) );
+    CPPUNIT_ASSERT_EQUAL( 2.0f, path0.segmentLength( 1 ) );
+    CPPUNIT_ASSERT_EQUAL( sqrtXXX( 13.0f ), path0.segmentLength( 4 ) );
+    CPPUNIT_ASSERT( equalsRelative( 4.0f + sqrtXXX( 5.0f ) + sqrtXXX( 13.0f ), path0.length() ) );
+    
+    // Split the cycle closing segment.
+    path0 = *cyclicPath_;
+    path0.insertPoint( 4, Vec3( 0.0f, 2.0f, 0.0f ) );
+    CPPUNIT_ASSERT_EQUAL( cyclicPointCount_ + 1, path0.pointCount() );
+    CPPUNIT_ASSERT_EQUAL( points_[ 0 ], path0.point( 5 ) );
+    CPPUNIT_ASSERT_EQUAL( 2.0f, path0.segmentLength( 3 ) );
+    CPPUNIT_ASSERT_EQUAL( 2.0f, path0.segmentLength( 4 ) );
+    CPPUNIT_ASSERT( equalsRelative( pathLength_ + 4.0f, path0.length() ) );
+}
+
+
+
+void 
+OpenSteer::PolylineSegmentedPathTest::testErasePoint()
+{
+    // Join the first two segments of non-cyclic path.
+    PolylineSegmentedPath path0( *path_ );
+    path0.erasePoint( 1 );
+    CPPUNIT_ASSERT_EQUAL( pointCount_ - 1, path0.pointCount() );
+    CPPUNIT_ASSERT_EQUAL( segmentCount_ - 1, path0.segmentCount() );
+    CPPUNIT_ASSERT_EQUAL( points_[ 0 ], path0.point( 0 ) );
+    CPPUNIT_ASSERT_EQUAL( points_[ 2 ], path0.point( 1 ) );
+    CPPUNIT_ASSERT_EQUAL( 3.0f, path0.segmentLength( 0 ) );
+    CPPUNIT_ASSERT_EQUAL( sqrtXXX( 5.0f ), path0.segmentLength( 1 ) );
+    CPPUNIT_ASSERT( equalsRelative( pathLength_, path0.length() ) );
+    
+    // Erase the start and end point of non-cyclic path.
+    path0 = *path_;
+    path0.erasePoint( 3 );
+    path0.erasePoint( 0 );
+    CPPUNIT_ASSERT_EQUAL( static_cast< size_t >( 2 ), path0.pointCount() );
+    CPPUNIT_ASSERT_EQUAL( static_cast< size_t >( 1 ), path0.segmentCount() );
+    CPPUNIT_ASSERT_EQUAL( points_[ 1 ], path0.point( 0 ) );
+    CPPUNIT_ASSERT_EQUAL( points_[ 2 ], path0.point( 1 ) );
+    CPPUNIT_ASSERT_EQUAL( 1.0f, path0.length() );
+    
+    // Erase the first point of cyclic path, the cycle closing segment 
+    // follows the new first point.
+    path0 = *cyclicPath_;
+    path0.erasePoint( 0 );
+    CPPUNIT_ASSERT_EQUAL( cyclicPointCount_ - 1, path0.pointCount() );
+    CPPUNIT_ASSERT_EQUAL( cyclicSegmentCount_ - 1, path0.segmentCount() );
+    CPPUNIT_ASSERT_EQUAL( points_[ 1 ], path0.point( 0 ) );
+    CPPUNIT_ASSERT_EQUAL( path0.point( 0 ), path0.point( 3 ) );
+    CPPUNIT_ASSERT_EQUAL( 1.0f, path0.segmentLength( 0 ) );
+    CPPUNIT_ASSERT_EQUAL( sqrtXXX( 5.0f ), path0.segmentLength( 1 ) );
+    CPPUNIT_ASSERT_EQUAL( 2.0f, path0.segmentLength( 2 ) );
+    CPPUNIT_ASSERT( equalsRelative( 3.0f + sqrtXXX( 5.0f ), path0.length() ) );
+    
+    // Erasing an inserted point restores the path.
+    path0 = *cyclicPath_;
+    path0.insertPoint( 2, Vec3( 2.0f, 1.0f, 0.0f ) );
+    path0.erasePoint( 2 );
+    CPPUNIT_ASSERT_EQUAL( cyclicPointCount_, path0.pointCount() );
+    for ( size_t i = 0; i < path0.segmentCount(); ++i ) {
+        CPPUNIT_ASSERT_EQUAL( cyclicPath_->segmentLength( i ), path0.segmentLength( i ) );
+    }
+    CPPUNIT_ASSERT( equalsRelative( cyclicPathLength_, path0.length() ) );
+}
+
+
+
+void 
+OpenSteer::PolylineSegmentedPathTest::testSegmentDistanceIndex()
+{
+    PolylineSegmentedPath path0( *cyclicPath_ );
+    
+    CPPUNIT_ASSERT_EQUAL( 0.0f, path0.segmentStartDistance( 0 ) );
+    CPPUNIT_ASSERT_EQUAL( 2.0f, path0.segmentStartDistance( 1 ) );
+    CPPUNIT_ASSERT_EQUAL( 3.0f, path0.segmentStartDistance( 2 ) );
+    CPPUNIT_ASSERT( equalsRelative( pathLength_, path0.segmentStartDistance( 3 ) ) );
+    
+    float segmentStart = -1.0f;
+    CPPUNIT_ASSERT_EQUAL( static_cast< size_t >( 0 ), path0.mapDistanceToSegmentIndex( -1.0f, segmentStart ) );
+    CPPUNIT_ASSERT_EQUAL( 0.0f, segmentStart );
+    CPPUNIT_ASSERT_EQUAL( static_cast< size_t >( 0 ), path0.mapDistanceToSegmentIndex( 2.0f, segmentStart ) );
+    CPPUNIT_ASSERT_EQUAL( static_cast< size_t >( 1 ), path0.mapDistanceToSegmentIndex( 2.5f, segmentStart ) );
+    CPPUNIT_ASSERT_EQUAL( 2.0f, segmentStart );
+    CPPUNIT_ASSERT_EQUAL( static_cast< size_t >( 3 ), path0.mapDistanceToSegmentIndex( pathLength_ + 0.5f, segmentStart ) );
+    CPPUNIT_ASSERT( equalsRelative( pathLength_, segmentStart ) );
+    CPPUNIT_ASSERT_EQUAL( static_cast< size_t >( 3 ), path0.mapDistanceToSegmentIndex( 100.0f, segmentStart ) );
+    CPPUNIT_ASSERT( equalsRelative( pathLength_, segmentStart ) );
+    
+    // The index follows point edits.
+    path0.setPoint( 1, Vec3( 1.0f, 0.0f, 0.0f ) );
+    CPPUNIT_ASSERT_EQUAL( 1.0f, path0.segmentStartDistance( 1 ) );
+    CPPUNIT_ASSERT_EQUAL( static_cast< size_t >( 1 ), path0.mapDistanceToSegmentIndex( 2.5f, segmentStart ) );
+    CPPUNIT_ASSERT_EQUAL( 1.0f, segmentStart );
+    CPPUNIT_ASSERT( equalsRelative( Vec3( 2.5f, 0.0f, 0.0f ), path0.mapPathDistanceToPoint( 2.5f ) ) );
+    
+    path0.insertPoint( 1, Vec3( 0.5f, 0.0f, 0.0f ) );
+    CPPUNIT_ASSERT_EQUAL( 0.5f, path0.segmentStartDistance( 1 ) );
+    CPPUNIT_ASSERT_EQUAL( 1.0f, path0.segmentStartDistance( 2 ) );
+    CPPUNIT_ASSERT_EQUAL( static_cast< size_t >( 2 ), path0.mapDistanceToSegmentIndex( 2.5f, segmentStart ) );
+    CPPUNIT_ASSERT( equalsRelative( Vec3( 2.5f, 0.0f, 0.0f ), path0.mapPathDistanceToPoint( 2.5f ) ) );
+    
+    path0.erasePoint( 2 );
+    CPPUNIT_ASSERT_EQUAL( 0.5f, path0.segmentStartDistance( 1 ) );
+    CPPUNIT_ASSERT_EQUAL( 3.0f, path0.segmentStartDistance( 2 ) );
+    CPPUNIT_ASSERT_EQUAL( static_cast< size_t >( 1 ), path0.mapDistanceToSegmentIndex( 2.5f, segmentStart ) );
+    CPPUNIT_ASSERT( equalsRelative( Vec3( 2.5f, 0.0f, 0.0f ), path0.mapPathDistanceToPoint( 2.5f ) ) );
+}
+
+
+
+
 void 
 OpenSteer::PolylineSegmentedPathTest::testSegmentMappings()
 {
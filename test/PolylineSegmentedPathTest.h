@@ -63,6 +63,10 @@ namespace OpenSteer {
         CPPUNIT_TEST(testSegmentData);
         CPPUNIT_TEST(testMovePoints);
         CPPUNIT_TEST(testMovePointsCyclicPath);
+        CPPUNIT_TEST(testSetPoint);
+        CPPUNIT_TEST(testInsertPoint);
+        CPPUNIT_TEST(testErasePoint);
+        CPPUNIT_TEST(testSegmentDistanceIndex);
         CPPUNIT_TEST(testSegmentMappings);
         CPPUNIT_TEST(testPointToPathMappings);
         CPPUNIT_TEST(testDistanceToPathMappings);
@@ -86,6 +90,10 @@ namespace OpenSteer {
         void testSegmentData();
         void testMovePoints();
         void testMovePointsCyclicPath();
+        void testSetPoint();
+        void testInsertPoint();
+        void testErasePoint();
+        void testSegmentDistanceIndex();
         void testSegmentMappings();        
         void testPointToPathMappings();
         void testDistanceToPathMappings();
@@ -0,0 +1,150 @@
+/**
+ * OpenSteer -- Steering Behaviors for Autonomous Characters
+ *
+ * Copyright (c) 2002-2005, Sony Computer Entertainment America
+ * Original author: Craig Reynolds <craig_reynolds@playstation.sony.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+#include "PolylineSegmentedPathwaySegmentRadiiTest.h"
+
+
+
+// Register test suite.
+CPPUNIT_TEST_SUITE_REGISTRATION( OpenSteer::PolylineSegmentedPathwaySegmentRadiiTest );
+
+
+OpenSteer::size_t const OpenSteer::PolylineSegmentedPathwaySegmentRadiiTest::pointCount_;
+OpenSteer::size_t const OpenSteer::PolylineSegmentedPathwaySegmentRadiiTest::cyclicPointCount_;
+OpenSteer::size_t const OpenSteer::PolylineSegmentedPathwaySegmentRadiiTest::segmentCount_ = 3;
+OpenSteer::size_t const OpenSteer::PolylineSegmentedPathwaySegmentRadiiTest::cyclicSegmentCount_ = 4;
+OpenSteer::Vec3 const OpenSteer::PolylineSegmentedPathwaySegmentRadiiTest::points_[ OpenSteer::PolylineSegmentedPathwaySegmentRadiiTest::pointCount_ ] = {  
+    OpenSteer::Vec3( 0.0f, 0.0f, 0.0f ),
+    OpenSteer::Vec3( 2.0f, 0.0f, 0.0f ),
+    OpenSteer::Vec3( 3.0f, 0.0f, 0.0f ),
+    OpenSteer::Vec3( 2.0f, 2.0f, 0.0f ) };
+float const OpenSteer::PolylineSegmentedPathwaySegmentRadiiTest::radii_[ OpenSteer::PolylineSegmentedPathwaySegmentRadiiTest::cyclicPointCount_ - 1 ] = {
+    1.0f, 2.0f, 3.0f, 4.0f };
+
+
+
+OpenSteer::PolylineSegmentedPathwaySegmentRadiiTest::PolylineSegmentedPathwaySegmentRadiiTest()
+{
+    // Nothing to do.
+}
+
+
+
+OpenSteer::PolylineSegmentedPathwaySegmentRadiiTest::~PolylineSegmentedPathwaySegmentRadiiTest()
+{
+    // Nothing to do.
+}
+
+
+
+
+void 
+OpenSteer::PolylineSegmentedPathwaySegmentRadiiTest::setUp()
+{
+    TestFixture::setUp();
+    
+    path_.reset( new PolylineSegmentedPathwaySegmentRadii( pointCount_, points_, radii_, false ) );
+    cyclicPath_.reset( new PolylineSegmentedPathwaySegmentRadii( pointCount_, points_, radii_, true ) );
+}
+
+
+
+void 
+OpenSteer::PolylineSegmentedPathwaySegmentRadiiTest::tearDown()
+{
+    TestFixture::tearDown();
+}
+
+
+
+void 
+OpenSteer::PolylineSegmentedPathwaySegmentRadiiTest::testInsertPoint()
+{
+    // Both halves of a split segment keep its radius.
+    PolylineSegmentedPathwaySegmentRadii path0( *path_ );
+    path0.insertPoint( 2, Vec3( 2.0f, 1.0f, 0.0f ) );
+    CPPUNIT_ASSERT_EQUAL( segmentCount_ + 1, path0.segmentCount() );
+    CPPUNIT_ASSERT_EQUAL( 1.0f, path0.segmentRadius( 0 ) );
+    CPPUNIT_ASSERT_EQUAL( 2.0f, path0.segmentRadius( 1 ) );
+    CPPUNIT_ASSERT_EQUAL( 2.0f, path0.segmentRadius( 2 ) );
+    CPPUNIT_ASSERT_EQUAL( 3.0f, path0.segmentRadius( 3 ) );
+    
+    // A prepended point takes the radius of the first segment, an appended
+    // one that of the last segment.
+    path0 = *path_;
+    path0.insertPoint( 0, Vec3( -1.0f, 0.0f, 0.0f ) );
+    path0.insertPoint( path0.pointCount(), Vec3( 2.0f, 3.0f, 0.0f ) );
+    CPPUNIT_ASSERT_EQUAL( pointCount_ + 2, path0.pointCount() );
+    CPPUNIT_ASSERT_EQUAL( segmentCount_ + 2, path0.segmentCount() );
+    CPPUNIT_ASSERT_EQUAL( Vec3( 2.0f, 3.0f, 0.0f ), path0.point( 5 ) );
+    CPPUNIT_ASSERT_EQUAL( 1.0f, path0.segmentRadius( 0 ) );
+    CPPUNIT_ASSERT_EQUAL( 1.0f, path0.segmentRadius( 1 ) );
+    CPPUNIT_ASSERT_EQUAL( 3.0f, path0.segmentRadius( 3 ) );
+    CPPUNIT_ASSERT_EQUAL( 3.0f, path0.segmentRadius( 4 ) );
+    
+    // Appending twice keeps extending with the last radius.
+    path0 = *path_;
+    path0.insertPoint( path0.pointCount(), Vec3( 2.0f, 3.0f, 0.0f ) );
+    path0.insertPoint( path0.pointCount(), Vec3( 2.0f, 4.0f, 0.0f ) );
+    CPPUNIT_ASSERT_EQUAL( segmentCount_ + 2, path0.segmentCount() );
+    CPPUNIT_ASSERT_EQUAL( 3.0f, path0.segmentRadius( 4 ) );
+    
+    // A new first point of a cyclic pathway splits the cycle closing segment.
+    path0 = *cyclicPath_;
+    path0.insertPoint( 0, Vec3( 0.0f, -1.0f, 0.0f ) );
+    CPPUNIT_ASSERT_EQUAL( cyclicSegmentCount_ + 1, path0.segmentCount() );
+    CPPUNIT_ASSERT_EQUAL( 4.0f, path0.segmentRadius( 0 ) );
+    CPPUNIT_ASSERT_EQUAL( 1.0f, path0.segmentRadius( 1 ) );
+    CPPUNIT_ASSERT_EQUAL( 4.0f, path0.segmentRadius( 4 ) );
+    
+    // Split the cycle closing segment.
+    path0 = *cyclicPath_;
+    path0.insertPoint( 4, Vec3( 0.0f, 2.0f, 0.0f ) );
+    CPPUNIT_ASSERT_EQUAL( cyclicSegmentCount_ + 1, path0.segmentCount() );
+    CPPUNIT_ASSERT_EQUAL( 4.0f, path0.segmentRadius( 3 ) );
+    CPPUNIT_ASSERT_EQUAL( 4.0f, path0.segmentRadius( 4 ) );
+}
+
+
+
+void 
+OpenSteer::PolylineSegmentedPathwaySegmentRadiiTest::testErasePoint()
+{
+    // The joined segment keeps the radius of the segment ending at the 
+    // erased point.
+    PolylineSegmentedPathwaySegmentRadii path0( *path_ );
+    path0.erasePoint( 2 );
+    CPPUNIT_ASSERT_EQUAL( segmentCount_ - 1, path0.segmentCount() );
+    CPPUNIT_ASSERT_EQUAL( 1.0f, path0.segmentRadius( 0 ) );
+    CPPUNIT_ASSERT_EQUAL( 2.0f, path0.segmentRadius( 1 ) );
+    
+    // Erasing the first or the last point drops the segment at it.
+    path0 = *path_;
+    path0.erasePoint( 0 );
+    CPPUNIT_ASSERT_EQUAL( 2.0f, path0.segmentRadius( 0 ) );
+    path0 = *path_;
+    path0.erasePoint( pointCount_ - 1 );
+    CPPUNIT_ASSERT_EQUAL( segmentCount_ - 1, path0.segmentCount() );
+    CPPUNIT_ASSERT_EQUAL( 2.0f, path0.segmentRadius( 1 ) );
+}
@@ -0,0 +1,99 @@
+/**
+ * OpenSteer -- Steering Behaviors for Autonomous Characters
+ *
+ * Copyright (c) 2002-2005, Sony Computer Entertainment America
+ * Original author: Craig Reynolds <craig_reynolds@playstation.sony.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ *
+ * @file
+ *
+ * Unit test for @c OpenSteer::PolylineSegmentedPathwaySegmentRadii.
+ */
+
+#ifndef OPENSTEER_POLYLINESEGMENTEDPATHWAYSEGMENTRADIITEST_H
+#define OPENSTEER_POLYLINESEGMENTEDPATHWAYSEGMENTRADIITEST_H
+
+// Include std::auto_ptr
+#include <memory>
+
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <cppunit/TestFixture.h>
+
+
+
+// Include OpenSteer::PolylineSegmentedPathwaySegmentRadii
+#include "OpenSteer/PolylineSegmentedPathwaySegmentRadii.h"
+
+// Include OpenSteer::size_t
+#include "OpenSteer/StandardTypes.h"
+
+// Include OpenSteer::Vec3
+#include "OpenSteer/Vec3.h"
+
+
+namespace OpenSteer {
+    
+    
+    class PolylineSegmentedPathwaySegmentRadiiTest : public CppUnit::TestFixture {
+    public:
+        PolylineSegmentedPathwaySegmentRadiiTest();
+        virtual ~PolylineSegmentedPathwaySegmentRadiiTest();
+        
+        virtual void setUp();
+        virtual void tearDown();
+        
+        CPPUNIT_TEST_SUITE(PolylineSegmentedPathwaySegmentRadiiTest);
+        CPPUNIT_TEST(testInsertPoint);
+        CPPUNIT_TEST(testErasePoint);
+        CPPUNIT_TEST_SUITE_END();
+        
+    private:
+        /**
+         * Not implemented to make it non-copyable.
+         */
+        PolylineSegmentedPathwaySegmentRadiiTest( PolylineSegmentedPathwaySegmentRadiiTest const& );
+        
+        /**
+         * Not implemented to make it non-copyable.
+         */
+        PolylineSegmentedPathwaySegmentRadiiTest& operator=( PolylineSegmentedPathwaySegmentRadiiTest );
+        
+    private:
+        void testInsertPoint();
+        void testErasePoint();
+        
+        
+        std::auto_ptr< PolylineSegmentedPathwaySegmentRadii > path_;
+        std::auto_ptr< PolylineSegmentedPathwaySegmentRadii > cyclicPath_;
+        static size_t const pointCount_ = 4;
+        static size_t const cyclicPointCount_ = 5;
+        static size_t const segmentCount_;
+        static size_t const cyclicSegmentCount_;
+        static Vec3 const points_[ pointCount_ ];
+        static float const radii_[ cyclicPointCount_ - 1 ];
+        
+    }; // PolylineSegmentedPathwaySegmentRadiiTest
+
+    
+} // namespace OpenSteer
+
+#endif // OPENSTEER_POLYLINESEGMENTEDPATHWAYSEGMENTRADIITEST_H
@@ -0,0 +1,218 @@
+/**
+ * OpenSteer -- Steering Behaviors for Autonomous Characters
+ *
+ * Copyright (c) 2002-2005, Sony Computer Entertainment America
+ * Original author: Craig Reynolds <craig_reynolds@playstation.sony.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ *
+ * @file
+ *
+ * Unit test for @c OpenSteer::SteerLibraryMixin.
+ */
+#include "SteerLibraryTest.h"
+
+
+// Include OpenSteer::SteerLibraryMixin
+#include "OpenSteer/SteerLibrary.h"
+
+// Include OpenSteer::LocalSpaceMixin
+#include "OpenSteer/LocalSpace.h"
+
+// Include OpenSteer::AbstractVehicle, OpenSteer::AVGroup
+#include "OpenSteer/AbstractVehicle.h"
+
+// Include OpenSteer::Vec3
+#include "OpenSteer/Vec3.h"
+
+
+
+// Register test suite.
+CPPUNIT_TEST_SUITE_REGISTRATION( OpenSteer::SteerLibraryTest );
+
+
+namespace {
+
+    using namespace OpenSteer;
+    
+    /**
+     * Vehicle moving in a straight line with just the state the steering
+     * behaviors read.
+     */
+    class TestVehicle : public SteerLibraryMixin< LocalSpaceMixin< AbstractVehicle > > {
+    public:
+        TestVehicle( Vec3 const& position, Vec3 const& velocity, float radius )
+            : mass_( 1.0f ), radius_( radius ), speed_( velocity.length() ), maxForce_( 1.0f ), maxSpeed_( 1.0f ) {
+            setPosition( position );
+            if ( 0.0f < speed_ ) {
+                regenerateOrthonormalBasisUF( velocity / speed_ );
+            }
+        }
+        
+        virtual float mass() const { return mass_; }
+        virtual float setMass( float m ) { return mass_ = m; }
+        virtual float radius() const { return radius_; }
+        virtual float setRadius( float r ) { return radius_ = r; }
+        virtual Vec3 velocity() const { return forward() * speed_; }
+        virtual float speed() const { return speed_; }
+        virtual float setSpeed( float s ) { return speed_ = s; }
+        virtual Vec3 predictFuturePosition( float const predictionTime ) const { return position() + velocity() * predictionTime; }
+        virtual float maxForce() const { return maxForce_; }
+        virtual float setMaxForce( float mf ) { return maxForce_ = mf; }
+        virtual float maxSpeed() const { return maxSpeed_; }
+        virtual float setMaxSpeed( float ms ) { return maxSpeed_ = ms; }
+        virtual void update( float const, float const ) {}
+    
+    private:
+        float mass_;
+        float radius_;
+        float speed_;
+        float maxForce_;
+        float maxSpeed_;
+    };
+    
+    
+    bool equal( Vec3 const& lhs, Vec3 const& rhs ) {
+        return ( lhs - rhs ).length() < 0.0001f;
+    }
+    
+    
+    // Menaces and vehicle have a radius of 1, so they touch at distance 2.
+    float const maxPredictionTime = 4.0f;
+
+} // anonymous namespace
+
+
+
+OpenSteer::SteerLibraryTest::SteerLibraryTest()
+{
+    // Nothing to do.
+}
+
+
+
+OpenSteer::SteerLibraryTest::~SteerLibraryTest()
+{
+    // Nothing to do.
+}
+
+
+
+
+void 
+OpenSteer::SteerLibraryTest::setUp()
+{
+    TestFixture::setUp();
+}
+
+
+
+void 
+OpenSteer::SteerLibraryTest::tearDown()
+{
+    TestFixture::tearDown();
+}
+
+
+
+void 
+OpenSteer::SteerLibraryTest::testEvasionFromGroupWeighting()
+{
+    TestVehicle vehicle( Vec3( 0.0f, 0.0f, 0.0f ), Vec3( 0.0f, 0.0f, 0.0f ), 1.0f );
+    
+    // Touches in 2 of 4 seconds, weight 0.5, at x = 2 by then.
+    TestVehicle slow( Vec3( 10.0f, 0.0f, 0.0f ), Vec3( -4.0f, 0.0f, 0.0f ), 1.0f );
+    // Touches in 1 of 4 seconds, weight 0.75, at z = 2 by then.
+    TestVehicle fast( Vec3( 0.0f, 0.0f, 6.0f ), Vec3( 0.0f, 0.0f, -4.0f ), 1.0f );
+    
+    AVGroup menaces;
+    menaces.push_back( &slow );
+    CPPUNIT_ASSERT( equal( Vec3( -0.5f, 0.0f, 0.0f ), vehicle.steerForEvasionFromGroup( menaces, maxPredictionTime ) ) );
+    
+    menaces.push_back( &fast );
+    CPPUNIT_ASSERT( equal( Vec3( -0.5f, 0.0f, -0.75f ), vehicle.steerForEvasionFromGroup( menaces, maxPredictionTime ) ) );
+    
+    // The desired velocity never exceeds the maximum speed.
+    TestVehicle fastX( Vec3( 6.0f, 0.0f, 0.0f ), Vec3( -4.0f, 0.0f, 0.0f ), 1.0f );
+    menaces[ 0 ] = &fastX;
+    CPPUNIT_ASSERT( equal( Vec3( -1.0f, 0.0f, -1.0f ).normalize(), vehicle.steerForEvasionFromGroup( menaces, maxPredictionTime ) ) );
+    
+    // Menaces are predicted relative to the vehicle's own motion, the 
+    // steering force corrects the vehicle's velocity.
+    TestVehicle moving( Vec3( 0.0f, 0.0f, 0.0f ), Vec3( 0.0f, 0.0f, 0.5f ), 1.0f );
+    TestVehicle follower( Vec3( 0.0f, 0.0f, 6.0f ), Vec3( 0.0f, 0.0f, -3.5f ), 1.0f );
+    AVGroup followers( 1, &follower );
+    CPPUNIT_ASSERT( equal( Vec3( 0.0f, 0.0f, -1.25f ), moving.steerForEvasionFromGroup( followers, maxPredictionTime ) ) );
+}
+
+
+
+void 
+OpenSteer::SteerLibraryTest::testEvasionFromGroupIgnoresOutOfRangeMenaces()
+{
+    TestVehicle vehicle( Vec3( 0.0f, 0.0f, 0.0f ), Vec3( 0.0f, 0.0f, 0.0f ), 1.0f );
+    AVGroup menaces;
+    CPPUNIT_ASSERT( Vec3::zero == vehicle.steerForEvasionFromGroup( menaces, maxPredictionTime ) );
+    
+    // Moving away.
+    TestVehicle leaving( Vec3( 5.0f, 0.0f, 0.0f ), Vec3( 3.0f, 0.0f, 0.0f ), 1.0f );
+    // Standing still.
+    TestVehicle waiting( Vec3( 0.0f, 0.0f, -5.0f ), Vec3( 0.0f, 0.0f, 0.0f ), 1.0f );
+    // Passing by without closing in.
+    TestVehicle passing( Vec3( -5.0f, 0.0f, 0.0f ), Vec3( 0.0f, 0.0f, 2.0f ), 1.0f );
+    // Touches in 8 seconds, after the maximum prediction time.
+    TestVehicle late( Vec3( 0.0f, 0.0f, 18.0f ), Vec3( 0.0f, 0.0f, -2.0f ), 1.0f );
+    // Touches exactly at the maximum prediction time.
+    TestVehicle edge( Vec3( 10.0f, 0.0f, 10.0f ), Vec3( -1.0f, 0.0f, -1.0f ).normalize() * ( ( Vec3( 10.0f, 0.0f, 10.0f ).length() - 2.0f ) / maxPredictionTime ), 1.0f );
+    
+    menaces.push_back( &leaving );
+    menaces.push_back( &waiting );
+    menaces.push_back( &passing );
+    menaces.push_back( &late );
+    menaces.push_back( &edge );
+    CPPUNIT_ASSERT( equal( Vec3::zero, vehicle.steerForEvasionFromGroup( menaces, maxPredictionTime ) ) );
+    
+    // Ignored menaces don't dilute the others.
+    TestVehicle slow( Vec3( 10.0f, 0.0f, 0.0f ), Vec3( -4.0f, 0.0f, 0.0f ), 1.0f );
+    menaces.push_back( &slow );
+    CPPUNIT_ASSERT( equal( Vec3( -0.5f, 0.0f, 0.0f ), vehicle.steerForEvasionFromGroup( menaces, maxPredictionTime ) ) );
+}
+
+
+
+void 
+OpenSteer::SteerLibraryTest::testEvasionFromGroupWhenOverlapping()
+{
+    TestVehicle vehicle( Vec3( 0.0f, 0.0f, 0.0f ), Vec3( 0.0f, 0.0f, 0.0f ), 1.0f );
+    
+    // Touching and moving away, standing still or closing in, the vehicle
+    // flees from the current position at full speed.
+    Vec3 const velocities[] = { Vec3( 3.0f, 0.0f, 0.0f ), Vec3( 0.0f, 0.0f, 0.0f ), Vec3( -3.0f, 0.0f, 0.0f ), Vec3( 0.0f, 0.0f, 3.0f ) };
+    for ( size_t k = 0; k < sizeof( velocities ) / sizeof( velocities[ 0 ] ); ++k ) {
+        TestVehicle overlapping( Vec3( 1.5f, 0.0f, 0.0f ), velocities[ k ], 1.0f );
+        AVGroup menaces( 1, &overlapping );
+        CPPUNIT_ASSERT( equal( Vec3( -1.0f, 0.0f, 0.0f ), vehicle.steerForEvasionFromGroup( menaces, maxPredictionTime ) ) );
+    }
+    
+    // Exactly touching counts as overlapping.
+    TestVehicle touching( Vec3( 0.0f, 0.0f, 2.0f ), Vec3( 0.0f, 0.0f, 1.0f ), 1.0f );
+    AVGroup menaces( 1, &touching );
+    CPPUNIT_ASSERT( equal( Vec3( 0.0f, 0.0f, -1.0f ), vehicle.steerForEvasionFromGroup( menaces, maxPredictionTime ) ) );
+}
@@ -0,0 +1,537 @@
+/**
+ * OpenSteer -- Steering Behaviors for Autonomous Characters
+ *
+ * Copyright (c) 2002-2005, Sony Computer Entertainment America
+ * Original author: Craig Reynolds <craig_reynolds@playstation.sony.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ *
+ * @file
+ *
+ * Unit test for @c RayTester.
+ */
+#include "TerrainRayTestTest.h"
+
+
+// Include std::sin, std::cos, std::sqrt
+#include <cmath>
+
+// Include std::printf, std::fopen, std::fread, std::fwrite, std::fclose, std::remove
+#include <cstdio>
+
+// Include std::clock
+#include <ctime>
+
+// Include std::memcmp
+#include <cstring>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+
+
+// Register test suite.
+CPPUNIT_TEST_SUITE_REGISTRATION( OpenSteer::TerrainRayTestTest );
+
+
+namespace {
+    
+    /**
+     * Rolling hills over a square grid with unit spacing.
+     */
+    float terrainHeight( float x, float z ) {
+        return 6.0f * std::sin( 0.05f * x ) * std::cos( 0.07f * z ) + 3.0f * std::sin( 0.013f * x + 0.021f * z );
+    }
+    
+    
+    /**
+     * Deterministic random numbers in [0, 1).
+     */
+    class Random {
+    public:
+        explicit Random( unsigned long seed ) : state_( seed ) {}
+        
+        double operator()() {
+            state_ = ( state_ * 1103515245UL + 12345UL ) & 0x7fffffffUL;
+            return static_cast< double >( state_ ) / 2147483648.0;
+        }
+        
+    private:
+        unsigned long state_;
+    };
+    
+    
+    /**
+     * Returns @c true if both results describe the same hit or both missed.
+     */
+    bool sameResult( RayTestInfo const& lhs, RayTestInfo const& rhs ) {
+        if ( lhs.hitOccurred != rhs.hitOccurred ) {
+            return false;
+        }
+        
+        return ! lhs.hitOccurred ||
+            ( 0 == std::memcmp( &lhs.t, &rhs.t, sizeof( lhs.t ) ) &&
+              0 == std::memcmp( lhs.pos, rhs.pos, sizeof( lhs.pos ) ) &&
+              0 == std::memcmp( lhs.norm, rhs.norm, sizeof( lhs.norm ) ) );
+    }
+    
+    
+    /**
+     * Returns the nearest intersection at a non-negative t of the ray with
+     * the terrain's triangles, or a negative value if there is none.
+     */
+    double nearestHit( int gridSize, double const* eye, double const* direction ) {
+        double nearest = -1.0;
+        for ( int z = 0; z + 1 < gridSize; ++z ) {
+            for ( int x = 0; x + 1 < gridSize; ++x ) {
+                float const x0 = static_cast< float >( x );
+                float const x1 = static_cast< float >( x + 1 );
+                float const z0 = static_cast< float >( z );
+                float const z1 = static_cast< float >( z + 1 );
+                double const corners[ 4 ][ 3 ] = {
+                    { x0, terrainHeight( x0, z0 ), z0 },
+                    { x1, terrainHeight( x1, z0 ), z0 },
+                    { x0, terrainHeight( x0, z1 ), z1 },
+                    { x1, terrainHeight( x1, z1 ), z1 } };
+                int const triangles[ 2 ][ 3 ] = { { 0, 2, 1 }, { 3, 1, 2 } };
+                
+                for ( int k = 0; k < 2; ++k ) {
+                    double const* a = corners[ triangles[ k ][ 0 ] ];
+                    double const* b = corners[ triangles[ k ][ 1 ] ];
+                    double const* c = corners[ triangles[ k ][ 2 ] ];
+                    double const e1[ 3 ] = { b[ 0 ] - a[ 0 ], b[ 1 ] - a[ 1 ], b[ 2 ] - a[ 2 ] };
+                    double const e2[ 3 ] = { c[ 0 ] - a[ 0 ], c[ 1 ] - a[ 1 ], c[ 2 ] - a[ 2 ] };
+                    double const p[ 3 ] = { direction[ 1 ] * e2[ 2 ] - direction[ 2 ] * e2[ 1 ],
+                                            direction[ 2 ] * e2[ 0 ] - direction[ 0 ] * e2[ 2 ],
+                                            direction[ 0 ] * e2[ 1 ] - direction[ 1 ] * e2[ 0 ] };
+                    double const det = e1[ 0 ] * p[ 0 ] + e1[ 1 ] * p[ 1 ] + e1[ 2 ] * p[ 2 ];
+                    if ( det <= 0.0 ) {
+                        continue;
+                    }
+                    
+                    double const s[ 3 ] = { eye[ 0 ] - a[ 0 ], eye[ 1 ] - a[ 1 ], eye[ 2 ] - a[ 2 ] };
+                    double const u = s[ 0 ] * p[ 0 ] + s[ 1 ] * p[ 1 ] + s[ 2 ] * p[ 2 ];
+                    double const q[ 3 ] = { s[ 1 ] * e1[ 2 ] - s[ 2 ] * e1[ 1 ],
+                                            s[ 2 ] * e1[ 0 ] - s[ 0 ] * e1[ 2 ],
+                                            s[ 0 ] * e1[ 1 ] - s[ 1 ] * e1[ 0 ] };
+                    double const v = direction[ 0 ] * q[ 0 ] + direction[ 1 ] * q[ 1 ] + direction[ 2 ] * q[ 2 ];
+                    double const t = ( e2[ 0 ] * q[ 0 ] + e2[ 1 ] * q[ 1 ] + e2[ 2 ] * q[ 2 ] ) / det;
+                    if ( u >= 0.0 && v >= 0.0 && u + v <= det && t >= 0.0 && ( nearest < 0.0 || t < nearest ) ) {
+                        nearest = t;
+                    }
+                }
+            }
+        }
+        return nearest;
+    }
+    
+    
+    /**
+     * Seconds on a wall clock if available.
+     */
+    double seconds() {
+#ifdef _OPENMP
+        return omp_get_wtime();
+#else
+        return static_cast< double >( std::clock() ) / CLOCKS_PER_SEC;
+#endif
+    }
+    
+} // anonymous namespace
+
+
+
+int const OpenSteer::TerrainRayTestTest::gridSize_;
+char OpenSteer::TerrainRayTestTest::fileName_[] = "TerrainRayTestTest.data";
+char OpenSteer::TerrainRayTestTest::compiledName_[] = "TerrainRayTestTest.compiled";
+
+
+
+OpenSteer::TerrainRayTestTest::TerrainRayTestTest()
+{
+    // Nothing to do.
+}
+
+
+
+OpenSteer::TerrainRayTestTest::~TerrainRayTestTest()
+{
+    // Nothing to do.
+}
+
+
+
+
+void 
+OpenSteer::TerrainRayTestTest::setUp()
+{
+    TestFixture::setUp();
+    
+    writeTerrain( 1.0f );
+}
+
+
+
+void 
+OpenSteer::TerrainRayTestTest::tearDown()
+{
+    TestFixture::tearDown();
+    
+    std::remove( fileName_ );
+    std::remove( compiledName_ );
+    eyes_.clear();
+    directions_.clear();
+}
+
+
+
+void
+OpenSteer::TerrainRayTestTest::testBatchMatchesRayCast()
+{
+    RayTester tester;
+    tester.LoadData( fileName_ );
+    
+    makeRays( 200, 61 );
+    CPPUNIT_ASSERT( batchMatchesRayCast( tester, TRT_INFINITY ) );
+}
+
+
+
+void
+OpenSteer::TerrainRayTestTest::testBatchMatchesRayCastTransformed()
+{
+    // Queries in a world twice as large, offset and with a flatter height
+    // scale than the data set.
+    RayTester tester;
+    tester.LoadData( fileName_, -300, 212, -20, 10, 100, 612 );
+    
+    makeRays( 200, 61 );
+    for ( std::size_t i = 0; i < eyes_.size(); i += 3 ) {
+        eyes_[ i ] = 2 * eyes_[ i ] - 300;
+        eyes_[ i + 2 ] = 2 * eyes_[ i + 2 ] + 100;
+    }
+    CPPUNIT_ASSERT( batchMatchesRayCast( tester, TRT_INFINITY ) );
+}
+
+
+
+void
+OpenSteer::TerrainRayTestTest::testBatchMaxT()
+{
+    RayTester tester;
+    tester.LoadData( fileName_ );
+    
+    makeRays( 50, 32 );
+    CPPUNIT_ASSERT( batchMatchesRayCast( tester, 0 ) );
+    CPPUNIT_ASSERT( batchMatchesRayCast( tester, 5 ) );
+    CPPUNIT_ASSERT( batchMatchesRayCast( tester, 40 ) );
+}
+
+
+
+void
+OpenSteer::TerrainRayTestTest::testLongRangeRays()
+{
+    // Shallow rays from high above cross most of the terrain before they
+    // come down, which is where RayTester skips blocks of cells.
+    RayTester tester;
+    tester.LoadData( fileName_ );
+    
+    Random random( 1234 );
+    float const edge = static_cast< float >( gridSize_ - 1 );
+    for ( int i = 0; i < 60; ++i ) {
+        double const eye[ 3 ] = { edge * random(), 12 + 20 * random(), edge * random() };
+        double const yaw = 6.283185307 * random();
+        double const pitch = -0.02 - 0.15 * random();
+        double const direction[ 3 ] = { std::cos( pitch ) * std::sin( yaw ), std::sin( pitch ), std::cos( pitch ) * std::cos( yaw ) };
+        
+        TRTScalar rayEye[ 3 ] = { static_cast< TRTScalar >( eye[ 0 ] ), static_cast< TRTScalar >( eye[ 1 ] ), static_cast< TRTScalar >( eye[ 2 ] ) };
+        TRTScalar rayDirection[ 3 ] = { static_cast< TRTScalar >( direction[ 0 ] ), static_cast< TRTScalar >( direction[ 1 ] ), static_cast< TRTScalar >( direction[ 2 ] ) };
+        RayTestInfo result;
+        tester.RayCast( result, rayEye, rayDirection );
+        
+        double const expected = nearestHit( gridSize_, eye, direction );
+        CPPUNIT_ASSERT_EQUAL( expected >= 0.0, result.hitOccurred );
+        if ( result.hitOccurred && expected >= 0.0 ) {
+            CPPUNIT_ASSERT_DOUBLES_EQUAL( expected, result.t, 0.001 );
+        }
+    }
+}
+
+
+
+void
+OpenSteer::TerrainRayTestTest::testCompiledMatchesLoaded()
+{
+    CPPUNIT_ASSERT( RayTester::CompileData( fileName_, compiledName_ ) );
+    
+    makeRays( 100, 32 );
+    int const rayCount = static_cast< int >( eyes_.size() / 3 );
+    
+    // Plain and with query ranges other than the data set's, unless the
+    // ranges are baked into the data.
+#ifdef TRT_TRANSFORM_DATA
+    int const rangeCases = 1;
+#else
+    int const rangeCases = 2;
+#endif
+    for ( int ranges = 0; ranges < rangeCases; ++ranges ) {
+        RayTester loaded;
+        RayTester compiled;
+        if ( 0 == ranges ) {
+            loaded.LoadData( fileName_ );
+            CPPUNIT_ASSERT( compiled.LoadCompiled( compiledName_ ) );
+        } else {
+            loaded.LoadData( fileName_, -300, 212, -20, 10, 100, 612 );
+            CPPUNIT_ASSERT( compiled.LoadCompiled( compiledName_, -300, 212, -20, 10, 100, 612 ) );
+        }
+        
+        int hits = 0;
+        for ( int i = 0; i < rayCount; ++i ) {
+            RayTestInfo expected;
+            RayTestInfo result;
+            loaded.RayCast( expected, &eyes_[ 3 * i ], &directions_[ 3 * i ] );
+            compiled.RayCast( result, &eyes_[ 3 * i ], &directions_[ 3 * i ] );
+            CPPUNIT_ASSERT( sameResult( expected, result ) );
+            hits += expected.hitOccurred ? 1 : 0;
+        }
+        CPPUNIT_ASSERT( 0 < hits );
+    }
+}
+
+
+
+void
+OpenSteer::TerrainRayTestTest::testCompiledRejectsOtherFiles()
+{
+    RayTester tester;
+    CPPUNIT_ASSERT( ! tester.LoadCompiled( "TerrainRayTestTest.missing" ) );
+    CPPUNIT_ASSERT( ! tester.LoadCompiled( fileName_ ) );
+    
+    // A truncated file.
+    CPPUNIT_ASSERT( RayTester::CompileData( fileName_, compiledName_ ) );
+    std::FILE* file = std::fopen( compiledName_, "rb" );
+    std::vector< char > contents( 100000 );
+    contents.resize( std::fread( &contents[ 0 ], 1, contents.size(), file ) );
+    std::fclose( file );
+    file = std::fopen( compiledName_, "wb" );
+    std::fwrite( &contents[ 0 ], 1, contents.size(), file );
+    std::fclose( file );
+    CPPUNIT_ASSERT( ! tester.LoadCompiled( compiledName_ ) );
+}
+
+
+
+void
+OpenSteer::TerrainRayTestTest::testCompactLayoutPrecision()
+{
+    // Vertices 0.37 apart are not exactly where the compact layout's
+    // regular grid puts them, so hits move by rounding errors and rays
+    // grazing an edge may hit the triangle next to it.
+    float const spacing = 0.37f;
+    writeTerrain( spacing );
+    makeRays( 200, 61 );
+    for ( std::size_t i = 0; i < eyes_.size(); i += 3 ) {
+        eyes_[ i ] *= spacing;
+        eyes_[ i + 2 ] *= spacing;
+    }
+    
+    RayTester full;
+    full.LoadData( fileName_ );
+    CPPUNIT_ASSERT( ! full.CompactLayout() );
+    
+    RayTester compact;
+    compact.SetCompactLayout( true );
+    compact.LoadData( fileName_ );
+    CPPUNIT_ASSERT( compact.CompactLayout() );
+    CPPUNIT_ASSERT( ! compact.SaveCompiled( compiledName_ ) );
+    
+    int const rayCount = static_cast< int >( eyes_.size() / 3 );
+    std::vector< RayTestInfo > batch( rayCount );
+    compact.RayCastBatch( &batch[ 0 ], &eyes_[ 0 ], &directions_[ 0 ], rayCount );
+    
+    int hits = 0;
+    int otherNormals = 0;
+    for ( int i = 0; i < rayCount; ++i ) {
+        RayTestInfo expected;
+        RayTestInfo result;
+        full.RayCast( expected, &eyes_[ 3 * i ], &directions_[ 3 * i ] );
+        compact.RayCast( result, &eyes_[ 3 * i ], &directions_[ 3 * i ] );
+        CPPUNIT_ASSERT( sameResult( result, batch[ i ] ) );
+        
+        CPPUNIT_ASSERT_EQUAL( expected.hitOccurred, result.hitOccurred );
+        if ( ! expected.hitOccurred || ! result.hitOccurred ) {
+            continue;
+        }
+        ++hits;
+        
+        CPPUNIT_ASSERT_DOUBLES_EQUAL( expected.t, result.t, 0.001 );
+        for ( int c = 0; c < 3; ++c ) {
+            CPPUNIT_ASSERT_DOUBLES_EQUAL( expected.pos[ c ], result.pos[ c ], 0.001 );
+        }
+        
+        // Normals are only unit length with TRT_PRECOMPUTE_NORMALS or TRT_NORMALIZE.
+        double const cosine = ( expected.norm[ 0 ] * result.norm[ 0 ] + expected.norm[ 1 ] * result.norm[ 1 ] + expected.norm[ 2 ] * result.norm[ 2 ] ) /
+            std::sqrt( ( expected.norm[ 0 ] * expected.norm[ 0 ] + expected.norm[ 1 ] * expected.norm[ 1 ] + expected.norm[ 2 ] * expected.norm[ 2 ] ) *
+                       ( result.norm[ 0 ] * result.norm[ 0 ] + result.norm[ 1 ] * result.norm[ 1 ] + result.norm[ 2 ] * result.norm[ 2 ] ) );
+        CPPUNIT_ASSERT( cosine > 0.99 );
+        otherNormals += cosine < 0.999999 ? 1 : 0;
+    }
+    
+    CPPUNIT_ASSERT( 0 < hits );
+    CPPUNIT_ASSERT( otherNormals * 100 < hits );
+}
+
+
+
+void
+OpenSteer::TerrainRayTestTest::testBatchBenchmark()
+{
+    RayTester tester;
+    tester.LoadData( fileName_ );
+    
+    int const vehicleCount = 1000;
+    int const raysPerVehicle = 64;
+    int const repetitions = 10;
+    makeRays( vehicleCount, raysPerVehicle );
+    
+    int const rayCount = static_cast< int >( eyes_.size() / 3 );
+    std::vector< RayTestInfo > scalar( rayCount );
+    std::vector< RayTestInfo > batch( rayCount );
+    
+    double const scalarStart = seconds();
+    for ( int r = 0; r < repetitions; ++r ) {
+        for ( int i = 0; i < rayCount; ++i ) {
+            tester.RayCast( scalar[ i ], &eyes_[ 3 * i ], &directions_[ 3 * i ] );
+        }
+    }
+    double const scalarTime = seconds() - scalarStart;
+    
+    // One batch per vehicle, as a sensor update would issue them.
+    double const batchStart = seconds();
+    for ( int r = 0; r < repetitions; ++r ) {
+        for ( int i = 0; i < rayCount; i += raysPerVehicle ) {
+            int const count = rayCount - i < raysPerVehicle ? rayCount - i : raysPerVehicle;
+            tester.RayCastBatch( &batch[ i ], &eyes_[ 3 * i ], &directions_[ 3 * i ], count );
+        }
+    }
+    double const batchTime = seconds() - batchStart;
+    
+    std::printf( "\nRayTester: %d rays x %d, RayCast %.1f ms, RayCastBatch %.1f ms\n",
+                 rayCount, repetitions, 1000.0 * scalarTime, 1000.0 * batchTime );
+    
+    for ( int i = 0; i < rayCount; ++i ) {
+        CPPUNIT_ASSERT( sameResult( scalar[ i ], batch[ i ] ) );
+    }
+}
+
+
+
+void
+OpenSteer::TerrainRayTestTest::writeTerrain( float spacing )
+{
+    // Same layout RayTester::LoadData reads: width, height, then x, y, z
+    // per vertex row by row.
+    std::FILE* file = std::fopen( fileName_, "wb" );
+    CPPUNIT_ASSERT( 0 != file );
+    
+    int const size = gridSize_;
+    std::fwrite( &size, sizeof( size ), 1, file );
+    std::fwrite( &size, sizeof( size ), 1, file );
+    for ( int z = 0; z < gridSize_; ++z ) {
+        for ( int x = 0; x < gridSize_; ++x ) {
+            float const vertex[ 3 ] = { spacing * x, terrainHeight( static_cast< float >( x ), static_cast< float >( z ) ), spacing * z };
+            std::fwrite( vertex, sizeof( float ), 3, file );
+        }
+    }
+    std::fclose( file );
+}
+
+
+
+void
+OpenSteer::TerrainRayTestTest::makeRays( int vehicleCount, int raysPerVehicle )
+{
+    Random random( 4711 );
+    float const edge = static_cast< float >( gridSize_ - 1 );
+    
+    eyes_.clear();
+    directions_.clear();
+    
+    for ( int v = 0; v < vehicleCount; ++v ) {
+        TRTScalar eye[ 3 ];
+        eye[ 0 ] = static_cast< TRTScalar >( 2 + ( edge - 4 ) * random() );
+        eye[ 2 ] = static_cast< TRTScalar >( 2 + ( edge - 4 ) * random() );
+        eye[ 1 ] = terrainHeight( static_cast< float >( eye[ 0 ] ), static_cast< float >( eye[ 2 ] ) ) + 2;
+        
+        // Every other vehicle is off the terrain or high above it.
+        switch ( v % 8 ) {
+            case 1: eye[ 0 ] = -20 - 50 * random(); break;
+            case 3: eye[ 2 ] = edge + 20 + 50 * random(); break;
+            case 5: eye[ 1 ] = 15 + 40 * random(); break;
+            case 7: eye[ 0 ] = edge + 10; eye[ 2 ] = -10; break;
+        }
+        
+        double const heading = 6.283185307 * random();
+        for ( int r = 0; r < raysPerVehicle; ++r ) {
+            double const yaw = heading + 6.283185307 * r / raysPerVehicle;
+            double const pitch = -0.35 + 0.5 * random();
+            TRTScalar direction[ 3 ] = {
+                static_cast< TRTScalar >( std::cos( pitch ) * std::sin( yaw ) ),
+                static_cast< TRTScalar >( std::sin( pitch ) ),
+                static_cast< TRTScalar >( std::cos( pitch ) * std::cos( yaw ) ) };
+            
+            // Axis aligned and vertical rays take special paths.
+            switch ( r % 16 ) {
+                case 3: direction[ 0 ] = 0; break;
+                case 7: direction[ 2 ] = 0; break;
+                case 11: direction[ 0 ] = direction[ 2 ] = 0; direction[ 1 ] = -1; break;
+                case 15: direction[ 0 ] = direction[ 2 ] = 0; direction[ 1 ] = 1; break;
+            }
+            
+            eyes_.insert( eyes_.end(), eye, eye + 3 );
+            directions_.insert( directions_.end(), direction, direction + 3 );
+        }
+    }
+}
+
+
+
+bool
+OpenSteer::TerrainRayTestTest::batchMatchesRayCast( RayTester const& tester, TRTScalar maxt ) const
+{
+    int const rayCount = static_cast< int >( eyes_.size() / 3 );
+    std::vector< RayTestInfo > batch( rayCount );
+    tester.RayCastBatch( &batch[ 0 ], &eyes_[ 0 ], &directions_[ 0 ], rayCount, maxt );
+    
+    int hits = 0;
+    for ( int i = 0; i < rayCount; ++i ) {
+        RayTestInfo scalar;
+        tester.RayCast( scalar, &eyes_[ 3 * i ], &directions_[ 3 * i ], maxt );
+        if ( ! sameResult( scalar, batch[ i ] ) ) {
+            return false;
+        }
+        hits += scalar.hitOccurred ? 1 : 0;
+    }
+    
+    // Both hits and misses were compared.
+    return 0 < hits || 0 == maxt;
+}
@@ -0,0 +1,121 @@
+/**
+ * OpenSteer -- Steering Behaviors for Autonomous Characters
+ *
+ * Copyright (c) 2002-2005, Sony Computer Entertainment America
+ * Original author: Craig Reynolds <craig_reynolds@playstation.sony.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ *
+ * @file
+ *
+ * Unit test for @c RayTester.
+ */
+
+#ifndef OPENSTEER_TERRAINRAYTESTTEST_H
+#define OPENSTEER_TERRAINRAYTESTTEST_H
+
+// Include std::vector
+#include <vector>
+
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <cppunit/TestFixture.h>
+
+
+
+// Include RayTester, RayTestInfo, TRTScalar
+#include "TerrainRayTest.h"
+
+
+namespace OpenSteer {
+    
+    
+    class TerrainRayTestTest : public CppUnit::TestFixture {
+    public:
+        TerrainRayTestTest();
+        virtual ~TerrainRayTestTest();
+        
+        virtual void setUp();
+        virtual void tearDown();
+        
+        CPPUNIT_TEST_SUITE(TerrainRayTestTest);
+        CPPUNIT_TEST(testBatchMatchesRayCast);
+        CPPUNIT_TEST(testBatchMatchesRayCastTransformed);
+        CPPUNIT_TEST(testBatchMaxT);
+        CPPUNIT_TEST(testLongRangeRays);
+        CPPUNIT_TEST(testCompiledMatchesLoaded);
+        CPPUNIT_TEST(testCompiledRejectsOtherFiles);
+        CPPUNIT_TEST(testCompactLayoutPrecision);
+        CPPUNIT_TEST(testBatchBenchmark);
+        CPPUNIT_TEST_SUITE_END();
+        
+    private:
+        /**
+         * Not implemented to make it non-copyable.
+         */
+        TerrainRayTestTest( TerrainRayTestTest const& );
+        
+        /**
+         * Not implemented to make it non-copyable.
+         */
+        TerrainRayTestTest& operator=( TerrainRayTestTest );
+        
+    private:
+        void testBatchMatchesRayCast();
+        void testBatchMatchesRayCastTransformed();
+        void testBatchMaxT();
+        void testLongRangeRays();
+        void testCompiledMatchesLoaded();
+        void testCompiledRejectsOtherFiles();
+        void testCompactLayoutPrecision();
+        void testBatchBenchmark();
+        
+        /**
+         * Writes the test terrain to @c fileName_ with @a spacing between
+         * neighboring vertices.
+         */
+        void writeTerrain( float spacing );
+        
+        /**
+         * Fills @c eyes_ and @c directions_ with @a vehicleCount sensor fans
+         * of @a raysPerVehicle rays over the terrain, plus some rays from
+         * outside it, straight up or down and from far above.
+         */
+        void makeRays( int vehicleCount, int raysPerVehicle );
+        
+        /**
+         * Returns @c true if @c RayCastBatch and @c RayCast return the same
+         * results, bit for bit, for every ray in @c eyes_ and @c directions_.
+         */
+        bool batchMatchesRayCast( RayTester const& tester, TRTScalar maxt ) const;
+        
+        
+        static int const gridSize_ = 257;
+        static char fileName_[];
+        static char compiledName_[];
+        std::vector< TRTScalar > eyes_;
+        std::vector< TRTScalar > directions_;
+        
+    }; // TerrainRayTestTest
+
+    
+} // namespace OpenSteer
+
+#endif // OPENSTEER_TERRAINRAYTESTTEST_H